@@ -0,0 +1,193 @@
+// Buffered vs O_DIRECT disk I/O under B+Tree point lookups and range scans.
+//
+// Builds a timestamp index larger than the buffer pool, then runs the same
+// lookups against it with each I/O mode, starting from a cold page cache.
+// Besides time per operation it reports how much of the disk file the
+// kernel page cache holds afterwards: memory buffered I/O spends on a
+// second copy of the pages. The last row runs direct I/O with that memory
+// handed to the buffer pool instead.
+//
+// Creates data/disk/cmse.disk in the current directory: run it from a
+// scratch directory.
+//
+// usage: bench_disk_io [keys] [pool_pages] [lookups]
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/btree/bplus_tree.h"
+
+using namespace cmse;
+
+namespace {
+
+constexpr IndexID INDEX_ID = 1;
+constexpr KeyType KEY_STEP = 10;
+
+PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+// Write back and evict the disk file from the page cache
+void DropFileCache() {
+    int fd = open(DISK_FILE_PATH.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+// Bytes of the disk file resident in the page cache
+uint64_t CachedFileBytes() {
+    int fd = open(DISK_FILE_PATH.c_str(), O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    uint64_t resident = 0;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        size_t size = static_cast<size_t>(st.st_size);
+        void *map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (map != MAP_FAILED) {
+            long os_page = sysconf(_SC_PAGESIZE);
+            std::vector<unsigned char> pages((size + os_page - 1) / os_page);
+            if (mincore(map, size, pages.data()) == 0) {
+                for (unsigned char p : pages) resident += (p & 1) ? os_page : 0;
+            }
+            munmap(map, size);
+        }
+    }
+    close(fd);
+    return resident;
+}
+
+struct RunResult {
+    double point_us = 0;
+    double range_us = 0;
+    uint64_t cached_bytes = 0;
+    DiskIoMode mode = DiskIoMode::BUFFERED;
+};
+
+RunResult Run(DiskIoMode mode, size_t pool_pages, uint64_t keys, size_t lookups) {
+    DropFileCache();
+
+    BufferPoolManager bpm(pool_pages, mode);
+    IndexCatalog catalog(&bpm);
+    BPlusTree tree(catalog.GetRoot(INDEX_ID), INDEX_ID, &catalog, &bpm);
+
+    std::mt19937_64 rng(11);
+    std::vector<RecordRef> result;
+    uint32_t temp = 0;
+    RunResult run;
+    run.mode = bpm.GetIoMode();
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; i++) {
+        tree.Search(rng() % keys * KEY_STEP, result, temp);
+    }
+    run.point_us = std::chrono::duration<double, std::micro>(
+                       std::chrono::steady_clock::now() - start).count() /
+                   static_cast<double>(lookups);
+
+    // ~2000 keys (8 leaves) per scan
+    size_t scans = std::max<size_t>(1, lookups / 10);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < scans; i++) {
+        KeyType low = rng() % keys * KEY_STEP;
+        result.clear();
+        tree.RangeSearch(low, low + 2000 * KEY_STEP, result, temp);
+    }
+    run.range_us = std::chrono::duration<double, std::micro>(
+                       std::chrono::steady_clock::now() - start).count() /
+                   static_cast<double>(scans);
+
+    run.cached_bytes = CachedFileBytes();
+    return run;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    uint64_t keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+    size_t pool_pages = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1024;
+    size_t lookups = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 50000;
+
+    if (std::filesystem::exists(DISK_FILE_PATH)) {
+        std::cerr << DISK_FILE_PATH << " exists; run from a scratch directory\n";
+        return 1;
+    }
+    std::filesystem::create_directories(std::filesystem::path(DISK_FILE_PATH).parent_path());
+
+    // build the index once, buffered
+    {
+        BufferPoolManager bpm(4096, DiskIoMode::BUFFERED);
+        IndexCatalog catalog(&bpm);
+        catalog.RegisterIndex(INDEX_ID, "timestamp", FieldType::NUMERIC, IndexType::BTREE,
+                              NewLeafRoot(bpm));
+        BPlusTree tree(catalog.GetRoot(INDEX_ID), INDEX_ID, &catalog, &bpm);
+        tree.SetAppendMode(true);
+
+        std::vector<std::pair<KeyType, RecordRef>> batch;
+        for (uint64_t i = 0; i < keys; i++) {
+            batch.emplace_back(i * KEY_STEP, RecordRef{i * 120});
+            if (batch.size() == 1024 || i + 1 == keys) {
+                tree.InsertBatch(batch);
+                batch.clear();
+            }
+        }
+    }
+    double file_mb = static_cast<double>(std::filesystem::file_size(DISK_FILE_PATH)) / (1 << 20);
+    std::cout << keys << " keys, " << std::fixed << std::setprecision(1) << file_mb
+              << " MB index file, " << lookups << " point lookups, " << lookups / 10
+              << " range scans\n\n";
+
+    RunResult buffered = Run(DiskIoMode::BUFFERED, pool_pages, keys, lookups);
+    RunResult direct = Run(DiskIoMode::DIRECT, pool_pages, keys, lookups);
+
+    // the page cache memory buffered I/O used, given to the pool
+    size_t grown_pool = pool_pages + buffered.cached_bytes / PAGE_SIZE;
+    RunResult direct_grown = Run(DiskIoMode::DIRECT, grown_pool, keys, lookups);
+
+    if (direct.mode != DiskIoMode::DIRECT) {
+        std::cout << "(O_DIRECT unsupported here: 'direct' rows ran buffered)\n";
+    }
+
+    std::cout << std::left << std::setw(12) << "I/O mode" << std::right << std::setw(12)
+              << "pool MB" << std::setw(14) << "point us/op" << std::setw(14) << "range us/op"
+              << std::setw(16) << "page cache MB" << std::setw(12) << "total MB" << "\n";
+    auto row = [&](const char *name, size_t pool, const RunResult &run) {
+        double pool_mb = static_cast<double>(pool * PAGE_SIZE) / (1 << 20);
+        double cache_mb = static_cast<double>(run.cached_bytes) / (1 << 20);
+        std::cout << std::left << std::setw(12) << name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << pool_mb << std::setw(14)
+                  << run.point_us << std::setw(14) << run.range_us << std::setw(16) << cache_mb
+                  << std::setw(12) << pool_mb + cache_mb << "\n";
+    };
+    row("buffered", pool_pages, buffered);
+    row("direct", pool_pages, direct);
+    row("direct+", grown_pool, direct_grown);
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+// B+Tree ingest of log timestamps: default inserts vs append mode.
+//
+// Keys follow a log stream: a clock advancing a few ticks per record, a
+// little jitter, duplicates, and a small share of late records. For each
+// insert strategy the benchmark reports buffer-pool page touches per
+// insert, the resulting index size and the average leaf fill.
+//
+// usage: bench_ingest [records]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/btree/bplus_tree.h"
+
+using namespace cmse;
+
+namespace {
+
+struct TreeShape {
+    uint64_t leaves = 0;
+    uint64_t internals = 0;
+    uint64_t keys = 0;
+};
+
+void Walk(BufferPoolManager &bpm, PageID page_id, TreeShape &shape) {
+    Page *page = bpm.FetchPage(page_id);
+    auto *header = reinterpret_cast<BPlusTreePageHeader *>(page->GetData());
+
+    if (header->is_leaf) {
+        shape.leaves++;
+        shape.keys += header->key_count;
+        bpm.UnpinPage(page_id, false);
+        return;
+    }
+
+    auto *internal = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
+    std::vector<PageID> children(internal->children,
+                                 internal->children + internal->header.key_count + 1);
+    shape.internals++;
+    bpm.UnpinPage(page_id, false);
+
+    for (PageID child : children) {
+        Walk(bpm, child, shape);
+    }
+}
+
+PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t records = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::mt19937_64 rng(5);
+    std::vector<std::pair<KeyType, RecordRef>> entries;
+    entries.reserve(records);
+    KeyType clock = 1'700'000'000;
+    for (size_t i = 0; i < records; i++) {
+        if (rng() % 4 == 0) clock++;
+        KeyType key = clock + rng() % 3;
+        if (rng() % 200 == 0) key -= rng() % 60;   // late record
+        entries.emplace_back(key, RecordRef{i * 120});
+    }
+
+    BufferPoolManager bpm(4096);
+    IndexCatalog catalog(&bpm);
+
+    struct Config {
+        const char *name;
+        bool append;
+        bool batch;
+    };
+    const Config configs[] = {
+        {"Insert", false, false},
+        {"Insert, append mode", true, false},
+        {"InsertBatch(1024)", false, true},
+        {"InsertBatch(1024), append mode", true, true},
+    };
+
+    std::cout << std::left << std::setw(34) << "strategy"
+              << std::right << std::setw(12) << "pages/ins"
+              << std::setw(10) << "leaves" << std::setw(10) << "internal"
+              << std::setw(10) << "fill" << std::setw(12) << "MB" << std::setw(12) << "ms" << "\n";
+
+    IndexID next_id = 1;
+    for (const auto &config : configs) {
+        IndexID id = next_id++;
+        catalog.RegisterIndex(id, "bench_" + std::to_string(id), FieldType::NUMERIC,
+                              IndexType::BTREE, NewLeafRoot(bpm));
+
+        uint64_t fetches_before = bpm.GetFetchCount();
+        auto start = std::chrono::steady_clock::now();
+        {
+            BPlusTree tree(catalog.GetRoot(id), id, &catalog, &bpm);
+            tree.SetAppendMode(config.append);
+
+            if (config.batch) {
+                for (size_t i = 0; i < entries.size(); i += 1024) {
+                    size_t n = std::min<size_t>(1024, entries.size() - i);
+                    tree.InsertBatch(std::span(entries).subspan(i, n));
+                }
+            } else {
+                for (const auto &[key, ref] : entries) {
+                    tree.Insert(key, ref);
+                }
+            }
+        }
+        double ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start).count();
+        uint64_t fetches = bpm.GetFetchCount() - fetches_before;
+
+        TreeShape shape;
+        Walk(bpm, catalog.GetRoot(id), shape);
+
+        double fill = static_cast<double>(shape.keys) /
+                      static_cast<double>(shape.leaves * BPLUS_TREE_LEAF_MAX_KEYS);
+        double mb = static_cast<double>((shape.leaves + shape.internals) * PAGE_SIZE) / (1 << 20);
+
+        std::cout << std::left << std::setw(34) << config.name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12)
+                  << static_cast<double>(fetches) / static_cast<double>(records)
+                  << std::setw(10) << shape.leaves << std::setw(10) << shape.internals
+                  << std::setw(9) << std::setprecision(0) << fill * 100 << "%"
+                  << std::setw(12) << std::setprecision(1) << mb
+                  << std::setw(12) << std::setprecision(0) << ms
+                  << (shape.keys == records ? "" : "  KEY COUNT MISMATCH") << "\n";
+    }
+
+    return 0;
+}
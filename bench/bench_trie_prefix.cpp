@@ -0,0 +1,124 @@
+// Parallel vs serial TrieIndex prefix search on a syslog-like message mix.
+//
+// Message templates follow a Zipf-like frequency (a few templates make up
+// most lines, as in real journald/syslog output); variable parts are drawn
+// from small vocabularies so the trie has realistic shared prefixes and a
+// few very large subtrees.
+//
+// usage: bench_trie_prefix [messages] [max_threads]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/common/thread_pool.h"
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/trie/trie.h"
+
+using namespace cmse;
+
+namespace {
+
+const std::vector<std::string> USERS = {"root", "www-data", "postgres", "backup", "deploy",
+                                        "alice", "bob", "carol", "nagios", "git"};
+const std::vector<std::string> SERVICES = {"sshd", "nginx", "cron", "docker", "postgresql",
+                                           "systemd-journald", "containerd", "kubelet"};
+const std::vector<std::string> DEVICES = {"sda1", "sda2", "nvme0n1p1", "nvme1n1p1", "dm-0"};
+
+std::string MakeMessage(std::mt19937_64 &rng, size_t template_id) {
+    auto pick = [&](const std::vector<std::string> &v) { return v[rng() % v.size()]; };
+    auto num = [&](uint64_t mod) { return std::to_string(rng() % mod); };
+
+    switch (template_id) {
+        case 0: return "pam_unix(cron:session): session opened for user " + pick(USERS) + "(uid=" + num(2000) + ")";
+        case 1: return "pam_unix(cron:session): session closed for user " + pick(USERS);
+        case 2: return "Started " + pick(SERVICES) + ".service";
+        case 3: return "Accepted publickey for " + pick(USERS) + " from 10.0." + num(4) + "." + num(64) + " port " + num(65536);
+        case 4: return "INFO " + pick(SERVICES) + " health check ok latency_ms=" + num(500);
+        case 5: return "WARN " + pick(SERVICES) + " slow request path=/api/v1/" + num(40);
+        case 6: return "ERROR disk_failure device=" + pick(DEVICES) + " sector=" + num(1000000);
+        case 7: return "ERROR connection refused upstream=" + pick(SERVICES) + ":" + num(10000);
+        default: return "EXT4-fs warning (device " + pick(DEVICES) + "): ext4_end_bio: I/O error " + num(16);
+    }
+}
+
+double Millis(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    size_t max_threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 8;
+
+    BufferPoolManager bpm(1 << 17);   // keep the trie resident
+    IndexCatalog catalog(&bpm);
+
+    PageID root_id;
+    Page *root_page = bpm.NewPage(&root_id);
+    auto *root = reinterpret_cast<TrieNodePage *>(root_page->GetData());
+    for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
+        root->children[i] = INVALID_PAGE_ID;
+    }
+    root->is_terminal = false;
+    root->record_count = 0;
+    catalog.SetRoot(1, root_id);
+    bpm.UnpinPage(root_id, true);
+
+    TrieIndex trie(root_id, &bpm);
+
+    // Zipf(1.1) over templates
+    const size_t TEMPLATES = 9;
+    std::vector<double> weights;
+    for (size_t i = 0; i < TEMPLATES; i++) {
+        weights.push_back(1.0 / std::pow(static_cast<double>(i + 1), 1.1));
+    }
+    std::discrete_distribution<size_t> zipf(weights.begin(), weights.end());
+    std::mt19937_64 rng(2024);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < messages; i++) {
+        trie.Insert(MakeMessage(rng, zipf(rng)), RecordRef{i * 128});
+    }
+    std::cout << "inserted " << messages << " messages in " << Millis(start) << " ms\n\n";
+
+    const std::vector<std::string> prefixes = {"E", "ERROR", "pam_unix(cron:session): session ", "Started ", "W"};
+
+    for (const auto &prefix : prefixes) {
+        std::vector<RecordRef> serial;
+        start = std::chrono::steady_clock::now();
+        trie.PrefixSearch(prefix, serial);
+        double serial_ms = Millis(start);
+
+        std::cout << "STARTSWITH \"" << prefix << "\": " << serial.size() << " records\n";
+        std::cout << "  serial            " << serial_ms << " ms\n";
+
+        for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+            ThreadPool pool(threads);
+
+            std::vector<RecordRef> parallel;
+            start = std::chrono::steady_clock::now();
+            trie.ParallelPrefixSearch(prefix, parallel, &pool);
+            double ms = Millis(start);
+
+            std::vector<RecordRef> capped;
+            trie.ParallelPrefixSearch(prefix, capped, &pool, 100);
+
+            bool ok = parallel.size() == serial.size() &&
+                      capped.size() == std::min<size_t>(100, serial.size());
+
+            std::cout << "  " << threads << " threads" << std::string(threads < 10 ? 9 : 8, ' ')
+                      << ms << " ms (x" << serial_ms / ms << ")"
+                      << (ok ? "" : "  MISMATCH") << "\n";
+        }
+    }
+
+    return 0;
+}
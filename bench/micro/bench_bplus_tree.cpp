@@ -0,0 +1,162 @@
+// B+Tree insert, point search and range scan, per key distribution and
+// tree size. Trees are resident (the pool holds them whole), so these
+// measure node layout and search cost rather than I/O. Read benchmarks
+// descend through the hot tier (hot_index_levels upper levels) and below
+// it through swizzled links (pointer_swizzling).
+//
+//   Insert/<dist>/keys:N        build an N-key tree one Insert at a time
+//   Search/<dist>/keys:N        Search of a random key present in the tree
+//   RangeScan/keys:N/span:S     RangeSearch returning ~S consecutive keys
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench_common.h"
+#include "../../include/index/index_catalog.h"
+#include "../../include/index/btree/bplus_tree.h"
+
+using namespace cmse;
+using namespace cmse::bench;
+
+namespace {
+
+constexpr IndexID INDEX_ID = 1;
+constexpr size_t POOL_PAGES = 1 << 15;
+const std::vector<int64_t> TREE_SIZES = {1 << 14, 1 << 17, 1 << 20};
+const KeyDistribution DISTRIBUTIONS[] = {KeyDistribution::SEQUENTIAL, KeyDistribution::LOG_CLOCK,
+                                         KeyDistribution::UNIFORM, KeyDistribution::ZIPF};
+
+// An empty timestamp index over a new disk file
+struct TreeFixture {
+    BufferPoolManager bpm;
+    IndexCatalog catalog;
+
+    explicit TreeFixture(const StorageOptions &options) : bpm(options), catalog(&bpm) {
+        catalog.RegisterIndex(INDEX_ID, "timestamp", FieldType::NUMERIC, IndexType::BTREE,
+                              NewLeafRoot(bpm));
+    }
+};
+
+// Trees for the read benchmarks, built once per (distribution, size)
+struct BuiltTree {
+    std::unique_ptr<ScratchDir> dir;
+    std::unique_ptr<TreeFixture> fixture;
+    std::vector<KeyType> keys;
+};
+
+BuiltTree &GetTree(KeyDistribution dist, size_t count) {
+    static std::map<std::pair<KeyDistribution, size_t>, BuiltTree> trees;
+
+    BuiltTree &tree = trees[{dist, count}];
+    if (!tree.fixture) {
+        tree.dir = std::make_unique<ScratchDir>(std::string("btree_") +
+                                                KeyDistributionName(dist) + std::to_string(count));
+        tree.fixture = std::make_unique<TreeFixture>(tree.dir->Options(POOL_PAGES));
+        tree.keys = MakeKeys(count, dist);
+
+        BPlusTree btree(tree.fixture->catalog.GetRoot(INDEX_ID), INDEX_ID,
+                        &tree.fixture->catalog, &tree.fixture->bpm);
+        for (size_t i = 0; i < count; i++) {
+            btree.Insert(tree.keys[i], RecordRef{i});
+        }
+        btree.FlushAppends();
+        std::sort(tree.keys.begin(), tree.keys.end());
+
+        // built outside a write epoch: searches start in the hot tier once
+        // the catalog has looked at the new tree
+        tree.fixture->catalog.RefreshHotLevels();
+    }
+    return tree;
+}
+
+void BM_BPlusTreeInsert(benchmark::State &state, KeyDistribution dist) {
+    const auto count = static_cast<size_t>(state.range(0));
+    std::vector<KeyType> keys = MakeKeys(count, dist);
+    ScratchDir dir(std::string("btree_insert_") + KeyDistributionName(dist));
+    StorageOptions options = dir.Options(POOL_PAGES);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::filesystem::remove(options.disk_file);
+        auto fixture = std::make_unique<TreeFixture>(options);
+        BPlusTree tree(fixture->catalog.GetRoot(INDEX_ID), INDEX_ID, &fixture->catalog,
+                       &fixture->bpm);
+        state.ResumeTiming();
+
+        for (size_t i = 0; i < count; i++) {
+            tree.Insert(keys[i], RecordRef{i});
+        }
+
+        state.PauseTiming();
+        tree.FlushAppends();
+        fixture.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
+}
+
+void BM_BPlusTreeSearch(benchmark::State &state, KeyDistribution dist) {
+    BuiltTree &built = GetTree(dist, static_cast<size_t>(state.range(0)));
+    BPlusTree tree(built.fixture->catalog.GetRoot(INDEX_ID), INDEX_ID, &built.fixture->catalog,
+                   &built.fixture->bpm);
+
+    std::mt19937_64 rng(1);
+    std::vector<RecordRef> result;
+    uint64_t pages = 0;
+    for (auto _ : state) {
+        KeyType key = built.keys[rng() % built.keys.size()];
+        uint32_t fetches = 0;
+        result.clear();
+        tree.Search(key, result, fetches);
+        benchmark::DoNotOptimize(result.data());
+        pages += fetches;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["pages/op"] = benchmark::Counter(static_cast<double>(pages),
+                                                    benchmark::Counter::kAvgIterations);
+}
+
+void BM_BPlusTreeRangeScan(benchmark::State &state) {
+    BuiltTree &built = GetTree(KeyDistribution::LOG_CLOCK, static_cast<size_t>(state.range(0)));
+    BPlusTree tree(built.fixture->catalog.GetRoot(INDEX_ID), INDEX_ID, &built.fixture->catalog,
+                   &built.fixture->bpm);
+    const auto span = std::min<size_t>(static_cast<size_t>(state.range(1)), built.keys.size());
+
+    std::mt19937_64 rng(1);
+    std::vector<RecordRef> result;
+    uint64_t records = 0;
+    for (auto _ : state) {
+        size_t first = rng() % (built.keys.size() - span + 1);
+        uint32_t fetches = 0;
+        result.clear();
+        tree.RangeSearch(built.keys[first], built.keys[first + span - 1], result, fetches);
+        records += result.size();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(records));
+}
+BENCHMARK(BM_BPlusTreeRangeScan)
+    ->ArgNames({"keys", "span"})
+    ->ArgsProduct({{1 << 17, 1 << 20}, {10, 1000, 100000}});
+
+[[maybe_unused]] const bool registered = [] {
+    for (KeyDistribution dist : DISTRIBUTIONS) {
+        std::string suffix = std::string("/") + KeyDistributionName(dist);
+        benchmark::RegisterBenchmark(("BM_BPlusTreeInsert" + suffix).c_str(), BM_BPlusTreeInsert, dist)
+            ->ArgName("keys")
+            ->ArgsProduct({TREE_SIZES})
+            ->Unit(benchmark::kMillisecond);
+        benchmark::RegisterBenchmark(("BM_BPlusTreeSearch" + suffix).c_str(), BM_BPlusTreeSearch, dist)
+            ->ArgName("keys")
+            ->ArgsProduct({TREE_SIZES});
+    }
+    return true;
+}();
+
+} // namespace
@@ -0,0 +1,141 @@
+// Buffer pool: FetchPage/UnpinPage on each path through the pool.
+//
+//   Hit             page resident, no I/O
+//   Miss/dirty:0    page not resident, victim clean: one read
+//   Miss/dirty:1    page not resident, victim dirty: one write, one read
+//   NewPage         fresh page over a full pool: evicts (and writes) the
+//                   previous new page; a fixed iteration count bounds the
+//                   disk file, which grows by a page per call
+//   RootHeavy       1 to 64 threads walking root -> inner -> leaf of a
+//                   resident three-level page tree, as every index lookup
+//                   does; snapshot:1 reads through a PageSnapshot, like
+//                   queries. All hits: measures the pin path's contention
+//
+// The misses cycle over a working set 16x the pool so the LRU victim is
+// never the page about to be fetched; reads are served by the kernel page
+// cache, so these measure the engine's per-miss cost, not the device's.
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "bench_common.h"
+
+using namespace cmse;
+using namespace cmse::bench;
+
+namespace {
+
+constexpr size_t POOL_PAGES = 64;
+constexpr size_t WORKING_SET = POOL_PAGES * 16;
+
+// pages 0..count-1 written to disk, none resident
+std::vector<PageID> MakePages(BufferPoolManager &bpm, size_t count) {
+    std::vector<PageID> ids;
+    for (size_t i = 0; i < count; i++) {
+        PageID id;
+        Page *page = bpm.NewPage(&id);
+        page->GetData()[0] = static_cast<char>(i);
+        bpm.UnpinPage(id, true);
+        ids.push_back(id);
+    }
+    bpm.FlushAllPages();
+    return ids;
+}
+
+void BM_BufferPoolHit(benchmark::State &state) {
+    ScratchDir dir("bpm_hit");
+    BufferPoolManager bpm(dir.Options(POOL_PAGES));
+    std::vector<PageID> ids = MakePages(bpm, POOL_PAGES / 2);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        PageID id = ids[i++ % ids.size()];
+        Page *page = bpm.FetchPage(id);
+        benchmark::DoNotOptimize(page->GetData()[0]);
+        bpm.UnpinPage(id, false);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BufferPoolHit);
+
+void BM_BufferPoolMiss(benchmark::State &state) {
+    const bool dirty = state.range(0) != 0;
+    ScratchDir dir("bpm_miss");
+    BufferPoolManager bpm(dir.Options(POOL_PAGES));
+    std::vector<PageID> ids = MakePages(bpm, WORKING_SET);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        PageID id = ids[i++ % ids.size()];
+        Page *page = bpm.FetchPage(id);
+        benchmark::DoNotOptimize(page->GetData()[0]);
+        bpm.UnpinPage(id, dirty);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * PAGE_SIZE * (dirty ? 2 : 1));
+}
+BENCHMARK(BM_BufferPoolMiss)->ArgName("dirty")->Arg(0)->Arg(1);
+
+void BM_BufferPoolNewPage(benchmark::State &state) {
+    ScratchDir dir("bpm_new");
+    BufferPoolManager bpm(dir.Options(POOL_PAGES));
+    MakePages(bpm, POOL_PAGES);
+
+    for (auto _ : state) {
+        PageID id;
+        Page *page = bpm.NewPage(&id);
+        benchmark::DoNotOptimize(page);
+        bpm.UnpinPage(id, true);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BufferPoolNewPage)->Iterations(20000);
+
+constexpr size_t TREE_INNER = 16;
+constexpr size_t TREE_LEAVES = 1024;
+
+// shared by the threads of a run (Setup/Teardown run once around them)
+struct RootHeavyPool {
+    ScratchDir dir{"bpm_root"};
+    BufferPoolManager bpm{dir.Options(2 * (1 + TREE_INNER + TREE_LEAVES))};
+    std::vector<PageID> ids = MakePages(bpm, 1 + TREE_INNER + TREE_LEAVES);
+};
+RootHeavyPool *root_heavy = nullptr;
+
+void SetupRootHeavy(const benchmark::State &) {
+    root_heavy = new RootHeavyPool();
+    for (PageID id : root_heavy->ids) {         // make every page resident
+        root_heavy->bpm.FetchPage(id);
+        root_heavy->bpm.UnpinPage(id, false);
+    }
+}
+
+void TeardownRootHeavy(const benchmark::State &) {
+    delete root_heavy;
+    root_heavy = nullptr;
+}
+
+void BM_BufferPoolRootHeavy(benchmark::State &state) {
+    BufferPoolManager &bpm = root_heavy->bpm;
+    const std::vector<PageID> &ids = root_heavy->ids;
+    PageSnapshot snapshot = state.range(0) != 0 ? bpm.OpenSnapshot() : PageSnapshot();
+    SnapshotScope scope(&snapshot);
+    std::mt19937_64 rng(state.thread_index());
+
+    for (auto _ : state) {
+        uint64_t r = rng();
+        PageID path[] = {ids[0], ids[1 + r % TREE_INNER], ids[1 + TREE_INNER + (r >> 8) % TREE_LEAVES]};
+        for (PageID id : path) {
+            Page *page = bpm.FetchPage(id);
+            benchmark::DoNotOptimize(page->GetData()[0]);
+            bpm.UnpinPage(id, false);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 3);
+}
+BENCHMARK(BM_BufferPoolRootHeavy)->ArgName("snapshot")->Arg(0)->Arg(1)
+    ->ThreadRange(1, 64)->UseRealTime()->Setup(SetupRootHeavy)->Teardown(TeardownRootHeavy);
+
+} // namespace
@@ -0,0 +1,137 @@
+#include "bench_common.h"
+
+#include <unistd.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+#include "../../include/index/btree/bplus_tree.h"
+#include "../../include/index/trie/trie.h"
+#include "../../include/ingest/log_generator.h"
+
+namespace cmse::bench {
+
+ScratchDir::ScratchDir(const std::string &name) {
+    auto dir = std::filesystem::temp_directory_path() /
+               ("cmse_bench_" + name + "_" + std::to_string(getpid()));
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    path_ = dir.string();
+}
+
+ScratchDir::~ScratchDir() {
+    std::error_code ec;
+    std::filesystem::remove_all(path_, ec);
+}
+
+StorageOptions ScratchDir::Options(size_t pool_pages, const std::string &disk_name) const {
+    StorageOptions options;
+    options.pool_pages = pool_pages;
+    options.disk_file = File(disk_name);
+    return options;
+}
+
+PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+PageID NewTrieRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *root = reinterpret_cast<TrieNodePage *>(page->GetData());
+    for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
+        root->children[i] = INVALID_PAGE_ID;
+    }
+    root->is_terminal = false;
+    root->record_count = 0;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+const char *KeyDistributionName(KeyDistribution dist) {
+    switch (dist) {
+        case KeyDistribution::SEQUENTIAL: return "sequential";
+        case KeyDistribution::LOG_CLOCK: return "log_clock";
+        case KeyDistribution::UNIFORM: return "uniform";
+        case KeyDistribution::ZIPF: return "zipf";
+    }
+    return "?";
+}
+
+std::vector<KeyType> MakeKeys(size_t count, KeyDistribution dist, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<KeyType> keys;
+    keys.reserve(count);
+
+    switch (dist) {
+        case KeyDistribution::SEQUENTIAL:
+            for (size_t i = 0; i < count; i++) keys.push_back(1000000 + i * 10);
+            break;
+
+        case KeyDistribution::LOG_CLOCK: {
+            KeyType clock = 1000000;
+            for (size_t i = 0; i < count; i++) {
+                clock += rng() % 4;
+                // 1% arrive late, up to ~1000 ticks behind
+                keys.push_back(rng() % 100 == 0 && clock > 1000 ? clock - rng() % 1000 : clock);
+            }
+            break;
+        }
+
+        case KeyDistribution::UNIFORM:
+            for (size_t i = 0; i < count; i++) keys.push_back(rng() >> 1);
+            break;
+
+        case KeyDistribution::ZIPF: {
+            // rank r drawn with P ~ 1/r over count/4 distinct keys (inverse CDF
+            // of the continuous approximation)
+            double distinct = std::max<double>(2.0, static_cast<double>(count) / 4.0);
+            std::uniform_real_distribution<double> u(0.0, 1.0);
+            for (size_t i = 0; i < count; i++) {
+                auto rank = static_cast<KeyType>(std::pow(distinct, u(rng)));
+                keys.push_back(1000000 + rank * 7919 % (static_cast<KeyType>(distinct) * 10));
+            }
+            break;
+        }
+    }
+    return keys;
+}
+
+std::string MakeLogMessage(std::mt19937_64 &rng) {
+    static const std::vector<double> weights = [] {
+        std::vector<double> w;
+        for (size_t k = 1; k <= LogGenerator::TemplateCount(); k++) {
+            w.push_back(1.0 / std::pow(static_cast<double>(k), 1.1));
+        }
+        return w;
+    }();
+    std::discrete_distribution<size_t> zipf(weights.begin(), weights.end());
+    return LogGenerator::MakeMessage(rng, zipf(rng));
+}
+
+KeyType WriteSyntheticLog(const std::string &path, size_t lines, KeyType first_timestamp,
+                          uint64_t seed) {
+    LogGeneratorOptions options;
+    options.seed = seed;
+    options.start_timestamp = first_timestamp;
+    options.ticks_per_second = 1;
+    options.rate = 1.0 / 1.5;
+    LogGenerator generator(options);
+
+    std::ofstream out(path, std::ios::trunc);
+    for (size_t i = 0; i < lines; i++) {
+        out << generator.NextLine() << "\n";
+    }
+    return generator.Clock() + 1;
+}
+
+} // namespace cmse::bench
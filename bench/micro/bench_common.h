@@ -0,0 +1,57 @@
+#pragma once
+
+// Fixtures shared by the cmse_bench suites.
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../include/common/storage_options.h"
+#include "../../include/common/types.h"
+#include "../../include/storage/buffer_pool_manager.h"
+
+namespace cmse::bench {
+
+// A private directory under the system temp dir, removed on destruction,
+// so benchmarks never touch data/disk/cmse.disk
+class ScratchDir {
+public:
+    explicit ScratchDir(const std::string &name);
+    ~ScratchDir();
+
+    ScratchDir(const ScratchDir &) = delete;
+    ScratchDir &operator=(const ScratchDir &) = delete;
+
+    std::string File(const std::string &name) const { return path_ + "/" + name; }
+
+    // Options for a pool of pool_pages frames over File(disk_name)
+    StorageOptions Options(size_t pool_pages, const std::string &disk_name = "bench.disk") const;
+
+private:
+    std::string path_;
+};
+
+PageID NewLeafRoot(BufferPoolManager &bpm);
+PageID NewTrieRoot(BufferPoolManager &bpm);
+
+enum class KeyDistribution : int {
+    SEQUENTIAL,     // strictly increasing
+    LOG_CLOCK,      // log timestamps: a few ticks apart, jitter, duplicates, late records
+    UNIFORM,        // uniform over 64-bit keys
+    ZIPF,           // few hot keys, long tail (many duplicates)
+};
+
+const char *KeyDistributionName(KeyDistribution dist);
+
+std::vector<KeyType> MakeKeys(size_t count, KeyDistribution dist, uint64_t seed = 42);
+
+// syslog-like message: a Zipf-distributed LogGenerator template
+std::string MakeLogMessage(std::mt19937_64 &rng);
+
+// LogGenerator lines with default mixes, ~1.5 timestamp ticks apart,
+// starting at first_timestamp; returns the timestamp after the last one
+KeyType WriteSyntheticLog(const std::string &path, size_t lines, KeyType first_timestamp,
+                          uint64_t seed = 7);
+
+} // namespace cmse::bench
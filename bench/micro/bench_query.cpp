@@ -0,0 +1,142 @@
+// End-to-end queries over an indexed synthetic log (200000 lines,
+// timestamp B+Tree + severity trie with Bloom filters, as cmse sets up),
+// and the RefReader fetch every returned record costs.
+//
+//   RefReaderRead              read one random indexed line from the log
+//   Query/<name>               QueryParser::Parse + QueryExecutor::Execute,
+//                              output formatted into a discarding stream
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "bench_common.h"
+#include "../../include/index/index_catalog.h"
+#include "../../include/index/btree/bplus_tree.h"
+#include "../../include/ingest/log_ingestor.h"
+#include "../../include/query/query_executor.h"
+#include "../../include/query/query_parser.h"
+#include "../../include/query/ref_reader.h"
+
+using namespace cmse;
+using namespace cmse::bench;
+
+namespace {
+
+constexpr IndexID TIMESTAMP_INDEX_ID = 1;
+constexpr IndexID SEVERITY_INDEX_ID = 2;
+constexpr size_t LOG_LINES = 200000;
+constexpr KeyType FIRST_TIMESTAMP = 1000000;
+constexpr size_t POOL_PAGES = 1 << 14;
+
+// Counts what the executor writes, keeps none of it
+class DiscardBuf : public std::streambuf {
+public:
+    uint64_t bytes = 0;
+
+protected:
+    int overflow(int c) override {
+        bytes++;
+        return c;
+    }
+    std::streamsize xsputn(const char *, std::streamsize n) override {
+        bytes += static_cast<uint64_t>(n);
+        return n;
+    }
+};
+
+struct IndexedLog {
+    ScratchDir dir{"query"};
+    std::string log_path = dir.File("app.log");
+    KeyType last_timestamp = WriteSyntheticLog(log_path, LOG_LINES, FIRST_TIMESTAMP);
+    BufferPoolManager bpm{dir.Options(POOL_PAGES)};
+    IndexCatalog catalog{&bpm};
+    RefReader reader{log_path};
+    std::unique_ptr<QueryExecutor> executor;
+    std::vector<RecordRef> refs;
+
+    IndexedLog() {
+        catalog.RegisterIndex(TIMESTAMP_INDEX_ID, "timestamp", FieldType::NUMERIC,
+                              IndexType::BTREE, NewLeafRoot(bpm));
+        catalog.RegisterIndex(SEVERITY_INDEX_ID, "severity", FieldType::STRING,
+                              IndexType::TRIE, NewTrieRoot(bpm));
+        catalog.EnableBloomFilter(TIMESTAMP_INDEX_ID);
+        catalog.EnableBloomFilter(SEVERITY_INDEX_ID);
+
+        LogIngestor ingestor(log_path, &bpm, &catalog);
+        if (ingestor.Start()) {
+            ingestor.Wait();
+        }
+
+        BPlusTree tree(catalog.GetRoot(TIMESTAMP_INDEX_ID), TIMESTAMP_INDEX_ID, &catalog, &bpm);
+        uint32_t fetches = 0;
+        tree.RangeSearch(0, last_timestamp, refs, fetches);
+
+        executor = std::make_unique<QueryExecutor>(&bpm, &catalog, &reader);
+    }
+};
+
+IndexedLog &GetLog() {
+    static IndexedLog log;
+    return log;
+}
+
+void BM_RefReaderRead(benchmark::State &state) {
+    IndexedLog &log = GetLog();
+
+    std::mt19937_64 rng(1);
+    uint64_t bytes = 0;
+    for (auto _ : state) {
+        std::string line = log.reader.Read(log.refs[rng() % log.refs.size()]);
+        bytes += line.size();
+        benchmark::DoNotOptimize(line.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_RefReaderRead);
+
+void BM_Query(benchmark::State &state, std::string text) {
+    IndexedLog &log = GetLog();
+
+    DiscardBuf buf;
+    std::ostream out(&buf);
+    for (auto _ : state) {
+        Query query;
+        if (!QueryParser::Parse(text, query)) {
+            state.SkipWithError(("cannot parse: " + text).c_str());
+            break;
+        }
+        log.executor->Execute(query, out);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["out_bytes/op"] = benchmark::Counter(static_cast<double>(buf.bytes),
+                                                        benchmark::Counter::kAvgIterations);
+}
+
+[[maybe_unused]] const bool registered = [] {
+    // the log spans timestamps ~1000000..~1300000, 1.5 ticks per line
+    const std::pair<const char *, const char *> queries[] = {
+        {"point", "WHERE timestamp EQUALS 1150000"},
+        {"range_100", "WHERE timestamp BETWEEN 1150000,1150150"},
+        {"range_10k", "WHERE timestamp BETWEEN 1150000,1165000"},
+        {"count_all", "COUNT WHERE timestamp BETWEEN 0,9999999"},
+        {"max_range", "MAX WHERE timestamp BETWEEN 1100000,1200000"},
+        {"count_group", "COUNT WHERE timestamp BETWEEN 1000000,1300000 GROUP BY 10000"},
+        {"severity_count", "COUNT WHERE severity EQUALS \"ERROR\""},
+        {"severity_absent", "WHERE severity EQUALS \"FATAL\""},
+        {"range_and_severity",
+         "WHERE timestamp BETWEEN 1150000,1153000 AND severity EQUALS \"ERROR\""},
+    };
+    for (const auto &[name, text] : queries) {
+        benchmark::RegisterBenchmark((std::string("BM_Query/") + name).c_str(), BM_Query,
+                                     std::string(text));
+    }
+    return true;
+}();
+
+} // namespace
@@ -0,0 +1,159 @@
+// TrieIndex over a synthetic syslog corpus (see MakeLogMessage).
+//
+//   Insert/messages:N        insert N messages into an empty trie
+//   Exact/messages:N         ExactSearch of a message in the trie
+//   ExactMiss/messages:N     ExactSearch of an absent message
+//   Prefix/<prefix>          PrefixSearch over a 20000-message trie
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench_common.h"
+#include "../../include/index/index_catalog.h"
+#include "../../include/index/trie/trie.h"
+
+using namespace cmse;
+using namespace cmse::bench;
+
+namespace {
+
+constexpr IndexID INDEX_ID = 2;
+constexpr size_t POOL_PAGES = 1 << 17;   // keep the trie resident
+
+std::vector<std::string> MakeCorpus(size_t count, uint64_t seed = 2024) {
+    std::mt19937_64 rng(seed);
+    std::vector<std::string> messages;
+    messages.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        messages.push_back(MakeLogMessage(rng));
+    }
+    return messages;
+}
+
+struct TrieFixture {
+    BufferPoolManager bpm;
+    IndexCatalog catalog;
+
+    explicit TrieFixture(const StorageOptions &options) : bpm(options), catalog(&bpm) {
+        catalog.RegisterIndex(INDEX_ID, "message", FieldType::STRING, IndexType::TRIE,
+                              NewTrieRoot(bpm));
+    }
+
+    TrieIndex Trie() { return TrieIndex(catalog.GetRoot(INDEX_ID), &bpm, INVALID_PAGE_ID, nullptr, INDEX_ID); }
+};
+
+struct BuiltTrie {
+    std::unique_ptr<ScratchDir> dir;
+    std::unique_ptr<TrieFixture> fixture;
+    std::vector<std::string> messages;
+};
+
+BuiltTrie &GetTrie(size_t count) {
+    static std::map<size_t, BuiltTrie> tries;
+
+    BuiltTrie &built = tries[count];
+    if (!built.fixture) {
+        built.dir = std::make_unique<ScratchDir>("trie_" + std::to_string(count));
+        built.fixture = std::make_unique<TrieFixture>(built.dir->Options(POOL_PAGES));
+        built.messages = MakeCorpus(count);
+
+        TrieIndex trie = built.fixture->Trie();
+        for (size_t i = 0; i < count; i++) {
+            trie.Insert(built.messages[i], RecordRef{i * 128});
+        }
+    }
+    return built;
+}
+
+void BM_TrieInsert(benchmark::State &state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    std::vector<std::string> messages = MakeCorpus(count);
+    ScratchDir dir("trie_insert");
+    StorageOptions options = dir.Options(POOL_PAGES);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::filesystem::remove(options.disk_file);
+        auto fixture = std::make_unique<TrieFixture>(options);
+        TrieIndex trie = fixture->Trie();
+        state.ResumeTiming();
+
+        for (size_t i = 0; i < count; i++) {
+            trie.Insert(messages[i], RecordRef{i * 128});
+        }
+
+        state.PauseTiming();
+        fixture.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
+}
+BENCHMARK(BM_TrieInsert)->ArgName("messages")->Arg(2000)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+void BM_TrieExact(benchmark::State &state) {
+    BuiltTrie &built = GetTrie(static_cast<size_t>(state.range(0)));
+    TrieIndex trie = built.fixture->Trie();
+
+    std::mt19937_64 rng(1);
+    std::vector<RecordRef> result;
+    for (auto _ : state) {
+        result.clear();
+        trie.ExactSearch(built.messages[rng() % built.messages.size()], result);
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TrieExact)->ArgName("messages")->Arg(2000)->Arg(20000);
+
+void BM_TrieExactMiss(benchmark::State &state) {
+    BuiltTrie &built = GetTrie(static_cast<size_t>(state.range(0)));
+    TrieIndex trie = built.fixture->Trie();
+
+    // same templates, other random fields: diverges from the trie late
+    std::vector<std::string> absent = MakeCorpus(1000, 99);
+    size_t i = 0;
+    std::vector<RecordRef> result;
+    for (auto _ : state) {
+        result.clear();
+        trie.ExactSearch(absent[i++ % absent.size()] + "~", result);
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TrieExactMiss)->ArgName("messages")->Arg(2000)->Arg(20000);
+
+void BM_TriePrefix(benchmark::State &state, std::string prefix) {
+    BuiltTrie &built = GetTrie(20000);
+    TrieIndex trie = built.fixture->Trie();
+
+    std::vector<RecordRef> result;
+    for (auto _ : state) {
+        result.clear();
+        trie.PrefixSearch(prefix, result);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(result.size()));
+    state.counters["matches"] = static_cast<double>(result.size());
+}
+
+[[maybe_unused]] const bool registered = [] {
+    // from one huge subtree down to a narrow one
+    const std::pair<const char *, const char *> prefixes[] = {
+        {"p", "pam_unix"},
+        {"session_closed", "pam_unix(cron:session): session closed for user "},
+        {"Started", "Started "},
+        {"Accepted_root", "Accepted publickey for root from "},
+        {"EXT4_dm0", "EXT4-fs warning (device dm-0)"},
+    };
+    for (const auto &[name, prefix] : prefixes) {
+        benchmark::RegisterBenchmark((std::string("BM_TriePrefix/") + name).c_str(), BM_TriePrefix,
+                                     std::string(prefix));
+    }
+    return true;
+}();
+
+} // namespace
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace cmse {
+
+/**
+ * Blocking FIFO with a fixed capacity, used between pipeline stages.
+ *
+ * A full queue blocks the producer (back-pressure); the time producers
+ * spend blocked is accumulated so a slow downstream stage shows up in
+ * the statistics. Close() wakes everyone: Push fails from then on, Pop
+ * drains what is left and then fails.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity) {}
+
+    bool Push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if (items_.size() >= capacity_ && !closed_) {
+            auto start = std::chrono::steady_clock::now();
+            not_full_.wait(lock, [&] { return items_.size() < capacity_ || closed_; });
+            blocked_us_ += static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+            full_events_++;
+        }
+        if (closed_) {
+            return false;
+        }
+
+        items_.push_back(std::move(item));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    bool Pop(T &out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [&] { return !items_.empty() || closed_; });
+        if (items_.empty()) {
+            return false;
+        }
+
+        out = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void Close() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        closed_ = true;
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+    size_t Size() const {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return items_.size();
+    }
+
+    size_t Capacity() const { return capacity_; }
+
+    // Total time producers waited on a full queue, and how often
+    uint64_t BlockedMicros() const {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return blocked_us_;
+    }
+
+    uint64_t FullEvents() const {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return full_events_;
+    }
+
+private:
+    const size_t capacity_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<T> items_;
+    bool closed_ = false;
+
+    uint64_t blocked_us_ = 0;
+    uint64_t full_events_ = 0;
+};
+
+} // namespace cmse
@@ -11,6 +11,26 @@ namespace cmse {
 // Number of pages that can be held in memory
 constexpr size_t DEFAULT_BUFFER_POOL_SIZE = 128;
 
+// Back frame data with huge pages when the pool spans at least one (2 MiB):
+// MAP_HUGETLB if reserved, else transparent huge pages, else 4 KiB pages
+constexpr bool BUFFER_POOL_HUGE_PAGES = true;
+
+// On multi-node machines, place one partition of the frames on each NUMA
+// node and hand threads free frames from their own node first
+constexpr bool BUFFER_POOL_NUMA_PARTITIONS = false;
+
+// Hot tier: index roots and the levels just below them (HOT_INDEX_LEVELS
+// levels, 0 = none) stay in the pool for good, and descents reach them by
+// swizzled page id without a page table lookup. At most
+// BUFFER_POOL_HOT_PAGES pages, and never more than a quarter of the pool.
+constexpr size_t BUFFER_POOL_HOT_PAGES = 256;
+constexpr size_t HOT_INDEX_LEVELS = 2;
+
+// Pointer swizzling: B+Tree descents link each internal page's frame to the
+// frames its children were found in and follow those links next time, with
+// no page table lookup; a link goes away when either page is evicted
+constexpr bool BUFFER_POOL_POINTER_SWIZZLING = true;
+
 // ================================
 // Disk Configuration
 // ================================
@@ -18,6 +38,104 @@ constexpr size_t DEFAULT_BUFFER_POOL_SIZE = 128;
 // Path to simulated disk file
 inline const std::string DISK_FILE_PATH = "data/disk/cmse.disk";
 
+enum class DiskIoMode {
+    BUFFERED,   // through the kernel page cache
+    DIRECT      // O_DIRECT: pages cached only in the buffer pool
+};
+
+// Default I/O mode (serve/interactive: --direct-io). Direct I/O stops the
+// page cache from holding a second copy of every index page; spend that
+// memory on a bigger buffer pool instead. Falls back to buffered I/O on
+// file systems without O_DIRECT support.
+constexpr DiskIoMode DISK_IO_MODE = DiskIoMode::BUFFERED;
+
+// ================================
+// B+Tree
+// ================================
+
+// Append mode: share of keys the left node keeps when the rightmost leaf
+// (or an internal node growing at its right edge) splits. Monotonic keys
+// then leave nodes 90% full instead of half full; the slack absorbs
+// slightly late records.
+constexpr double BPLUS_TREE_APPEND_SPLIT_FILL = 0.9;
+
+// ================================
+// Bloom filters
+// ================================
+
+// Target false-positive rate: share of absent-key point lookups that still
+// descend the index
+constexpr double BLOOM_FILTER_FPR = 0.01;
+
+// Keys the first layer of a growing filter is sized for; every further
+// layer doubles the capacity (at half the false-positive rate)
+constexpr uint64_t BLOOM_FILTER_INITIAL_KEYS = 64 * 1024;
+
+// ================================
+// LSM write buffer (optional, see LsmWriteBuffer)
+// ================================
+
+// Memtable entries before it is frozen and written out as a sorted run
+constexpr size_t LSM_MEMTABLE_MAX_ENTRIES = 64 * 1024;
+
+// Sorted runs that accumulate before compaction merges them into the tree
+constexpr size_t LSM_COMPACTION_TRIGGER_RUNS = 4;
+
+// Merged entries inserted into the tree per index latch hold (and write epoch)
+constexpr size_t LSM_COMPACTION_CHUNK = 4096;
+
+// ================================
+// Parallel scans
+// ================================
+
+// Key sub-ranges to aim for per worker (extra ones feed work stealing)
+constexpr size_t PARALLEL_SCAN_PARTITIONS_PER_THREAD = 4;
+
+// How many internal levels (from the root) may be read to find split keys
+constexpr size_t PARALLEL_SCAN_PARTITION_LEVELS = 2;
+
+// Trie levels below the prefix node that fork one task per child edge;
+// deeper subtrees are walked serially by the task that reaches them
+constexpr size_t PARALLEL_TRIE_SPAWN_DEPTH = 3;
+
+// A task whose pending-node stack grows past this hands half of it to a
+// new task, so long unbalanced chains are stolen by idle workers
+constexpr size_t PARALLEL_TRIE_SPLIT_STACK = 64;
+
+// ================================
+// Log ingestion
+// ================================
+
+// Lines per batch handed between pipeline stages (and per write epoch)
+constexpr size_t INGEST_BATCH_LINES = 1024;
+
+// Batches each inter-stage queue holds before the producer blocks
+constexpr size_t INGEST_QUEUE_BATCHES = 16;
+
+// Bytes read from the log per read() call
+constexpr size_t INGEST_READ_CHUNK = 256 * 1024;
+
+// When following a log: longest wait for new data (inotify or not)
+constexpr int INGEST_POLL_INTERVAL_MS = 200;
+
+// ================================
+// Query Planner cost model
+// ================================
+//
+// All costs are expressed in units of one random page read.
+
+constexpr double PLANNER_RANDOM_PAGE_COST = 1.0;
+constexpr double PLANNER_SEQ_PAGE_COST = 0.1;       // sequential log read
+constexpr double PLANNER_RECORD_FETCH_COST = 1.0;   // one RefReader::Read
+constexpr double PLANNER_CPU_RECORD_COST = 0.01;    // evaluating one ref/record
+
+// Fallbacks when an index has no statistics
+constexpr double PLANNER_AVG_RECORD_BYTES = 128.0;
+constexpr double PLANNER_DEFAULT_EQ_SELECTIVITY = 0.005;
+constexpr double PLANNER_DEFAULT_PREFIX_SELECTIVITY = 0.05;
+constexpr double PLANNER_BTREE_LEAF_FILL = 0.69;    // average leaf occupancy
+constexpr double PLANNER_TRIE_PAGES_PER_MATCH = 4.0;
+
 // ================================
 // Debug / Logging
 // ================================
@@ -9,8 +9,18 @@ namespace cmse {
 // Storage constants
 // ================================
 
-// Size of a disk page (bytes)
-constexpr size_t PAGE_SIZE = 4096;
+// Size of a disk page (bytes). Chosen per build (cmake -DCMSE_PAGE_SIZE=):
+// every page layout below is sized from it, and the disk file records it.
+#ifndef CMSE_PAGE_SIZE
+#define CMSE_PAGE_SIZE 4096
+#endif
+constexpr size_t PAGE_SIZE = CMSE_PAGE_SIZE;
+static_assert(PAGE_SIZE == 4096 || PAGE_SIZE == 8192 || PAGE_SIZE == 16384 || PAGE_SIZE == 65536,
+              "CMSE_PAGE_SIZE must be 4, 8, 16 or 64 KiB");
+
+// The disk file header (see DiskFileHeader) sits at this offset of page 0,
+// behind the catalog directory, within the smallest page size
+constexpr size_t DISK_FILE_HEADER_OFFSET = 4096 - 16;
 
 // ================================
 // Invalid identifiers
@@ -24,14 +34,48 @@ constexpr uint32_t INVALID_FRAME_ID = static_cast<uint32_t>(-1);
 // ================================
 
 constexpr uint32_t MAX_PIN_COUNT = 1'000'000;
-constexpr uint32_t MAX_INDEXES = 16;
+// indexes in one catalog; the directory of old files held at most 16
+constexpr uint32_t MAX_INDEXES = 4096;
+constexpr uint32_t LEGACY_MAX_INDEXES = 16;
+// threads reading at an epoch at once (snapshots, see EpochManager)
+constexpr size_t EPOCH_MAX_READERS = 256;
 
 // ================================
 // B+Tree limitations
 // ================================
 //
-constexpr size_t BPLUS_TREE_LEAF_MAX_KEYS = 254;
-constexpr size_t BPLUS_TREE_INTERNAL_MAX_KEYS = 254;
+// A node holds one extra slot so an insert can overflow it before the
+// split; these values keep both page layouts within PAGE_SIZE (253 and 200
+// at 4 KiB). They are the capacity; StorageOptions may set lower limits.
+constexpr size_t BPLUS_TREE_LEAF_MAX_KEYS = (PAGE_SIZE - 24) / 16 - 1;
+constexpr size_t BPLUS_TREE_INTERNAL_MAX_KEYS = (PAGE_SIZE - 72) / 20 - 1;
+
+// ================================
+// LSM write buffer
+// ================================
+//
+// (key, RecordRef) pairs per sorted-run page, after the entry count
+constexpr size_t LSM_RUN_PAGE_ENTRIES = (PAGE_SIZE - 8) / 16;
+
+// ================================
+// Bloom filters
+// ================================
+//
+// A key's bits all fall into one block of one cache line
+constexpr size_t BLOOM_FILTER_BLOCK_BYTES = 64;
+constexpr size_t BLOOM_FILTER_BLOCK_WORDS = BLOOM_FILTER_BLOCK_BYTES / sizeof(uint64_t);
+constexpr uint32_t BLOOM_FILTER_MAX_LAYERS = 32;
+constexpr uint32_t BLOOM_FILTER_MAX_PROBES = 16;
+// blocks per persisted filter page, after the page header
+constexpr size_t BLOOM_FILTER_PAGE_BLOCKS = (PAGE_SIZE - 16) / BLOOM_FILTER_BLOCK_BYTES;
+
+// ================================
+// Index statistics
+// ================================
+//
+constexpr uint32_t INDEX_STATS_HISTOGRAM_BUCKETS = 64;
+constexpr uint32_t INDEX_STATS_HLL_PRECISION = 11;
+constexpr uint32_t INDEX_STATS_HLL_REGISTERS = 1u << INDEX_STATS_HLL_PRECISION;
 
 // ================================
 // Trie limitations
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace cmse {
+
+// 64-bit finalizer (MurmurHash3 fmix64): good avalanche for integer keys
+inline uint64_t HashKey(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+// FNV-1a over the bytes, then finalized
+inline uint64_t HashBytes(const char *data, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= static_cast<uint8_t>(data[i]);
+        h *= 0x100000001b3ULL;
+    }
+    return HashKey(h);
+}
+
+inline uint64_t HashString(const std::string &s) {
+    return HashBytes(s.data(), s.size());
+}
+
+} // namespace cmse
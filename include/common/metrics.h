@@ -0,0 +1,219 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "constants.h"
+#include "types.h"
+
+namespace cmse {
+
+// ================================
+// What is counted
+// ================================
+
+enum class Counter : uint32_t {
+    BUFFER_POOL_HITS,
+    BUFFER_POOL_MISSES,
+    BUFFER_POOL_EVICTIONS,
+    BUFFER_POOL_DIRTY_WRITEBACKS,   // dirty victims written on eviction
+    BUFFER_POOL_FLUSHES,            // pages written by FlushPage/FlushAllPages
+    PAGE_VERSIONS_SAVED,            // page images kept for snapshot readers
+    PAGE_VERSION_READS,             // snapshot reads served from an older image
+    HOT_PAGE_HITS,                  // fetches by swizzled id served from the hot tier
+    HOT_PAGE_PINS,                  // pages added to the hot tier
+    HOT_PAGE_UNPINS,                // pages released from it
+    SWIZZLED_HITS,                  // child fetches served through a frame link
+    PAGE_SWIZZLES,                  // parent -> child frame links made
+    PAGE_UNSWIZZLES,                // links dropped as a page left its frame
+    DISK_READS,
+    DISK_WRITES,
+    DISK_READ_BYTES,
+    DISK_WRITE_BYTES,
+    LOG_READ_BYTES,                 // log lines read back by queries (RefReader)
+    QUERIES,
+    COUNT
+};
+
+// Kept per index (IndexID); ids past METRICS_MAX_INDEX_ID share slot 0
+enum class IndexCounter : uint32_t {
+    NODE_VISITS,        // index pages fetched by B+Tree / trie operations
+    LEAF_SPLITS,
+    INTERNAL_SPLITS,
+    NODES_CREATED,      // trie nodes
+    COUNT
+};
+
+enum class Histogram : uint32_t {
+    DISK_READ_LATENCY,
+    DISK_WRITE_LATENCY,
+    PROBE_EQUALS,       // one index probe of a predicate, by operator
+    PROBE_BETWEEN,
+    PROBE_STARTSWITH,
+    QUERY_SELECT,       // whole query, by aggregate
+    QUERY_COUNT,
+    QUERY_MIN,
+    QUERY_MAX,
+    COUNT
+};
+
+constexpr size_t METRICS_COUNTERS = static_cast<size_t>(Counter::COUNT);
+constexpr size_t METRICS_INDEX_COUNTERS = static_cast<size_t>(IndexCounter::COUNT);
+constexpr size_t METRICS_HISTOGRAMS = static_cast<size_t>(Histogram::COUNT);
+constexpr IndexID METRICS_MAX_INDEX_ID = 64;
+
+// Log-linear (HDR-style) latency buckets: exact below 8 ns, then 8 per
+// power of two (at most 12.5% wide) up to 2^42 ns (~73 min), then one
+// overflow bucket
+constexpr size_t METRICS_SUB_BUCKETS = 8;
+constexpr size_t METRICS_MAX_EXPONENT = 42;
+constexpr size_t METRICS_HISTOGRAM_BUCKETS = (METRICS_MAX_EXPONENT - 2) * METRICS_SUB_BUCKETS + 1;
+
+inline size_t LatencyBucket(uint64_t nanos) {
+    if (nanos < METRICS_SUB_BUCKETS) {
+        return static_cast<size_t>(nanos);
+    }
+    size_t exponent = 63 - static_cast<size_t>(__builtin_clzll(nanos));
+    if (exponent >= METRICS_MAX_EXPONENT) {
+        return METRICS_HISTOGRAM_BUCKETS - 1;
+    }
+    size_t sub = static_cast<size_t>(nanos >> (exponent - 3)) & (METRICS_SUB_BUCKETS - 1);
+    return (exponent - 2) * METRICS_SUB_BUCKETS + sub;
+}
+
+// Smallest value of a bucket (its upper bound is the next bucket's)
+inline uint64_t LatencyBucketLow(size_t bucket) {
+    if (bucket < METRICS_SUB_BUCKETS) {
+        return bucket;
+    }
+    size_t exponent = bucket / METRICS_SUB_BUCKETS + 2;
+    uint64_t sub = bucket % METRICS_SUB_BUCKETS;
+    return (METRICS_SUB_BUCKETS + sub) << (exponent - 3);
+}
+
+struct HistogramSnapshot {
+    uint64_t count = 0;
+    uint64_t sum_nanos = 0;
+    uint64_t max_nanos = 0;
+    std::vector<uint64_t> buckets = std::vector<uint64_t>(METRICS_HISTOGRAM_BUCKETS, 0);
+
+    // upper bound of the bucket holding the q-quantile (0 when empty)
+    uint64_t Percentile(double q) const;
+};
+
+// Totals over every thread at one point in time
+struct MetricsSnapshot {
+    uint64_t counters[METRICS_COUNTERS] = {};
+    uint64_t index_counters[METRICS_MAX_INDEX_ID + 1][METRICS_INDEX_COUNTERS] = {};
+    HistogramSnapshot histograms[METRICS_HISTOGRAMS];
+
+    uint64_t Get(Counter c) const { return counters[static_cast<size_t>(c)]; }
+    uint64_t Get(IndexID index_id, IndexCounter c) const;
+
+    // human-readable summary (the "stats" command)
+    std::string Describe() const;
+
+    // Prometheus text exposition format
+    std::string Prometheus() const;
+};
+
+/**
+ * Engine-wide performance counters.
+ *
+ * Every thread updates its own shard (plain relaxed stores, no shared
+ * cache lines, no locks); Collect() adds the shards up. A thread's
+ * counts are folded into the totals when it exits, so nothing is lost.
+ */
+class MetricsRegistry {
+public:
+    static MetricsRegistry &Global();
+
+    MetricsSnapshot Collect();
+
+    // Write Collect().Prometheus() to path (through a temporary file and
+    // rename, so a scraper never sees half a dump); false on I/O errors
+    bool WritePrometheusFile(const std::string &path);
+
+    struct Shard {
+        std::atomic<uint64_t> counters[METRICS_COUNTERS] = {};
+        std::atomic<uint64_t> index_counters[METRICS_MAX_INDEX_ID + 1][METRICS_INDEX_COUNTERS] = {};
+        struct Hist {
+            std::atomic<uint64_t> count{0};
+            std::atomic<uint64_t> sum{0};
+            std::atomic<uint64_t> max{0};
+            std::atomic<uint64_t> buckets[METRICS_HISTOGRAM_BUCKETS] = {};
+        } histograms[METRICS_HISTOGRAMS];
+    };
+
+    // The calling thread's shard, created on first use
+    static Shard &Local();
+
+private:
+    MetricsRegistry() = default;
+
+    void Register(Shard *shard);
+    void Retire(Shard *shard);
+    void AddShard(const Shard &shard, MetricsSnapshot &into) const;
+
+    struct ShardOwner;
+
+    std::mutex mutex_;
+    std::vector<Shard *> shards_;
+    MetricsSnapshot retired_;     // threads that have exited
+};
+
+// ================================
+// Recording (hot paths)
+// ================================
+
+namespace metrics_detail {
+// single writer per shard: a load and a store, no locked instruction
+inline void Bump(std::atomic<uint64_t> &cell, uint64_t n) {
+    cell.store(cell.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+} // namespace metrics_detail
+
+inline void CountMetric(Counter c, uint64_t n = 1) {
+    metrics_detail::Bump(MetricsRegistry::Local().counters[static_cast<size_t>(c)], n);
+}
+
+inline void CountIndexMetric(IndexID index_id, IndexCounter c, uint64_t n = 1) {
+    size_t slot = index_id <= METRICS_MAX_INDEX_ID ? index_id : 0;
+    metrics_detail::Bump(
+        MetricsRegistry::Local().index_counters[slot][static_cast<size_t>(c)], n);
+}
+
+inline void RecordLatency(Histogram h, uint64_t nanos) {
+    auto &hist = MetricsRegistry::Local().histograms[static_cast<size_t>(h)];
+    metrics_detail::Bump(hist.count, 1);
+    metrics_detail::Bump(hist.sum, nanos);
+    metrics_detail::Bump(hist.buckets[LatencyBucket(nanos)], 1);
+    if (nanos > hist.max.load(std::memory_order_relaxed)) {
+        hist.max.store(nanos, std::memory_order_relaxed);
+    }
+}
+
+// Records the time from construction to destruction
+class LatencyTimer {
+public:
+    explicit LatencyTimer(Histogram h) : histogram_(h), start_(std::chrono::steady_clock::now()) {}
+    ~LatencyTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        RecordLatency(histogram_, static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    LatencyTimer(const LatencyTimer &) = delete;
+    LatencyTimer &operator=(const LatencyTimer &) = delete;
+
+private:
+    Histogram histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace cmse
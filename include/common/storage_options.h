@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "config.h"
+#include "constants.h"
+
+namespace cmse {
+
+/**
+ * Storage engine settings chosen at startup instead of at compile time.
+ * Defaults come from config.h / constants.h; a config file (key = value
+ * lines, '#' comments) and command-line flags of the same names override
+ * them. BufferPoolManager and DiskManager take the options at
+ * construction; the indexes read theirs from the pool (GetOptions).
+ *
+ * The page size is the exception: page layouts are sized at compile time,
+ * so page_size only has to match the build (cmake -DCMSE_PAGE_SIZE=).
+ * It and the B+Tree limits are recorded in the disk file, which refuses
+ * to open with different ones.
+ */
+struct StorageOptions {
+    size_t pool_pages = DEFAULT_BUFFER_POOL_SIZE;
+    std::string disk_file = DISK_FILE_PATH;
+    DiskIoMode io_mode = DISK_IO_MODE;
+    bool huge_pages = BUFFER_POOL_HUGE_PAGES;
+    bool numa_partitions = BUFFER_POOL_NUMA_PARTITIONS;
+    size_t hot_pages = BUFFER_POOL_HOT_PAGES;
+    uint32_t hot_index_levels = HOT_INDEX_LEVELS;
+    bool pointer_swizzling = BUFFER_POOL_POINTER_SWIZZLING;
+
+    size_t page_size = PAGE_SIZE;
+    uint32_t btree_leaf_max_keys = BPLUS_TREE_LEAF_MAX_KEYS;
+    uint32_t btree_internal_max_keys = BPLUS_TREE_INTERNAL_MAX_KEYS;
+    uint32_t trie_max_records = TRIE_MAX_RECORDS;
+
+    // Set one option by name ("pool_pages", "direct_io", "page_size", ...).
+    // Sizes accept a K/KiB or M/MiB suffix. false, with error set, for an
+    // unknown name or a malformed value.
+    bool Set(const std::string &name, const std::string &value, std::string &error);
+
+    // Apply a config file; error names the file and line
+    bool LoadFile(const std::string &path, std::string &error);
+
+    // Ranges and consistency with this build; false with error set
+    bool Validate(std::string &error) const;
+
+    // one line per option, in config file syntax
+    std::string Describe() const;
+};
+
+} // namespace cmse
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cmse {
+
+/**
+ * Work-stealing thread pool.
+ *
+ * Every worker owns a deque: tasks submitted from a worker go to its own
+ * deque and are popped LIFO (cache-warm), idle workers steal FIFO from
+ * the other deques, so unbalanced work (one huge range or subtree)
+ * spreads across the pool.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void Submit(std::function<void()> task);
+
+    // Run one queued task on the calling thread; false if none was found.
+    // Used by TaskGroup::Wait so waiting threads help instead of blocking.
+    bool TryRunOne();
+
+    size_t Size() const { return workers_.size(); }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void WorkerLoop(size_t index);
+    bool PopTask(size_t index, std::function<void()> &task);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> next_queue_{0};
+    bool stop_ = false;
+};
+
+// Fork/join helper: run tasks on a pool and wait for all of them
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool *pool) : pool_(pool) {}
+    ~TaskGroup() { Wait(); }
+
+    void Run(std::function<void()> task);
+    void Wait();
+
+private:
+    ThreadPool *pool_;
+    std::atomic<size_t> pending_{0};
+    std::mutex mutex_;
+    std::condition_variable done_cv_;
+};
+
+} // namespace cmse
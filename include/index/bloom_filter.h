@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "../common/config.h"
+#include "../common/constants.h"
+#include "../common/types.h"
+#include "../storage/buffer_pool_manager.h"
+
+namespace cmse {
+
+struct BloomFilterLayerInfo {
+    uint64_t capacity;
+    uint64_t count;
+    uint32_t probes;
+    uint32_t block_count;
+};
+
+// Head page of a persisted filter, linked from IndexMetaEntryPage
+struct BloomFilterHeaderPage {
+    uint32_t clean;             // 0: changed since it was saved, blocks are stale
+    uint32_t layer_count;
+    double fpr;
+    PageID first_block_page;
+    BloomFilterLayerInfo layers[BLOOM_FILTER_MAX_LAYERS];
+};
+
+// The layers' blocks, back to back over a chain of pages
+struct BloomFilterBlockPage {
+    PageID next_page_id;
+    uint32_t block_count;
+    uint64_t words[BLOOM_FILTER_PAGE_BLOCKS * BLOOM_FILTER_BLOCK_WORDS];
+};
+
+static_assert(sizeof(BloomFilterHeaderPage) <= PAGE_SIZE, "bloom header page exceeds PAGE_SIZE");
+static_assert(sizeof(BloomFilterBlockPage) <= PAGE_SIZE, "bloom block page exceeds PAGE_SIZE");
+
+/**
+ * Blocked Bloom filter over 64-bit key hashes (HashKey / HashString).
+ *
+ * A key selects one cache-line block and sets or tests all its probe bits
+ * there, so a lookup costs one cache miss. The filter grows by layers:
+ * when the newest layer reaches its capacity a new one twice as large is
+ * added at half the false-positive rate, which keeps the overall rate
+ * under the target without rebuilding. Build() sizes a single layer for a
+ * known key set (existing indexes, LSM runs).
+ *
+ * One thread may Add while others call MayContain: layer storage never
+ * moves (room for BLOOM_FILTER_MAX_LAYERS is reserved up front), a new
+ * layer is published by its count, and bits are set atomically.
+ */
+class BloomFilter {
+public:
+    explicit BloomFilter(double fpr = BLOOM_FILTER_FPR);
+
+    // only while no other thread uses either filter
+    BloomFilter(BloomFilter &&other) noexcept;
+    BloomFilter &operator=(BloomFilter &&other) noexcept;
+
+    // Bulk builder: one layer sized for exactly these hashes
+    static BloomFilter Build(std::span<const uint64_t> hashes, double fpr = BLOOM_FILTER_FPR);
+
+    void Add(uint64_t hash);
+
+    // false: the key was never added
+    bool MayContain(uint64_t hash) const;
+
+    uint64_t KeyCount() const;
+    size_t LayerCount() const { return layer_count_.load(std::memory_order_acquire); }
+    size_t MemoryBytes() const;
+
+    // Write the filter to the pages below header_page_id (block pages are
+    // reused or allocated as needed; blocks reach disk before the header).
+    // Later Adds first mark the saved copy stale on disk.
+    void Save(BufferPoolManager *bpm, PageID header_page_id);
+
+    // Read a saved filter; false if it is stale and must be rebuilt
+    bool Load(BufferPoolManager *bpm, PageID header_page_id);
+
+private:
+    struct alignas(BLOOM_FILTER_BLOCK_BYTES) Block {
+        uint64_t words[BLOOM_FILTER_BLOCK_WORDS];
+    };
+
+    struct Layer {
+        std::vector<Block> blocks;
+        uint64_t capacity = 0;
+        uint64_t count = 0;
+        uint32_t probes = 0;
+    };
+
+    static Layer MakeLayer(uint64_t capacity, double fpr);
+    static void SetBits(Layer &layer, uint64_t hash);
+    static bool TestBits(const Layer &layer, uint64_t hash);
+
+    // append a layer and publish it to concurrent readers
+    void PushLayer(Layer layer);
+
+    // false-positive rate of layer i
+    double LayerFpr(size_t i) const;
+
+    void MarkSavedCopyStale();
+
+    double fpr_;
+    std::vector<Layer> layers_;                 // capacity reserved: never reallocated
+    std::atomic<uint32_t> layer_count_{0};      // layers readers may use
+
+    // where the filter was last saved or loaded from
+    BufferPoolManager *bpm_ = nullptr;
+    PageID header_page_id_ = INVALID_PAGE_ID;
+    bool saved_copy_current_ = false;
+};
+
+} // namespace cmse
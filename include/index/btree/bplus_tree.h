@@ -1,10 +1,17 @@
 #pragma once
 
+#include <memory>
+#include <span>
+#include <utility>
 #include <vector>
+#include "../../common/config.h"
+#include "../../common/thread_pool.h"
 #include "../../common/types.h"
 #include "../../common/constants.h"
 #include "../../storage/buffer_pool_manager.h"
 #include "../../index/index_catalog.h"
+#include "../../index/bloom_filter.h"
+#include "../../index/hot_index_levels.h"
 
 namespace cmse {
 
@@ -20,52 +27,199 @@ struct BPlusTreePageHeader {
 struct BPlusTreeLeafPage {
     BPlusTreePageHeader header;
     PageID next_leaf_page_id;
-    KeyType keys[BPLUS_TREE_LEAF_MAX_KEYS];
-    RecordRef values[BPLUS_TREE_LEAF_MAX_KEYS];
+    KeyType keys[BPLUS_TREE_LEAF_MAX_KEYS + 1];
+    RecordRef values[BPLUS_TREE_LEAF_MAX_KEYS + 1];
 };
 
 struct BPlusTreeInternalPage {
     BPlusTreePageHeader header;
 
-    // ===== Phase 3 statistics =====
+    // ===== Phase 3 statistics (whole subtree) =====
     KeyType min_key;
     KeyType max_key;
     uint32_t total_keys;
     float density;
 
     // ===== Core B+Tree data =====
-    PageID children[BPLUS_TREE_INTERNAL_MAX_KEYS + 1];
-    KeyType keys[BPLUS_TREE_INTERNAL_MAX_KEYS];
+    PageID children[BPLUS_TREE_INTERNAL_MAX_KEYS + 2];
+    KeyType keys[BPLUS_TREE_INTERNAL_MAX_KEYS + 1];
+
+    // number of keys in each child's subtree (sums to total_keys)
+    uint32_t child_counts[BPLUS_TREE_INTERNAL_MAX_KEYS + 2];
+};
+
+static_assert(sizeof(BPlusTreeLeafPage) <= PAGE_SIZE, "leaf page exceeds PAGE_SIZE");
+static_assert(sizeof(BPlusTreeInternalPage) <= PAGE_SIZE, "internal page exceeds PAGE_SIZE");
+
+// Summary of the whole tree, read from the root (used by the query planner)
+struct BPlusTreeStats {
+    KeyType min_key = 0;
+    KeyType max_key = 0;
+    uint32_t total_keys = 0;
+    uint32_t height = 0;        // number of levels, 1 == root is a leaf
+    float density = 0.0f;       // keys per unit of key space
 };
 
 class BPlusTree {
 public:
     BPlusTree(PageID root_page_id, IndexID index_id, IndexCatalog *catalog, BufferPoolManager *bpm);
+    ~BPlusTree();
+
+    // Append mode, for (nearly) monotonic keys such as log timestamps:
+    // keys that fall in the rightmost leaf's range go straight into a
+    // cached rightmost leaf without a descent, ancestor statistics are brought up
+    // to date once per leaf instead of once per key, and nodes splitting at
+    // the right edge keep BPLUS_TREE_APPEND_SPLIT_FILL of their keys
+    void SetAppendMode(bool enabled);
+
+    // Apply deferred append statistics to the ancestors. Every other
+    // operation (and the destructor) does this first.
+    void FlushAppends();
 
-    // exact match search
+    // Whether inserts add their keys to the index statistics page. Off when
+    // the keys were already counted on the way in (LsmWriteBuffer).
+    void SetStatsPageUpdates(bool enabled) { update_stats_page_ = enabled; }
+
+    // exact match search; absent keys rejected by the index's Bloom
+    // filter (if it has one) cost no page reads
     void Search(KeyType key, std::vector<RecordRef> &result, uint32_t &page_fetch_count);
 
     // range match search
     void RangeSearch(KeyType low, KeyType high, std::vector<RecordRef> &result, uint32_t &page_fetch_count);
 
+    // range search split into disjoint key sub-ranges (at the separator keys
+    // of the upper internal levels) scanned concurrently on pool.
+    // ordered: results in key order, otherwise in completion order
+    void ParallelRangeSearch(KeyType low, KeyType high, std::vector<RecordRef> &result,
+                             uint32_t &page_fetch_count, ThreadPool *pool, bool ordered = true);
+
     // insert key
     void Insert(KeyType key, RecordRef value);
+
+    // insert many keys: the batch is sorted and split into runs that land
+    // in the same leaf; each run costs one descent, one leaf pin and one
+    // stats update per ancestor, the statistics page is updated once
+    void InsertBatch(std::span<const std::pair<KeyType, RecordRef>> entries);
+
+    // hash of every distinct key (bulk Bloom filter builds)
+    void KeyHashes(std::vector<uint64_t> &out);
+
+    // root statistics + tree height (height page fetches)
+    void GetStats(BPlusTreeStats &stats);
+
+    // ===== Index-only aggregates (no RecordRef materialization) =====
+
+    // number of keys in [low, high]; subtrees fully inside the range are
+    // counted from their parent's child_counts without being fetched
+    uint64_t CountRange(KeyType low, KeyType high, uint32_t &page_fetch_count);
+
+    // smallest / largest key in [low, high]; false if the range is empty
+    bool MinInRange(KeyType low, KeyType high, KeyType &out, uint32_t &page_fetch_count);
+    bool MaxInRange(KeyType low, KeyType high, KeyType &out, uint32_t &page_fetch_count);
+
+    // counts of [low + k * width, low + (k + 1) * width - 1] for every k,
+    // the last bucket being clipped at high
+    void CountByBucket(KeyType low, KeyType high, uint64_t width,
+                       std::vector<uint64_t> &counts, uint32_t &page_fetch_count);
+
     PageID root_page_id_;
 
 private:
-    PageID FindLeafPageForSearch(KeyType key, uint32_t &fetch_count);
-    PageID FindLeafPageForInsert(KeyType key);
-    PageID SplitLeaf(PageID leaf_page_id);
-    PageID SplitInternal(PageID internal_page_id);
+    // An internal node an insert descended through, pinned, and the child
+    // slot it took; a path holds them root first and is what a split walks
+    // back up (no node is fetched twice per insert)
+    struct PathEntry {
+        WritePageGuard node;
+        uint32_t slot;
+    };
+    using InsertPath = std::vector<PathEntry>;
+
+    // Fetch a tree node, counted as a node visit of this index
+    ReadPageGuard ReadNode(PageID page_id);
+    WritePageGuard WriteNode(PageID page_id);
+
+    // The same for the child in slot of parent (BufferPoolManager::
+    // FetchChild: swizzled links)
+    ReadPageGuard ReadChildNode(const PageGuard &parent, uint32_t slot, PageID child_id);
+
+    // the leaf that may hold key (empty if min/max pruning rules it out)
+    ReadPageGuard FindLeafPageForSearch(KeyType key, uint32_t &fetch_count);
+
+    // insert descent: the leaf, with the ancestors left in path; upper, if
+    // given, gets the leaf's exclusive upper key bound (*has_upper false:
+    // rightmost leaf)
+    WritePageGuard FindLeafPageForInsert(KeyType key, InsertPath &path,
+                                         KeyType *upper = nullptr, bool *has_upper = nullptr);
+
+    // descent without min/max pruning; rightmost: go right on equal keys
+    ReadPageGuard FindLeafPageForRange(KeyType key, bool rightmost, uint32_t &fetch_count);
+
+    // split an overflowing node whose ancestors are path (consumed on the
+    // way up)
+    void SplitLeaf(WritePageGuard &leaf, InsertPath &path);
+    void SplitInternal(WritePageGuard &node, bool right_edge, InsertPath &path);
+
+    // append-mode fast path: insert into the cached rightmost leaf,
+    // splitting it when full; false if key belongs to another leaf
+    bool TryAppend(KeyType key, const RecordRef &value);
+
+    // right_spine_ pinned as an insert path down to the rightmost leaf
+    void FetchRightSpine(InsertPath &spine);
+    void ApplyAppends(InsertPath &spine);
 
     void InsertIntoLeaf(BPlusTreeLeafPage *leaf, KeyType key, const RecordRef &value);
-    void InsertIntoParent(PageID left, KeyType key, PageID right);
-    void InsertIntoInternal(PageID parent_id, PageID left_child, KeyType key, PageID right_child);
+    void InsertIntoParent(WritePageGuard &left, KeyType key, WritePageGuard &right,
+                          InsertPath &path);
+
+    // parent: the node holding left in slot idx
+    void InsertIntoInternal(WritePageGuard &parent, uint32_t idx, KeyType key,
+                            WritePageGuard &right, InsertPath &path);
     void UpdateInternalStats(BPlusTreeInternalPage *node, KeyType key);
+    void UpdateInternalStats(BPlusTreeInternalPage *node, KeyType min_key, KeyType max_key,
+                             uint32_t count);
+
+    // the index statistics page (empty if none or not updated)
+    WritePageGuard FetchStatsPage();
+    BloomFilter *GetBloomFilter();
+    void ReadSubtreeStats(const PageGuard &node, KeyType &min_key, KeyType &max_key,
+                          uint32_t &total_keys);
+
+    // split [low, high] into at most ~target disjoint sub-ranges
+    void PartitionRange(KeyType low, KeyType high, size_t target,
+                        std::vector<std::pair<KeyType, KeyType>> &parts, uint32_t &fetch_count);
+
+    // subtree at node holds only keys within [lo_bound, hi_bound]
+    uint64_t CountSubtree(const HotCursor &node, KeyType low, KeyType high,
+                          KeyType lo_bound, KeyType hi_bound, uint32_t &fetch_count);
 
     BufferPoolManager *bpm_;
     IndexID index_id_;
     IndexCatalog *catalog_;
+
+    // node limits from the pool's StorageOptions (at most the page capacity)
+    uint32_t leaf_max_keys_;
+    uint32_t internal_max_keys_;
+
+    // upper levels in the hot tier (read descents start there)
+    std::shared_ptr<const HotIndexLevels> hot_levels_;
+
+    // looked up from the catalog on first insert
+    PageID stats_page_id_ = INVALID_PAGE_ID;
+    bool stats_page_resolved_ = false;
+    bool update_stats_page_ = true;
+    BloomFilter *bloom_filter_ = nullptr;
+    bool bloom_filter_resolved_ = false;
+
+    // append mode: cached rightmost leaf and the internal nodes above it
+    // (root first); appends not yet counted in those nodes' statistics
+    bool append_mode_ = false;
+    PageID rightmost_leaf_id_ = INVALID_PAGE_ID;
+    KeyType rightmost_low_ = 0;         // smallest key the leaf may take
+    bool has_rightmost_low_ = false;    // false: root is the leaf
+    std::vector<PageID> right_spine_;
+    uint32_t pending_appends_ = 0;
+    KeyType pending_min_ = 0;
+    KeyType pending_max_ = 0;
 };
 
 } // namespace cmse
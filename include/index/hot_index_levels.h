@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../common/types.h"
+#include "../storage/buffer_pool_manager.h"
+
+namespace cmse {
+
+/**
+ * The upper levels of one index as kept in the buffer pool's hot tier
+ * (IndexCatalog::GetHotLevels): the root and the nodes below it down to
+ * hot_index_levels, each named by its swizzled page id, with the links
+ * between them. Built by the catalog from a snapshot and never changed.
+ *
+ * A descent follows it with HotCursor, which checks every link against
+ * the child id in the page it just read (its own snapshot's), so a copy
+ * that went stale only costs page table lookups, never a wrong page.
+ */
+struct HotIndexLevels {
+    static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+    struct Node {
+        PageID page_id;                     // swizzled if the tier had room
+        std::vector<uint32_t> children;     // child slot -> node, NO_NODE if not hot
+    };
+
+    std::vector<Node> nodes;                // nodes[0]: the root
+};
+
+// Where a descent is in an index's HotIndexLevels: the id to fetch the
+// current page with (swizzled while on a hot node, the plain page id
+// once the descent has left them)
+class HotCursor {
+public:
+    // levels may be nullptr (no hot levels)
+    HotCursor(const HotIndexLevels *levels, PageID root_page_id)
+        : levels_(levels), node_(HotIndexLevels::NO_NODE), page_id_(root_page_id) {
+        if (levels_ != nullptr && !levels_->nodes.empty() &&
+            BufferPoolManager::Unswizzle(levels_->nodes[0].page_id) == root_page_id) {
+            node_ = 0;
+            page_id_ = levels_->nodes[0].page_id;
+        }
+    }
+
+    // Fetch / unpin the current page with this id
+    PageID Id() const { return page_id_; }
+
+    // The current page's plain id
+    PageID PageId() const { return BufferPoolManager::Unswizzle(page_id_); }
+
+    // Move to the child in slot, child_page_id as read from the current page
+    void Descend(uint32_t slot, PageID child_page_id) {
+        if (node_ != HotIndexLevels::NO_NODE) {
+            const auto &children = levels_->nodes[node_].children;
+            uint32_t child = slot < children.size() ? children[slot] : HotIndexLevels::NO_NODE;
+            if (child != HotIndexLevels::NO_NODE &&
+                BufferPoolManager::Unswizzle(levels_->nodes[child].page_id) == child_page_id) {
+                node_ = child;
+                page_id_ = levels_->nodes[child].page_id;
+                return;
+            }
+        }
+        node_ = HotIndexLevels::NO_NODE;
+        page_id_ = child_page_id;
+    }
+
+private:
+    const HotIndexLevels *levels_;
+    uint32_t node_;
+    PageID page_id_;
+};
+
+} // namespace cmse
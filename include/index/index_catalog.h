@@ -1,27 +1,256 @@
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bloom_filter.h"
+#include "hot_index_levels.h"
 #include "index_meta_page.h"
+#include "index_stats.h"
 #include "../storage/buffer_pool_manager.h"
 
 namespace cmse {
 
+class LsmWriteBuffer;
+
+/**
+ * Directory of the indexes: page 0 points to a chain of IndexCatalogPages,
+ * each packing INDEX_CATALOG_PAGE_ENTRIES entries (62 at 4 KiB), so a
+ * catalog of hundreds of indexes loads in a handful of page reads. Files
+ * written before the chain existed (one page per entry, 16 at most) are
+ * converted when first opened.
+ *
+ * The entries are loaded into memory once, when the catalog is built, and
+ * lookups by id or field name are hash lookups that never touch the
+ * buffer pool. Changes are written through to the catalog pages at once.
+ * One catalog per disk file: a second instance would not see the first
+ * one's changes.
+ *
+ * Snapshot reads: a thread reading through a snapshot from OpenSnapshot
+ * (SnapshotScope) gets the entries as of the snapshot's epoch from
+ * GetEntry, GetEntryByField, GetRoot, GetStatsPage, HasIndex and
+ * GetBloomFilter; the other calls read the live entries. A copy of the
+ * entries is published when a write epoch (IndexWriteScope) that changed
+ * them commits.
+ *
+ * Hot levels: the catalog keeps the top hot_index_levels levels of every
+ * index (roots first, breadth first while there is room) in the pool's hot
+ * tier and hands descents a map of them (GetHotLevels). The map is rebuilt
+ * after write epochs that changed a root or a hot page.
+ */
 class IndexCatalog {
 public:
     explicit IndexCatalog(BufferPoolManager *bpm);
 
+    // saves changed Bloom filters, releases the hot pages
+    ~IndexCatalog();
+
     PageID GetRoot(IndexID index_id) const;
     void SetRoot(IndexID index_id, PageID root_page_id);
 
+    // Create (or update) an index entry bound to a field; false if the
+    // catalog already holds MAX_INDEXES entries
+    bool RegisterIndex(IndexID index_id, const std::string &field_name,
+                       FieldType field_type, IndexType index_type,
+                       PageID root_page_id);
+
+    // Remove an index's entry and its Bloom filter. Its pages are not
+    // reused (the disk file has no free list). False if there is no such
+    // index or a write buffer is attached to it. Caller holds the index
+    // latch exclusively.
+    bool DropIndex(IndexID index_id);
+
     bool HasIndex(IndexID index_id) const;
     uint32_t GetIndexCount() const;
 
-    // NEW (needed for query layer later)
-    PageID GetIndexMetaPage(IndexID index_id) const;
-    PageID GetIndexMetaPageByField(const std::string &field_name) const;
+    // Every entry, by index id
+    std::vector<IndexMetaEntryPage> ListIndexes() const;
+
+    // An id no index uses
+    IndexID NextIndexId() const;
+
+    // Catalog pages in the chain (each one read at startup)
+    size_t GetCatalogPageCount() const;
+
+    // Copy of an index's entry (root, stats page, types) as one consistent
+    // snapshot; false if there is no such index
+    bool GetEntry(IndexID index_id, IndexMetaEntryPage &out) const;
+    bool GetEntryByField(const std::string &field_name, IndexMetaEntryPage &out) const;
+
+    // Bumped by every change to an entry: equal versions, same catalog
+    uint64_t GetVersion() const { return version_.load(std::memory_order_acquire); }
+
+    // Statistics page of an index (INVALID_PAGE_ID if unknown)
+    PageID GetStatsPage(IndexID index_id) const;
+
+    // Copy of the index statistics; false if the index has none
+    bool GetIndexStats(IndexID index_id, IndexStatsPage &out) const;
+
+    // ===== Bloom filters (point lookups) =====
+
+    // Build a filter over the index's current keys (bulk) and keep it up
+    // to date from now on. Caller is the only writer (write epoch and index
+    // latch, or nothing else running); a replaced filter is freed once no
+    // snapshot can be using it.
+    bool EnableBloomFilter(IndexID index_id);
+
+    // The index's filter, nullptr if it has none. Loaded on first use;
+    // rebuilt from the index if the saved copy went stale (crash). Snapshot
+    // readers only get a filter already loaded (filters only gain keys, so
+    // the current one answers for older snapshots too).
+    BloomFilter *GetBloomFilter(IndexID index_id);
+
+    // Write filters changed since they were last saved
+    void SaveBloomFilters();
+
+    // How much of the log the indexes cover (see LogIngestor)
+    uint64_t GetIngestedBytes() const;
+    void SetIngestedBytes(uint64_t bytes);
+
+    // ===== Hot levels =====
+
+    // The index's upper levels in the pool's hot tier, nullptr if none;
+    // a descent keeps its copy for as long as it runs
+    std::shared_ptr<const HotIndexLevels> GetHotLevels(IndexID index_id) const;
+
+    // Rebuild the hot levels if a root or a hot page changed since the
+    // last time. Runs at construction and after every write epoch; call it
+    // after changing indexes outside write epochs.
+    void RefreshHotLevels();
+
+    // ===== Snapshot reads =====
+
+    // Read view for a query: index pages and entries as of the last
+    // committed write epoch. Install it with SnapshotScope.
+    PageSnapshot OpenSnapshot();
+
+    // Write epoch over the index pages and the entries (IndexWriteScope)
+    void BeginWrite();
+    void CommitWrite();
+
+    // Guards what snapshots do not cover: write buffers (LsmWriteBuffer),
+    // which their writers change holding it exclusively and queries read
+    // holding it shared, and index statements (exclusive). Take it after
+    // the write epoch.
+    std::shared_mutex &IndexLatch() { return index_latch_; }
+
+    // Write buffer in front of a B+Tree index (nullptr if none). Ingest
+    // inserts into it and queries merge it with the tree; attach and detach
+    // only while neither is running.
+    void AttachWriteBuffer(IndexID index_id, LsmWriteBuffer *buffer);
+    LsmWriteBuffer *GetWriteBuffer(IndexID index_id) const;
+    bool HasWriteBuffers() const { return !write_buffers_.empty(); }
 
 private:
+    // page 0 (IndexMetaPage), pinned while the guard lives
+    ReadPageGuard ReadDirectory() const;
+    WritePageGuard WriteDirectory();
+
+    // The entries as of a write epoch
+    struct CatalogView {
+        uint64_t epoch;
+        std::unordered_map<IndexID, IndexMetaEntryPage> entries;
+        std::unordered_map<std::string, IndexID> by_field;
+    };
+
+    // The calling thread's snapshot view; nullptr: read the live entries
+    std::shared_ptr<const CatalogView> SnapshotView() const;
+
+    // Copy the live entries into a view at epoch if they changed since
+    // the last one; caller holds views_mutex_ exclusively
+    void PublishView(uint64_t epoch);
+
+    struct CatalogEntry {
+        PageID catalog_page_id;
+        uint32_t slot;
+        IndexMetaEntryPage meta;
+    };
+
+    struct CatalogPageInfo {
+        PageID page_id;
+        uint32_t used_count;
+    };
+
+    // Read the catalog page chain into entries_ (constructor)
+    void LoadEntries();
+
+    // Move the entries of a legacy directory into catalog pages
+    void ConvertLegacyDirectory();
+
+    // The rest need entries_mutex_ held exclusively
+
+    // Put a new entry into a free slot, adding a catalog page if needed
+    bool AddEntry(const IndexMetaEntryPage &meta);
+
+    // Copy entry.meta to its slot
+    void WriteEntry(const CatalogEntry &entry);
+
+    struct BloomFilterEntry {
+        std::unique_ptr<BloomFilter> filter;    // nullptr: index has none
+        PageID header_page_id = INVALID_PAGE_ID;
+    };
+
+    // one layer over every key currently in the index
+    std::unique_ptr<BloomFilter> BuildBloomFilter(const IndexMetaEntryPage &meta);
+
+    // free a replaced filter once no snapshot reader can hold it
+    void RetireBloomFilter(std::unique_ptr<BloomFilter> filter);
+
     BufferPoolManager *bpm_;
-    IndexMetaPage *directory_;   // page 0
+    std::shared_mutex index_latch_;
+
+    mutable std::shared_mutex entries_mutex_;
+    std::unordered_map<IndexID, CatalogEntry> entries_;
+    std::unordered_map<std::string, IndexID> entries_by_field_;
+    std::vector<CatalogPageInfo> catalog_pages_;    // chain order
+    std::atomic<uint64_t> version_{0};
+
+    mutable std::shared_mutex views_mutex_;
+    std::deque<std::shared_ptr<const CatalogView>> views_;   // oldest first
+    std::atomic<uint64_t> published_version_{0};             // version_ of the newest view
+    bool writing_ = false;                                   // a write epoch is open
+
+    std::unordered_map<IndexID, LsmWriteBuffer *> write_buffers_;
+
+    std::mutex bloom_mutex_;     // the map; filter contents follow index_latch_
+    std::unordered_map<IndexID, BloomFilterEntry> bloom_filters_;
+
+    std::mutex hot_mutex_;       // one refresh at a time; the members up to hot_levels_
+    bool hot_built_ = false;
+    uint64_t hot_writes_seen_ = 0;                           // bpm_->GetHotWriteCount()
+    uint64_t hot_version_seen_ = 0;                          // GetVersion()
+    std::vector<PageID> hot_pages_;                          // pinned in the hot tier
+    mutable std::shared_mutex hot_levels_mutex_;
+    std::unordered_map<IndexID, std::shared_ptr<const HotIndexLevels>> hot_levels_;
+};
+
+// Write epoch over a catalog's indexes for a scope: page and entry
+// changes become visible to snapshots together when it ends. One at a
+// time (others wait); take it before the index latch.
+class IndexWriteScope {
+public:
+    explicit IndexWriteScope(IndexCatalog *catalog) : catalog_(catalog) { catalog_->BeginWrite(); }
+    ~IndexWriteScope() { Commit(); }
+
+    // end the epoch early (before releasing a latch its readers take)
+    void Commit() {
+        if (catalog_ != nullptr) {
+            catalog_->CommitWrite();
+            catalog_ = nullptr;
+        }
+    }
+
+    IndexWriteScope(const IndexWriteScope &) = delete;
+    IndexWriteScope &operator=(const IndexWriteScope &) = delete;
+
+private:
+    IndexCatalog *catalog_;
 };
 
 } // namespace cmse
@@ -15,6 +15,8 @@ enum class FieldType : uint8_t {
     STRING  = 2
 };
 
+// One index: what it covers and where its pages are. Stored in a slot of
+// an IndexCatalogPage (before catalog format 1, in a page of its own).
 struct IndexMetaEntryPage {
     IndexID index_id;
 
@@ -23,11 +25,44 @@ struct IndexMetaEntryPage {
     IndexType index_type;
 
     PageID root_page_id;
+    PageID stats_page_id;       // IndexStatsPage (histogram + HLL)
+    PageID bloom_page_id;       // BloomFilterHeaderPage; INVALID_PAGE_ID or 0: none
 };
 
+// Entries per catalog page, after the header and the slot map
+constexpr size_t INDEX_CATALOG_PAGE_ENTRIES =
+    (PAGE_SIZE - 24) / (sizeof(IndexMetaEntryPage) + 1);
+
+// Catalog entries packed into slots; the pages form a chain starting at
+// IndexMetaPage::catalog_head_page_id
+struct IndexCatalogPage {
+    PageID next_page_id;        // INVALID_PAGE_ID: last page
+    uint32_t used_count;
+    uint32_t reserved;
+    uint8_t used[INDEX_CATALOG_PAGE_ENTRIES];   // 1: slot holds an entry
+    IndexMetaEntryPage entries[INDEX_CATALOG_PAGE_ENTRIES];
+};
+
+static_assert(sizeof(IndexCatalogPage) <= PAGE_SIZE, "catalog page exceeds PAGE_SIZE");
+
+// catalog_format values
+constexpr uint32_t INDEX_CATALOG_FORMAT_LEGACY = 0;   // one meta page per index
+constexpr uint32_t INDEX_CATALOG_FORMAT_PAGES = 1;    // IndexCatalogPage chain
+
+// Page 0
 struct IndexMetaPage {
+    // legacy directory, read once to convert an old file
     uint32_t index_count;
-    PageID index_meta_pages[MAX_INDEXES];
+    PageID index_meta_pages[LEGACY_MAX_INDEXES];
+
+    uint64_t ingested_bytes;    // log prefix already indexed (ingest resume point)
+
+    uint32_t catalog_format;
+    uint32_t catalog_entry_count;
+    PageID catalog_head_page_id;
 };
 
+static_assert(sizeof(IndexMetaPage) <= DISK_FILE_HEADER_OFFSET,
+              "catalog directory overlaps the disk file header");
+
 } // namespace cmse
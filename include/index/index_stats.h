@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+
+#include "../common/types.h"
+#include "../common/constants.h"
+
+namespace cmse {
+
+// Bucket i covers (buckets[i - 1].upper, buckets[i].upper];
+// bucket 0 starts at IndexStatsPage::min_key.
+struct HistogramBucket {
+    KeyType upper;
+    uint64_t count;
+};
+
+/**
+ * Per-index statistics page, linked from IndexMetaEntryPage.
+ *
+ * - equi-depth histogram over numeric keys (B+Tree indexes), kept
+ *   balanced incrementally by splitting overfull buckets and merging
+ *   the lightest adjacent pair
+ * - HyperLogLog sketch of distinct keys (all index types)
+ */
+struct IndexStatsPage {
+    uint64_t total_count;
+    KeyType min_key;
+    KeyType max_key;
+
+    uint32_t bucket_count;
+    HistogramBucket buckets[INDEX_STATS_HISTOGRAM_BUCKETS];
+
+    uint8_t hll_registers[INDEX_STATS_HLL_REGISTERS];
+};
+
+static_assert(sizeof(IndexStatsPage) <= PAGE_SIZE, "stats page exceeds PAGE_SIZE");
+
+void InitIndexStats(IndexStatsPage *stats);
+
+// Incremental maintenance (called on every index insert)
+void IndexStatsAddKey(IndexStatsPage *stats, KeyType key);
+void IndexStatsAddString(IndexStatsPage *stats, const std::string &key);
+
+// Estimated number of distinct keys (HyperLogLog)
+double EstimateDistinctKeys(const IndexStatsPage *stats);
+
+// Estimated number of entries with low <= key <= high (histogram)
+double EstimateRangeCount(const IndexStatsPage *stats, KeyType low, KeyType high);
+
+// Estimated number of entries equal to key
+double EstimateEqualCount(const IndexStatsPage *stats, KeyType key);
+
+} // namespace cmse
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../../common/config.h"
+#include "../../common/constants.h"
+#include "../../common/types.h"
+#include "../../storage/buffer_pool_manager.h"
+#include "../bloom_filter.h"
+#include "../index_catalog.h"
+
+namespace cmse {
+
+// One page of an immutable sorted run; every page but the last is full
+struct LsmRunPage {
+    uint32_t count;
+    KeyType keys[LSM_RUN_PAGE_ENTRIES];
+    RecordRef values[LSM_RUN_PAGE_ENTRIES];
+};
+
+static_assert(sizeof(LsmRunPage) <= PAGE_SIZE, "LSM run page exceeds PAGE_SIZE");
+
+struct LsmStats {
+    uint64_t memtable_entries = 0;
+    uint64_t frozen_memtables = 0;  // waiting to be written as runs
+    uint64_t runs = 0;
+    uint64_t run_entries = 0;       // in runs, not yet compacted
+    uint64_t run_pages_written = 0;
+    uint64_t compactions = 0;
+    uint64_t entries_compacted = 0;
+
+    std::string Describe() const;
+};
+
+/**
+ * Optional LSM-style write buffer in front of a B+Tree index.
+ *
+ *   insert -> memtable -> (full) -> sorted run pages -> (compaction) -> BPlusTree
+ *
+ * Inserts land in an in-memory ordered memtable. A full memtable is frozen
+ * and the background thread writes it out as an immutable sorted run on
+ * freshly allocated pages, flushing them in page order. Once
+ * LSM_COMPACTION_TRIGGER_RUNS runs exist they are merged and inserted into
+ * the tree (InsertBatch, append mode), LSM_COMPACTION_CHUNK entries at a
+ * time. Pages of compacted runs are reused for later runs. Each run gets a
+ * Bloom filter so point lookups only read runs that may hold the key.
+ *
+ * The catalog's index latch covers the buffer as well as the tree: Insert
+ * callers hold it exclusively, readers hold it shared, and the background
+ * thread takes it exclusively only to publish a run or a compacted chunk.
+ * A chunk's tree insert, its write epoch's commit and the advance of its
+ * runs' compacted prefixes share one hold, so a reader (tree through a
+ * snapshot opened under the latch) finds every entry exactly once.
+ *
+ * Keys are counted in the index statistics page when buffered. Buffered
+ * entries reach the tree on Stop(); after a crash the log has to be
+ * reindexed.
+ */
+class LsmWriteBuffer {
+public:
+    LsmWriteBuffer(IndexID index_id, BufferPoolManager *bpm, IndexCatalog *catalog);
+    ~LsmWriteBuffer();
+
+    LsmWriteBuffer(const LsmWriteBuffer &) = delete;
+    LsmWriteBuffer &operator=(const LsmWriteBuffer &) = delete;
+
+    // Start the background flush/compaction thread
+    void Start();
+
+    // Join the background thread and merge everything still buffered into
+    // the tree. The caller must not hold the index latch.
+    void Stop();
+
+    // Caller holds the index latch exclusively
+    void Insert(KeyType key, RecordRef value);
+    void InsertBatch(std::span<const std::pair<KeyType, RecordRef>> entries);
+
+    // ===== Reads over the buffered entries only (combine with the tree) =====
+    // Caller holds the index latch (shared is enough).
+
+    // appends to result, in no particular key order
+    void RangeSearch(KeyType low, KeyType high, std::vector<RecordRef> &result) const;
+
+    uint64_t CountRange(KeyType low, KeyType high) const;
+    bool MinInRange(KeyType low, KeyType high, KeyType &out) const;
+    bool MaxInRange(KeyType low, KeyType high, KeyType &out) const;
+
+    // adds to counts as laid out by BPlusTree::CountByBucket
+    void CountByBucket(KeyType low, KeyType high, uint64_t width,
+                       std::vector<uint64_t> &counts) const;
+
+    LsmStats GetStats() const;
+
+private:
+    using SortedEntries = std::vector<std::pair<KeyType, RecordRef>>;
+
+    struct Run {
+        std::vector<PageID> pages;
+        std::vector<KeyType> first_keys;    // smallest key of each page
+        uint64_t entries = 0;
+        uint64_t compacted = 0;             // leading entries already in the tree
+        BloomFilter filter;                 // point lookups skip runs without the key
+    };
+
+    void BackgroundLoop();
+
+    // memtable -> frozen_; caller holds the index latch exclusively
+    void Freeze();
+
+    // write the oldest frozen memtable as a run; false if there is none
+    bool WriteRun();
+
+    // merge the oldest run_count runs into the tree
+    void Compact(size_t run_count);
+    void PublishChunk(SortedEntries &chunk, std::vector<uint64_t> &consumed);
+
+    Page *AllocateRunPage(PageID *page_id);
+
+    // calls fn(key, ref) for buffered entries in [low, high], source by
+    // source (memtable, frozen memtables, runs) in key order within each;
+    // fn returning false skips the rest of that source
+    template <typename Fn>
+    void ForEach(KeyType low, KeyType high, Fn &&fn) const;
+
+    IndexID index_id_;
+    BufferPoolManager *bpm_;
+    IndexCatalog *catalog_;
+    PageID stats_page_id_;
+
+    // guarded by the index latch; runs_ is only modified by the thread
+    // doing flushes and compactions, which may read it without the latch
+    std::multimap<KeyType, RecordRef> memtable_;
+    std::deque<std::shared_ptr<const SortedEntries>> frozen_;
+    std::vector<Run> runs_;
+
+    std::vector<PageID> free_pages_;        // from compacted runs
+
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool work_pending_ = false;
+    bool stopping_ = false;
+
+    std::atomic<uint64_t> memtable_entries_{0};
+    std::atomic<uint64_t> frozen_count_{0};
+    std::atomic<uint64_t> run_count_{0};
+    std::atomic<uint64_t> run_entries_{0};
+    std::atomic<uint64_t> run_pages_written_{0};
+    std::atomic<uint64_t> compactions_{0};
+    std::atomic<uint64_t> entries_compacted_{0};
+};
+
+} // namespace cmse
@@ -2,9 +2,19 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "../../common/config.h"
 #include "../../common/constants.h"
+#include "../../common/thread_pool.h"
 #include "../../common/types.h"
 #include "../../storage/buffer_pool_manager.h"
+#include "../bloom_filter.h"
+#include "../hot_index_levels.h"
 
 namespace cmse {
 
@@ -24,20 +34,73 @@ struct TrieNodePage {
 
 class TrieIndex {
 public:
-    TrieIndex(PageID root_page_id, BufferPoolManager *bpm);
+    // stats_page_id: IndexStatsPage updated on insert (optional)
+    // bloom_filter: the index's filter (IndexCatalog::GetBloomFilter), checked
+    // by ExactSearch; once an index has one, every writer must pass it
+    // index_id: the catalog id node visits are counted under (metrics)
+    TrieIndex(PageID root_page_id, BufferPoolManager *bpm,
+              PageID stats_page_id = INVALID_PAGE_ID, BloomFilter *bloom_filter = nullptr,
+              IndexID index_id = 0);
+
+    // The index's levels in the hot tier (IndexCatalog::GetHotLevels):
+    // searches start their descent there
+    void SetHotLevels(std::shared_ptr<const HotIndexLevels> hot_levels);
 
     void Insert(const std::string &sentence, RecordRef ref);
 
+    // insert many entries: sorted first, so equal keys share one descent
+    // and one pin of their node, and each key only walks down from where
+    // it stops sharing a prefix with the previous one
+    void InsertBatch(std::span<const std::pair<std::string, RecordRef>> entries);
+
+    // absent keys rejected by the Bloom filter cost no page reads
     void ExactSearch(const std::string &sentence, std::vector<RecordRef> &result);
 
     void PrefixSearch(const std::string &prefix, std::vector<RecordRef> &result);
 
+    // PrefixSearch with the subtree below the prefix node split across
+    // pool, one task per non-empty child edge. limit > 0 caps the number
+    // of results (which ones are returned is then unspecified).
+    void ParallelPrefixSearch(const std::string &prefix, std::vector<RecordRef> &result,
+                              ThreadPool *pool, size_t limit = 0);
+
+    // hash of every key (bulk Bloom filter builds)
+    void KeyHashes(std::vector<uint64_t> &out);
+
 private:
     PageID root_page_id_;
     BufferPoolManager *bpm_;
+    PageID stats_page_id_;
+    BloomFilter *bloom_filter_;
+    uint32_t max_records_;      // per key, from the pool's StorageOptions
+    IndexID index_id_;
+    std::shared_ptr<const HotIndexLevels> hot_levels_;
+
+    // Fetch a trie node, counted as a node visit of this index
+    ReadPageGuard ReadNode(PageID page_id);
+    WritePageGuard WriteNode(PageID page_id);
+
+    // allocate an empty node (counted as created)
+    WritePageGuard NewNode(PageID *page_id);
+
+    // the node path leads to from node_id, nodes allocated where edges are
+    // missing; the ids passed on the way are appended to nodes (if given).
+    // Nodes that already have the edge are only read.
+    WritePageGuard WalkOrCreate(PageID node_id, std::string_view path, std::vector<PageID> *nodes);
+
+    // the node key leads to from the root (empty if there is none); upper
+    // levels through the hot tier
+    ReadPageGuard FindNode(const std::string &key);
+
+    // records of the subtree at page, which is unpinned before its children
+    // are visited
+    void CollectAll(ReadPageGuard page, std::vector<RecordRef> &result);
+
+    // shared state of one ParallelPrefixSearch
+    struct ParallelCollect;
 
-    PageID FindNode(const std::string &key, bool create);
-    void CollectAll(PageID node_id, std::vector<RecordRef> &result);
+    // task body: depth-first walk of (node, depth below prefix) entries
+    void CollectParallel(std::vector<std::pair<PageID, size_t>> stack, ParallelCollect &state);
 };
 
 }
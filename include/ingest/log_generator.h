@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../common/types.h"
+
+namespace cmse {
+
+struct LogGeneratorOptions {
+    uint64_t seed = 1;
+
+    KeyType start_timestamp = 1718000000000;  // first timestamp (ms since the epoch)
+    uint32_t ticks_per_second = 1000;         // timestamp resolution
+    double rate = 1000.0;                     // mean lines per second of log time (Poisson)
+
+    // a share of lines is stamped up to max_skew_ticks in the past, as when
+    // several hosts ship to one file with clock skew or buffering
+    double late_fraction = 0.01;
+    uint64_t max_skew_ticks = 2000;
+
+    // message template popularity: P(template k) ~ 1 / k^s
+    double zipf_exponent = 1.1;
+
+    // relative weights, e.g. {{"INFO", 70}, {"WARN", 10}}
+    std::vector<std::pair<std::string, double>> severity_mix = {
+        {"INFO", 70}, {"DEBUG", 15}, {"WARN", 10}, {"ERROR", 5}};
+
+    // Set one option by name ("rate", "severity_mix", ...); false, with
+    // error set, for an unknown name or a malformed value
+    bool Set(const std::string &name, const std::string &value, std::string &error);
+};
+
+/**
+ * Deterministic synthetic log stream: "<timestamp> <SEVERITY> <message>".
+ *
+ * Messages come from syslog-like templates (sshd, cron, nginx, kernel,
+ * ...) picked with a Zipf law, with variable fields drawn from small
+ * vocabularies, so an index sees realistic shared prefixes, hot keys and
+ * a long tail. The same options and seed give the same lines.
+ */
+class LogGenerator {
+public:
+    explicit LogGenerator(const LogGeneratorOptions &options);
+
+    // next line, without the newline
+    std::string NextLine();
+
+    // timestamp of the newest line generated so far (the clock; late
+    // lines are stamped below it)
+    KeyType Clock() const { return clock_; }
+
+    uint64_t LinesGenerated() const { return lines_; }
+
+    const LogGeneratorOptions &GetOptions() const { return options_; }
+
+    // fixed text each template starts with (for prefix queries)
+    static const std::vector<std::string> &TemplatePrefixes();
+
+    // a random message from the templates, with the given randomness
+    static std::string MakeMessage(std::mt19937_64 &rng, size_t template_id);
+    static size_t TemplateCount();
+
+private:
+    LogGeneratorOptions options_;
+    std::mt19937_64 rng_;
+    std::discrete_distribution<size_t> templates_;
+    std::discrete_distribution<size_t> severities_;
+    std::exponential_distribution<double> gaps_;
+
+    double fine_clock_;     // in ticks, fractional
+    KeyType clock_;
+    uint64_t lines_ = 0;
+};
+
+} // namespace cmse
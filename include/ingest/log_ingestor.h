@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../common/bounded_queue.h"
+#include "../common/config.h"
+#include "../index/index_catalog.h"
+#include "../query/log_record.h"
+#include "../storage/buffer_pool_manager.h"
+
+namespace cmse {
+
+struct IngestOptions {
+    size_t batch_lines = INGEST_BATCH_LINES;
+    size_t queue_batches = INGEST_QUEUE_BATCHES;
+    bool follow = false;        // keep tailing after reaching the end of the log
+    int poll_interval_ms = INGEST_POLL_INTERVAL_MS;
+};
+
+struct IngestStats {
+    uint64_t bytes_read = 0;
+    uint64_t lines_read = 0;
+    uint64_t lines_indexed = 0;
+    uint64_t parse_errors = 0;
+    uint64_t batches_indexed = 0;
+    uint64_t indexed_bytes = 0;     // resume point: log prefix fully indexed
+
+    // back-pressure: queue fill and how long the upstream stage was blocked
+    size_t parse_queue_depth = 0;
+    size_t index_queue_depth = 0;
+    size_t queue_capacity = 0;
+    uint64_t reader_blocked_us = 0; // reader waiting on the parser
+    uint64_t parser_blocked_us = 0; // parser waiting on the indexer
+
+    double elapsed_sec = 0.0;
+
+    // One-line summary, e.g. for periodic status output
+    std::string Describe() const;
+};
+
+/**
+ * Tails a log file into the catalog's indexes.
+ *
+ * Three stages connected by bounded queues:
+ *
+ *   reader  -> [raw line batches] -> parser -> [records] -> indexer
+ *
+ * The reader follows the file from the catalog's ingested_bytes (inotify,
+ * falling back to polling) and records each line's byte offset as its
+ * RecordRef. The parser splits lines into timestamp/severity/message.
+ * The indexer inserts each batch into every index bound to one of those
+ * fields in one write epoch per batch (IndexWriteScope: queries reading a
+ * snapshot see the whole batch or none of it and never wait for it), then
+ * advances ingested_bytes. A full queue blocks the stage feeding it.
+ * Timestamps go through the index's LsmWriteBuffer when one is attached,
+ * under the catalog's index latch.
+ */
+class LogIngestor {
+public:
+    LogIngestor(const std::string &log_path, BufferPoolManager *bpm, IndexCatalog *catalog,
+                const IngestOptions &options = IngestOptions{});
+    ~LogIngestor();
+
+    LogIngestor(const LogIngestor &) = delete;
+    LogIngestor &operator=(const LogIngestor &) = delete;
+
+    // Open the log and start the pipeline; false if the log cannot be read
+    bool Start();
+
+    // Without follow: block until the whole log is indexed
+    void Wait();
+
+    // Stop reading, index what is already queued and join the stages
+    void Stop();
+
+    IngestStats GetStats() const;
+
+private:
+    struct RawLine {
+        uint64_t offset;
+        std::string text;
+    };
+
+    struct RawBatch {
+        std::vector<RawLine> lines;
+        uint64_t end_offset = 0;    // first byte after the last line
+    };
+
+    struct ParsedRecord {
+        RecordRef ref;
+        LogRecord record;
+    };
+
+    struct ParsedBatch {
+        std::vector<ParsedRecord> records;
+        uint64_t end_offset = 0;
+    };
+
+    void ReadLoop();
+    void ParseLoop();
+    void IndexLoop();
+
+    // Wait for the log to grow; false once stopping
+    bool WaitForData();
+
+    void IndexBatch(const ParsedBatch &batch);
+
+    std::string log_path_;
+    BufferPoolManager *bpm_;
+    IndexCatalog *catalog_;
+    IngestOptions options_;
+
+    int fd_ = -1;
+    int inotify_fd_ = -1;
+
+    BoundedQueue<RawBatch> parse_queue_;
+    BoundedQueue<ParsedBatch> index_queue_;
+
+    std::thread reader_;
+    std::thread parser_;
+    std::thread indexer_;
+
+    std::atomic<bool> stopping_{false};
+    std::chrono::steady_clock::time_point started_;
+
+    std::atomic<uint64_t> bytes_read_{0};
+    std::atomic<uint64_t> lines_read_{0};
+    std::atomic<uint64_t> lines_indexed_{0};
+    std::atomic<uint64_t> parse_errors_{0};
+    std::atomic<uint64_t> batches_indexed_{0};
+    std::atomic<uint64_t> indexed_bytes_{0};
+};
+
+} // namespace cmse
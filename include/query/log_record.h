@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "query_types.h"
+
+namespace cmse {
+
+/**
+ * One parsed log line:
+ *
+ *   <timestamp> <severity> <message...>
+ *
+ * e.g. "1718000000 ERROR disk_failure device=sda1"
+ */
+struct LogRecord {
+    uint64_t timestamp = 0;
+    std::string severity;
+    std::string message;
+};
+
+// Returns false if the line does not start with a numeric timestamp.
+bool ParseLogRecord(const std::string &line, LogRecord &out);
+
+// Evaluate one predicate against a parsed record (used for residual
+// filtering and full scans). Unknown fields never match.
+bool MatchesPredicate(const LogRecord &record, const Predicate &pred);
+
+} // namespace cmse
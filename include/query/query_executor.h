@@ -1,8 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <iostream>
+#include <string>
+
 #include "../index/index_catalog.h"
 #include "../index/btree/bplus_tree.h"
 #include "../index/trie/trie.h"
+#include "query_planner.h"
+#include "query_profile.h"
 #include "query_types.h"
 #include "ref_reader.h"
 
@@ -10,15 +16,50 @@ namespace cmse {
 
 class QueryExecutor {
 public:
-    QueryExecutor(BufferPoolManager *bpm, IndexCatalog *catalog, RefReader *reader);
+    // pool (optional): range and prefix predicates run as parallel scans
+    QueryExecutor(BufferPoolManager *bpm, IndexCatalog *catalog, RefReader *reader,
+                  ThreadPool *pool = nullptr);
+
+    // Plan and run a query, writing result lines to out. Safe to call from
+    // several threads at once (read-only queries over a shared pool).
+    // Queries read a snapshot of the indexes (IndexCatalog::OpenSnapshot):
+    // they neither wait for ingest batches nor see part of one. Index
+    // statements (CREATE/DROP INDEX) are write epochs like ingest batches
+    // and also take the index latch exclusively.
+    void Execute(const Query &query, std::ostream &out = std::cout);
 
-    void Execute(const Query &query);
+    // Profile every query and write a Chrome trace (QueryProfile) of each
+    // one slower than threshold_nanos to dir/slow-query-<ms>-<n>.json. Set
+    // before queries run; an empty dir turns it off.
+    void SetSlowQueryLog(const std::string &dir, uint64_t threshold_nanos);
 
 private:
+    // Plan and run; profile (optional) records every stage
+    void Run(const Query &query, std::ostream &out, QueryProfile *profile, QueryPlan &plan);
+
+    // Run the index probe of one access path; parallel uses pool_ if set
+    void RunAccessPath(const AccessPath &path, const Predicate &pred,
+                       std::vector<RecordRef> &result, bool parallel);
+
+    // CREATE INDEX, DROP INDEX, SHOW INDEXES
+    void ExecuteIndexStatement(const Query &query, std::ostream &out);
+
+    // Index the records of the first `covered` log bytes into a new index
+    uint64_t BackfillIndex(const IndexMetaEntryPage &meta, uint64_t covered);
+
+    // COUNT/MIN/MAX straight from B+Tree pages (PlanType::INDEX_AGGREGATE)
+    void ExecuteIndexAggregate(const Query &query, const QueryPlan &plan, std::ostream &out);
+
+    void WriteSlowQueryTrace(const Query &query, const QueryProfile &profile);
+
     BufferPoolManager *bpm_;
     IndexCatalog *catalog_;
     RefReader *reader_;
+    ThreadPool *pool_;
+
+    std::string slow_query_dir_;
+    uint64_t slow_query_nanos_ = 0;
+    std::atomic<uint64_t> slow_query_seq_{0};
 };
 
 } // namespace cmse
-
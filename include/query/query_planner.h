@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../index/index_catalog.h"
+#include "../index/index_meta_page.h"
+#include "../storage/buffer_pool_manager.h"
+#include "query_types.h"
+#include "ref_reader.h"
+
+namespace cmse {
+
+enum class PlanType {
+    FULL_SCAN,            // read every log record and filter
+    INDEX_SCAN,           // one index, residual predicates on records
+    INDEX_INTERSECTION,   // several indexes, RecordRef sets intersected
+    INDEX_AGGREGATE       // COUNT/MIN/MAX answered from B+Tree pages alone
+};
+
+// One way to answer a single predicate through an index
+struct AccessPath {
+    size_t predicate_idx;
+
+    IndexID index_id;
+    IndexType index_type;
+    PageID root_page_id;
+
+    double selectivity;   // fraction of all records matched
+    double est_rows;
+    double cost;          // index traversal only (no record fetches)
+    double descent_cost;  // root-to-leaf part of cost
+};
+
+struct QueryPlan {
+    PlanType type = PlanType::FULL_SCAN;
+
+    std::vector<AccessPath> paths;    // indexes to probe
+    std::vector<size_t> residual;     // predicates evaluated on records
+
+    double table_rows = 0.0;
+    double est_rows = 0.0;
+    double cost = 0.0;
+
+    // Human readable plan tree (EXPLAIN output)
+    std::string Explain(const Query &query) const;
+};
+
+/**
+ * Cost-based planner.
+ *
+ * Estimates the selectivity of every predicate from the per-index
+ * statistics page (equi-depth histogram, HyperLogLog distinct count),
+ * falling back to the B+Tree root statistics (min_key, max_key,
+ * total_keys), and picks the cheapest of: full scan, single index scan,
+ * multi-index intersection.
+ */
+class QueryPlanner {
+public:
+    QueryPlanner(BufferPoolManager *bpm, IndexCatalog *catalog, RefReader *reader);
+
+    QueryPlan Plan(const Query &query);
+
+private:
+    // Returns false if no index can answer this predicate
+    bool BuildAccessPath(const Predicate &pred, size_t predicate_idx, AccessPath &path);
+
+    void EstimateBTree(const Predicate &pred, AccessPath &path);
+    void EstimateTrie(const Predicate &pred, AccessPath &path);
+
+    BufferPoolManager *bpm_;
+    IndexCatalog *catalog_;
+    RefReader *reader_;
+
+    double table_rows_ = 0.0;
+};
+
+std::string PredicateToString(const Predicate &pred);
+
+// The query as it would be typed (without EXPLAIN)
+std::string QueryToString(const Query &query);
+
+} // namespace cmse
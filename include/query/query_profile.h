@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cmse {
+
+// One timed step of a query (plan, index probe, record fetch, ...)
+struct ProfileStage {
+    std::string name;
+    std::string detail;         // index and predicate, may be empty
+    size_t depth = 0;           // nesting level, 0 = the whole query
+
+    uint64_t start_nanos = 0;   // since the profile started
+    uint64_t elapsed_nanos = 0;
+    uint64_t rows = 0;          // RecordRefs or records produced
+
+    // counted on the calling thread while the stage ran
+    uint64_t pool_hits = 0;     // pages pinned from the pool
+    uint64_t pool_misses = 0;   // pages pinned after a disk read
+    uint64_t disk_read_bytes = 0;
+    uint64_t node_visits = 0;   // index pages touched (all indexes)
+    uint64_t log_read_bytes = 0;
+
+    bool parallel = false;      // work ran on the scan pool: counters are partial
+};
+
+/**
+ * Per-query execution profile (EXPLAIN ANALYZE, slow query traces).
+ *
+ * Stages nest: Begin() opens a stage inside the innermost open one. Page
+ * and byte counts are deltas of the calling thread's metrics shard (see
+ * MetricsRegistry), so they are exact when the stage runs on that thread
+ * and concurrent queries do not leak into them.
+ */
+class QueryProfile {
+public:
+    QueryProfile();
+
+    size_t Begin(const std::string &name, const std::string &detail = std::string());
+    void End(size_t stage);
+
+    ProfileStage &Stage(size_t stage) { return stages_[stage]; }
+    const std::vector<ProfileStage> &Stages() const { return stages_; }
+
+    // elapsed time of the outermost stage (0 before it ended)
+    uint64_t TotalNanos() const;
+
+    // indented stage tree, one line per stage
+    std::string Describe() const;
+
+    // Chrome trace event format (chrome://tracing, Perfetto), one complete
+    // event per stage; title (the query) goes into the trace metadata
+    std::string ChromeTrace(const std::string &title) const;
+
+private:
+    struct Counts {
+        uint64_t hits, misses, disk_bytes, node_visits, log_bytes;
+    };
+    static Counts Sample();
+
+    std::chrono::steady_clock::time_point origin_;
+    std::vector<ProfileStage> stages_;
+    std::vector<size_t> open_;          // stack of open stages
+    std::vector<Counts> open_counts_;   // counters when each opened
+};
+
+// Begin/End for a scope; does nothing when profile is null
+class ProfileScope {
+public:
+    ProfileScope(QueryProfile *profile, const std::string &name,
+                 const std::string &detail = std::string())
+        : profile_(profile), stage_(profile != nullptr ? profile->Begin(name, detail) : 0) {}
+    ~ProfileScope() {
+        if (profile_ != nullptr) profile_->End(stage_);
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+    void SetRows(uint64_t rows) {
+        if (profile_ != nullptr) profile_->Stage(stage_).rows = rows;
+    }
+    void SetParallel() {
+        if (profile_ != nullptr) profile_->Stage(stage_).parallel = true;
+    }
+
+private:
+    QueryProfile *profile_;
+    size_t stage_;
+};
+
+} // namespace cmse
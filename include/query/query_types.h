@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <cstdint>
 
 namespace cmse {
@@ -11,14 +12,53 @@ enum class QueryOp {
     STARTSWITH
 };
 
-struct Query {
+enum class AggregateOp {
+    NONE,
+    COUNT,
+    MIN,
+    MAX
+};
+
+enum class StatementType {
+    SELECT,         // [EXPLAIN [ANALYZE]] [COUNT|MIN|MAX] WHERE ...
+    CREATE_INDEX,   // CREATE INDEX ON <field> [USING BTREE|TRIE]
+    DROP_INDEX,     // DROP INDEX ON <field>
+    SHOW_INDEXES    // SHOW INDEXES
+};
+
+// A single "<field> <op> <value>" term of a WHERE clause
+struct Predicate {
     std::string field_name;
     QueryOp op;
 
-    uint64_t num_value;      // for EQUALS
-    uint64_t low, high;      // for BETWEEN
+    uint64_t num_value = 0;  // for EQUALS
+    uint64_t low = 0;        // for BETWEEN
+    uint64_t high = 0;
     std::string str_value;   // for string ops
+    bool is_string = false;  // EQUALS on a quoted value
 };
 
-} // namespace cmse
+struct Query {
+    StatementType statement = StatementType::SELECT;
 
+    // CREATE / DROP INDEX: the field, and "BTREE", "TRIE" or "" (the
+    // field's default) for USING
+    std::string index_field;
+    std::string index_using;
+
+    // Conjunction of predicates ("... AND ...")
+    std::vector<Predicate> predicates;
+
+    // "EXPLAIN" prefix: print the chosen plan instead of running it
+    bool explain = false;
+
+    // "EXPLAIN ANALYZE": run it, then print the plan with the measured
+    // time, rows and page counts of every stage instead of the results
+    bool analyze = false;
+
+    // "COUNT|MIN|MAX WHERE ... [GROUP BY <width>]"
+    AggregateOp aggregate = AggregateOp::NONE;
+    uint64_t group_by_width = 0;   // 0 = no grouping
+};
+
+} // namespace cmse
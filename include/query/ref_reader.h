@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <string>
 #include "../common/types.h"
 
@@ -9,12 +10,19 @@ namespace cmse {
 class RefReader {
 public:
     explicit RefReader(const std::string &log_file);
+    ~RefReader();
 
+    // Read the log line starting at ref.offset (without the trailing newline)
     std::string Read(const RecordRef &ref);
 
+    // Size of the log file in bytes (0 if it cannot be opened)
+    uint64_t Size() const;
+
+    // Sequentially read every line of the log (used by full scans)
+    void Scan(const std::function<void(RecordRef, const std::string &)> &fn);
+
 private:
     int fd_;
 };
 
 } // namespace cmse
-
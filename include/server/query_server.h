@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "../common/thread_pool.h"
+#include "../query/query_executor.h"
+
+namespace cmse {
+
+struct ServerOptions {
+    // Unix-domain socket path; when empty, listen on TCP bind_address:port
+    std::string unix_path;
+    std::string bind_address = "127.0.0.1";
+    uint16_t port = 7411;
+    int backlog = 128;
+};
+
+/**
+ * Query server.
+ *
+ * Protocol: one QueryParser query per line. Every request is answered
+ * with the executor's output followed by a line "END"; unparsable
+ * requests get "ERROR <reason>" before the "END". Responses are streamed
+ * to the socket while the query runs. The request "STATS" returns the
+ * engine metrics in Prometheus text format (see MetricsRegistry).
+ *
+ * A single epoll thread accepts connections and reads request lines;
+ * queries run on the worker pool against the shared executor. Requests
+ * of one connection are answered in order, different connections in
+ * parallel.
+ */
+class QueryServer {
+public:
+    QueryServer(QueryExecutor *executor, ThreadPool *workers, const ServerOptions &options);
+    ~QueryServer();
+
+    QueryServer(const QueryServer &) = delete;
+    QueryServer &operator=(const QueryServer &) = delete;
+
+    // Bind and listen; false (with a message on stderr) on failure
+    bool Start();
+
+    // Event loop; returns after Stop()
+    void Run();
+
+    // Safe to call from another thread or a signal handler
+    void Stop();
+
+    uint64_t QueriesServed() const { return queries_served_.load(); }
+
+private:
+    struct Connection;
+
+    void Accept();
+    void ReadFrom(const std::shared_ptr<Connection> &conn);
+    void Close(const std::shared_ptr<Connection> &conn);
+
+    // Runs on a worker: answer queued requests until the queue is empty
+    void Serve(const std::shared_ptr<Connection> &conn);
+
+    QueryExecutor *executor_;
+    ServerOptions options_;
+
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;   // eventfd used by Stop()
+
+    // owned by the event loop thread
+    std::unordered_map<int, std::shared_ptr<Connection>> connections_;
+
+    // Serve() tasks still running; waited for before the server goes away
+    TaskGroup inflight_;
+    std::atomic<uint64_t> queries_served_{0};
+};
+
+} // namespace cmse
@@ -1,20 +1,195 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "../common/types.h"
 #include "../common/constants.h"
 #include "../common/config.h"
+#include "../common/storage_options.h"
 #include "page.h"
+#include "frame_arena.h"
 #include "disk_manager.h"
+#include "epoch_manager.h"
 #include "lru_replacer.h"
+#include "page_table.h"
 
 namespace cmse {
 
+class BufferPoolManager;
+
+// A consistent read view of a pool's pages: the state after the last
+// write epoch committed before it was opened (BufferPoolManager::
+// OpenSnapshot). Holds an epoch slot until destroyed; move-only.
+class PageSnapshot {
+public:
+    PageSnapshot() = default;
+    ~PageSnapshot();
+
+    PageSnapshot(PageSnapshot &&other) noexcept;
+    PageSnapshot &operator=(PageSnapshot &&other) noexcept;
+    PageSnapshot(const PageSnapshot &) = delete;
+    PageSnapshot &operator=(const PageSnapshot &) = delete;
+
+    bool Valid() const { return bpm_ != nullptr; }
+    uint64_t Epoch() const { return epoch_; }
+    BufferPoolManager *Pool() const { return bpm_; }
+
+    // Snapshot the calling thread reads through (see SnapshotScope); nullptr if none
+    static const PageSnapshot *Current();
+
+private:
+    friend class BufferPoolManager;
+    PageSnapshot(BufferPoolManager *bpm, size_t slot, uint64_t epoch)
+        : bpm_(bpm), slot_(slot), epoch_(epoch) {}
+
+    void Release();
+
+    BufferPoolManager *bpm_ = nullptr;
+    size_t slot_ = 0;
+    uint64_t epoch_ = 0;
+};
+
+// The calling thread reads pages through snapshot until the scope ends
+// (then through whatever it used before); nullptr or an empty snapshot
+// reads the latest pages. Tasks handed to other threads install the
+// snapshot of the thread that made them (PageSnapshot::Current()).
+class SnapshotScope {
+public:
+    explicit SnapshotScope(const PageSnapshot *snapshot);
+    ~SnapshotScope();
+
+    SnapshotScope(const SnapshotScope &) = delete;
+    SnapshotScope &operator=(const SnapshotScope &) = delete;
+
+private:
+    const PageSnapshot *previous_;
+};
+
+// One pin on a page, dropped when the guard is destroyed or assigned over
+// (BufferPoolManager::FetchPageRead / FetchPageWrite / NewPageGuarded);
+// move-only, empty if the fetch failed. A guard is a pin, not a latch:
+// readers and writers are kept apart by write epochs and snapshots as for
+// FetchPage.
+class PageGuard {
+public:
+    bool IsValid() const { return page_ != nullptr; }
+    explicit operator bool() const { return page_ != nullptr; }
+
+    // Plain id of the page
+    PageID PageId() const { return page_->GetPageID(); }
+
+    const Page* GetPage() const { return page_; }
+    const char* GetData() const { return page_->GetData(); }
+
+    // Unpin now; the guard is empty afterwards
+    void Drop();
+
+protected:
+    PageGuard() = default;
+    PageGuard(BufferPoolManager *bpm, Page *page, PageID page_id, bool dirty)
+        : bpm_(bpm), page_(page), page_id_(page_id), dirty_(dirty) {}
+    ~PageGuard() { Drop(); }
+
+    PageGuard(PageGuard &&other) noexcept;
+    PageGuard &operator=(PageGuard &&other) noexcept;
+    PageGuard(const PageGuard &) = delete;
+    PageGuard &operator=(const PageGuard &) = delete;
+
+    BufferPoolManager *bpm_ = nullptr;
+    Page *page_ = nullptr;
+    PageID page_id_ = INVALID_PAGE_ID;     // as fetched (maybe swizzled), to unpin with
+    bool dirty_ = false;
+};
+
+// Pin of a page only read: unpinned clean
+class ReadPageGuard : public PageGuard {
+public:
+    ReadPageGuard() = default;
+
+private:
+    friend class BufferPoolManager;
+    ReadPageGuard(BufferPoolManager *bpm, Page *page, PageID page_id)
+        : PageGuard(bpm, page, page_id, false) {}
+};
+
+// Pin of a page being changed: unpinned dirty
+class WritePageGuard : public PageGuard {
+public:
+    WritePageGuard() = default;
+
+    using PageGuard::GetData;
+    char* GetData() { return page_->GetData(); }
+
+private:
+    friend class BufferPoolManager;
+    WritePageGuard(BufferPoolManager *bpm, Page *page, PageID page_id)
+        : PageGuard(bpm, page, page_id, true) {}
+};
+
+/**
+ * Thread-safe: loading, evicting and versioning pages run under one pool
+ * latch. Page contents are not latched; concurrent readers of a page are
+ * fine.
+ *
+ * Hits take no lock: the page table is read lock-free (PageTable), the
+ * frame is pinned with one atomic increment (Page::TryPin) and its page id
+ * checked afterwards, so a frame evicted or reused in between is noticed
+ * and the fetch retried under the latch. A frame only leaves the pool
+ * unpinned (Page::TryEvict), so a pinned page stays put. Resident frames
+ * stay in the replacer while pinned; the victim search skips pinned ones
+ * and gives frames hit since its last pass a second chance. Unpins without
+ * a dirty mark are lock-free too. Each frame carries the last write epoch
+ * that saved a version of its page, so snapshots no later epoch changed
+ * hit lock-free as well; versions (below) are resolved under the latch,
+ * and write epochs always take it.
+ *
+ * Snapshot reads: writers change pages inside write epochs (BeginWrite /
+ * CommitWrite, one epoch open at a time) and readers read through a
+ * PageSnapshot, so a reader never sees half of a write epoch and never
+ * waits for one. The first time a write epoch fetches a page, the page's
+ * committed image is saved in a version table: on the heap when nobody
+ * has the page pinned, otherwise by moving the page to a fresh frame and
+ * leaving the old frame to its readers. A snapshot fetch of a page picks
+ * the oldest image saved after the snapshot's epoch (the page as it was
+ * then) and copies it into a frame of its own while pinned; pages with no
+ * such image are read as they are. Images are dropped at commit when the
+ * epoch did not change the page, and otherwise once no snapshot is older
+ * than the epoch that replaced them (EpochManager).
+ *
+ * Hot tier: PinHotPage keeps a page in the pool for good (its frame leaves
+ * the replacer) and hands out a swizzled page id, the page id tagged with
+ * the hot slot holding its frame. FetchPage and UnpinPage given one go
+ * straight to the slot's frame with no page table lookup; the frame's page
+ * id and version epoch are checked as for any lock-free hit, so a swizzled
+ * id that went stale (page released from the tier, moved by a write epoch)
+ * falls back to the plain page id. IndexCatalog fills the tier with the
+ * upper index levels.
+ *
+ * Pointer swizzling: FetchChild links a parent page's frame to the frame
+ * its child was found in, per child slot, so the next descent through that
+ * slot goes to the child's frame with no page table lookup (the link is
+ * checked like a swizzled id). Links are kept beside the frames, never in
+ * the page data, and are dropped when either page leaves its frame
+ * (eviction, free) or moved along when a write epoch moves the child.
+ *
+ * Pages written in write epochs must only be read concurrently through
+ * snapshots; page 0 (catalog directory) is never versioned.
+ */
 class BufferPoolManager {
 public:
-    explicit BufferPoolManager(size_t pool_size = DEFAULT_BUFFER_POOL_SIZE);
+    explicit BufferPoolManager(size_t pool_size = DEFAULT_BUFFER_POOL_SIZE,
+                               DiskIoMode io_mode = DISK_IO_MODE);
+
+    // options must have passed StorageOptions::Validate
+    explicit BufferPoolManager(const StorageOptions &options);
     ~BufferPoolManager();
 
     // Fetch the page with the given ID. Loads from disk if necessary.
@@ -29,6 +204,12 @@ public:
     // Returns false if the page is not in the pool or pin_count is already 0.
     bool UnpinPage(PageID page_id, bool is_dirty);
 
+    // FetchPage / NewPage with the pin held by a guard (empty where those
+    // return nullptr); write guards unpin dirty
+    ReadPageGuard FetchPageRead(PageID page_id);
+    WritePageGuard FetchPageWrite(PageID page_id);
+    WritePageGuard NewPageGuarded(PageID* page_id);
+
     // Flush a specific page to disk (if dirty).
     // Returns false if the page is not in the pool.
     bool FlushPage(PageID page_id);
@@ -36,17 +217,209 @@ public:
     // Flush all dirty pages to disk (called on destruction).
     void FlushAllPages();
 
+    // Number of FetchPage calls so far (page touches, hit or miss)
+    uint64_t GetFetchCount() const;
+
+    // What the frame data ended up backed by (huge pages or not)
+    FrameBacking GetFrameBacking() const { return arena_.Backing(); }
+
+    // Disk I/O mode in effect (direct may have fallen back to buffered)
+    DiskIoMode GetIoMode() const { return disk_manager_.GetIoMode(); }
+
+    // Why the disk file is unusable (format mismatch); empty if it is fine
+    const std::string& GetDiskError() const { return disk_manager_.GetError(); }
+
+    // Options the pool was built with; indexes take their limits from here
+    const StorageOptions& GetOptions() const { return options_; }
+
+    // ===== Snapshot reads =====
+
+    // Read view at the last committed write epoch
+    PageSnapshot OpenSnapshot();
+
+    // Open a write epoch for the calling thread, waiting while another one
+    // is open; its page changes become visible to snapshots at CommitWrite
+    // (same thread)
+    void BeginWrite();
+    void CommitWrite();
+
+    // Whether some thread has a write epoch open
+    bool WriteEpochOpen() const { return write_epoch_.load(std::memory_order_acquire) != 0; }
+
+    // Snapshot the calling thread reads this pool through: nullptr when it
+    // has none installed or is in a write epoch (writers read the latest)
+    const PageSnapshot* CurrentSnapshot() const;
+
+    // Last committed write epoch
+    uint64_t GetCommittedEpoch() const { return epochs_.Current(); }
+
+    // Snapshot epochs; also frees objects retired by writers (Bloom filters)
+    EpochManager& Epochs() { return epochs_; }
+
+    // Page images kept for snapshots
+    size_t GetVersionCount();
+
+    // ===== Hot tier =====
+
+    // Keep page_id in the pool until UnpinHotPage and return its swizzled
+    // id, which FetchPage and UnpinPage take in place of page_id. The same
+    // id again if the page is hot already; INVALID_PAGE_ID if the tier is
+    // full or the page cannot be loaded.
+    PageID PinHotPage(PageID page_id);
+
+    // Let a hot page (swizzled or plain id) be evicted again; false if it
+    // is not hot
+    bool UnpinHotPage(PageID page_id);
+
+    static bool IsSwizzled(PageID page_id) { return (page_id & SWIZZLED) != 0; }
+    static PageID Unswizzle(PageID page_id) { return page_id & SWIZZLED_PAGE_MASK; }
+
+    size_t GetHotPageCount();
+    size_t GetHotCapacity() const { return hot_capacity_; }
+
+    // Dirty unpins of hot pages so far (whoever mirrors their contents
+    // rereads them when it moves)
+    uint64_t GetHotWriteCount() const { return hot_writes_.load(std::memory_order_acquire); }
+
+    // ===== Pointer swizzling =====
+
+    // Fetch the child in slot of parent (pinned by the caller), *child_id
+    // as read from parent. Readers go through the link from parent's frame
+    // when the child is still in the linked frame, and otherwise fetch it
+    // by id and link the frame it is in. *child_id becomes the id to unpin
+    // the child with (swizzled while linked). Writers always fetch by id.
+    Page* FetchChild(const Page* parent, uint32_t slot, PageID* child_id);
+
+    // FetchChild with both pins held by guards
+    ReadPageGuard FetchChildRead(const PageGuard& parent, uint32_t slot, PageID child_id);
+
+    // Links currently held
+    size_t GetSwizzledCount();
+
 private:
-    // Helper: allocate a frame (free or victim via LRU)
+    friend class PageSnapshot;
+
+    // A page as it was before write epoch `until` changed it
+    struct PageVersion {
+        uint64_t until;
+        std::unique_ptr<char[]> data;           // nullptr while only in frame
+        FrameID frame = INVALID_FRAME_ID;       // pinned by snapshot readers
+    };
+
+    struct VersionChain {
+        uint64_t written = 0;                   // last write epoch that saved or created it
+        std::vector<PageVersion> versions;      // oldest first
+    };
+
+    // Helper: allocate a frame (free or victim via LRU); FREE until MarkLoaded
     FrameID AllocateFrame();
 
+    // Frame holding the latest page_id, read from disk if not resident
+    // (INVALID_FRAME_ID if no frame is free); not pinned
+    FrameID LoadPage(PageID page_id);
+
+    // Swizzled page id: SWIZZLED | slot << SWIZZLED_SLOT_SHIFT | page id,
+    // slot a hot slot, or with SWIZZLED_FRAME a frame (FetchChild links)
+    static constexpr PageID SWIZZLED = 1ull << 63;
+    static constexpr PageID SWIZZLED_FRAME = 1ull << 62;
+    static constexpr unsigned SWIZZLED_SLOT_SHIFT = 40;
+    static constexpr PageID SWIZZLED_PAGE_MASK = (1ull << SWIZZLED_SLOT_SHIFT) - 1;
+    static constexpr size_t SWIZZLED_SLOTS = SWIZZLED_FRAME >> SWIZZLED_SLOT_SHIFT;
+
+    static PageID Swizzle(PageID page_id, size_t slot, PageID tag) {
+        return SWIZZLED | tag | static_cast<PageID>(slot) << SWIZZLED_SLOT_SHIFT | page_id;
+    }
+
+    // Frame holding page_id (or, swizzled, the frame it names) as far as a
+    // lock-free reader can tell; INVALID_FRAME_ID if unknown
+    FrameID ResidentFrame(PageID page_id) const;
+
+    void CountFetch();
+
+    // Lock-free hit: pin page_id in frame_id if it is there and the caller
+    // may read it as it is (nullptr: take the latch)
+    Page* TryFetchResident(PageID page_id, FrameID frame_id, const PageSnapshot* snapshot);
+    bool TryUnpinResident(PageID page_id, FrameID frame_id, const PageSnapshot* snapshot);
+
+    // Whether a reader at snapshot (nullptr: latest) may read page as page_id
+    bool ReadsLatest(const Page& page, PageID page_id, const PageSnapshot* snapshot) const;
+
+    // Last pin on an old image frame went away without the latch
+    void ReleaseUnpinnedVersion(PageID page_id, FrameID frame_id);
+
+    void FreeFrame(FrameID frame_id);
+
+    // Link parent's slot to child (frames holding the latest parent and
+    // child_page_id); false if either is not
+    bool SwizzleChild(FrameID parent, uint32_t slot, PageID child_page_id, FrameID child);
+
+    // The page in frame_id leaves it: drop the link to it and its links
+    void UnswizzleFrame(FrameID frame_id);
+
+    // The version a snapshot at epoch reads instead of the latest page (nullptr: latest)
+    PageVersion* FindVersion(PageID page_id, uint64_t epoch);
+
+    // Save the committed image of page_id (latest in frame_id) before the
+    // write epoch changes it; returns the frame the writer uses from now on
+    FrameID SaveVersion(PageID page_id, FrameID frame_id);
+
+    // Snapshot reader's last pin on a version frame is gone
+    void ReleaseVersionFrame(PageVersion& version);
+
+    // Drop images no snapshot can read any more
+    void ReclaimVersions();
+
+    void CloseSnapshot(size_t slot);
+
+    std::mutex latch_;                                 // Protects all members below (writes to page_table_)
+    const StorageOptions options_;
     const size_t pool_size_;
-    Page* pages_;                                      // Array of in-memory pages (frames)
-    std::unordered_map<PageID, FrameID> page_table_;   // page_id -> frame_id
-    std::vector<FrameID> free_frames_;                 // List of free frames
+    FrameArena arena_;                                 // Frame data, one PAGE_SIZE slot per frame
+    Page* pages_;                                      // Frame metadata, pointing into arena_
+    PageTable page_table_;                             // page_id -> frame_id, lock-free reads
+    std::vector<std::vector<FrameID>> free_frames_;    // Free frames per arena partition
     LRUReplacer replacer_;                             // LRU replacer for eviction
     DiskManager disk_manager_;                         // Owns the disk interface
-    PageID next_page_id_ = 0;                          // Monotonically increasing page ID
+    PageID next_page_id_ = 1;                          // Monotonically increasing page ID (0 = catalog)
+
+    std::unordered_map<PageID, VersionChain> versions_;
+    std::deque<std::pair<uint64_t, PageID>> version_queue_;   // (until, page), oldest first
+    std::vector<PageID> epoch_pages_;                  // saved or created in the open write epoch
+
+    // Hot tier: frame of each slot's page (INVALID_FRAME_ID: slot unused),
+    // read lock-free by FetchPage; frames in it are not in the replacer
+    const size_t hot_capacity_;
+    std::unique_ptr<std::atomic<FrameID>[]> hot_frames_;
+    size_t hot_count_ = 0;
+    std::atomic<uint64_t> hot_writes_{0};
+
+    // Pointer swizzling: per frame, the frame of the child in each slot
+    // (INVALID_FRAME_ID: not linked; allocated with the frame's first link
+    // and kept with the frame, read lock-free), and the link to the frame.
+    // swip_arrays_[p]->frames[s] == c exactly when swip_owners_[c] is {p, s}.
+    static constexpr size_t SWIP_SLOTS = BPLUS_TREE_INTERNAL_MAX_KEYS + 2;
+    struct SwipArray {
+        std::atomic<FrameID> frames[SWIP_SLOTS];
+        uint32_t linked = 0;
+    };
+    struct SwipOwner {
+        FrameID parent = INVALID_FRAME_ID;
+        uint32_t slot = 0;
+    };
+    std::unique_ptr<std::atomic<SwipArray*>[]> swip_arrays_;
+    std::vector<SwipOwner> swip_owners_;
+    size_t swizzled_count_ = 0;
+
+    // FetchPage calls, striped by thread so hits do not share a counter
+    static constexpr size_t FETCH_COUNT_STRIPES = 64;
+    struct alignas(64) FetchCountStripe {
+        std::atomic<uint64_t> count{0};
+    };
+    FetchCountStripe fetch_counts_[FETCH_COUNT_STRIPES];
+
+    EpochManager epochs_;                              // committed write epoch = epochs_.Current()
+    std::mutex write_mutex_;                           // held from BeginWrite to CommitWrite
+    std::atomic<uint64_t> write_epoch_{0};             // open write epoch, 0 if none
 };
 
 } // namespace cmse
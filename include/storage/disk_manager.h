@@ -1,25 +1,73 @@
 #pragma once
 
-#include <fstream>
+#include <cstdint>
 #include <string>
 
 #include "../common/types.h"
 #include "../common/constants.h"
 #include "../common/config.h"
+#include "../common/storage_options.h"
 
 namespace cmse {
 
+constexpr uint32_t DISK_FILE_MAGIC = 0x45534D43;   // "CMSE"
+
+// Format of the disk file, at DISK_FILE_HEADER_OFFSET in page 0. Files
+// from before the header have zeros there: 4 KiB pages, default fan-out.
+struct DiskFileHeader {
+    uint32_t magic;
+    uint32_t page_size;
+    uint32_t btree_leaf_max_keys;
+    uint32_t btree_internal_max_keys;
+};
+
+static_assert(DISK_FILE_HEADER_OFFSET + sizeof(DiskFileHeader) <= PAGE_SIZE,
+              "disk file header exceeds page 0");
+
+// Reads and writes whole pages of the disk file with pread/pwrite.
+//
+// In DiskIoMode::DIRECT the file is opened with O_DIRECT, so transfers
+// bypass the page cache and must use PAGE_SIZE-aligned buffers: buffer
+// pool frames already are (see FrameArena), anything else goes through an
+// aligned bounce buffer. Not thread-safe; the buffer pool serializes calls.
+//
+// The file header is checked on open and stamped whenever page 0 is
+// written. A file whose header disagrees with the options is not used:
+// GetError() says why, reads return zeros and writes are dropped.
 class DiskManager {
 public:
-    DiskManager();
+    explicit DiskManager(const StorageOptions &options);
     ~DiskManager();
 
+    DiskManager(const DiskManager &) = delete;
+    DiskManager &operator=(const DiskManager &) = delete;
+
     void ReadPage(PageID page_id, char* data);
     void WritePage(PageID page_id, const char* data);
 
+    // Number of pages currently stored in the file
+    PageID GetNumPages();
+
+    // Mode in effect: DIRECT falls back to BUFFERED if the file system
+    // refuses O_DIRECT
+    DiskIoMode GetIoMode() const { return mode_; }
+
+    // Empty unless the file could not be opened or has another format
+    const std::string &GetError() const { return error_; }
+
 private:
-    std::fstream file_;
+    // Compare an existing file's header with header_
+    void CheckHeader();
+
+    // Aligned stand-in for a caller buffer O_DIRECT cannot use
+    char* BounceBuffer();
+
+    int fd_ = -1;
+    DiskIoMode mode_;
+    DiskFileHeader header_;
+    std::string path_;
+    std::string error_;
+    char* bounce_ = nullptr;
 };
 
 } // namespace cmse
-
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+#include "../common/constants.h"
+
+namespace cmse {
+
+/**
+ * Epoch-based reclamation.
+ *
+ * Readers announce the epoch they started in (Enter) and withdraw it when
+ * done (Exit); they take no lock, only a slot in a fixed table of
+ * cache-line sized cells. Whatever a writer unlinks while readers may
+ * still hold it is retired with the current epoch and freed by Reclaim
+ * once the epoch has moved on and every reader that could have seen it
+ * has exited.
+ *
+ * The buffer pool uses it for snapshot reads: a snapshot's epoch is the
+ * last committed write epoch, and page versions, catalog views and Bloom
+ * filters replaced by later epochs are kept until SafeEpoch passes them.
+ */
+class EpochManager {
+public:
+    static constexpr uint64_t IDLE = UINT64_MAX;
+
+    EpochManager() = default;
+
+    // runs every callback still waiting
+    ~EpochManager();
+
+    EpochManager(const EpochManager &) = delete;
+    EpochManager &operator=(const EpochManager &) = delete;
+
+    uint64_t Current() const { return epoch_.load(std::memory_order_seq_cst); }
+
+    // Move to the next epoch and return it
+    uint64_t Advance() { return epoch_.fetch_add(1, std::memory_order_seq_cst) + 1; }
+
+    // Announce a reader at the current epoch (stored in *epoch); returns
+    // its slot. Waits while all EPOCH_MAX_READERS slots are taken.
+    size_t Enter(uint64_t *epoch);
+    void Exit(size_t slot);
+
+    // Smallest epoch an active reader announced (IDLE if none)
+    uint64_t MinActive() const;
+
+    // Every reader, now or later, is at this epoch or after it
+    uint64_t SafeEpoch() const;
+
+    // Call free_fn once every reader that entered by now has exited
+    void Retire(std::function<void()> free_fn);
+
+    // Run the retired callbacks that became safe; returns how many ran
+    size_t Reclaim();
+
+    size_t RetiredCount() const;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{IDLE};
+    };
+
+    std::atomic<uint64_t> epoch_{0};
+    Slot slots_[EPOCH_MAX_READERS];
+
+    mutable std::mutex retired_mutex_;
+    std::deque<std::pair<uint64_t, std::function<void()>>> retired_;   // (epoch, callback)
+};
+
+} // namespace cmse
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../common/types.h"
+#include "../common/constants.h"
+
+namespace cmse {
+
+// What the arena's memory turned out to be backed by
+enum class FrameBacking {
+    HUGETLB,            // explicit huge pages (MAP_HUGETLB)
+    TRANSPARENT_HUGE,   // normal mapping with MADV_HUGEPAGE
+    NORMAL              // plain 4 KiB pages
+};
+
+const char *FrameBackingName(FrameBacking backing);
+
+/**
+ * FrameArena holds the data of every buffer pool frame in one anonymous
+ * mapping, PAGE_SIZE-aligned and kept apart from the frame metadata (see
+ * Page), so scanning pin counts or dirty flags does not drag page data
+ * through the cache and the pool costs a few TLB entries instead of one
+ * per frame.
+ *
+ * Huge pages are tried first: MAP_HUGETLB when the pool spans at least one
+ * huge page and the system has them reserved, otherwise a 2 MiB-aligned
+ * mapping advised for transparent huge pages, otherwise plain pages.
+ *
+ * With NUMA partitioning on and more than one node online, the frames are
+ * split into one contiguous partition per node and each partition's memory
+ * is placed on its node (MPOL_PREFERRED); the buffer pool then hands a
+ * thread free frames from its own node's partition first.
+ */
+class FrameArena {
+public:
+    FrameArena(size_t frame_count, bool huge_pages, bool numa_partitions);
+    ~FrameArena();
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    char *Frame(FrameID frame_id) const {
+        return base_ + static_cast<size_t>(frame_id) * PAGE_SIZE;
+    }
+
+    FrameBacking Backing() const { return backing_; }
+
+    // One partition per NUMA node in use (1 when not partitioned)
+    size_t PartitionCount() const { return partition_begin_.size(); }
+
+    // Partition a frame belongs to
+    size_t PartitionOf(FrameID frame_id) const;
+
+    // Partition for the NUMA node the calling thread runs on
+    size_t CurrentPartition() const;
+
+private:
+    // Spread frames over the online nodes and bind each range to its node
+    void BindPartitions(const std::vector<int> &nodes);
+
+    char *base_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    size_t frame_count_;
+    FrameBacking backing_ = FrameBacking::NORMAL;
+
+    // first frame of each partition, and the node it is placed on
+    std::vector<FrameID> partition_begin_;
+    std::vector<int> partition_node_;
+};
+
+} // namespace cmse
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 
 #include "../common/types.h"
@@ -12,19 +14,42 @@ namespace cmse {
  * Page represents a fixed-size block of data
  * loaded from disk into memory.
  *
- * The buffer pool manages Page objects.
+ * The buffer pool manages Page objects. A Page holds only the frame's
+ * metadata; its PAGE_SIZE bytes of data live in the pool's FrameArena.
+ *
+ * The pin count shares one atomic word with a FREE bit, set while the
+ * frame holds no page (free, being loaded, or evicted), so resident pages
+ * can be pinned without the pool latch: TryPin is a single increment that
+ * fails on a FREE frame, and eviction claims only frames with no pins
+ * (TryEvict). Each Page sits on its own cache line so pins of neighbouring
+ * frames do not contend.
  */
-class Page {
+class alignas(64) Page {
 public:
-    Page() {
-        Reset();
+    // Pin word bit: the frame holds no page
+    static constexpr uint32_t FREE = 1u << 31;
+
+    // Version epoch of a frame holding an old image for snapshots
+    static constexpr uint64_t OLD_VERSION = UINT64_MAX;
+
+    // Hot slot of a frame outside the hot tier
+    static constexpr uint32_t NO_HOT_SLOT = UINT32_MAX;
+
+    Page() = default;
+
+    // Point the page at its frame's data (done once by the buffer pool)
+    void SetData(char* data) {
+        data_ = data;
     }
 
-    // Reset page metadata and clear data buffer
+    // Reset page metadata and clear data buffer (the pin word is left to
+    // the buffer pool: MarkLoaded/MarkFree)
     void Reset() {
-        page_id_ = INVALID_PAGE_ID;
+        page_id_.store(INVALID_PAGE_ID, std::memory_order_relaxed);
         is_dirty_ = false;
-        pin_count_ = 0;
+        referenced_.store(false, std::memory_order_relaxed);
+        version_epoch_.store(0, std::memory_order_relaxed);
+        hot_slot_ = NO_HOT_SLOT;
         std::memset(data_, 0, PAGE_SIZE);
     }
 
@@ -39,11 +64,11 @@ public:
 
     // Metadata accessors
     PageID GetPageID() const {
-        return page_id_;
+        return page_id_.load(std::memory_order_relaxed);
     }
 
     void SetPageID(PageID page_id) {
-        page_id_ = page_id;
+        page_id_.store(page_id, std::memory_order_relaxed);
     }
 
     bool IsDirty() const {
@@ -55,26 +80,84 @@ public:
     }
 
     uint32_t GetPinCount() const {
-        return pin_count_;
+        return pin_.load(std::memory_order_seq_cst) & ~FREE;
     }
 
     void Pin() {
-        ++pin_count_;
+        pin_.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    // Callers check GetPinCount() > 0 first; returns the pins left
+    uint32_t Unpin() {
+        return (pin_.fetch_sub(1, std::memory_order_acq_rel) - 1) & ~FREE;
     }
 
-    void Unpin() {
-        if (pin_count_ > 0) {
-            --pin_count_;
+    // Pin unless the frame is FREE (then the pin is undone)
+    bool TryPin() {
+        if (pin_.fetch_add(1, std::memory_order_seq_cst) & FREE) {
+            pin_.fetch_sub(1, std::memory_order_relaxed);
+            return false;
         }
+        return true;
     }
 
-private:
-    PageID page_id_;
-    bool is_dirty_;
-    uint32_t pin_count_;
+    // Claim an unpinned frame for eviction (sets FREE)
+    bool TryEvict() {
+        uint32_t unpinned = 0;
+        return pin_.compare_exchange_strong(unpinned, FREE, std::memory_order_acq_rel);
+    }
+
+    // The frame holds its page from now on: TryPin succeeds. Pins that
+    // raced with the FREE bit are kept; their owners undo them.
+    void MarkLoaded() {
+        pin_.fetch_and(~FREE, std::memory_order_release);
+    }
 
-    // Actual page data
-    char data_[PAGE_SIZE];
+    void MarkFree() {
+        pin_.fetch_or(FREE, std::memory_order_acq_rel);
+    }
+
+    // Hit since the replacer last looked at the frame (second chance)
+    void SetReferenced() {
+        if (!referenced_.load(std::memory_order_relaxed)) {
+            referenced_.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    bool TakeReferenced() {
+        return referenced_.exchange(false, std::memory_order_relaxed);
+    }
+
+    // Last write epoch that saved a version of the page held here (0: none
+    // a snapshot can see), OLD_VERSION for a frame holding an old image
+    uint64_t GetVersionEpoch() const {
+        return version_epoch_.load(std::memory_order_seq_cst);
+    }
+
+    void SetVersionEpoch(uint64_t epoch) {
+        version_epoch_.store(epoch, std::memory_order_seq_cst);
+    }
+
+    // Slot of the pool's hot tier holding the frame, NO_HOT_SLOT if none
+    // (under the pool latch)
+    uint32_t GetHotSlot() const {
+        return hot_slot_;
+    }
+
+    void SetHotSlot(uint32_t slot) {
+        hot_slot_ = slot;
+    }
+
+private:
+    std::atomic<uint32_t> pin_{FREE};
+    std::atomic<bool> referenced_{false};
+    bool is_dirty_ = false;
+    std::atomic<PageID> page_id_{INVALID_PAGE_ID};
+    std::atomic<uint64_t> version_epoch_{0};
+    uint32_t hot_slot_ = NO_HOT_SLOT;
+
+    // Actual page data (in the frame arena)
+    char* data_ = nullptr;
 };
 
 } // namespace cmse
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "../common/types.h"
+#include "../common/constants.h"
+
+namespace cmse {
+
+/**
+ * The buffer pool's page_id -> frame_id map: open addressing with linear
+ * probing over a fixed power-of-two slot array, sized once for the pool
+ * (load factor at most 1/2) so it never grows.
+ *
+ * Insert and Erase run under the pool latch, one at a time; Find takes no
+ * lock. Erase closes the gap by shifting later entries back instead of
+ * leaving tombstones, so a concurrent Find may miss an entry that is being
+ * moved, or pair a key with the frame of the entry that replaced it. Its
+ * answer is a hint: the pool pins the frame and checks the frame's page id
+ * (and falls back to the latch on a miss).
+ */
+class PageTable {
+public:
+    // Room for max_entries pages
+    explicit PageTable(size_t max_entries);
+
+    PageTable(const PageTable &) = delete;
+    PageTable &operator=(const PageTable &) = delete;
+
+    // Frame holding page_id, INVALID_FRAME_ID if absent; lock-free
+    FrameID Find(PageID page_id) const;
+
+    // Add page_id or move it to another frame
+    void Insert(PageID page_id, FrameID frame_id);
+
+    bool Erase(PageID page_id);
+
+    size_t Size() const { return size_; }
+    size_t Capacity() const { return mask_ + 1; }
+
+    // fn(page_id, frame_id) for every entry; under the pool latch
+    template <typename Fn>
+    void ForEach(Fn &&fn) const {
+        for (size_t i = 0; i <= mask_; i++) {
+            PageID page_id = slots_[i].page_id.load(std::memory_order_relaxed);
+            if (page_id != INVALID_PAGE_ID) {
+                fn(page_id, slots_[i].frame_id.load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        std::atomic<PageID> page_id{INVALID_PAGE_ID};
+        std::atomic<FrameID> frame_id{INVALID_FRAME_ID};
+    };
+
+    // Slot a page id probes first (Fibonacci hashing: page ids are dense)
+    size_t Home(PageID page_id) const {
+        return static_cast<size_t>((page_id * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+    unsigned shift_ = 0;
+    size_t size_ = 0;
+};
+
+} // namespace cmse
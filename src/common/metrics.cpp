@@ -0,0 +1,296 @@
+#include "../../include/common/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace cmse {
+
+namespace {
+
+struct CounterInfo {
+    const char *name;       // Prometheus name, without the cmse_ prefix
+    const char *help;
+};
+
+const CounterInfo COUNTER_INFO[METRICS_COUNTERS] = {
+    {"buffer_pool_hits_total", "Page requests served from the buffer pool."},
+    {"buffer_pool_misses_total", "Page requests that had to read the page from disk."},
+    {"buffer_pool_evictions_total", "Pages evicted to make room for another."},
+    {"buffer_pool_dirty_writebacks_total", "Dirty pages written back on eviction."},
+    {"buffer_pool_flushes_total", "Dirty pages written by explicit flushes."},
+    {"page_versions_saved_total", "Page images saved before a write epoch changed the page."},
+    {"page_version_reads_total", "Snapshot page reads served from an older page image."},
+    {"hot_page_hits_total", "Page requests served from the hot tier without a page table lookup."},
+    {"hot_page_pins_total", "Index pages added to the hot tier."},
+    {"hot_page_unpins_total", "Index pages released from the hot tier."},
+    {"swizzled_hits_total", "Child page fetches served through a swizzled link without a page table lookup."},
+    {"page_swizzles_total", "Links made from a parent page's frame to the frame of a resident child."},
+    {"page_unswizzles_total", "Swizzled links dropped because a page left its frame."},
+    {"disk_reads_total", "Page reads from the disk file."},
+    {"disk_writes_total", "Page writes to the disk file."},
+    {"disk_read_bytes_total", "Bytes read from the disk file."},
+    {"disk_write_bytes_total", "Bytes written to the disk file."},
+    {"log_read_bytes_total", "Bytes of the log file read by queries."},
+    {"queries_total", "Queries executed."},
+};
+
+const CounterInfo INDEX_COUNTER_INFO[METRICS_INDEX_COUNTERS] = {
+    {"index_node_visits_total", "Index pages fetched by index operations."},
+    {"index_leaf_splits_total", "B+Tree leaf splits."},
+    {"index_internal_splits_total", "B+Tree internal node splits."},
+    {"index_nodes_created_total", "Trie nodes created."},
+};
+
+struct HistogramInfo {
+    const char *name;       // Prometheus family
+    const char *label;      // label="value", or "" for none
+    const char *help;
+    const char *title;      // Describe()
+};
+
+const HistogramInfo HISTOGRAM_INFO[METRICS_HISTOGRAMS] = {
+    {"disk_read_seconds", "", "Latency of one page read.", "disk read"},
+    {"disk_write_seconds", "", "Latency of one page write.", "disk write"},
+    {"index_probe_seconds", "op=\"equals\"", "Latency of one index probe by operator.", "probe EQUALS"},
+    {"index_probe_seconds", "op=\"between\"", "", "probe BETWEEN"},
+    {"index_probe_seconds", "op=\"startswith\"", "", "probe STARTSWITH"},
+    {"query_seconds", "kind=\"select\"", "Latency of a whole query by aggregate.", "query (records)"},
+    {"query_seconds", "kind=\"count\"", "", "query COUNT"},
+    {"query_seconds", "kind=\"min\"", "", "query MIN"},
+    {"query_seconds", "kind=\"max\"", "", "query MAX"},
+};
+
+// Prometheus histogram buckets: powers of two from ~1 us to ~69 s
+constexpr size_t EXPORT_FIRST_EXPONENT = 10;
+constexpr size_t EXPORT_LAST_EXPONENT = 36;
+
+std::string FormatNanos(uint64_t nanos) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    if (nanos < 10'000) {
+        out << std::setprecision(0) << nanos << "ns";
+    } else if (nanos < 10'000'000) {
+        out << static_cast<double>(nanos) / 1e3 << "us";
+    } else if (nanos < 10'000'000'000) {
+        out << static_cast<double>(nanos) / 1e6 << "ms";
+    } else {
+        out << static_cast<double>(nanos) / 1e9 << "s";
+    }
+    return out.str();
+}
+
+} // namespace
+
+// ================================
+// Snapshots
+// ================================
+
+uint64_t HistogramSnapshot::Percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(count)));
+    rank = std::clamp<uint64_t>(rank, 1, count);
+
+    uint64_t seen = 0;
+    for (size_t b = 0; b < buckets.size(); b++) {
+        seen += buckets[b];
+        if (seen >= rank) {
+            uint64_t upper = b + 1 < buckets.size() ? LatencyBucketLow(b + 1) - 1 : max_nanos;
+            return std::min(upper, max_nanos);
+        }
+    }
+    return max_nanos;
+}
+
+uint64_t MetricsSnapshot::Get(IndexID index_id, IndexCounter c) const {
+    size_t slot = index_id <= METRICS_MAX_INDEX_ID ? index_id : 0;
+    return index_counters[slot][static_cast<size_t>(c)];
+}
+
+std::string MetricsSnapshot::Describe() const {
+    std::ostringstream out;
+
+    uint64_t hits = Get(Counter::BUFFER_POOL_HITS);
+    uint64_t misses = Get(Counter::BUFFER_POOL_MISSES);
+    double hit_rate = hits + misses > 0 ? 100.0 * static_cast<double>(hits) /
+                                              static_cast<double>(hits + misses)
+                                        : 0.0;
+    out << std::fixed << std::setprecision(1);
+    out << "buffer pool: " << hits << " hits, " << misses << " misses (" << hit_rate
+        << "% hit rate), " << Get(Counter::BUFFER_POOL_EVICTIONS) << " evictions, "
+        << Get(Counter::BUFFER_POOL_DIRTY_WRITEBACKS) << " dirty writebacks, "
+        << Get(Counter::BUFFER_POOL_FLUSHES) << " flushed\n";
+    out << "snapshots: " << Get(Counter::PAGE_VERSIONS_SAVED) << " page versions saved, "
+        << Get(Counter::PAGE_VERSION_READS) << " old version reads\n";
+    out << "hot tier: " << Get(Counter::HOT_PAGE_PINS) - Get(Counter::HOT_PAGE_UNPINS)
+        << " pages held, " << Get(Counter::HOT_PAGE_HITS) << " hits\n";
+    out << "swizzling: " << Get(Counter::PAGE_SWIZZLES) << " links made, "
+        << Get(Counter::PAGE_UNSWIZZLES) << " dropped, " << Get(Counter::SWIZZLED_HITS) << " hits\n";
+    out << "disk: " << Get(Counter::DISK_READS) << " reads ("
+        << Get(Counter::DISK_READ_BYTES) / 1024 << " KiB), " << Get(Counter::DISK_WRITES)
+        << " writes (" << Get(Counter::DISK_WRITE_BYTES) / 1024 << " KiB)\n";
+    out << "log: " << Get(Counter::LOG_READ_BYTES) / 1024 << " KiB read by queries\n";
+
+    for (IndexID id = 0; id <= METRICS_MAX_INDEX_ID; id++) {
+        const uint64_t *c = index_counters[id];
+        if (std::all_of(c, c + METRICS_INDEX_COUNTERS, [](uint64_t v) { return v == 0; })) {
+            continue;
+        }
+        out << "index " << (id == 0 ? std::string("(other)") : std::to_string(id)) << ": "
+            << c[static_cast<size_t>(IndexCounter::NODE_VISITS)] << " node visits, "
+            << c[static_cast<size_t>(IndexCounter::LEAF_SPLITS)] << " leaf splits, "
+            << c[static_cast<size_t>(IndexCounter::INTERNAL_SPLITS)] << " internal splits, "
+            << c[static_cast<size_t>(IndexCounter::NODES_CREATED)] << " trie nodes created\n";
+    }
+
+    out << "queries: " << Get(Counter::QUERIES) << "\n";
+    for (size_t h = 0; h < METRICS_HISTOGRAMS; h++) {
+        const HistogramSnapshot &hist = histograms[h];
+        if (hist.count == 0) {
+            continue;
+        }
+        out << "  " << std::left << std::setw(18) << HISTOGRAM_INFO[h].title << std::right
+            << " n=" << hist.count << " avg=" << FormatNanos(hist.sum_nanos / hist.count)
+            << " p50=" << FormatNanos(hist.Percentile(0.5))
+            << " p99=" << FormatNanos(hist.Percentile(0.99))
+            << " p99.9=" << FormatNanos(hist.Percentile(0.999))
+            << " max=" << FormatNanos(hist.max_nanos) << "\n";
+    }
+    return out.str();
+}
+
+std::string MetricsSnapshot::Prometheus() const {
+    std::ostringstream out;
+
+    for (size_t c = 0; c < METRICS_COUNTERS; c++) {
+        out << "# HELP cmse_" << COUNTER_INFO[c].name << " " << COUNTER_INFO[c].help << "\n"
+            << "# TYPE cmse_" << COUNTER_INFO[c].name << " counter\n"
+            << "cmse_" << COUNTER_INFO[c].name << " " << counters[c] << "\n";
+    }
+
+    for (size_t c = 0; c < METRICS_INDEX_COUNTERS; c++) {
+        out << "# HELP cmse_" << INDEX_COUNTER_INFO[c].name << " " << INDEX_COUNTER_INFO[c].help
+            << "\n# TYPE cmse_" << INDEX_COUNTER_INFO[c].name << " counter\n";
+        for (IndexID id = 0; id <= METRICS_MAX_INDEX_ID; id++) {
+            if (index_counters[id][c] == 0) continue;
+            out << "cmse_" << INDEX_COUNTER_INFO[c].name << "{index=\""
+                << (id == 0 ? std::string("other") : std::to_string(id)) << "\"} "
+                << index_counters[id][c] << "\n";
+        }
+    }
+
+    for (size_t h = 0; h < METRICS_HISTOGRAMS; h++) {
+        const HistogramInfo &info = HISTOGRAM_INFO[h];
+        const HistogramSnapshot &hist = histograms[h];
+        std::string label = info.label;
+
+        if (info.help[0] != '\0') {
+            out << "# HELP cmse_" << info.name << " " << info.help << "\n"
+                << "# TYPE cmse_" << info.name << " histogram\n";
+        }
+
+        // power-of-two bounds fall on bucket boundaries: exact cumulative counts
+        uint64_t cumulative = 0;
+        size_t bucket = 0;
+        for (size_t e = EXPORT_FIRST_EXPONENT; e <= EXPORT_LAST_EXPONENT; e++) {
+            size_t end = LatencyBucket(uint64_t{1} << e);
+            for (; bucket < end; bucket++) cumulative += hist.buckets[bucket];
+            out << "cmse_" << info.name << "_bucket{" << label << (label.empty() ? "" : ",")
+                << "le=\"" << static_cast<double>(uint64_t{1} << e) / 1e9 << "\"} "
+                << cumulative << "\n";
+        }
+        out << "cmse_" << info.name << "_bucket{" << label << (label.empty() ? "" : ",")
+            << "le=\"+Inf\"} " << hist.count << "\n";
+
+        std::string suffix = label.empty() ? "" : "{" + label + "}";
+        out << "cmse_" << info.name << "_sum" << suffix << " "
+            << static_cast<double>(hist.sum_nanos) / 1e9 << "\n"
+            << "cmse_" << info.name << "_count" << suffix << " " << hist.count << "\n";
+    }
+    return out.str();
+}
+
+// ================================
+// Registry
+// ================================
+
+// Owns the thread's shard; hands its counts to the registry at thread exit
+struct MetricsRegistry::ShardOwner {
+    Shard *shard = new Shard();
+
+    ShardOwner() { MetricsRegistry::Global().Register(shard); }
+    ~ShardOwner() { MetricsRegistry::Global().Retire(shard); }
+};
+
+MetricsRegistry &MetricsRegistry::Global() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::Shard &MetricsRegistry::Local() {
+    thread_local ShardOwner owner;
+    return *owner.shard;
+}
+
+void MetricsRegistry::Register(Shard *shard) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    shards_.push_back(shard);
+}
+
+void MetricsRegistry::Retire(Shard *shard) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    AddShard(*shard, retired_);
+    shards_.erase(std::remove(shards_.begin(), shards_.end(), shard), shards_.end());
+    delete shard;
+}
+
+void MetricsRegistry::AddShard(const Shard &shard, MetricsSnapshot &into) const {
+    for (size_t c = 0; c < METRICS_COUNTERS; c++) {
+        into.counters[c] += shard.counters[c].load(std::memory_order_relaxed);
+    }
+    for (size_t id = 0; id <= METRICS_MAX_INDEX_ID; id++) {
+        for (size_t c = 0; c < METRICS_INDEX_COUNTERS; c++) {
+            into.index_counters[id][c] += shard.index_counters[id][c].load(std::memory_order_relaxed);
+        }
+    }
+    for (size_t h = 0; h < METRICS_HISTOGRAMS; h++) {
+        const Shard::Hist &from = shard.histograms[h];
+        HistogramSnapshot &to = into.histograms[h];
+        to.count += from.count.load(std::memory_order_relaxed);
+        to.sum_nanos += from.sum.load(std::memory_order_relaxed);
+        to.max_nanos = std::max(to.max_nanos, from.max.load(std::memory_order_relaxed));
+        for (size_t b = 0; b < METRICS_HISTOGRAM_BUCKETS; b++) {
+            to.buckets[b] += from.buckets[b].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+MetricsSnapshot MetricsRegistry::Collect() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    MetricsSnapshot snapshot = retired_;
+    for (const Shard *shard : shards_) {
+        AddShard(*shard, snapshot);
+    }
+    return snapshot;
+}
+
+bool MetricsRegistry::WritePrometheusFile(const std::string &path) {
+    std::string text = Collect().Prometheus();
+
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        out << text;
+        if (!out.flush()) {
+            return false;
+        }
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+} // namespace cmse
@@ -0,0 +1,168 @@
+#include "../../include/common/storage_options.h"
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+namespace cmse {
+
+namespace {
+
+std::string Trim(const std::string &s) {
+    size_t begin = s.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+
+// "16384", "16K", "16KiB", "2M"
+bool ParseSize(const std::string &value, uint64_t &out) {
+    size_t pos = 0;
+    while (pos < value.size() && std::isdigit(static_cast<unsigned char>(value[pos]))) pos++;
+    if (pos == 0 || pos > 18) return false;
+
+    uint64_t n = std::stoull(value.substr(0, pos));
+    std::string suffix = value.substr(pos);
+    for (char &c : suffix) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+
+    if (suffix.empty()) {
+        out = n;
+    } else if (suffix == "K" || suffix == "KB" || suffix == "KIB") {
+        out = n << 10;
+    } else if (suffix == "M" || suffix == "MB" || suffix == "MIB") {
+        out = n << 20;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ParseBool(const std::string &value, bool &out) {
+    if (value == "true" || value == "on" || value == "yes" || value == "1") {
+        out = true;
+    } else if (value == "false" || value == "off" || value == "no" || value == "0") {
+        out = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool StorageOptions::Set(const std::string &name, const std::string &value, std::string &error) {
+    uint64_t n = 0;
+    bool flag = false;
+    bool ok = true;
+
+    if (name == "pool_pages") {
+        ok = ParseSize(value, n);
+        pool_pages = n;
+    } else if (name == "disk_file") {
+        ok = !value.empty();
+        disk_file = value;
+    } else if (name == "direct_io") {
+        ok = ParseBool(value, flag);
+        io_mode = flag ? DiskIoMode::DIRECT : DiskIoMode::BUFFERED;
+    } else if (name == "huge_pages") {
+        ok = ParseBool(value, huge_pages);
+    } else if (name == "numa_partitions") {
+        ok = ParseBool(value, numa_partitions);
+    } else if (name == "hot_pages") {
+        ok = ParseSize(value, n);
+        hot_pages = n;
+    } else if (name == "hot_index_levels") {
+        ok = ParseSize(value, n) && n <= UINT32_MAX;
+        hot_index_levels = static_cast<uint32_t>(n);
+    } else if (name == "pointer_swizzling") {
+        ok = ParseBool(value, pointer_swizzling);
+    } else if (name == "page_size") {
+        ok = ParseSize(value, n);
+        page_size = n;
+    } else if (name == "btree_leaf_max_keys") {
+        ok = ParseSize(value, n) && n <= UINT32_MAX;
+        btree_leaf_max_keys = static_cast<uint32_t>(n);
+    } else if (name == "btree_internal_max_keys") {
+        ok = ParseSize(value, n) && n <= UINT32_MAX;
+        btree_internal_max_keys = static_cast<uint32_t>(n);
+    } else if (name == "trie_max_records") {
+        ok = ParseSize(value, n) && n <= UINT32_MAX;
+        trie_max_records = static_cast<uint32_t>(n);
+    } else {
+        error = "unknown option '" + name + "'";
+        return false;
+    }
+
+    if (!ok) {
+        error = "bad value '" + value + "' for " + name;
+    }
+    return ok;
+}
+
+bool StorageOptions::LoadFile(const std::string &path, std::string &error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot read " + path;
+        return false;
+    }
+
+    std::string line;
+    for (int line_no = 1; std::getline(in, line); line_no++) {
+        line = Trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            error = path + ":" + std::to_string(line_no) + ": expected key = value";
+            return false;
+        }
+        if (!Set(Trim(line.substr(0, eq)), Trim(line.substr(eq + 1)), error)) {
+            error = path + ":" + std::to_string(line_no) + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StorageOptions::Validate(std::string &error) const {
+    if (pool_pages < 8) {
+        error = "pool_pages must be at least 8";
+    } else if (hot_index_levels > 8) {
+        error = "hot_index_levels must be within 0..8";
+    } else if (page_size != 4096 && page_size != 8192 && page_size != 16384 && page_size != 65536) {
+        error = "page_size must be 4K, 8K, 16K or 64K";
+    } else if (page_size != PAGE_SIZE) {
+        error = "page_size " + std::to_string(page_size) + " needs a build with -DCMSE_PAGE_SIZE=" +
+                std::to_string(page_size) + " (this one uses " + std::to_string(PAGE_SIZE) + ")";
+    } else if (btree_leaf_max_keys < 4 || btree_leaf_max_keys > BPLUS_TREE_LEAF_MAX_KEYS) {
+        error = "btree_leaf_max_keys must be within 4.." + std::to_string(BPLUS_TREE_LEAF_MAX_KEYS);
+    } else if (btree_internal_max_keys < 4 ||
+               btree_internal_max_keys > BPLUS_TREE_INTERNAL_MAX_KEYS) {
+        error = "btree_internal_max_keys must be within 4.." +
+                std::to_string(BPLUS_TREE_INTERNAL_MAX_KEYS);
+    } else if (trie_max_records < 1 || trie_max_records > TRIE_MAX_RECORDS) {
+        error = "trie_max_records must be within 1.." + std::to_string(TRIE_MAX_RECORDS);
+    } else {
+        return true;
+    }
+    return false;
+}
+
+std::string StorageOptions::Describe() const {
+    std::ostringstream out;
+    out << "pool_pages = " << pool_pages << "\n"
+        << "disk_file = " << disk_file << "\n"
+        << "direct_io = " << (io_mode == DiskIoMode::DIRECT ? "true" : "false") << "\n"
+        << "huge_pages = " << (huge_pages ? "true" : "false") << "\n"
+        << "numa_partitions = " << (numa_partitions ? "true" : "false") << "\n"
+        << "hot_pages = " << hot_pages << "\n"
+        << "hot_index_levels = " << hot_index_levels << "\n"
+        << "pointer_swizzling = " << (pointer_swizzling ? "true" : "false") << "\n"
+        << "page_size = " << page_size << "\n"
+        << "btree_leaf_max_keys = " << btree_leaf_max_keys << "\n"
+        << "btree_internal_max_keys = " << btree_internal_max_keys << "\n"
+        << "trie_max_records = " << trie_max_records << "\n";
+    return out.str();
+}
+
+} // namespace cmse
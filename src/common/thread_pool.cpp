@@ -0,0 +1,152 @@
+#include "../../include/common/thread_pool.h"
+
+#include <chrono>
+
+namespace cmse {
+
+namespace {
+
+// Index of the calling worker in its pool (or SIZE_MAX outside workers)
+thread_local const ThreadPool *tls_pool = nullptr;
+thread_local size_t tls_worker_index = static_cast<size_t>(-1);
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+
+    for (size_t i = 0; i < num_threads; i++) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+    for (size_t i = 0; i < num_threads; i++) {
+        workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    sleep_cv_.notify_all();
+
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    // own deque when called from a worker, round-robin otherwise
+    size_t index = (tls_pool == this)
+        ? tls_worker_index
+        : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+
+    // count first so a concurrent pop can never drive queued_ below zero
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        queued_.fetch_add(1, std::memory_order_release);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    sleep_cv_.notify_one();
+}
+
+bool ThreadPool::PopTask(size_t index, std::function<void()> &task) {
+    // 1. own deque, newest first
+    if (index < queues_.size()) {
+        WorkQueue &own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued_.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+
+    // 2. steal the oldest task from someone else
+    size_t n = queues_.size();
+    size_t start = (index < n) ? index + 1 : next_queue_.load(std::memory_order_relaxed);
+    for (size_t k = 0; k < n; k++) {
+        WorkQueue &victim = *queues_[(start + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued_.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ThreadPool::TryRunOne() {
+    size_t index = (tls_pool == this) ? tls_worker_index : queues_.size();
+
+    std::function<void()> task;
+    if (!PopTask(index, task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void ThreadPool::WorkerLoop(size_t index) {
+    tls_pool = this;
+    tls_worker_index = index;
+
+    while (true) {
+        std::function<void()> task;
+        if (PopTask(index, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.wait(lock, [this] {
+            return stop_ || queued_.load(std::memory_order_acquire) > 0;
+        });
+        if (stop_ && queued_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+void TaskGroup::Run(std::function<void()> task) {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+
+    pool_->Submit([this, task = std::move(task)]() {
+        task();
+
+        // under the mutex: Wait() takes it before returning, so the group
+        // cannot be destroyed while we still touch it
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            done_cv_.notify_all();
+        }
+    });
+}
+
+void TaskGroup::Wait() {
+    while (pending_.load(std::memory_order_acquire) > 0) {
+        // help out instead of blocking a worker (nested groups)
+        if (pool_->TryRunOne()) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait_for(lock, std::chrono::microseconds(200), [this] {
+            return pending_.load(std::memory_order_acquire) == 0;
+        });
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+}
+
+} // namespace cmse
@@ -0,0 +1,308 @@
+#include "../../include/index/bloom_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace cmse {
+
+namespace {
+
+constexpr uint32_t BLOCK_BITS = BLOOM_FILTER_BLOCK_BYTES * 8;
+
+// block of a hash: multiply-shift of the high half over block_count
+inline size_t BlockIndex(uint64_t hash, size_t block_count) {
+    return static_cast<size_t>(((hash >> 32) * static_cast<uint64_t>(block_count)) >> 32);
+}
+
+} // namespace
+
+BloomFilter::BloomFilter(double fpr) : fpr_(fpr) {
+    layers_.reserve(BLOOM_FILTER_MAX_LAYERS);
+}
+
+BloomFilter::BloomFilter(BloomFilter &&other) noexcept
+    : fpr_(other.fpr_),
+      layers_(std::move(other.layers_)),
+      layer_count_(other.layer_count_.load(std::memory_order_relaxed)),
+      bpm_(other.bpm_),
+      header_page_id_(other.header_page_id_),
+      saved_copy_current_(other.saved_copy_current_) {
+    other.layers_.clear();
+    other.layers_.reserve(BLOOM_FILTER_MAX_LAYERS);
+    other.layer_count_.store(0, std::memory_order_relaxed);
+}
+
+BloomFilter &BloomFilter::operator=(BloomFilter &&other) noexcept {
+    if (this != &other) {
+        fpr_ = other.fpr_;
+        layers_ = std::move(other.layers_);
+        layer_count_.store(other.layer_count_.load(std::memory_order_relaxed),
+                           std::memory_order_release);
+        bpm_ = other.bpm_;
+        header_page_id_ = other.header_page_id_;
+        saved_copy_current_ = other.saved_copy_current_;
+
+        other.layers_.clear();
+        other.layers_.reserve(BLOOM_FILTER_MAX_LAYERS);
+        other.layer_count_.store(0, std::memory_order_relaxed);
+    }
+    return *this;
+}
+
+void BloomFilter::PushLayer(Layer layer) {
+    layers_.push_back(std::move(layer));
+    layer_count_.store(static_cast<uint32_t>(layers_.size()), std::memory_order_release);
+}
+
+BloomFilter::Layer BloomFilter::MakeLayer(uint64_t capacity, double fpr) {
+    // optimal bits per key, plus ~20% for the uneven load across blocks
+    double bits_per_key = -std::log(fpr) / (std::log(2.0) * std::log(2.0)) * 1.2;
+    double bits = std::max(1.0, static_cast<double>(capacity)) * bits_per_key;
+
+    Layer layer;
+    layer.capacity = std::max<uint64_t>(capacity, 1);
+    layer.blocks.assign(static_cast<size_t>(std::ceil(bits / BLOCK_BITS)), Block{});
+    layer.probes = static_cast<uint32_t>(std::clamp(
+        std::lround(bits_per_key / 1.2 * std::log(2.0)), 1L,
+        static_cast<long>(BLOOM_FILTER_MAX_PROBES)));
+    return layer;
+}
+
+void BloomFilter::SetBits(Layer &layer, uint64_t hash) {
+    Block &block = layer.blocks[BlockIndex(hash, layer.blocks.size())];
+
+    // probe positions by double hashing the low half
+    uint32_t h1 = static_cast<uint32_t>(hash);
+    uint32_t h2 = static_cast<uint32_t>(hash >> 17) | 1;
+    for (uint32_t i = 0; i < layer.probes; i++) {
+        uint32_t bit = (h1 + i * h2) % BLOCK_BITS;
+        std::atomic_ref<uint64_t>(block.words[bit / 64])
+            .fetch_or(uint64_t{1} << (bit % 64), std::memory_order_relaxed);
+    }
+}
+
+bool BloomFilter::TestBits(const Layer &layer, uint64_t hash) {
+    // atomic_ref needs a non-const object; the bits are only loaded
+    Block &block = const_cast<Block &>(layer.blocks[BlockIndex(hash, layer.blocks.size())]);
+
+    uint32_t h1 = static_cast<uint32_t>(hash);
+    uint32_t h2 = static_cast<uint32_t>(hash >> 17) | 1;
+    for (uint32_t i = 0; i < layer.probes; i++) {
+        uint32_t bit = (h1 + i * h2) % BLOCK_BITS;
+        uint64_t word = std::atomic_ref<uint64_t>(block.words[bit / 64]).load(std::memory_order_relaxed);
+        if ((word & (uint64_t{1} << (bit % 64))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double BloomFilter::LayerFpr(size_t i) const {
+    // fpr/2 + fpr/4 + ... stays below fpr
+    return fpr_ / std::pow(2.0, static_cast<double>(i + 1));
+}
+
+BloomFilter BloomFilter::Build(std::span<const uint64_t> hashes, double fpr) {
+    BloomFilter filter(fpr);
+    if (hashes.empty()) {
+        return filter;
+    }
+
+    Layer layer = MakeLayer(hashes.size(), filter.LayerFpr(0));
+    for (uint64_t hash : hashes) {
+        SetBits(layer, hash);
+    }
+    layer.count = hashes.size();
+    filter.PushLayer(std::move(layer));
+    return filter;
+}
+
+void BloomFilter::Add(uint64_t hash) {
+    // duplicates would only eat into the layer's capacity
+    if (MayContain(hash)) {
+        return;
+    }
+
+    if (saved_copy_current_) {
+        MarkSavedCopyStale();
+    }
+
+    // out of layers, the last one keeps filling up (and its rate degrades)
+    if (layers_.empty()) {
+        PushLayer(MakeLayer(BLOOM_FILTER_INITIAL_KEYS, LayerFpr(0)));
+    } else if (layers_.back().count >= layers_.back().capacity &&
+               layers_.size() < BLOOM_FILTER_MAX_LAYERS) {
+        uint64_t capacity = std::max(BLOOM_FILTER_INITIAL_KEYS, layers_.back().capacity * 2);
+        PushLayer(MakeLayer(capacity, LayerFpr(layers_.size())));
+    }
+
+    Layer &layer = layers_.back();
+    SetBits(layer, hash);
+    std::atomic_ref<uint64_t>(layer.count).fetch_add(1, std::memory_order_relaxed);
+}
+
+bool BloomFilter::MayContain(uint64_t hash) const {
+    uint32_t count = layer_count_.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++) {
+        if (TestBits(layers_[i], hash)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t BloomFilter::KeyCount() const {
+    uint32_t layers = layer_count_.load(std::memory_order_acquire);
+    uint64_t count = 0;
+    for (uint32_t i = 0; i < layers; i++) {
+        count += std::atomic_ref<uint64_t>(const_cast<uint64_t &>(layers_[i].count))
+                     .load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+size_t BloomFilter::MemoryBytes() const {
+    uint32_t layers = layer_count_.load(std::memory_order_acquire);
+    size_t bytes = 0;
+    for (uint32_t i = 0; i < layers; i++) bytes += layers_[i].blocks.size() * sizeof(Block);
+    return bytes;
+}
+
+void BloomFilter::MarkSavedCopyStale() {
+    Page *page = bpm_->FetchPage(header_page_id_);
+    reinterpret_cast<BloomFilterHeaderPage *>(page->GetData())->clean = 0;
+    bpm_->UnpinPage(header_page_id_, true);
+
+    // on disk before any index page holding the new key can be
+    bpm_->FlushPage(header_page_id_);
+    saved_copy_current_ = false;
+}
+
+void BloomFilter::Save(BufferPoolManager *bpm, PageID header_page_id) {
+    if (saved_copy_current_ && bpm == bpm_ && header_page_id == header_page_id_) {
+        return;
+    }
+
+    Page *page = bpm->FetchPage(header_page_id);
+    auto *header = reinterpret_cast<BloomFilterHeaderPage *>(page->GetData());
+    PageID next_page = header->layer_count > 0 ? header->first_block_page : INVALID_PAGE_ID;
+    bpm->UnpinPage(header_page_id, false);
+
+    // blocks first, reusing the existing chain
+    PageID first_block_page = INVALID_PAGE_ID;
+    PageID prev_page = INVALID_PAGE_ID;
+    size_t layer_idx = 0;
+    size_t block_idx = 0;
+
+    while (layer_idx < layers_.size()) {
+        PageID page_id = next_page;
+        bool fresh = page_id == INVALID_PAGE_ID;
+        Page *block_page = fresh ? bpm->NewPage(&page_id) : bpm->FetchPage(page_id);
+        auto *blocks = reinterpret_cast<BloomFilterBlockPage *>(block_page->GetData());
+        next_page = fresh ? INVALID_PAGE_ID : blocks->next_page_id;
+
+        uint32_t n = 0;
+        while (n < BLOOM_FILTER_PAGE_BLOCKS && layer_idx < layers_.size()) {
+            std::memcpy(&blocks->words[n * BLOOM_FILTER_BLOCK_WORDS],
+                        layers_[layer_idx].blocks[block_idx].words, BLOOM_FILTER_BLOCK_BYTES);
+            n++;
+            if (++block_idx == layers_[layer_idx].blocks.size()) {
+                layer_idx++;
+                block_idx = 0;
+            }
+        }
+        blocks->block_count = n;
+        blocks->next_page_id = next_page;
+
+        bpm->UnpinPage(page_id, true);
+        bpm->FlushPage(page_id);
+
+        if (prev_page == INVALID_PAGE_ID) {
+            first_block_page = page_id;
+        } else if (fresh) {
+            Page *prev = bpm->FetchPage(prev_page);
+            reinterpret_cast<BloomFilterBlockPage *>(prev->GetData())->next_page_id = page_id;
+            bpm->UnpinPage(prev_page, true);
+            bpm->FlushPage(prev_page);
+        }
+        prev_page = page_id;
+    }
+
+    page = bpm->FetchPage(header_page_id);
+    header = reinterpret_cast<BloomFilterHeaderPage *>(page->GetData());
+    header->fpr = fpr_;
+    header->layer_count = static_cast<uint32_t>(layers_.size());
+    header->first_block_page = first_block_page;
+    for (size_t i = 0; i < layers_.size(); i++) {
+        header->layers[i] = BloomFilterLayerInfo{
+            layers_[i].capacity, layers_[i].count, layers_[i].probes,
+            static_cast<uint32_t>(layers_[i].blocks.size())};
+    }
+    header->clean = 1;
+    bpm->UnpinPage(header_page_id, true);
+    bpm->FlushPage(header_page_id);
+
+    bpm_ = bpm;
+    header_page_id_ = header_page_id;
+    saved_copy_current_ = true;
+}
+
+bool BloomFilter::Load(BufferPoolManager *bpm, PageID header_page_id) {
+    Page *page = bpm->FetchPage(header_page_id);
+    BloomFilterHeaderPage header;
+    std::memcpy(&header, page->GetData(), sizeof(header));
+    bpm->UnpinPage(header_page_id, false);
+
+    if (header.clean == 0 || header.layer_count > BLOOM_FILTER_MAX_LAYERS) {
+        return false;
+    }
+
+    fpr_ = header.fpr;
+    layers_.clear();
+    layer_count_.store(0, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < header.layer_count; i++) {
+        Layer layer;
+        layer.capacity = header.layers[i].capacity;
+        layer.count = header.layers[i].count;
+        layer.probes = header.layers[i].probes;
+        layer.blocks.resize(header.layers[i].block_count);
+        if (layer.blocks.empty() || layer.probes == 0) {
+            layers_.clear();
+            return false;
+        }
+        layers_.push_back(std::move(layer));
+    }
+
+    PageID page_id = header.first_block_page;
+    size_t layer_idx = 0;
+    size_t block_idx = 0;
+    while (layer_idx < layers_.size()) {
+        if (page_id == INVALID_PAGE_ID) {
+            layers_.clear();
+            return false;
+        }
+
+        page = bpm->FetchPage(page_id);
+        auto *blocks = reinterpret_cast<const BloomFilterBlockPage *>(page->GetData());
+        for (uint32_t n = 0; n < blocks->block_count && layer_idx < layers_.size(); n++) {
+            std::memcpy(layers_[layer_idx].blocks[block_idx].words,
+                        &blocks->words[n * BLOOM_FILTER_BLOCK_WORDS], BLOOM_FILTER_BLOCK_BYTES);
+            if (++block_idx == layers_[layer_idx].blocks.size()) {
+                layer_idx++;
+                block_idx = 0;
+            }
+        }
+        PageID next = blocks->next_page_id;
+        bpm->UnpinPage(page_id, false);
+        page_id = next;
+    }
+
+    layer_count_.store(static_cast<uint32_t>(layers_.size()), std::memory_order_release);
+    bpm_ = bpm;
+    header_page_id_ = header_page_id;
+    saved_copy_current_ = true;
+    return true;
+}
+
+} // namespace cmse
@@ -1,116 +1,311 @@
+#include "../../../include/common/hash_util.h"
+#include "../../../include/common/metrics.h"
 #include "../../../include/index/index_meta_page.h"
+#include "../../../include/index/index_stats.h"
 #include "../../../include/index/btree/bplus_tree.h"
 #include "../../../include/storage/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+
 namespace cmse {
 
 BPlusTree::BPlusTree(PageID root_page_id, IndexID index_id, IndexCatalog *catalog, BufferPoolManager *bpm)
-    : root_page_id_(root_page_id), bpm_(bpm), index_id_(index_id), catalog_(catalog) {}
+    : root_page_id_(root_page_id), bpm_(bpm), index_id_(index_id), catalog_(catalog),
+      leaf_max_keys_(bpm->GetOptions().btree_leaf_max_keys),
+      internal_max_keys_(bpm->GetOptions().btree_internal_max_keys),
+      hot_levels_(catalog != nullptr ? catalog->GetHotLevels(index_id) : nullptr) {}
+
+ReadPageGuard BPlusTree::ReadNode(PageID page_id) {
+    CountIndexMetric(index_id_, IndexCounter::NODE_VISITS);
+    return bpm_->FetchPageRead(page_id);
+}
 
-PageID BPlusTree::FindLeafPageForSearch(KeyType key, uint32_t &fetch_count) {
-    PageID current_page_id = root_page_id_;
+WritePageGuard BPlusTree::WriteNode(PageID page_id) {
+    CountIndexMetric(index_id_, IndexCounter::NODE_VISITS);
+    return bpm_->FetchPageWrite(page_id);
+}
+
+ReadPageGuard BPlusTree::ReadChildNode(const PageGuard &parent, uint32_t slot, PageID child_id) {
+    CountIndexMetric(index_id_, IndexCounter::NODE_VISITS);
+    return bpm_->FetchChildRead(parent, slot, child_id);
+}
+
+BPlusTree::~BPlusTree() {
+    FlushAppends();
+}
+
+void BPlusTree::SetAppendMode(bool enabled) {
+    FlushAppends();
+    append_mode_ = enabled;
+    rightmost_leaf_id_ = INVALID_PAGE_ID;
+}
+
+void BPlusTree::FlushAppends() {
+    if (pending_appends_ == 0) {
+        return;
+    }
+
+    InsertPath spine;
+    FetchRightSpine(spine);
+    ApplyAppends(spine);
+}
+
+void BPlusTree::FetchRightSpine(InsertPath &spine) {
+    // the rightmost leaf hangs off the last child slot of every spine node
+    spine.clear();
+    for (PageID page_id : right_spine_) {
+        WritePageGuard node = WriteNode(page_id);
+        auto *internal = reinterpret_cast<const BPlusTreeInternalPage *>(node.GetData());
+        uint32_t slot = internal->header.key_count;
+        spine.push_back(PathEntry{std::move(node), slot});
+    }
+}
+
+void BPlusTree::ApplyAppends(InsertPath &spine) {
+    if (pending_appends_ == 0) {
+        return;
+    }
+
+    for (PathEntry &entry : spine) {
+        auto *internal = reinterpret_cast<BPlusTreeInternalPage *>(entry.node.GetData());
+
+        UpdateInternalStats(internal, pending_min_, pending_max_, pending_appends_);
+        internal->child_counts[entry.slot] += pending_appends_;
+    }
+
+    pending_appends_ = 0;
+}
+
+bool BPlusTree::TryAppend(KeyType key, const RecordRef &value) {
+    if (rightmost_leaf_id_ == INVALID_PAGE_ID) {
+        right_spine_.clear();
+        has_rightmost_low_ = false;
+
+        PageID current_page_id = root_page_id_;
+        while (true) {
+            ReadPageGuard page = ReadNode(current_page_id);
+            auto *header =
+                reinterpret_cast<const BPlusTreePageHeader *>(page.GetData());
+
+            if (header->is_leaf) {
+                break;
+            }
+
+            auto *internal =
+                reinterpret_cast<const BPlusTreeInternalPage *>(page.GetData());
+            uint32_t last = internal->header.key_count;
+
+            // the last separator on the way down bounds the leaf from below
+            if (last > 0) {
+                rightmost_low_ = internal->keys[last - 1];
+                has_rightmost_low_ = true;
+            }
+
+            right_spine_.push_back(current_page_id);
+            current_page_id = internal->children[last];
+        }
+
+        rightmost_leaf_id_ = current_page_id;
+    }
+
+    if (has_rightmost_low_ && key < rightmost_low_) {
+        return false;   // belongs further left
+    }
+
+    WritePageGuard leaf_guard = WriteNode(rightmost_leaf_id_);
+    auto *leaf =
+        reinterpret_cast<BPlusTreeLeafPage *>(leaf_guard.GetData());
+
+    // near-sorted keys: the slot is at (or close to) the end
+    uint32_t pos = leaf->header.key_count;
+    while (pos > 0 && leaf->keys[pos - 1] > key) {
+        leaf->keys[pos] = leaf->keys[pos - 1];
+        leaf->values[pos] = leaf->values[pos - 1];
+        pos--;
+    }
+    leaf->keys[pos] = key;
+    leaf->values[pos] = value;
+    leaf->header.key_count++;
+
+    bool overflow = leaf->header.key_count > leaf_max_keys_;
+
+    if (pending_appends_ == 0) {
+        pending_min_ = key;
+        pending_max_ = key;
+    }
+    pending_min_ = std::min(pending_min_, key);
+    pending_max_ = std::max(pending_max_, key);
+    pending_appends_++;
+
+    // counts must be current before the split moves keys around; the
+    // spine pinned for them is the split's path
+    if (overflow) {
+        InsertPath spine;
+        FetchRightSpine(spine);
+        ApplyAppends(spine);
+        SplitLeaf(leaf_guard, spine);
+        rightmost_leaf_id_ = INVALID_PAGE_ID;
+    }
+    return true;
+}
+
+ReadPageGuard BPlusTree::FindLeafPageForSearch(KeyType key, uint32_t &fetch_count) {
+    // upper levels through the hot tier, the rest through swizzled links
+    // (each child fetched before its parent is unpinned)
+    HotCursor cursor(hot_levels_.get(), root_page_id_);
+    fetch_count++;
+    ReadPageGuard page = ReadNode(cursor.Id());
 
     while (true) {
-        fetch_count++;
-        Page *page = bpm_->FetchPage(current_page_id);
         auto *header =
-            reinterpret_cast<BPlusTreePageHeader *>(page->GetData());
+            reinterpret_cast<const BPlusTreePageHeader *>(page.GetData());
 
         // reached leaf
         if (header->is_leaf) {
-            bpm_->UnpinPage(current_page_id, false);
-            return current_page_id;
+            return page;
         }
 
         // internal page
         auto *internal =
-            reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
+            reinterpret_cast<const BPlusTreeInternalPage *>(page.GetData());
 
-        // Phase 3 pruning
-        if (key < internal->min_key || key > internal->max_key) {
-            bpm_->UnpinPage(current_page_id, false);
-            return INVALID_PAGE_ID;
+        // Phase 3 pruning. Below the root only from below: a key equal to
+        // a separator is looked for on its left, past that subtree's max
+        if (key < internal->min_key ||
+            (cursor.PageId() == root_page_id_ && key > internal->max_key)) {
+            return ReadPageGuard();
         }
 
+        // duplicates of a separator may sit on both sides of it, so go
+        // left on equality and let the caller walk the leaf chain
         uint32_t i = 0;
-        while (i < internal->header.key_count && key >= internal->keys[i]) {
+        while (i < internal->header.key_count && key > internal->keys[i]) {
             i++;
         }
 
-        PageID next_page_id = internal->children[i];
-
-        bpm_->UnpinPage(current_page_id, false);
-        current_page_id = next_page_id;
+        cursor.Descend(i, internal->children[i]);
+        fetch_count++;
+        page = ReadChildNode(page, i, cursor.Id());
     }
 }
 
-PageID BPlusTree::FindLeafPageForInsert(KeyType key) {
-    PageID current_page_id = root_page_id_;
+WritePageGuard BPlusTree::FindLeafPageForInsert(KeyType key, InsertPath &path,
+                                                KeyType *upper, bool *has_upper) {
+    path.clear();
+    if (has_upper != nullptr) {
+        *has_upper = false;
+    }
+
+    WritePageGuard page = WriteNode(root_page_id_);
 
     while (true) {
-        Page *page = bpm_->FetchPage(current_page_id);
         auto *header =
-            reinterpret_cast<BPlusTreePageHeader *>(page->GetData());
+            reinterpret_cast<const BPlusTreePageHeader *>(page.GetData());
 
         // reached leaf
         if (header->is_leaf) {
-            bpm_->UnpinPage(current_page_id, false);
-            return current_page_id;
+            return page;
         }
 
         // internal page
         auto *internal =
-            reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
+            reinterpret_cast<const BPlusTreeInternalPage *>(page.GetData());
 
         uint32_t i = 0;
         while (i < internal->header.key_count && key >= internal->keys[i]) {
             i++;
         }
 
+        // separators tighten on the way down
+        if (has_upper != nullptr && i < internal->header.key_count) {
+            *upper = internal->keys[i];
+            *has_upper = true;
+        }
+
         PageID next_page_id = internal->children[i];
+        path.push_back(PathEntry{std::move(page), i});
+        page = WriteNode(next_page_id);
+    }
+}
+
+ReadPageGuard BPlusTree::FindLeafPageForRange(KeyType key, bool rightmost, uint32_t &fetch_count) {
+    HotCursor cursor(hot_levels_.get(), root_page_id_);
+    fetch_count++;
+    ReadPageGuard page = ReadNode(cursor.Id());
 
-        bpm_->UnpinPage(current_page_id, false);
-        current_page_id = next_page_id;
+    while (true) {
+        auto *header =
+            reinterpret_cast<const BPlusTreePageHeader *>(page.GetData());
+
+        if (header->is_leaf) {
+            return page;
+        }
+
+        auto *internal =
+            reinterpret_cast<const BPlusTreeInternalPage *>(page.GetData());
+
+        // no min/max pruning: the range may start before min_key
+        uint32_t i = 0;
+        while (i < internal->header.key_count &&
+               (key > internal->keys[i] || (rightmost && key == internal->keys[i]))) {
+            i++;
+        }
+
+        cursor.Descend(i, internal->children[i]);
+        fetch_count++;
+        page = ReadChildNode(page, i, cursor.Id());
     }
 }
 
 void BPlusTree::Search(KeyType key, std::vector<RecordRef> &result, uint32_t &page_fetch_count) {
     result.clear();
-
-    PageID leaf_page_id = FindLeafPageForSearch(key, page_fetch_count);
-    if (leaf_page_id == INVALID_PAGE_ID) {
+    if (BloomFilter *filter = GetBloomFilter(); filter != nullptr && !filter->MayContain(HashKey(key))) {
         return;
     }
 
-    Page *page = bpm_->FetchPage(leaf_page_id);
+    FlushAppends();
 
-    auto *leaf =
-        reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    ReadPageGuard page = FindLeafPageForSearch(key, page_fetch_count);
 
-    // binary search is possible, but linear is OK for now
-    for (uint32_t i = 0; i < leaf->header.key_count; i++) {
-        if (leaf->keys[i] == key) {
-            result.push_back(leaf->values[i]);
+    while (page) {
+        auto *leaf =
+            reinterpret_cast<const BPlusTreeLeafPage *>(page.GetData());
+
+        // binary search is possible, but linear is OK for now
+        bool should_continue = true;
+        for (uint32_t i = 0; i < leaf->header.key_count; i++) {
+            if (leaf->keys[i] == key) {
+                result.push_back(leaf->values[i]);
+            } else if (leaf->keys[i] > key) {
+                should_continue = false;
+                break;
+            }
+        }
+
+        // duplicates may continue in the next leaf
+        PageID next_leaf = leaf->next_leaf_page_id;
+        if (!should_continue || next_leaf == INVALID_PAGE_ID) {
+            break;
         }
-    }
 
-    bpm_->UnpinPage(leaf_page_id, false);
+        page_fetch_count++;
+        page = ReadNode(next_leaf);
+    }
 }
 
 void BPlusTree::RangeSearch(KeyType low, KeyType high, std::vector<RecordRef> &result, uint32_t &page_fetch_count) {
+    FlushAppends();
     result.clear();
 
     // Step 1: find starting leaf
-    PageID leaf_page_id = FindLeafPageForSearch(low, page_fetch_count);
-    if (leaf_page_id == INVALID_PAGE_ID) {
-        return;
-    }
+    ReadPageGuard page = FindLeafPageForRange(low, false, page_fetch_count);
 
-    while (leaf_page_id != INVALID_PAGE_ID) {
-        page_fetch_count++;
-        Page *page = bpm_->FetchPage(leaf_page_id);
+    while (page) {
         auto *leaf =
-            reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+            reinterpret_cast<const BPlusTreeLeafPage *>(page.GetData());
 
         bool should_continue = true;
 
@@ -130,46 +325,278 @@ void BPlusTree::RangeSearch(KeyType low, KeyType high, std::vector<RecordRef> &r
             result.push_back(leaf->values[i]);
         }
 
+        // Step 3: decide whether to move to next leaf
         PageID next_leaf = leaf->next_leaf_page_id;
-        bpm_->UnpinPage(leaf_page_id, false);
+        if (!should_continue || next_leaf == INVALID_PAGE_ID) {
+            break;
+        }
 
-        // Step 3: decide whether to move to next leaf
-        if (!should_continue) {
+        page_fetch_count++;
+        page = ReadNode(next_leaf);
+    }
+}
+
+void BPlusTree::PartitionRange(KeyType low, KeyType high, size_t target,
+                               std::vector<std::pair<KeyType, KeyType>> &parts,
+                               uint32_t &fetch_count) {
+    // split points: a new sub-range starts at every separator in (low, high]
+    std::vector<KeyType> splits;
+    std::vector<HotCursor> frontier{HotCursor(hot_levels_.get(), root_page_id_)};
+
+    for (size_t level = 0; level < PARALLEL_SCAN_PARTITION_LEVELS && !frontier.empty(); level++) {
+        std::vector<HotCursor> next_frontier;
+
+        for (const HotCursor &node : frontier) {
+            fetch_count++;
+            ReadPageGuard page = ReadNode(node.Id());
+            auto *header =
+                reinterpret_cast<const BPlusTreePageHeader *>(page.GetData());
+
+            if (!header->is_leaf) {
+                auto *internal =
+                    reinterpret_cast<const BPlusTreeInternalPage *>(page.GetData());
+                uint32_t n = internal->header.key_count;
+
+                for (uint32_t i = 0; i <= n; i++) {
+                    bool after_low = (i == n) || internal->keys[i] >= low;
+                    bool before_high = (i == 0) || internal->keys[i - 1] <= high;
+                    if (after_low && before_high) {
+                        next_frontier.push_back(node);
+                        next_frontier.back().Descend(i, internal->children[i]);
+                    }
+                    if (i < n && internal->keys[i] > low && internal->keys[i] <= high) {
+                        splits.push_back(internal->keys[i]);
+                    }
+                }
+            }
+        }
+
+        if (splits.size() + 1 >= target) {
             break;
         }
+        frontier.swap(next_frontier);
+    }
+
+    std::sort(splits.begin(), splits.end());
+    splits.erase(std::unique(splits.begin(), splits.end()), splits.end());
 
-        leaf_page_id = next_leaf;
+    KeyType start = low;
+    for (KeyType split : splits) {
+        parts.emplace_back(start, split - 1);
+        start = split;
+    }
+    parts.emplace_back(start, high);
+}
+
+void BPlusTree::ParallelRangeSearch(KeyType low, KeyType high, std::vector<RecordRef> &result,
+                                    uint32_t &page_fetch_count, ThreadPool *pool, bool ordered) {
+    FlushAppends();
+    result.clear();
+    if (low > high) {
+        return;
+    }
+
+    std::vector<std::pair<KeyType, KeyType>> parts;
+    if (pool != nullptr && pool->Size() > 1) {
+        PartitionRange(low, high, pool->Size() * PARALLEL_SCAN_PARTITIONS_PER_THREAD,
+                       parts, page_fetch_count);
+    }
+
+    if (parts.size() <= 1) {
+        RangeSearch(low, high, result, page_fetch_count);
+        return;
+    }
+
+    std::atomic<uint32_t> fetches{0};
+    std::vector<std::vector<RecordRef>> part_results(ordered ? parts.size() : 0);
+    std::mutex result_mutex;
+
+    // sub-ranges read the caller's snapshot, whichever thread runs them
+    const PageSnapshot *snapshot = PageSnapshot::Current();
+
+    {
+        TaskGroup group(pool);
+        for (size_t i = 0; i < parts.size(); i++) {
+            group.Run([&, i]() {
+                SnapshotScope scope(snapshot);
+                std::vector<RecordRef> local;
+                uint32_t local_fetches = 0;
+                RangeSearch(parts[i].first, parts[i].second, local, local_fetches);
+                fetches.fetch_add(local_fetches, std::memory_order_relaxed);
+
+                if (ordered) {
+                    part_results[i].swap(local);
+                } else {
+                    std::lock_guard<std::mutex> lock(result_mutex);
+                    result.insert(result.end(), local.begin(), local.end());
+                }
+            });
+        }
+        group.Wait();
+    }
+
+    page_fetch_count += fetches.load();
+
+    // sub-ranges are disjoint and ascending: concatenation is key order
+    if (ordered) {
+        size_t total = 0;
+        for (const auto &part : part_results) total += part.size();
+        result.reserve(total);
+        for (const auto &part : part_results) {
+            result.insert(result.end(), part.begin(), part.end());
+        }
     }
 }
 
 void BPlusTree::Insert(KeyType key, RecordRef value) {
+    if (BloomFilter *filter = GetBloomFilter()) {
+        filter->Add(HashKey(key));
+    }
 
-    PageID leaf_page_id = FindLeafPageForInsert(key);
-    Page *page = bpm_->FetchPage(leaf_page_id);
+    if (append_mode_ && TryAppend(key, value)) {
+        if (WritePageGuard stats = FetchStatsPage()) {
+            IndexStatsAddKey(reinterpret_cast<IndexStatsPage *>(stats.GetData()), key);
+        }
+        return;
+    }
+
+    FlushAppends();
+
+    // the leaf and its ancestors stay pinned from the descent to the split
+    InsertPath path;
+    WritePageGuard leaf_guard = FindLeafPageForInsert(key, path);
     auto *leaf =
-        reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+        reinterpret_cast<BPlusTreeLeafPage *>(leaf_guard.GetData());
 
     InsertIntoLeaf(leaf, key, value);
 
-    PageID parent_id = leaf->header.parent_page_id;
-    bpm_->UnpinPage(leaf_page_id, true);
-
-    while (parent_id != INVALID_PAGE_ID) {
-        Page *p = bpm_->FetchPage(parent_id);
+    for (PathEntry &entry : path) {
         auto *internal =
-            reinterpret_cast<BPlusTreeInternalPage *>(p->GetData());
+            reinterpret_cast<BPlusTreeInternalPage *>(entry.node.GetData());
 
         UpdateInternalStats(internal, key);
 
-        parent_id = internal->header.parent_page_id;
-        bpm_->UnpinPage(p->GetPageID(), true);
+        // per-subtree count of the child we came from
+        internal->child_counts[entry.slot]++;
+    }
+
+    if (leaf->header.key_count > leaf_max_keys_) {
+        SplitLeaf(leaf_guard, path);
+        rightmost_leaf_id_ = INVALID_PAGE_ID;
     }
 
-    if (leaf->header.key_count > BPLUS_TREE_LEAF_MAX_KEYS) {
-        SplitLeaf(leaf_page_id);
+    // Per-index histogram + distinct-count sketch
+    if (WritePageGuard stats = FetchStatsPage()) {
+        IndexStatsAddKey(reinterpret_cast<IndexStatsPage *>(stats.GetData()), key);
     }
 }
 
+void BPlusTree::InsertBatch(std::span<const std::pair<KeyType, RecordRef>> entries) {
+    if (entries.empty()) {
+        return;
+    }
+
+    FlushAppends();
+
+    std::vector<std::pair<KeyType, RecordRef>> sorted(entries.begin(), entries.end());
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    InsertPath path;
+    size_t i = 0;
+
+    while (i < sorted.size()) {
+        KeyType upper = 0;
+        bool has_upper = false;
+        WritePageGuard leaf_guard = FindLeafPageForInsert(sorted[i].first, path, &upper, &has_upper);
+        auto *leaf =
+            reinterpret_cast<BPlusTreeLeafPage *>(leaf_guard.GetData());
+
+        // the run: keys below the leaf's upper bound, at most one past full
+        // (the same transient overflow a single Insert leaves for SplitLeaf)
+        uint32_t n = leaf->header.key_count;
+        size_t room = leaf_max_keys_ + 1 - n;
+        size_t end = i;
+        while (end < sorted.size() && end - i < room &&
+               (!has_upper || sorted[end].first < upper)) {
+            end++;
+        }
+        uint32_t added = static_cast<uint32_t>(end - i);
+
+        // merge the sorted run into the leaf from the back
+        int64_t src = static_cast<int64_t>(n) - 1;
+        int64_t run = static_cast<int64_t>(end) - 1;
+        for (int64_t dst = n + added - 1; run >= static_cast<int64_t>(i); dst--) {
+            if (src >= 0 && leaf->keys[src] > sorted[run].first) {
+                leaf->keys[dst] = leaf->keys[src];
+                leaf->values[dst] = leaf->values[src];
+                src--;
+            } else {
+                leaf->keys[dst] = sorted[run].first;
+                leaf->values[dst] = sorted[run].second;
+                run--;
+            }
+        }
+        leaf->header.key_count = static_cast<uint16_t>(n + added);
+
+        // ancestors: one update per run
+        for (PathEntry &entry : path) {
+            auto *internal =
+                reinterpret_cast<BPlusTreeInternalPage *>(entry.node.GetData());
+
+            UpdateInternalStats(internal, sorted[i].first, sorted[end - 1].first, added);
+            internal->child_counts[entry.slot] += added;
+        }
+
+        if (leaf->header.key_count > leaf_max_keys_) {
+            SplitLeaf(leaf_guard, path);
+            rightmost_leaf_id_ = INVALID_PAGE_ID;
+        }
+
+        i = end;
+    }
+
+    if (WritePageGuard stats_guard = FetchStatsPage()) {
+        auto *stats = reinterpret_cast<IndexStatsPage *>(stats_guard.GetData());
+        for (const auto &entry : sorted) {
+            IndexStatsAddKey(stats, entry.first);
+        }
+    }
+
+    if (BloomFilter *filter = GetBloomFilter()) {
+        for (size_t i = 0; i < sorted.size(); i++) {
+            if (i == 0 || sorted[i].first != sorted[i - 1].first) {
+                filter->Add(HashKey(sorted[i].first));
+            }
+        }
+    }
+}
+
+WritePageGuard BPlusTree::FetchStatsPage() {
+    if (!update_stats_page_) {
+        return WritePageGuard();
+    }
+
+    if (!stats_page_resolved_) {
+        stats_page_id_ = catalog_->GetStatsPage(index_id_);
+        stats_page_resolved_ = true;
+    }
+
+    if (stats_page_id_ == INVALID_PAGE_ID) {
+        return WritePageGuard();
+    }
+
+    return bpm_->FetchPageWrite(stats_page_id_);
+}
+
+BloomFilter *BPlusTree::GetBloomFilter() {
+    if (!bloom_filter_resolved_) {
+        bloom_filter_ = catalog_->GetBloomFilter(index_id_);
+        bloom_filter_resolved_ = true;
+    }
+    return bloom_filter_;
+}
+
 void BPlusTree::InsertIntoLeaf(BPlusTreeLeafPage *leaf, KeyType key, const RecordRef &value) {
     uint32_t n = leaf->header.key_count;
 
@@ -191,24 +618,29 @@ void BPlusTree::InsertIntoLeaf(BPlusTreeLeafPage *leaf, KeyType key, const Recor
     leaf->header.key_count++;
 }
 
-PageID BPlusTree::SplitLeaf(PageID leaf_page_id) {
-    Page *old_page = bpm_->FetchPage(leaf_page_id);
+void BPlusTree::SplitLeaf(WritePageGuard &leaf_guard, InsertPath &path) {
+    CountIndexMetric(index_id_, IndexCounter::LEAF_SPLITS);
     auto *old_leaf =
-        reinterpret_cast<BPlusTreeLeafPage *>(old_page->GetData());
+        reinterpret_cast<BPlusTreeLeafPage *>(leaf_guard.GetData());
 
     // 1️⃣ Allocate new leaf page
     PageID new_leaf_page_id;
-    Page *new_page = bpm_->NewPage(&new_leaf_page_id);
+    WritePageGuard new_guard = bpm_->NewPageGuarded(&new_leaf_page_id);
     auto *new_leaf =
-        reinterpret_cast<BPlusTreeLeafPage *>(new_page->GetData());
+        reinterpret_cast<BPlusTreeLeafPage *>(new_guard.GetData());
 
     // initialize new leaf
     new_leaf->header.is_leaf = true;
     new_leaf->header.key_count = 0;
     new_leaf->header.parent_page_id = old_leaf->header.parent_page_id;
 
-    // 2️⃣ Split point
+    // 2️⃣ Split point: keep most keys on the left at the right edge in
+    // append mode (the new leaf is where future keys go)
     uint32_t split_index = old_leaf->header.key_count / 2;
+    if (append_mode_ && old_leaf->next_leaf_page_id == INVALID_PAGE_ID) {
+        split_index = static_cast<uint32_t>(old_leaf->header.key_count * BPLUS_TREE_APPEND_SPLIT_FILL);
+        split_index = std::clamp<uint32_t>(split_index, 1, old_leaf->header.key_count - 1);
+    }
 
     // 3️⃣ Move second half to new leaf
     for (uint32_t i = split_index; i < old_leaf->header.key_count; i++) {
@@ -231,121 +663,114 @@ PageID BPlusTree::SplitLeaf(PageID leaf_page_id) {
     // 6️⃣ Promote first key of new leaf
     KeyType promote_key = new_leaf->keys[0];
 
-    InsertIntoParent(leaf_page_id, promote_key, new_leaf_page_id);
-
-    // unpin pages
-    bpm_->UnpinPage(leaf_page_id, true);
-    bpm_->UnpinPage(new_leaf_page_id, true);
-
-    return new_leaf_page_id;
+    InsertIntoParent(leaf_guard, promote_key, new_guard, path);
 }
 
-void BPlusTree::InsertIntoParent(PageID left, KeyType key, PageID right) {
-    Page *left_page = bpm_->FetchPage(left);
+void BPlusTree::InsertIntoParent(WritePageGuard &left, KeyType key, WritePageGuard &right,
+                                 InsertPath &path) {
     auto *left_header =
-        reinterpret_cast<BPlusTreePageHeader *>(left_page->GetData());
+        reinterpret_cast<BPlusTreePageHeader *>(left.GetData());
+    auto *right_header =
+        reinterpret_cast<BPlusTreePageHeader *>(right.GetData());
 
     // Case 1: left was root
-    if (left_header->parent_page_id == INVALID_PAGE_ID) {
+    if (path.empty()) {
         PageID new_root_id;
-        Page *root_page = bpm_->NewPage(&new_root_id);
+        WritePageGuard root_guard = bpm_->NewPageGuarded(&new_root_id);
 
         auto *root =
-            reinterpret_cast<BPlusTreeInternalPage *>(root_page->GetData());
+            reinterpret_cast<BPlusTreeInternalPage *>(root_guard.GetData());
 
         root->header.is_leaf = false;
         root->header.key_count = 1;
         root->header.parent_page_id = INVALID_PAGE_ID;
 
-        root->children[0] = left;
-        root->children[1] = right;
+        root->children[0] = left.PageId();
+        root->children[1] = right.PageId();
         root->keys[0] = key;
 
-        // Update statistics
-        root->min_key = key;
-        root->max_key = key;
-        root->total_keys = 1;
-        root->density = 1.0f;
-
         // update children parent pointers
         left_header->parent_page_id = new_root_id;
-
-        Page *right_page = bpm_->FetchPage(right);
-        auto *right_header =
-            reinterpret_cast<BPlusTreePageHeader *>(right_page->GetData());
         right_header->parent_page_id = new_root_id;
 
+        // Update statistics: the new root covers both subtrees
+        KeyType left_min, left_max, right_min, right_max;
+        uint32_t left_total, right_total;
+        ReadSubtreeStats(left, left_min, left_max, left_total);
+        ReadSubtreeStats(right, right_min, right_max, right_total);
+
+        root->min_key = left_min;
+        root->max_key = right_max;
+        root->total_keys = left_total + right_total;
+        root->child_counts[0] = left_total;
+        root->child_counts[1] = right_total;
+        root->density =
+            static_cast<float>(root->total_keys) /
+            static_cast<float>(root->max_key - root->min_key + 1);
+
         root_page_id_ = new_root_id;
 
         // Persist new root in metadata
         catalog_->SetRoot(index_id_, root_page_id_);
-
-        bpm_->UnpinPage(right, true);
-        bpm_->UnpinPage(new_root_id, true);
-        bpm_->UnpinPage(left, true);
         return;
     }
 
-    // Case 2: normal internal insert
-    PageID parent_id = left_header->parent_page_id;
-    bpm_->UnpinPage(left, false);
+    // Case 2: normal internal insert into the node the descent came through
+    PathEntry parent = std::move(path.back());
+    path.pop_back();
 
-    InsertIntoInternal(parent_id, left, key, right);
+    InsertIntoInternal(parent.node, parent.slot, key, right, path);
 }
 
-void BPlusTree::InsertIntoInternal(PageID parent_id, PageID left_child, KeyType key, PageID right_child) {
-    Page *page = bpm_->FetchPage(parent_id);
+void BPlusTree::InsertIntoInternal(WritePageGuard &parent, uint32_t idx, KeyType key,
+                                   WritePageGuard &right, InsertPath &path) {
     auto *internal =
-        reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
+        reinterpret_cast<BPlusTreeInternalPage *>(parent.GetData());
 
     uint32_t n = internal->header.key_count;
 
-    // find index of left child
-    uint32_t idx = 0;
-    while (idx <= n && internal->children[idx] != left_child) {
-        idx++;
-    }
-
-    // shift keys and children right
+    // shift keys and children right of the left child (slot idx)
     for (uint32_t i = n; i > idx; i--) {
         internal->keys[i] = internal->keys[i - 1];
         internal->children[i + 1] = internal->children[i];
+        internal->child_counts[i + 1] = internal->child_counts[i];
     }
 
     // insert
     internal->keys[idx] = key;
-    internal->children[idx + 1] = right_child;
+    internal->children[idx + 1] = right.PageId();
     internal->header.key_count++;
 
-    // Update statistics
-    UpdateInternalStats(internal, key);
+    // statistics are unchanged: a split only moves keys inside this subtree
 
     // update right child parent pointer
-    Page *right_page = bpm_->FetchPage(right_child);
     auto *right_header =
-        reinterpret_cast<BPlusTreePageHeader *>(right_page->GetData());
-    right_header->parent_page_id = parent_id;
-    bpm_->UnpinPage(right_child, true);
+        reinterpret_cast<BPlusTreePageHeader *>(right.GetData());
+    right_header->parent_page_id = parent.PageId();
+
+    // split the left child's count between the two halves
+    uint32_t right_count = right_header->is_leaf
+        ? right_header->key_count
+        : reinterpret_cast<const BPlusTreeInternalPage *>(right.GetData())->total_keys;
+    internal->child_counts[idx + 1] = right_count;
+    internal->child_counts[idx] -= right_count;
 
     // overflow?
-    if (internal->header.key_count > BPLUS_TREE_INTERNAL_MAX_KEYS) {
-        PageID new_internal = SplitInternal(parent_id);
-        bpm_->UnpinPage(parent_id, true);
-        return;
+    if (internal->header.key_count > internal_max_keys_) {
+        bool right_edge = append_mode_ && idx + 1 == internal->header.key_count;
+        SplitInternal(parent, right_edge, path);
     }
-
-    bpm_->UnpinPage(parent_id, true);
 }
 
-PageID BPlusTree::SplitInternal(PageID internal_page_id) {
-    Page *old_page = bpm_->FetchPage(internal_page_id);
+void BPlusTree::SplitInternal(WritePageGuard &node, bool right_edge, InsertPath &path) {
+    CountIndexMetric(index_id_, IndexCounter::INTERNAL_SPLITS);
     auto *old =
-        reinterpret_cast<BPlusTreeInternalPage *>(old_page->GetData());
+        reinterpret_cast<BPlusTreeInternalPage *>(node.GetData());
 
     PageID new_page_id;
-    Page *new_page = bpm_->NewPage(&new_page_id);
+    WritePageGuard new_guard = bpm_->NewPageGuarded(&new_page_id);
     auto *new_internal =
-        reinterpret_cast<BPlusTreeInternalPage *>(new_page->GetData());
+        reinterpret_cast<BPlusTreeInternalPage *>(new_guard.GetData());
 
     new_internal->header.is_leaf = false;
     new_internal->header.parent_page_id = old->header.parent_page_id;
@@ -355,6 +780,10 @@ PageID BPlusTree::SplitInternal(PageID internal_page_id) {
 
     uint32_t total_keys = old->header.key_count;
     uint32_t mid = total_keys / 2;
+    if (right_edge) {
+        mid = static_cast<uint32_t>(total_keys * BPLUS_TREE_APPEND_SPLIT_FILL);
+        mid = std::clamp<uint32_t>(mid, 1, total_keys - 1);
+    }
 
     KeyType promote_key = old->keys[mid];
 
@@ -364,60 +793,303 @@ PageID BPlusTree::SplitInternal(PageID internal_page_id) {
 
         new_internal->keys[new_internal->header.key_count] = k;
         new_internal->children[new_internal->header.key_count] = old->children[i];
+        new_internal->child_counts[new_internal->header.key_count] = old->child_counts[i];
         new_internal->header.key_count++;
-
-        UpdateInternalStats(new_internal, k);
     }
 
     // last child
     new_internal->children[new_internal->header.key_count] =
         old->children[total_keys];
+    new_internal->child_counts[new_internal->header.key_count] =
+        old->child_counts[total_keys];
 
-    // update parent pointer of moved children
-    for (uint32_t i = 0; i <= new_internal->header.key_count; i++) {
-        Page *child = bpm_->FetchPage(new_internal->children[i]);
+    old->header.key_count = mid;
+
+    // update parent pointer of moved children; the new node's key range
+    // runs from its first child's min to its last child's max
+    KeyType child_min, child_max;
+    uint32_t child_total;
+    uint32_t last = new_internal->header.key_count;
+    for (uint32_t i = 0; i <= last; i++) {
+        WritePageGuard child = WriteNode(new_internal->children[i]);
         auto *hdr =
-            reinterpret_cast<BPlusTreePageHeader *>(child->GetData());
+            reinterpret_cast<BPlusTreePageHeader *>(child.GetData());
         hdr->parent_page_id = new_page_id;
-        bpm_->UnpinPage(new_internal->children[i], true);
+
+        if (i == 0 || i == last) {
+            ReadSubtreeStats(child, child_min, child_max, child_total);
+            if (i == 0) new_internal->min_key = child_min;
+            if (i == last) new_internal->max_key = child_max;
+        }
     }
 
-    old->header.key_count = mid;
-    if (old->header.key_count > 0) {
-        old->min_key = old->keys[0];
-        old->max_key = old->keys[old->header.key_count - 1];
+    // Split statistics: the new node gets its children's stats, the old
+    // node keeps the rest of the subtree
+    for (uint32_t i = 0; i <= last; i++) {
+        new_internal->total_keys += new_internal->child_counts[i];
     }
 
+    ReadSubtreeStats(ReadNode(old->children[mid]), child_min, child_max, child_total);
+    old->max_key = child_max;
+    old->total_keys -= new_internal->total_keys;
+
+    new_internal->density =
+        static_cast<float>(new_internal->total_keys) /
+        static_cast<float>(new_internal->max_key - new_internal->min_key + 1);
     old->density =
         static_cast<float>(old->total_keys) /
         static_cast<float>(old->max_key - old->min_key + 1);
 
-    bpm_->UnpinPage(internal_page_id, true);
-    bpm_->UnpinPage(new_page_id, true);
-
     // insert promoted key to parent
-    InsertIntoParent(internal_page_id, promote_key, new_page_id);
-
-    return new_page_id;
+    InsertIntoParent(node, promote_key, new_guard, path);
 }
 
 void BPlusTree::UpdateInternalStats(BPlusTreeInternalPage *node, KeyType key) {
+    UpdateInternalStats(node, key, key, 1);
+}
+
+void BPlusTree::UpdateInternalStats(BPlusTreeInternalPage *node, KeyType min_key,
+                                    KeyType max_key, uint32_t count) {
     if (node->total_keys == 0) {
-        node->min_key = key;
-        node->max_key = key;
-        node->total_keys = 1;
-        node->density = 1.0f;
+        node->min_key = min_key;
+        node->max_key = max_key;
+        node->total_keys = count;
+        node->density =
+            static_cast<float>(count) / static_cast<float>(max_key - min_key + 1);
         return;
     }
 
-    if (key < node->min_key) node->min_key = key;
-    if (key > node->max_key) node->max_key = key;
+    if (min_key < node->min_key) node->min_key = min_key;
+    if (max_key > node->max_key) node->max_key = max_key;
 
-    node->total_keys++;
+    node->total_keys += count;
 
     node->density =
         static_cast<float>(node->total_keys) /
         static_cast<float>(node->max_key - node->min_key + 1);
 }
 
+void BPlusTree::ReadSubtreeStats(const PageGuard &node, KeyType &min_key, KeyType &max_key,
+                                 uint32_t &total_keys) {
+    auto *header =
+        reinterpret_cast<const BPlusTreePageHeader *>(node.GetData());
+
+    if (header->is_leaf) {
+        auto *leaf =
+            reinterpret_cast<const BPlusTreeLeafPage *>(node.GetData());
+        total_keys = leaf->header.key_count;
+        min_key = total_keys > 0 ? leaf->keys[0] : 0;
+        max_key = total_keys > 0 ? leaf->keys[total_keys - 1] : 0;
+    } else {
+        auto *internal =
+            reinterpret_cast<const BPlusTreeInternalPage *>(node.GetData());
+        total_keys = internal->total_keys;
+        min_key = internal->min_key;
+        max_key = internal->max_key;
+    }
+}
+
+void BPlusTree::KeyHashes(std::vector<uint64_t> &out) {
+    uint32_t temp = 0;
+    ReadPageGuard page = FindLeafPageForRange(0, false, temp);
+
+    bool first = true;
+    KeyType last = 0;
+    while (page) {
+        auto *leaf = reinterpret_cast<const BPlusTreeLeafPage *>(page.GetData());
+
+        for (uint32_t i = 0; i < leaf->header.key_count; i++) {
+            if (first || leaf->keys[i] != last) {
+                out.push_back(HashKey(leaf->keys[i]));
+                last = leaf->keys[i];
+                first = false;
+            }
+        }
+
+        PageID next = leaf->next_leaf_page_id;
+        if (next == INVALID_PAGE_ID) {
+            break;
+        }
+        page = ReadNode(next);
+    }
+}
+
+void BPlusTree::GetStats(BPlusTreeStats &stats) {
+    FlushAppends();
+    stats = BPlusTreeStats{};
+
+    ReadSubtreeStats(ReadNode(HotCursor(hot_levels_.get(), root_page_id_).Id()),
+                     stats.min_key, stats.max_key, stats.total_keys);
+    if (stats.total_keys > 0) {
+        stats.density =
+            static_cast<float>(stats.total_keys) /
+            static_cast<float>(stats.max_key - stats.min_key + 1);
+    }
+
+    // height: follow the leftmost spine
+    PageID current_page_id = root_page_id_;
+    while (current_page_id != INVALID_PAGE_ID) {
+        stats.height++;
+
+        ReadPageGuard page = ReadNode(current_page_id);
+        auto *header =
+            reinterpret_cast<const BPlusTreePageHeader *>(page.GetData());
+
+        current_page_id = INVALID_PAGE_ID;
+        if (!header->is_leaf) {
+            current_page_id =
+                reinterpret_cast<const BPlusTreeInternalPage *>(page.GetData())->children[0];
+        }
+    }
+}
+
+uint64_t BPlusTree::CountRange(KeyType low, KeyType high, uint32_t &page_fetch_count) {
+    FlushAppends();
+    if (low > high) {
+        return 0;
+    }
+
+    return CountSubtree(HotCursor(hot_levels_.get(), root_page_id_), low, high,
+                        0, std::numeric_limits<KeyType>::max(), page_fetch_count);
+}
+
+uint64_t BPlusTree::CountSubtree(const HotCursor &node, KeyType low, KeyType high,
+                                 KeyType lo_bound, KeyType hi_bound, uint32_t &fetch_count) {
+    fetch_count++;
+    ReadPageGuard page = ReadNode(node.Id());
+    auto *header =
+        reinterpret_cast<const BPlusTreePageHeader *>(page.GetData());
+
+    uint64_t count = 0;
+
+    if (header->is_leaf) {
+        auto *leaf =
+            reinterpret_cast<const BPlusTreeLeafPage *>(page.GetData());
+        for (uint32_t i = 0; i < leaf->header.key_count; i++) {
+            if (leaf->keys[i] >= low && leaf->keys[i] <= high) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    auto *internal =
+        reinterpret_cast<const BPlusTreeInternalPage *>(page.GetData());
+
+    lo_bound = std::max(lo_bound, internal->min_key);
+    hi_bound = std::min(hi_bound, internal->max_key);
+
+    // children only partially inside the range (at most two per level
+    // once the bounds are tight)
+    struct Partial {
+        HotCursor node;
+        KeyType lo;
+        KeyType hi;
+    };
+    std::vector<Partial> partial;
+
+    uint32_t n = internal->header.key_count;
+    for (uint32_t i = 0; i <= n; i++) {
+        // child i holds keys in [keys[i - 1], keys[i]] (inclusive: duplicates
+        // of a separator may sit on both sides)
+        KeyType child_lo = (i == 0) ? lo_bound : internal->keys[i - 1];
+        KeyType child_hi = (i == n) ? hi_bound : internal->keys[i];
+
+        if (child_hi < low || child_lo > high) {
+            continue;
+        }
+
+        if (low <= child_lo && child_hi <= high) {
+            count += internal->child_counts[i];   // O(1) for the whole subtree
+        } else {
+            partial.push_back(Partial{node, child_lo, child_hi});
+            partial.back().node.Descend(i, internal->children[i]);
+        }
+    }
+
+    // not held across the recursion
+    page.Drop();
+
+    for (const auto &child : partial) {
+        count += CountSubtree(child.node, low, high, child.lo, child.hi, fetch_count);
+    }
+
+    return count;
+}
+
+bool BPlusTree::MinInRange(KeyType low, KeyType high, KeyType &out, uint32_t &page_fetch_count) {
+    FlushAppends();
+    if (low > high) {
+        return false;
+    }
+
+    ReadPageGuard page = FindLeafPageForRange(low, false, page_fetch_count);
+
+    while (page) {
+        auto *leaf =
+            reinterpret_cast<const BPlusTreeLeafPage *>(page.GetData());
+
+        for (uint32_t i = 0; i < leaf->header.key_count; i++) {
+            if (leaf->keys[i] >= low) {
+                out = leaf->keys[i];
+                return out <= high;
+            }
+        }
+
+        PageID next_leaf = leaf->next_leaf_page_id;
+        if (next_leaf == INVALID_PAGE_ID) {
+            break;
+        }
+
+        page_fetch_count++;
+        page = ReadNode(next_leaf);
+    }
+
+    return false;
+}
+
+bool BPlusTree::MaxInRange(KeyType low, KeyType high, KeyType &out, uint32_t &page_fetch_count) {
+    FlushAppends();
+    if (low > high) {
+        return false;
+    }
+
+    // the last leaf that may hold high: its first key is a separator <= high
+    ReadPageGuard page = FindLeafPageForRange(high, true, page_fetch_count);
+    auto *leaf =
+        reinterpret_cast<const BPlusTreeLeafPage *>(page.GetData());
+
+    bool found = false;
+    for (uint32_t i = leaf->header.key_count; i > 0; i--) {
+        if (leaf->keys[i - 1] <= high) {
+            out = leaf->keys[i - 1];
+            found = out >= low;
+            break;
+        }
+    }
+
+    return found;
+}
+
+void BPlusTree::CountByBucket(KeyType low, KeyType high, uint64_t width,
+                              std::vector<uint64_t> &counts, uint32_t &page_fetch_count) {
+    FlushAppends();
+    counts.clear();
+    if (low > high || width == 0) {
+        return;
+    }
+
+    KeyType start = low;
+    while (true) {
+        KeyType end = (high - start >= width - 1) ? start + (width - 1) : high;
+
+        counts.push_back(CountRange(start, end, page_fetch_count));
+
+        if (end == high) {
+            break;
+        }
+        start = end + 1;
+    }
+}
+
 }
@@ -1,130 +1,712 @@
 #include "../../include/index/index_catalog.h"
+#include "../../include/index/btree/bplus_tree.h"
+#include "../../include/index/trie/trie.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <unordered_set>
 
 namespace cmse {
 
 IndexCatalog::IndexCatalog(BufferPoolManager *bpm)
     : bpm_(bpm) {
-    Page *page = bpm_->FetchPage(0);
-    directory_ = reinterpret_cast<IndexMetaPage *>(page->GetData());
-    // DO NOT unpin page 0 here; catalog lives long
+    bool legacy = reinterpret_cast<const IndexMetaPage *>(ReadDirectory().GetData())
+                      ->catalog_format == INDEX_CATALOG_FORMAT_LEGACY;
+    if (legacy) {
+        ConvertLegacyDirectory();
+    } else {
+        LoadEntries();
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> guard(views_mutex_);
+        PublishView(bpm_->GetCommittedEpoch());
+    }
+    RefreshHotLevels();
+}
+
+IndexCatalog::~IndexCatalog() {
+    SaveBloomFilters();
+
+    std::lock_guard<std::mutex> guard(hot_mutex_);
+    for (PageID page_id : hot_pages_) {
+        bpm_->UnpinHotPage(page_id);
+    }
+}
+
+ReadPageGuard IndexCatalog::ReadDirectory() const {
+    return bpm_->FetchPageRead(0);
+}
+
+WritePageGuard IndexCatalog::WriteDirectory() {
+    return bpm_->FetchPageWrite(0);
+}
+
+void IndexCatalog::LoadEntries() {
+    PageID page_id =
+        reinterpret_cast<const IndexMetaPage *>(ReadDirectory().GetData())->catalog_head_page_id;
+
+    // pages are only added when all are full; a damaged chain must not
+    // loop forever
+    size_t max_pages = MAX_INDEXES / INDEX_CATALOG_PAGE_ENTRIES + 1;
+    while (page_id != INVALID_PAGE_ID && page_id != 0 && catalog_pages_.size() < max_pages) {
+        ReadPageGuard page = bpm_->FetchPageRead(page_id);
+        auto *catalog_page = reinterpret_cast<const IndexCatalogPage *>(page.GetData());
+
+        CatalogPageInfo info{page_id, 0};
+        for (uint32_t slot = 0; slot < INDEX_CATALOG_PAGE_ENTRIES; slot++) {
+            if (!catalog_page->used[slot]) {
+                continue;
+            }
+            info.used_count++;
+
+            const IndexMetaEntryPage &meta = catalog_page->entries[slot];
+            entries_[meta.index_id] = CatalogEntry{page_id, slot, meta};
+            if (meta.field_name[0] != '\0') {
+                entries_by_field_.emplace(meta.field_name, meta.index_id);
+            }
+        }
+        catalog_pages_.push_back(info);
+
+        page_id = catalog_page->next_page_id;
+    }
+}
+
+void IndexCatalog::ConvertLegacyDirectory() {
+    std::vector<IndexMetaEntryPage> legacy;
+    {
+        ReadPageGuard page = ReadDirectory();
+        auto *directory = reinterpret_cast<const IndexMetaPage *>(page.GetData());
+        uint32_t count = std::min(directory->index_count, LEGACY_MAX_INDEXES);
+        for (uint32_t i = 0; i < count; i++) {
+            ReadPageGuard meta_page = bpm_->FetchPageRead(directory->index_meta_pages[i]);
+            legacy.push_back(*reinterpret_cast<const IndexMetaEntryPage *>(meta_page.GetData()));
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> guard(entries_mutex_);
+    {
+        WritePageGuard page = WriteDirectory();
+        auto *directory = reinterpret_cast<IndexMetaPage *>(page.GetData());
+        directory->catalog_format = INDEX_CATALOG_FORMAT_PAGES;
+        directory->catalog_entry_count = 0;
+        directory->catalog_head_page_id = INVALID_PAGE_ID;
+    }
+
+    for (const IndexMetaEntryPage &meta : legacy) {
+        // first entry wins, as the old linear search did
+        if (entries_.count(meta.index_id) == 0) {
+            AddEntry(meta);
+        }
+    }
+
+    // the old per-entry pages are left unused
+    reinterpret_cast<IndexMetaPage *>(WriteDirectory().GetData())->index_count = 0;
+}
+
+bool IndexCatalog::AddEntry(const IndexMetaEntryPage &meta) {
+    if (entries_.size() >= MAX_INDEXES) {
+        return false;
+    }
+
+    auto target = std::find_if(catalog_pages_.begin(), catalog_pages_.end(),
+                               [](const CatalogPageInfo &info) {
+                                   return info.used_count < INDEX_CATALOG_PAGE_ENTRIES;
+                               });
+    if (target == catalog_pages_.end()) {
+        PageID new_pid;
+        WritePageGuard page = bpm_->NewPageGuarded(&new_pid);
+        auto *catalog_page = reinterpret_cast<IndexCatalogPage *>(page.GetData());
+        std::memset(catalog_page, 0, sizeof(IndexCatalogPage));
+        catalog_page->next_page_id = INVALID_PAGE_ID;
+        page.Drop();
+
+        // append to the chain
+        if (catalog_pages_.empty()) {
+            reinterpret_cast<IndexMetaPage *>(WriteDirectory().GetData())->catalog_head_page_id =
+                new_pid;
+        } else {
+            WritePageGuard tail = bpm_->FetchPageWrite(catalog_pages_.back().page_id);
+            reinterpret_cast<IndexCatalogPage *>(tail.GetData())->next_page_id = new_pid;
+        }
+        catalog_pages_.push_back(CatalogPageInfo{new_pid, 0});
+        target = catalog_pages_.end() - 1;
+    }
+
+    uint32_t slot = 0;
+    {
+        WritePageGuard page = bpm_->FetchPageWrite(target->page_id);
+        auto *catalog_page = reinterpret_cast<IndexCatalogPage *>(page.GetData());
+        while (catalog_page->used[slot]) {
+            slot++;
+        }
+        catalog_page->used[slot] = 1;
+        catalog_page->entries[slot] = meta;
+        catalog_page->used_count++;
+    }
+    target->used_count++;
+
+    entries_[meta.index_id] = CatalogEntry{target->page_id, slot, meta};
+    if (meta.field_name[0] != '\0') {
+        entries_by_field_.emplace(meta.field_name, meta.index_id);
+    }
+
+    reinterpret_cast<IndexMetaPage *>(WriteDirectory().GetData())->catalog_entry_count =
+        static_cast<uint32_t>(entries_.size());
+    version_.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+void IndexCatalog::WriteEntry(const CatalogEntry &entry) {
+    {
+        WritePageGuard page = bpm_->FetchPageWrite(entry.catalog_page_id);
+        reinterpret_cast<IndexCatalogPage *>(page.GetData())->entries[entry.slot] = entry.meta;
+    }
+    version_.fetch_add(1, std::memory_order_release);
+}
+
+std::shared_ptr<const IndexCatalog::CatalogView> IndexCatalog::SnapshotView() const {
+    const PageSnapshot *snapshot = bpm_->CurrentSnapshot();
+    if (snapshot == nullptr) {
+        return nullptr;
+    }
+
+    // newest view published at or before the snapshot's epoch
+    std::shared_lock<std::shared_mutex> guard(views_mutex_);
+    for (auto it = views_.rbegin(); it != views_.rend(); ++it) {
+        if ((*it)->epoch <= snapshot->Epoch()) {
+            return *it;
+        }
+    }
+    return views_.front();
+}
+
+void IndexCatalog::PublishView(uint64_t epoch) {
+    if (!views_.empty() && GetVersion() == published_version_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    auto view = std::make_shared<CatalogView>();
+    view->epoch = epoch;
+    {
+        std::shared_lock<std::shared_mutex> guard(entries_mutex_);
+        for (const auto &[index_id, entry] : entries_) {
+            view->entries.emplace(index_id, entry.meta);
+        }
+        view->by_field = entries_by_field_;
+        published_version_.store(GetVersion(), std::memory_order_relaxed);
+    }
+
+    if (!views_.empty() && views_.back()->epoch == epoch) {
+        views_.back() = std::move(view);
+    } else {
+        views_.push_back(std::move(view));
+    }
+
+    // a view is needed until every snapshot is at or past the next one
+    uint64_t safe = bpm_->Epochs().SafeEpoch();
+    while (views_.size() > 1 && views_[1]->epoch <= safe) {
+        views_.pop_front();
+    }
+}
+
+PageSnapshot IndexCatalog::OpenSnapshot() {
+    // changes made outside write epochs (setup, tools) count as committed
+    if (GetVersion() != published_version_.load(std::memory_order_relaxed)) {
+        std::unique_lock<std::shared_mutex> guard(views_mutex_);
+        if (!writing_) {
+            PublishView(bpm_->GetCommittedEpoch());
+        }
+    }
+    return bpm_->OpenSnapshot();
+}
+
+void IndexCatalog::BeginWrite() {
+    bpm_->BeginWrite();
+
+    std::unique_lock<std::shared_mutex> guard(views_mutex_);
+    PublishView(bpm_->GetCommittedEpoch());
+    writing_ = true;
+}
+
+void IndexCatalog::CommitWrite() {
+    {
+        // published before the pages: no snapshot sees one without the other
+        std::unique_lock<std::shared_mutex> guard(views_mutex_);
+        PublishView(bpm_->GetCommittedEpoch() + 1);
+        writing_ = false;
+    }
+    bpm_->CommitWrite();
+    RefreshHotLevels();
+}
+
+std::shared_ptr<const HotIndexLevels> IndexCatalog::GetHotLevels(IndexID index_id) const {
+    std::shared_lock<std::shared_mutex> guard(hot_levels_mutex_);
+    auto it = hot_levels_.find(index_id);
+    return it == hot_levels_.end() ? nullptr : it->second;
+}
+
+void IndexCatalog::RefreshHotLevels() {
+    std::lock_guard<std::mutex> guard(hot_mutex_);
+
+    uint64_t writes = bpm_->GetHotWriteCount();
+    uint64_t version = GetVersion();
+    if (hot_built_ && writes == hot_writes_seen_ && version == hot_version_seen_) {
+        return;
+    }
+    hot_built_ = true;
+    hot_writes_seen_ = writes;
+    hot_version_seen_ = version;
+
+    // the committed indexes (and changes made outside write epochs),
+    // through a snapshot of their own
+    PageSnapshot snapshot = OpenSnapshot();
+    SnapshotScope scope(&snapshot);
+    std::vector<IndexMetaEntryPage> indexes;
+    if (auto view = SnapshotView()) {
+        for (const auto &[index_id, meta] : view->entries) {
+            indexes.push_back(meta);
+        }
+    } else {
+        indexes = ListIndexes();
+    }
+
+    // breadth first over all indexes at once: every root, then the level
+    // below them, ... while the tier has room
+    struct Pending {
+        IndexID index_id;
+        IndexType index_type;
+        uint32_t parent;        // node in the index's levels
+        uint32_t slot;          // child slot in the parent
+        PageID page_id;
+        uint32_t level;
+    };
+    std::deque<Pending> queue;
+    const uint32_t max_levels = bpm_->GetOptions().hot_index_levels;
+    if (max_levels > 0) {
+        for (const IndexMetaEntryPage &meta : indexes) {
+            if (meta.root_page_id != INVALID_PAGE_ID && meta.root_page_id != 0) {
+                queue.push_back(Pending{meta.index_id, meta.index_type, HotIndexLevels::NO_NODE, 0,
+                                        meta.root_page_id, 0});
+            }
+        }
+    }
+
+    std::unordered_map<IndexID, std::shared_ptr<HotIndexLevels>> levels;
+    std::unordered_set<PageID> wanted;
+    while (!queue.empty() && wanted.size() < bpm_->GetHotCapacity()) {
+        Pending next = queue.front();
+        queue.pop_front();
+        if (!wanted.insert(next.page_id).second) {
+            continue;
+        }
+
+        auto &index_levels = levels[next.index_id];
+        if (!index_levels) {
+            index_levels = std::make_shared<HotIndexLevels>();
+        }
+        auto node = static_cast<uint32_t>(index_levels->nodes.size());
+        index_levels->nodes.push_back(HotIndexLevels::Node{next.page_id, {}});
+        if (next.parent != HotIndexLevels::NO_NODE) {
+            index_levels->nodes[next.parent].children[next.slot] = node;
+        }
+        if (next.level + 1 >= max_levels) {
+            continue;
+        }
+
+        std::vector<PageID> children;
+        {
+            ReadPageGuard page = bpm_->FetchPageRead(next.page_id);
+            if (!page) {
+                continue;
+            }
+            if (next.index_type == IndexType::BTREE) {
+                auto *header = reinterpret_cast<const BPlusTreePageHeader *>(page.GetData());
+                if (!header->is_leaf) {
+                    auto *internal = reinterpret_cast<const BPlusTreeInternalPage *>(page.GetData());
+                    children.assign(internal->children, internal->children + internal->header.key_count + 1);
+                }
+            } else {
+                auto *trie_node = reinterpret_cast<const TrieNodePage *>(page.GetData());
+                children.assign(trie_node->children, trie_node->children + TRIE_ALPHABET_SIZE);
+            }
+        }
+
+        index_levels->nodes[node].children.assign(children.size(), HotIndexLevels::NO_NODE);
+        for (uint32_t i = 0; i < children.size(); i++) {
+            if (children[i] != INVALID_PAGE_ID) {
+                queue.push_back(Pending{next.index_id, next.index_type, node, i, children[i],
+                                        next.level + 1});
+            }
+        }
+    }
+
+    // pages that left the hot levels first, so the new ones find room
+    for (PageID page_id : hot_pages_) {
+        if (wanted.count(page_id) == 0) {
+            bpm_->UnpinHotPage(page_id);
+        }
+    }
+    hot_pages_.clear();
+
+    std::unordered_map<IndexID, std::shared_ptr<const HotIndexLevels>> published;
+    for (auto &[index_id, index_levels] : levels) {
+        for (HotIndexLevels::Node &node : index_levels->nodes) {
+            PageID swizzled = bpm_->PinHotPage(node.page_id);
+            if (swizzled != INVALID_PAGE_ID) {
+                hot_pages_.push_back(node.page_id);
+                node.page_id = swizzled;
+            }
+        }
+        published.emplace(index_id, std::move(index_levels));
+    }
+
+    std::unique_lock<std::shared_mutex> levels_guard(hot_levels_mutex_);
+    hot_levels_.swap(published);
 }
 
 uint32_t IndexCatalog::GetIndexCount() const {
-    return directory_->index_count;
+    std::shared_lock<std::shared_mutex> guard(entries_mutex_);
+    return static_cast<uint32_t>(entries_.size());
 }
 
 bool IndexCatalog::HasIndex(IndexID index_id) const {
-    for (uint32_t i = 0; i < directory_->index_count; i++) {
-        PageID meta_pid = directory_->index_meta_pages[i];
-        Page *page = bpm_->FetchPage(meta_pid);
-
-        auto *meta =
-            reinterpret_cast<IndexMetaEntryPage *>(page->GetData());
+    if (auto view = SnapshotView()) {
+        return view->entries.count(index_id) > 0;
+    }
 
-        bool found = (meta->index_id == index_id);
-        bpm_->UnpinPage(meta_pid, false);
+    std::shared_lock<std::shared_mutex> guard(entries_mutex_);
+    return entries_.count(index_id) > 0;
+}
 
-        if (found) return true;
+std::vector<IndexMetaEntryPage> IndexCatalog::ListIndexes() const {
+    std::shared_lock<std::shared_mutex> guard(entries_mutex_);
+    std::vector<IndexMetaEntryPage> list;
+    list.reserve(entries_.size());
+    for (const auto &[index_id, entry] : entries_) {
+        list.push_back(entry.meta);
     }
-    return false;
+    std::sort(list.begin(), list.end(), [](const IndexMetaEntryPage &a, const IndexMetaEntryPage &b) {
+        return a.index_id < b.index_id;
+    });
+    return list;
 }
 
-PageID IndexCatalog::GetIndexMetaPage(IndexID index_id) const {
-    for (uint32_t i = 0; i < directory_->index_count; i++) {
-        PageID meta_pid = directory_->index_meta_pages[i];
-        Page *page = bpm_->FetchPage(meta_pid);
+IndexID IndexCatalog::NextIndexId() const {
+    std::shared_lock<std::shared_mutex> guard(entries_mutex_);
+    IndexID next = 1;
+    for (const auto &[index_id, entry] : entries_) {
+        next = std::max(next, index_id + 1);
+    }
+    return next;
+}
 
-        auto *meta =
-            reinterpret_cast<IndexMetaEntryPage *>(page->GetData());
+size_t IndexCatalog::GetCatalogPageCount() const {
+    std::shared_lock<std::shared_mutex> guard(entries_mutex_);
+    return catalog_pages_.size();
+}
 
-        if (meta->index_id == index_id) {
-            bpm_->UnpinPage(meta_pid, false);
-            return meta_pid;
+bool IndexCatalog::GetEntry(IndexID index_id, IndexMetaEntryPage &out) const {
+    if (auto view = SnapshotView()) {
+        auto it = view->entries.find(index_id);
+        if (it == view->entries.end()) {
+            return false;
         }
+        out = it->second;
+        return true;
+    }
 
-        bpm_->UnpinPage(meta_pid, false);
+    std::shared_lock<std::shared_mutex> guard(entries_mutex_);
+    auto it = entries_.find(index_id);
+    if (it == entries_.end()) {
+        return false;
     }
-    return INVALID_PAGE_ID;
+    out = it->second.meta;
+    return true;
 }
 
-PageID IndexCatalog::GetRoot(IndexID index_id) const {
-    PageID meta_pid = GetIndexMetaPage(index_id);
-    if (meta_pid == INVALID_PAGE_ID) {
-        return INVALID_PAGE_ID;
+bool IndexCatalog::GetEntryByField(const std::string &field_name, IndexMetaEntryPage &out) const {
+    if (auto view = SnapshotView()) {
+        auto by_field = view->by_field.find(field_name);
+        if (by_field == view->by_field.end()) {
+            return false;
+        }
+        out = view->entries.at(by_field->second);
+        return true;
     }
 
-    Page *page = bpm_->FetchPage(meta_pid);
-    auto *meta =
-        reinterpret_cast<IndexMetaEntryPage *>(page->GetData());
+    std::shared_lock<std::shared_mutex> guard(entries_mutex_);
+    auto by_field = entries_by_field_.find(field_name);
+    if (by_field == entries_by_field_.end()) {
+        return false;
+    }
+    out = entries_.at(by_field->second).meta;
+    return true;
+}
 
-    PageID root = meta->root_page_id;
-    bpm_->UnpinPage(meta_pid, false);
+PageID IndexCatalog::GetRoot(IndexID index_id) const {
+    if (auto view = SnapshotView()) {
+        auto it = view->entries.find(index_id);
+        return it == view->entries.end() ? INVALID_PAGE_ID : it->second.root_page_id;
+    }
 
-    return root;
+    std::shared_lock<std::shared_mutex> guard(entries_mutex_);
+    auto it = entries_.find(index_id);
+    return it == entries_.end() ? INVALID_PAGE_ID : it->second.meta.root_page_id;
 }
 
 void IndexCatalog::SetRoot(IndexID index_id, PageID root_page_id) {
+    std::unique_lock<std::shared_mutex> guard(entries_mutex_);
+
     // update existing index
-    for (uint32_t i = 0; i < directory_->index_count; i++) {
-        PageID meta_pid = directory_->index_meta_pages[i];
-        Page *page = bpm_->FetchPage(meta_pid);
+    auto it = entries_.find(index_id);
+    if (it != entries_.end()) {
+        it->second.meta.root_page_id = root_page_id;
+        WriteEntry(it->second);
+        return;
+    }
 
-        auto *meta =
-            reinterpret_cast<IndexMetaEntryPage *>(page->GetData());
+    // create new index entry
+    if (entries_.size() < MAX_INDEXES) {
+        IndexMetaEntryPage meta;
+        std::memset(&meta, 0, sizeof(meta));
+        meta.index_id = index_id;
+        meta.root_page_id = root_page_id;
+        meta.field_name[0] = '\0';   // optional init
+        meta.field_type = FieldType::NUMERIC; // default
+        meta.index_type = IndexType::BTREE;   // default
 
-        if (meta->index_id == index_id) {
-            meta->root_page_id = root_page_id;
-            bpm_->UnpinPage(meta_pid, true);
-            return;
-        }
+        // statistics page, updated on every insert
+        PageID stats_pid;
+        WritePageGuard stats_page = bpm_->NewPageGuarded(&stats_pid);
+        InitIndexStats(reinterpret_cast<IndexStatsPage *>(stats_page.GetData()));
+        stats_page.Drop();
+        meta.stats_page_id = stats_pid;
+        meta.bloom_page_id = INVALID_PAGE_ID;
 
-        bpm_->UnpinPage(meta_pid, false);
+        AddEntry(meta);
     }
+}
 
-    // create new index entry
-    if (directory_->index_count < MAX_INDEXES) {
-        PageID new_meta_pid;
-        Page *page = bpm_->NewPage(&new_meta_pid);
+bool IndexCatalog::RegisterIndex(IndexID index_id, const std::string &field_name,
+                                 FieldType field_type, IndexType index_type,
+                                 PageID root_page_id) {
+    SetRoot(index_id, root_page_id);
+
+    std::unique_lock<std::shared_mutex> guard(entries_mutex_);
+    auto it = entries_.find(index_id);
+    if (it == entries_.end()) {
+        return false; // catalog full
+    }
+    IndexMetaEntryPage &meta = it->second.meta;
+
+    auto old_field = entries_by_field_.find(meta.field_name);
+    if (old_field != entries_by_field_.end() && old_field->second == index_id) {
+        entries_by_field_.erase(old_field);
+    }
+
+    std::strncpy(meta.field_name, field_name.c_str(), sizeof(meta.field_name) - 1);
+    meta.field_name[sizeof(meta.field_name) - 1] = '\0';
+    meta.field_type = field_type;
+    meta.index_type = index_type;
+    WriteEntry(it->second);
+
+    entries_by_field_.emplace(meta.field_name, index_id);
+    return true;
+}
+
+bool IndexCatalog::DropIndex(IndexID index_id) {
+    // same order as EnableBloomFilter
+    std::lock_guard<std::mutex> bloom_guard(bloom_mutex_);
+    std::unique_lock<std::shared_mutex> guard(entries_mutex_);
+
+    auto it = entries_.find(index_id);
+    if (it == entries_.end() || write_buffers_.count(index_id) > 0) {
+        return false;
+    }
+    const CatalogEntry &entry = it->second;
+
+    {
+        WritePageGuard page = bpm_->FetchPageWrite(entry.catalog_page_id);
+        auto *catalog_page = reinterpret_cast<IndexCatalogPage *>(page.GetData());
+        catalog_page->used[entry.slot] = 0;
+        std::memset(&catalog_page->entries[entry.slot], 0, sizeof(IndexMetaEntryPage));
+        catalog_page->used_count--;
+    }
+
+    for (CatalogPageInfo &info : catalog_pages_) {
+        if (info.page_id == entry.catalog_page_id) info.used_count--;
+    }
+
+    auto by_field = entries_by_field_.find(entry.meta.field_name);
+    if (by_field != entries_by_field_.end() && by_field->second == index_id) {
+        entries_by_field_.erase(by_field);
+    }
+    entries_.erase(it);
+
+    auto bloom = bloom_filters_.find(index_id);
+    if (bloom != bloom_filters_.end()) {
+        RetireBloomFilter(std::move(bloom->second.filter));
+        bloom_filters_.erase(bloom);
+    }
 
-        auto *meta =
-            reinterpret_cast<IndexMetaEntryPage *>(page->GetData());
+    reinterpret_cast<IndexMetaPage *>(WriteDirectory().GetData())->catalog_entry_count =
+        static_cast<uint32_t>(entries_.size());
+    version_.fetch_add(1, std::memory_order_release);
+    return true;
+}
 
-        meta->index_id = index_id;
-        meta->root_page_id = root_page_id;
-        meta->field_name[0] = '\0';   // optional init
-        meta->field_type = FieldType::NUMERIC; // default
-        meta->index_type = IndexType::BTREE;   // default
+PageID IndexCatalog::GetStatsPage(IndexID index_id) const {
+    if (auto view = SnapshotView()) {
+        auto it = view->entries.find(index_id);
+        return it == view->entries.end() ? INVALID_PAGE_ID : it->second.stats_page_id;
+    }
 
-        directory_->index_meta_pages[directory_->index_count] =
-            new_meta_pid;
-        directory_->index_count++;
+    std::shared_lock<std::shared_mutex> guard(entries_mutex_);
+    auto it = entries_.find(index_id);
+    return it == entries_.end() ? INVALID_PAGE_ID : it->second.meta.stats_page_id;
+}
 
-        bpm_->UnpinPage(new_meta_pid, true);
-        bpm_->UnpinPage(0, true); // directory dirty
+bool IndexCatalog::GetIndexStats(IndexID index_id, IndexStatsPage &out) const {
+    PageID stats_pid = GetStatsPage(index_id);
+    if (stats_pid == INVALID_PAGE_ID) {
+        return false;
     }
+
+    ReadPageGuard page = bpm_->FetchPageRead(stats_pid);
+    std::memcpy(&out, page.GetData(), sizeof(IndexStatsPage));
+
+    return true;
 }
 
-PageID IndexCatalog::GetIndexMetaPageByField(const std::string &field_name) const {
-    for (uint32_t i = 0; i < directory_->index_count; i++) {
-        PageID meta_pid = directory_->index_meta_pages[i];
-        Page *page = bpm_->FetchPage(meta_pid);
+std::unique_ptr<BloomFilter> IndexCatalog::BuildBloomFilter(const IndexMetaEntryPage &meta) {
+    std::vector<uint64_t> hashes;
 
-        auto *meta =
-            reinterpret_cast<IndexMetaEntryPage *>(page->GetData());
+    if (meta.root_page_id != INVALID_PAGE_ID) {
+        if (meta.index_type == IndexType::BTREE) {
+            BPlusTree tree(meta.root_page_id, meta.index_id, this, bpm_);
+            tree.KeyHashes(hashes);
+        } else {
+            TrieIndex trie(meta.root_page_id, bpm_, INVALID_PAGE_ID, nullptr, meta.index_id);
+            trie.KeyHashes(hashes);
+        }
+    }
+
+    return std::make_unique<BloomFilter>(BloomFilter::Build(hashes));
+}
 
-        bool match =
-            (std::strncmp(meta->field_name,
-                           field_name.c_str(),
-                           sizeof(meta->field_name)) == 0);
+bool IndexCatalog::EnableBloomFilter(IndexID index_id) {
+    std::lock_guard<std::mutex> guard(bloom_mutex_);
 
-        bpm_->UnpinPage(meta_pid, false);
+    IndexMetaEntryPage meta_copy;
+    {
+        std::unique_lock<std::shared_mutex> entries_guard(entries_mutex_);
+        auto it = entries_.find(index_id);
+        if (it == entries_.end()) {
+            return false;
+        }
 
-        if (match) {
-            return meta_pid;
+        IndexMetaEntryPage &meta = it->second.meta;
+        if (meta.bloom_page_id == INVALID_PAGE_ID || meta.bloom_page_id == 0) {
+            PageID header_pid;
+            bpm_->NewPageGuarded(&header_pid);
+            meta.bloom_page_id = header_pid;
+            WriteEntry(it->second);
         }
+        meta_copy = meta;
     }
-    return INVALID_PAGE_ID;
+
+    BloomFilterEntry entry;
+    entry.filter = BuildBloomFilter(meta_copy);
+    entry.header_page_id = meta_copy.bloom_page_id;
+    entry.filter->Save(bpm_, entry.header_page_id);
+
+    BloomFilterEntry &slot = bloom_filters_[index_id];
+    RetireBloomFilter(std::move(slot.filter));
+    slot = std::move(entry);
+    return true;
 }
 
-} // namespace cmse
+void IndexCatalog::RetireBloomFilter(std::unique_ptr<BloomFilter> filter) {
+    if (filter) {
+        bpm_->Epochs().Retire([raw = filter.release()] { delete raw; });
+    }
+}
+
+BloomFilter *IndexCatalog::GetBloomFilter(IndexID index_id) {
+    if (auto view = SnapshotView()) {
+        // the filter of the entry the snapshot sees (ids are reused after
+        // a drop), and only if loaded: a load now would miss later keys
+        auto meta = view->entries.find(index_id);
+        if (meta == view->entries.end()) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> guard(bloom_mutex_);
+        auto it = bloom_filters_.find(index_id);
+        if (it == bloom_filters_.end() || it->second.header_page_id != meta->second.bloom_page_id) {
+            return nullptr;
+        }
+        return it->second.filter.get();
+    }
+
+    std::lock_guard<std::mutex> guard(bloom_mutex_);
+
+    auto it = bloom_filters_.find(index_id);
+    if (it != bloom_filters_.end()) {
+        return it->second.filter.get();
+    }
 
+    // remembered either way, so later lookups read no catalog pages
+    BloomFilterEntry &entry = bloom_filters_[index_id];
+
+    IndexMetaEntryPage meta;
+    if (!GetEntry(index_id, meta)) {
+        return nullptr;
+    }
+
+    if (meta.bloom_page_id == INVALID_PAGE_ID || meta.bloom_page_id == 0) {
+        return nullptr;
+    }
+
+    entry.header_page_id = meta.bloom_page_id;
+    entry.filter = std::make_unique<BloomFilter>();
+    if (!entry.filter->Load(bpm_, entry.header_page_id)) {
+        entry.filter = BuildBloomFilter(meta);
+        entry.filter->Save(bpm_, entry.header_page_id);
+    }
+    return entry.filter.get();
+}
+
+void IndexCatalog::SaveBloomFilters() {
+    std::lock_guard<std::mutex> guard(bloom_mutex_);
+
+    for (auto &[index_id, entry] : bloom_filters_) {
+        if (entry.filter) {
+            entry.filter->Save(bpm_, entry.header_page_id);
+        }
+    }
+}
+
+uint64_t IndexCatalog::GetIngestedBytes() const {
+    return reinterpret_cast<const IndexMetaPage *>(ReadDirectory().GetData())->ingested_bytes;
+}
+
+void IndexCatalog::SetIngestedBytes(uint64_t bytes) {
+    reinterpret_cast<IndexMetaPage *>(WriteDirectory().GetData())->ingested_bytes = bytes;
+}
+
+void IndexCatalog::AttachWriteBuffer(IndexID index_id, LsmWriteBuffer *buffer) {
+    if (buffer == nullptr) {
+        write_buffers_.erase(index_id);
+    } else {
+        write_buffers_[index_id] = buffer;
+    }
+}
+
+LsmWriteBuffer *IndexCatalog::GetWriteBuffer(IndexID index_id) const {
+    auto it = write_buffers_.find(index_id);
+    return it == write_buffers_.end() ? nullptr : it->second;
+}
+
+} // namespace cmse
@@ -0,0 +1,202 @@
+#include "../../include/index/index_stats.h"
+#include "../../include/common/hash_util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace cmse {
+
+namespace {
+
+KeyType BucketLower(const IndexStatsPage *stats, uint32_t i) {
+    return i == 0 ? stats->min_key : stats->buckets[i - 1].upper + 1;
+}
+
+// First bucket whose upper bound is >= key (bucket_count - 1 if none)
+uint32_t FindBucket(const IndexStatsPage *stats, KeyType key) {
+    uint32_t lo = 0;
+    uint32_t hi = stats->bucket_count - 1;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (stats->buckets[mid].upper >= key) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+void HllAdd(IndexStatsPage *stats, uint64_t hash) {
+    uint32_t idx = static_cast<uint32_t>(hash >> (64 - INDEX_STATS_HLL_PRECISION));
+    uint64_t rest = hash << INDEX_STATS_HLL_PRECISION;
+
+    // position of the first 1-bit in the remaining bits
+    uint8_t rho = 1;
+    while (rho <= 64 - INDEX_STATS_HLL_PRECISION && (rest & (1ULL << 63)) == 0) {
+        rest <<= 1;
+        rho++;
+    }
+
+    if (rho > stats->hll_registers[idx]) {
+        stats->hll_registers[idx] = rho;
+    }
+}
+
+// Keep the histogram equi-depth: split bucket i in two at the middle of
+// its key range, merging the lightest adjacent pair to make room.
+void SplitBucket(IndexStatsPage *stats, uint32_t i, uint64_t threshold) {
+    KeyType lower = BucketLower(stats, i);
+    KeyType upper = stats->buckets[i].upper;
+    if (lower >= upper) {
+        return; // single-value bucket (heavy hitter): cannot split
+    }
+
+    if (stats->bucket_count == INDEX_STATS_HISTOGRAM_BUCKETS) {
+        uint32_t best = INDEX_STATS_HISTOGRAM_BUCKETS;
+        uint64_t best_count = threshold;
+
+        for (uint32_t j = 0; j + 1 < stats->bucket_count; j++) {
+            if (j == i || j + 1 == i) continue;
+            uint64_t combined = stats->buckets[j].count + stats->buckets[j + 1].count;
+            if (combined < best_count) {
+                best = j;
+                best_count = combined;
+            }
+        }
+
+        if (best == INDEX_STATS_HISTOGRAM_BUCKETS) {
+            return; // nothing light enough to merge
+        }
+
+        stats->buckets[best].upper = stats->buckets[best + 1].upper;
+        stats->buckets[best].count = best_count;
+        for (uint32_t j = best + 1; j + 1 < stats->bucket_count; j++) {
+            stats->buckets[j] = stats->buckets[j + 1];
+        }
+        stats->bucket_count--;
+
+        if (best < i) {
+            i--;
+        }
+    }
+
+    uint64_t count = stats->buckets[i].count;
+    KeyType mid = lower + (upper - lower) / 2;
+
+    for (uint32_t j = stats->bucket_count; j > i + 1; j--) {
+        stats->buckets[j] = stats->buckets[j - 1];
+    }
+    stats->bucket_count++;
+
+    stats->buckets[i] = HistogramBucket{mid, count / 2};
+    stats->buckets[i + 1] = HistogramBucket{upper, count - count / 2};
+}
+
+} // namespace
+
+void InitIndexStats(IndexStatsPage *stats) {
+    std::memset(stats, 0, sizeof(IndexStatsPage));
+}
+
+void IndexStatsAddKey(IndexStatsPage *stats, KeyType key) {
+    HllAdd(stats, HashKey(key));
+
+    stats->total_count++;
+
+    if (stats->bucket_count == 0) {
+        stats->min_key = key;
+        stats->max_key = key;
+        stats->buckets[0] = HistogramBucket{key, 1};
+        stats->bucket_count = 1;
+        return;
+    }
+
+    if (key < stats->min_key) stats->min_key = key;
+    if (key > stats->max_key) {
+        stats->max_key = key;
+        stats->buckets[stats->bucket_count - 1].upper = key;
+    }
+
+    uint32_t i = FindBucket(stats, key);
+    stats->buckets[i].count++;
+
+    uint64_t threshold = std::max<uint64_t>(
+        2, 2 * stats->total_count / INDEX_STATS_HISTOGRAM_BUCKETS);
+
+    if (stats->buckets[i].count > threshold) {
+        SplitBucket(stats, i, threshold);
+    }
+}
+
+void IndexStatsAddString(IndexStatsPage *stats, const std::string &key) {
+    HllAdd(stats, HashString(key));
+    stats->total_count++;
+}
+
+double EstimateDistinctKeys(const IndexStatsPage *stats) {
+    const double m = static_cast<double>(INDEX_STATS_HLL_REGISTERS);
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+
+    double sum = 0.0;
+    uint32_t zeros = 0;
+    for (uint32_t i = 0; i < INDEX_STATS_HLL_REGISTERS; i++) {
+        sum += std::ldexp(1.0, -stats->hll_registers[i]);
+        if (stats->hll_registers[i] == 0) zeros++;
+    }
+
+    double estimate = alpha * m * m / sum;
+
+    // small range correction: linear counting
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / static_cast<double>(zeros));
+    }
+
+    return std::min(estimate, static_cast<double>(stats->total_count));
+}
+
+double EstimateRangeCount(const IndexStatsPage *stats, KeyType low, KeyType high) {
+    if (stats->bucket_count == 0 || low > high) {
+        return 0.0;
+    }
+
+    double total = 0.0;
+    for (uint32_t i = 0; i < stats->bucket_count; i++) {
+        KeyType lower = BucketLower(stats, i);
+        KeyType upper = stats->buckets[i].upper;
+
+        KeyType from = std::max(low, lower);
+        KeyType to = std::min(high, upper);
+        if (from > to) {
+            continue;
+        }
+
+        // uniform within the bucket
+        double width = static_cast<double>(upper - lower) + 1.0;
+        double covered = static_cast<double>(to - from) + 1.0;
+        total += static_cast<double>(stats->buckets[i].count) * covered / width;
+    }
+
+    return total;
+}
+
+double EstimateEqualCount(const IndexStatsPage *stats, KeyType key) {
+    if (stats->bucket_count == 0 || key < stats->min_key || key > stats->max_key) {
+        return 0.0;
+    }
+
+    uint32_t i = FindBucket(stats, key);
+    double count = static_cast<double>(stats->buckets[i].count);
+    double width =
+        static_cast<double>(stats->buckets[i].upper - BucketLower(stats, i)) + 1.0;
+
+    // distinct keys in this bucket: its share of the global distinct count
+    double distinct = EstimateDistinctKeys(stats) * count /
+                      static_cast<double>(stats->total_count);
+    distinct = std::max(1.0, std::min(width, distinct));
+
+    return count / distinct;
+}
+
+} // namespace cmse
@@ -0,0 +1,425 @@
+#include "../../../include/index/lsm/lsm_write_buffer.h"
+#include "../../../include/common/hash_util.h"
+#include "../../../include/index/index_stats.h"
+#include "../../../include/index/btree/bplus_tree.h"
+
+#include <algorithm>
+#include <cstring>
+#include <queue>
+#include <shared_mutex>
+#include <sstream>
+
+namespace cmse {
+
+std::string LsmStats::Describe() const {
+    std::ostringstream out;
+    out << "lsm: memtable=" << memtable_entries
+        << " frozen=" << frozen_memtables
+        << " runs=" << runs << " (" << run_entries << " entries)"
+        << " run pages written=" << run_pages_written
+        << " compactions=" << compactions << " (" << entries_compacted << " entries)";
+    return out.str();
+}
+
+LsmWriteBuffer::LsmWriteBuffer(IndexID index_id, BufferPoolManager *bpm, IndexCatalog *catalog)
+    : index_id_(index_id), bpm_(bpm), catalog_(catalog),
+      stats_page_id_(catalog->GetStatsPage(index_id)) {}
+
+LsmWriteBuffer::~LsmWriteBuffer() {
+    Stop();
+}
+
+void LsmWriteBuffer::Start() {
+    worker_ = std::thread([this] { BackgroundLoop(); });
+}
+
+void LsmWriteBuffer::Stop() {
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> latch(catalog_->IndexLatch());
+        if (!memtable_.empty()) {
+            Freeze();
+        }
+    }
+    while (WriteRun()) {
+    }
+    if (!runs_.empty()) {
+        Compact(runs_.size());
+    }
+}
+
+void LsmWriteBuffer::Insert(KeyType key, RecordRef value) {
+    std::pair<KeyType, RecordRef> entry{key, value};
+    InsertBatch(std::span(&entry, 1));
+}
+
+void LsmWriteBuffer::InsertBatch(std::span<const std::pair<KeyType, RecordRef>> entries) {
+    if (entries.empty()) {
+        return;
+    }
+
+    IndexStatsPage *stats = nullptr;
+    if (stats_page_id_ != INVALID_PAGE_ID) {
+        stats = reinterpret_cast<IndexStatsPage *>(bpm_->FetchPage(stats_page_id_)->GetData());
+    }
+
+    // log timestamps arrive nearly sorted: hint at the end of the memtable
+    for (const auto &[key, ref] : entries) {
+        memtable_.emplace_hint(memtable_.end(), key, ref);
+        if (stats != nullptr) {
+            IndexStatsAddKey(stats, key);
+        }
+    }
+
+    if (stats != nullptr) {
+        bpm_->UnpinPage(stats_page_id_, true);
+    }
+
+    if (memtable_.size() >= LSM_MEMTABLE_MAX_ENTRIES) {
+        Freeze();
+    }
+    memtable_entries_ = memtable_.size();
+}
+
+void LsmWriteBuffer::Freeze() {
+    frozen_.push_back(std::make_shared<const SortedEntries>(memtable_.begin(), memtable_.end()));
+    memtable_.clear();
+    memtable_entries_ = 0;
+    frozen_count_++;
+
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        work_pending_ = true;
+    }
+    cv_.notify_one();
+}
+
+void LsmWriteBuffer::BackgroundLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return work_pending_ || stopping_; });
+            if (stopping_) {
+                return;
+            }
+            work_pending_ = false;
+        }
+
+        while (WriteRun()) {
+        }
+        if (runs_.size() >= LSM_COMPACTION_TRIGGER_RUNS) {
+            Compact(runs_.size());
+        }
+    }
+}
+
+Page *LsmWriteBuffer::AllocateRunPage(PageID *page_id) {
+    if (free_pages_.empty()) {
+        return bpm_->NewPage(page_id);
+    }
+
+    // lowest recycled page first, so a run stays mostly contiguous
+    *page_id = free_pages_.back();
+    free_pages_.pop_back();
+    return bpm_->FetchPage(*page_id);
+}
+
+bool LsmWriteBuffer::WriteRun() {
+    std::shared_ptr<const SortedEntries> frozen;
+    {
+        std::shared_lock<std::shared_mutex> latch(catalog_->IndexLatch());
+        if (frozen_.empty()) {
+            return false;
+        }
+        frozen = frozen_.front();
+    }
+
+    // the pages are private until published: no latch while writing
+    Run run;
+    run.entries = frozen->size();
+
+    for (size_t i = 0; i < frozen->size(); i += LSM_RUN_PAGE_ENTRIES) {
+        size_t n = std::min(LSM_RUN_PAGE_ENTRIES, frozen->size() - i);
+
+        PageID page_id;
+        Page *page = AllocateRunPage(&page_id);
+        auto *run_page = reinterpret_cast<LsmRunPage *>(page->GetData());
+
+        run_page->count = static_cast<uint32_t>(n);
+        for (size_t j = 0; j < n; j++) {
+            run_page->keys[j] = (*frozen)[i + j].first;
+            run_page->values[j] = (*frozen)[i + j].second;
+        }
+
+        run.pages.push_back(page_id);
+        run.first_keys.push_back(run_page->keys[0]);
+
+        // written now, in page order, instead of whenever eviction gets to it
+        bpm_->UnpinPage(page_id, true);
+        bpm_->FlushPage(page_id);
+    }
+
+    std::vector<uint64_t> hashes;
+    for (size_t i = 0; i < frozen->size(); i++) {
+        if (i == 0 || (*frozen)[i].first != (*frozen)[i - 1].first) {
+            hashes.push_back(HashKey((*frozen)[i].first));
+        }
+    }
+    run.filter = BloomFilter::Build(hashes);
+
+    run_pages_written_ += run.pages.size();
+    run_entries_ += run.entries;
+
+    {
+        std::unique_lock<std::shared_mutex> latch(catalog_->IndexLatch());
+        frozen_.pop_front();
+        runs_.push_back(std::move(run));
+    }
+    frozen_count_--;
+    run_count_++;
+    return true;
+}
+
+void LsmWriteBuffer::Compact(size_t run_count) {
+    // k-way merge over copies of each run's current page (no pins held, so
+    // any number of runs can be merged on a small pool)
+    struct Cursor {
+        const Run *run;
+        size_t page_idx;
+        uint32_t slot;
+        LsmRunPage page;
+    };
+
+    auto load = [this](Cursor &c) {
+        Page *page = bpm_->FetchPage(c.run->pages[c.page_idx]);
+        std::memcpy(&c.page, page->GetData(), sizeof(LsmRunPage));
+        bpm_->UnpinPage(c.run->pages[c.page_idx], false);
+    };
+
+    std::vector<Cursor> cursors(run_count);
+    for (size_t r = 0; r < run_count; r++) {
+        const Run &run = runs_[r];
+        cursors[r].run = &run;
+        cursors[r].page_idx = run.compacted / LSM_RUN_PAGE_ENTRIES;
+        cursors[r].slot = static_cast<uint32_t>(run.compacted % LSM_RUN_PAGE_ENTRIES);
+        if (run.compacted < run.entries) {
+            load(cursors[r]);
+        }
+    }
+
+    auto greater = [&cursors](size_t a, size_t b) {
+        const Cursor &x = cursors[a];
+        const Cursor &y = cursors[b];
+        return x.page.keys[x.slot] > y.page.keys[y.slot];
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+    for (size_t r = 0; r < run_count; r++) {
+        if (runs_[r].compacted < runs_[r].entries) {
+            heap.push(r);
+        }
+    }
+
+    SortedEntries chunk;
+    chunk.reserve(LSM_COMPACTION_CHUNK);
+    std::vector<uint64_t> consumed(run_count, 0);
+
+    while (!heap.empty()) {
+        size_t r = heap.top();
+        heap.pop();
+
+        Cursor &c = cursors[r];
+        chunk.emplace_back(c.page.keys[c.slot], c.page.values[c.slot]);
+        consumed[r]++;
+
+        if (++c.slot == c.page.count) {
+            c.slot = 0;
+            if (++c.page_idx < c.run->pages.size()) {
+                load(c);
+                heap.push(r);
+            }
+        } else {
+            heap.push(r);
+        }
+
+        if (chunk.size() >= LSM_COMPACTION_CHUNK) {
+            PublishChunk(chunk, consumed);
+        }
+    }
+    PublishChunk(chunk, consumed);
+
+    {
+        std::unique_lock<std::shared_mutex> latch(catalog_->IndexLatch());
+        for (size_t r = 0; r < run_count; r++) {
+            free_pages_.insert(free_pages_.end(), runs_[r].pages.begin(), runs_[r].pages.end());
+        }
+        runs_.erase(runs_.begin(), runs_.begin() + static_cast<std::ptrdiff_t>(run_count));
+    }
+    std::sort(free_pages_.begin(), free_pages_.end(), std::greater<PageID>());
+
+    run_count_ -= run_count;
+    compactions_++;
+}
+
+void LsmWriteBuffer::PublishChunk(SortedEntries &chunk, std::vector<uint64_t> &consumed) {
+    if (chunk.empty()) {
+        return;
+    }
+
+    {
+        IndexWriteScope write(catalog_);
+        std::unique_lock<std::shared_mutex> latch(catalog_->IndexLatch());
+
+        BPlusTree tree(catalog_->GetRoot(index_id_), index_id_, catalog_, bpm_);
+        tree.SetStatsPageUpdates(false);    // counted when buffered
+        tree.SetAppendMode(true);
+        tree.InsertBatch(chunk);
+        tree.FlushAppends();
+
+        for (size_t r = 0; r < consumed.size(); r++) {
+            runs_[r].compacted += consumed[r];
+        }
+
+        // queries read the runs under the latch and the tree through a
+        // snapshot: the chunk must be in the tree for them before it
+        // leaves the runs
+        write.Commit();
+    }
+
+    run_entries_ -= chunk.size();
+    entries_compacted_ += chunk.size();
+    std::fill(consumed.begin(), consumed.end(), 0);
+    chunk.clear();
+}
+
+template <typename Fn>
+void LsmWriteBuffer::ForEach(KeyType low, KeyType high, Fn &&fn) const {
+    if (low > high) {
+        return;
+    }
+
+    for (auto it = memtable_.lower_bound(low); it != memtable_.end() && it->first <= high; ++it) {
+        if (!fn(it->first, it->second)) break;
+    }
+
+    for (const auto &frozen : frozen_) {
+        auto it = std::lower_bound(frozen->begin(), frozen->end(), low,
+                                   [](const auto &entry, KeyType key) { return entry.first < key; });
+        for (; it != frozen->end() && it->first <= high; ++it) {
+            if (!fn(it->first, it->second)) break;
+        }
+    }
+
+    for (const Run &run : runs_) {
+        if (run.compacted == run.entries) {
+            continue;
+        }
+        if (low == high && !run.filter.MayContain(HashKey(low))) {
+            continue;
+        }
+
+        // duplicates of low may start on the page before the first page
+        // whose smallest key is >= low
+        size_t page_idx = std::lower_bound(run.first_keys.begin(), run.first_keys.end(), low) -
+                          run.first_keys.begin();
+        if (page_idx > 0) page_idx--;
+        page_idx = std::max<size_t>(page_idx, run.compacted / LSM_RUN_PAGE_ENTRIES);
+
+        bool done = false;
+        for (; !done && page_idx < run.pages.size(); page_idx++) {
+            if (run.first_keys[page_idx] > high) {
+                break;
+            }
+
+            Page *page = bpm_->FetchPage(run.pages[page_idx]);
+            auto *run_page = reinterpret_cast<const LsmRunPage *>(page->GetData());
+
+            uint64_t base = page_idx * LSM_RUN_PAGE_ENTRIES;
+            for (uint32_t i = 0; i < run_page->count; i++) {
+                KeyType key = run_page->keys[i];
+                if (base + i < run.compacted || key < low) {
+                    continue;
+                }
+                if (key > high || !fn(key, run_page->values[i])) {
+                    done = true;
+                    break;
+                }
+            }
+
+            bpm_->UnpinPage(run.pages[page_idx], false);
+        }
+    }
+}
+
+void LsmWriteBuffer::RangeSearch(KeyType low, KeyType high, std::vector<RecordRef> &result) const {
+    ForEach(low, high, [&](KeyType, const RecordRef &ref) {
+        result.push_back(ref);
+        return true;
+    });
+}
+
+uint64_t LsmWriteBuffer::CountRange(KeyType low, KeyType high) const {
+    uint64_t count = 0;
+    ForEach(low, high, [&](KeyType, const RecordRef &) {
+        count++;
+        return true;
+    });
+    return count;
+}
+
+bool LsmWriteBuffer::MinInRange(KeyType low, KeyType high, KeyType &out) const {
+    bool found = false;
+    // each source is sorted: its first entry in range is its minimum
+    ForEach(low, high, [&](KeyType key, const RecordRef &) {
+        if (!found || key < out) out = key;
+        found = true;
+        return false;
+    });
+    return found;
+}
+
+bool LsmWriteBuffer::MaxInRange(KeyType low, KeyType high, KeyType &out) const {
+    bool found = false;
+    ForEach(low, high, [&](KeyType key, const RecordRef &) {
+        if (!found || key > out) out = key;
+        found = true;
+        return true;
+    });
+    return found;
+}
+
+void LsmWriteBuffer::CountByBucket(KeyType low, KeyType high, uint64_t width,
+                                   std::vector<uint64_t> &counts) const {
+    if (width == 0) {
+        return;
+    }
+
+    ForEach(low, high, [&](KeyType key, const RecordRef &) {
+        uint64_t bucket = (key - low) / width;
+        if (bucket < counts.size()) {
+            counts[bucket]++;
+        }
+        return true;
+    });
+}
+
+LsmStats LsmWriteBuffer::GetStats() const {
+    LsmStats stats;
+    stats.memtable_entries = memtable_entries_.load();
+    stats.frozen_memtables = frozen_count_.load();
+    stats.runs = run_count_.load();
+    stats.run_entries = run_entries_.load();
+    stats.run_pages_written = run_pages_written_.load();
+    stats.compactions = compactions_.load();
+    stats.entries_compacted = entries_compacted_.load();
+    return stats;
+}
+
+} // namespace cmse
@@ -1,98 +1,238 @@
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <mutex>
 
+#include "../../../include/common/hash_util.h"
+#include "../../../include/common/metrics.h"
+#include "../../../include/index/index_stats.h"
 #include "../../../include/index/trie/trie.h"
 
 namespace cmse {
 
-TrieIndex::TrieIndex(PageID root_page_id, BufferPoolManager *bpm)
-    : root_page_id_(root_page_id), bpm_(bpm) {}
+namespace {
 
-void TrieIndex::Insert(const std::string &sentence, RecordRef ref) {
-    PageID current_id = root_page_id_;
-
-    for (char c : sentence) {
-        if (c < TRIE_MIN_CHAR || c > TRIE_MAX_CHAR) {
-            continue; // or assert
+// the path Insert takes: characters outside the alphabet dropped
+std::string TriePath(const std::string &key) {
+    std::string path;
+    path.reserve(key.size());
+    for (char c : key) {
+        if (c >= TRIE_MIN_CHAR && c <= TRIE_MAX_CHAR) {
+            path.push_back(c);
         }
+    }
+    return path;
+}
 
-        uint32_t idx = CharToIndex(c);
-
-        Page *page = bpm_->FetchPage(current_id);
-        auto *node = reinterpret_cast<TrieNodePage *>(page->GetData());
-
-        if (node->children[idx] == INVALID_PAGE_ID) {
-            PageID new_id;
-            Page *new_page = bpm_->NewPage(&new_id);
+} // namespace
 
-            auto *child =
-                reinterpret_cast<TrieNodePage *>(new_page->GetData());
+TrieIndex::TrieIndex(PageID root_page_id, BufferPoolManager *bpm, PageID stats_page_id,
+                     BloomFilter *bloom_filter, IndexID index_id)
+    : root_page_id_(root_page_id), bpm_(bpm), stats_page_id_(stats_page_id),
+      bloom_filter_(bloom_filter), max_records_(bpm->GetOptions().trie_max_records),
+      index_id_(index_id) {}
 
-            for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
-                child->children[i] = INVALID_PAGE_ID;
-            }
+void TrieIndex::SetHotLevels(std::shared_ptr<const HotIndexLevels> hot_levels) {
+    hot_levels_ = std::move(hot_levels);
+}
 
-            child->is_terminal = false;
-            child->record_count = 0;
+ReadPageGuard TrieIndex::ReadNode(PageID page_id) {
+    CountIndexMetric(index_id_, IndexCounter::NODE_VISITS);
+    return bpm_->FetchPageRead(page_id);
+}
 
-            node->children[idx] = new_id;
+WritePageGuard TrieIndex::WriteNode(PageID page_id) {
+    CountIndexMetric(index_id_, IndexCounter::NODE_VISITS);
+    return bpm_->FetchPageWrite(page_id);
+}
 
-            bpm_->UnpinPage(new_id, true);
-        }
+WritePageGuard TrieIndex::NewNode(PageID *page_id) {
+    WritePageGuard page = bpm_->NewPageGuarded(page_id);
+    auto *node = reinterpret_cast<TrieNodePage *>(page.GetData());
 
-        PageID next_id = node->children[idx];
-        bpm_->UnpinPage(current_id, true);
-        current_id = next_id;
+    for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
+        node->children[i] = INVALID_PAGE_ID;
     }
 
+    node->is_terminal = false;
+    node->record_count = 0;
+    CountIndexMetric(index_id_, IndexCounter::NODES_CREATED);
+    return page;
+}
+
+void TrieIndex::Insert(const std::string &sentence, RecordRef ref) {
     // terminal node
-    Page *page = bpm_->FetchPage(current_id);
-    auto *node = reinterpret_cast<TrieNodePage *>(page->GetData());
+    WritePageGuard page = WalkOrCreate(root_page_id_, TriePath(sentence), nullptr);
+    auto *node = reinterpret_cast<TrieNodePage *>(page.GetData());
 
     node->is_terminal = true;
 
-    if (node->record_count < TRIE_MAX_RECORDS) {
+    if (node->record_count < max_records_) {
         node->records[node->record_count++] = ref;
     }
 
-    bpm_->UnpinPage(current_id, true);
+    page.Drop();
+
+    if (stats_page_id_ != INVALID_PAGE_ID) {
+        WritePageGuard stats_page = bpm_->FetchPageWrite(stats_page_id_);
+        IndexStatsAddString(reinterpret_cast<IndexStatsPage *>(stats_page.GetData()), sentence);
+    }
+
+    if (bloom_filter_ != nullptr) {
+        bloom_filter_->Add(HashString(TriePath(sentence)));
+    }
 }
 
-void TrieIndex::ExactSearch(const std::string &sentence, std::vector<RecordRef> &result) {
-    result.clear();
+void TrieIndex::InsertBatch(std::span<const std::pair<std::string, RecordRef>> entries) {
+    if (entries.empty()) {
+        return;
+    }
 
-    PageID current_id = root_page_id_;
+    std::vector<std::pair<std::string, RecordRef>> sorted;
+    sorted.reserve(entries.size());
+    for (const auto &entry : entries) {
+        sorted.emplace_back(TriePath(entry.first), entry.second);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    // nodes[d]: node reached after the first d characters of prev
+    std::vector<PageID> nodes{root_page_id_};
+    const std::string *prev = nullptr;
+
+    size_t i = 0;
+    while (i < sorted.size()) {
+        const std::string &key = sorted[i].first;
+
+        size_t common = 0;
+        if (prev != nullptr) {
+            while (common < prev->size() && common < key.size() &&
+                   (*prev)[common] == key[common]) {
+                common++;
+            }
+        }
+        nodes.resize(common + 1);
+
+        // every entry with this key under one pin
+        WritePageGuard page =
+            WalkOrCreate(nodes[common], std::string_view(key).substr(common), &nodes);
+        auto *node = reinterpret_cast<TrieNodePage *>(page.GetData());
+        node->is_terminal = true;
+
+        size_t end = i;
+        while (end < sorted.size() && sorted[end].first == key) {
+            if (node->record_count < max_records_) {
+                node->records[node->record_count++] = sorted[end].second;
+            }
+            end++;
+        }
 
-    for (char c : sentence) {
-        uint32_t idx = CharToIndex(c);
+        page.Drop();
+
+        if (bloom_filter_ != nullptr) {
+            bloom_filter_->Add(HashString(key));
+        }
+
+        prev = &key;
+        i = end;
+    }
+
+    if (stats_page_id_ != INVALID_PAGE_ID) {
+        WritePageGuard stats_page = bpm_->FetchPageWrite(stats_page_id_);
+        auto *stats = reinterpret_cast<IndexStatsPage *>(stats_page.GetData());
+        for (const auto &entry : entries) {
+            IndexStatsAddString(stats, entry.first);
+        }
+    }
+}
+
+WritePageGuard TrieIndex::WalkOrCreate(PageID node_id, std::string_view path,
+                                       std::vector<PageID> *nodes) {
+    if (path.empty()) {
+        return WriteNode(node_id);
+    }
+
+    // existing nodes are only read, the last one written
+    ReadPageGuard page = ReadNode(node_id);
+    size_t d = 0;
+    while (true) {
+        auto *node = reinterpret_cast<const TrieNodePage *>(page.GetData());
+        PageID child_id = node->children[CharToIndex(path[d])];
+        if (child_id == INVALID_PAGE_ID) {
+            break;
+        }
+
+        if (nodes != nullptr) {
+            nodes->push_back(child_id);
+        }
+        if (++d == path.size()) {
+            return WriteNode(child_id);
+        }
+        page = ReadNode(child_id);
+    }
+
+    // edge d is missing: this node gains a child and the rest of the path
+    // is new, written through the pins NewNode took
+    WritePageGuard current = WriteNode(page.PageId());
+    page.Drop();
+
+    for (; d < path.size(); d++) {
+        PageID child_id;
+        WritePageGuard child = NewNode(&child_id);
+
+        auto *node = reinterpret_cast<TrieNodePage *>(current.GetData());
+        node->children[CharToIndex(path[d])] = child_id;
+
+        if (nodes != nullptr) {
+            nodes->push_back(child_id);
+        }
+        current = std::move(child);
+    }
+    return current;
+}
 
-        Page *page = bpm_->FetchPage(current_id);
-        auto *node = reinterpret_cast<TrieNodePage *>(page->GetData());
+ReadPageGuard TrieIndex::FindNode(const std::string &key) {
+    // upper levels through the hot tier
+    HotCursor cursor(hot_levels_.get(), root_page_id_);
+    ReadPageGuard page = ReadNode(cursor.Id());
+
+    for (char c : key) {
+        uint32_t idx = CharToIndex(c);
+        auto *node = reinterpret_cast<const TrieNodePage *>(page.GetData());
 
         if (node->children[idx] == INVALID_PAGE_ID) {
-            bpm_->UnpinPage(current_id, false);
-            return;
+            return ReadPageGuard();
         }
 
-        PageID next = node->children[idx];
-        bpm_->UnpinPage(current_id, false);
-        current_id = next;
+        cursor.Descend(idx, node->children[idx]);
+        page = ReadNode(cursor.Id());
+    }
+    return page;
+}
+
+void TrieIndex::ExactSearch(const std::string &sentence, std::vector<RecordRef> &result) {
+    result.clear();
+
+    if (bloom_filter_ != nullptr && !bloom_filter_->MayContain(HashString(TriePath(sentence)))) {
+        return;
+    }
+
+    ReadPageGuard page = FindNode(sentence);
+    if (!page) {
+        return;
     }
 
-    Page *page = bpm_->FetchPage(current_id);
-    auto *node = reinterpret_cast<TrieNodePage *>(page->GetData());
+    auto *node = reinterpret_cast<const TrieNodePage *>(page.GetData());
 
     if (node->is_terminal) {
         for (uint32_t i = 0; i < node->record_count; i++) {
             result.push_back(node->records[i]);
         }
     }
-
-    bpm_->UnpinPage(current_id, false);
 }
 
-void TrieIndex::CollectAll(PageID node_id, std::vector<RecordRef> &result) {
-    Page *page = bpm_->FetchPage(node_id);
-    auto *node = reinterpret_cast<TrieNodePage *>(page->GetData());
+void TrieIndex::CollectAll(ReadPageGuard page, std::vector<RecordRef> &result) {
+    auto *node = reinterpret_cast<const TrieNodePage *>(page.GetData());
 
     // Collect records
     if (node->is_terminal) {
@@ -107,12 +247,34 @@ void TrieIndex::CollectAll(PageID node_id, std::vector<RecordRef> &result) {
         children[i] = node->children[i];
     }
 
-    bpm_->UnpinPage(node_id, false);
+    page.Drop();
 
     // Recurse AFTER unpin
     for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
         if (children[i] != INVALID_PAGE_ID) {
-            CollectAll(children[i], result);
+            CollectAll(ReadNode(children[i]), result);
+        }
+    }
+}
+
+void TrieIndex::KeyHashes(std::vector<uint64_t> &out) {
+    // (node, key spelled by the path to it)
+    std::vector<std::pair<PageID, std::string>> stack{{root_page_id_, std::string()}};
+
+    while (!stack.empty()) {
+        auto [node_id, key] = std::move(stack.back());
+        stack.pop_back();
+
+        ReadPageGuard page = ReadNode(node_id);
+        auto *node = reinterpret_cast<const TrieNodePage *>(page.GetData());
+
+        if (node->is_terminal) {
+            out.push_back(HashString(key));
+        }
+        for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
+            if (node->children[i] != INVALID_PAGE_ID) {
+                stack.emplace_back(node->children[i], key + static_cast<char>(TRIE_MIN_CHAR + i));
+            }
         }
     }
 }
@@ -120,25 +282,123 @@ void TrieIndex::CollectAll(PageID node_id, std::vector<RecordRef> &result) {
 void TrieIndex::PrefixSearch(const std::string &prefix, std::vector<RecordRef> &result) {
     result.clear();
 
-    PageID current_id = root_page_id_;
+    ReadPageGuard page = FindNode(prefix);
+    if (!page) {
+        return;
+    }
 
-    for (char c : prefix) {
-        uint32_t idx = CharToIndex(c);
+    CollectAll(std::move(page), result);
+}
 
-        Page *page = bpm_->FetchPage(current_id);
-        auto *node = reinterpret_cast<TrieNodePage *>(page->GetData());
+struct TrieIndex::ParallelCollect {
+    TaskGroup *group;
+    const PageSnapshot *snapshot;       // the caller's, installed by every task
+    size_t limit;                       // 0 = unlimited
+    std::atomic<size_t> reserved{0};    // records claimed so far
 
-        if (node->children[idx] == INVALID_PAGE_ID) {
-            bpm_->UnpinPage(current_id, false);
-            return;
+    std::mutex mutex;
+    std::vector<RecordRef> *result;
+
+    bool Full() const {
+        return limit > 0 && reserved.load(std::memory_order_relaxed) >= limit;
+    }
+
+    // how many of n records may still be taken
+    size_t Reserve(size_t n) {
+        if (limit == 0) return n;
+        size_t before = reserved.fetch_add(n, std::memory_order_relaxed);
+        if (before >= limit) return 0;
+        return std::min(n, limit - before);
+    }
+};
+
+void TrieIndex::CollectParallel(std::vector<std::pair<PageID, size_t>> stack,
+                                ParallelCollect &state) {
+    std::vector<RecordRef> local;
+
+    while (!stack.empty() && !state.Full()) {
+        auto [node_id, depth] = stack.back();
+        stack.pop_back();
+
+        ReadPageGuard page = ReadNode(node_id);
+        auto *node = reinterpret_cast<const TrieNodePage *>(page.GetData());
+
+        if (node->is_terminal && node->record_count > 0) {
+            size_t take = state.Reserve(node->record_count);
+            local.insert(local.end(), node->records, node->records + take);
+        }
+
+        PageID children[TRIE_ALPHABET_SIZE];
+        for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
+            children[i] = node->children[i];
+        }
+
+        page.Drop();
+
+        // upper levels: one task per non-empty child edge
+        for (uint32_t i = TRIE_ALPHABET_SIZE; i > 0; i--) {
+            PageID child = children[i - 1];
+            if (child == INVALID_PAGE_ID) continue;
+
+            if (depth < PARALLEL_TRIE_SPAWN_DEPTH) {
+                state.group->Run([this, child, depth, &state]() {
+                    SnapshotScope scope(state.snapshot);
+                    CollectParallel({{child, depth + 1}}, state);
+                });
+            } else {
+                stack.emplace_back(child, depth + 1);
+            }
+        }
+
+        // deep, bushy subtree: give the older half of the stack away
+        if (stack.size() > PARALLEL_TRIE_SPLIT_STACK) {
+            size_t half = stack.size() / 2;
+            std::vector<std::pair<PageID, size_t>> stolen(stack.begin(), stack.begin() + half);
+            stack.erase(stack.begin(), stack.begin() + half);
+
+            state.group->Run([this, stolen = std::move(stolen), &state]() mutable {
+                SnapshotScope scope(state.snapshot);
+                CollectParallel(std::move(stolen), state);
+            });
         }
+    }
 
-        PageID next = node->children[idx];
-        bpm_->UnpinPage(current_id, false);
-        current_id = next;
+    if (!local.empty()) {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.result->insert(state.result->end(), local.begin(), local.end());
     }
+}
+
+void TrieIndex::ParallelPrefixSearch(const std::string &prefix, std::vector<RecordRef> &result,
+                                     ThreadPool *pool, size_t limit) {
+    result.clear();
+
+    if (pool == nullptr) {
+        PrefixSearch(prefix, result);
+        if (limit > 0 && result.size() > limit) {
+            result.resize(limit);
+        }
+        return;
+    }
+
+    ReadPageGuard page = FindNode(prefix);
+    if (!page) {
+        return;
+    }
+    PageID current_id = page.PageId();
+    page.Drop();
+
+    TaskGroup group(pool);
+
+    ParallelCollect state;
+    state.group = &group;
+    state.snapshot = PageSnapshot::Current();
+    state.limit = limit;
+    state.result = &result;
 
-    CollectAll(current_id, result);
+    // the prefix node itself runs on the calling thread and forks its edges
+    CollectParallel({{current_id, 0}}, state);
+    group.Wait();
 }
 
 }
@@ -0,0 +1,178 @@
+#include "../../include/ingest/log_generator.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+namespace cmse {
+
+namespace {
+
+const std::vector<std::string> USERS = {"root", "www-data", "postgres", "backup", "deploy",
+                                        "alice", "bob", "carol", "nagios", "git"};
+const std::vector<std::string> SERVICES = {"sshd", "nginx", "cron", "docker", "postgresql",
+                                           "systemd-journald", "containerd", "kubelet"};
+const std::vector<std::string> DEVICES = {"sda1", "sda2", "nvme0n1p1", "nvme1n1p1", "dm-0"};
+const std::vector<std::string> PATHS = {"/", "/api/v1/users", "/api/v1/orders", "/healthz",
+                                        "/static/app.js", "/login", "/metrics"};
+
+// Templates by decreasing popularity; the prefix is the text before the
+// first variable field
+const std::vector<std::string> PREFIXES = {
+    "pam_unix(cron:session): session opened for user ",
+    "pam_unix(cron:session): session closed for user ",
+    "GET ",
+    "Started ",
+    "Accepted publickey for ",
+    "health check ok ",
+    "Connection closed by ",
+    "slow request ",
+    "Failed password for ",
+    "connection refused upstream=",
+    "Stopped ",
+    "disk_failure device=",
+    "EXT4-fs warning (device ",
+    "Out of memory: Killed process ",
+};
+
+bool ParseDouble(const std::string &value, double &out) {
+    char *end = nullptr;
+    out = std::strtod(value.c_str(), &end);
+    return !value.empty() && *end == '\0' && std::isfinite(out) && out >= 0;
+}
+
+bool ParseUint(const std::string &value, uint64_t &out) {
+    char *end = nullptr;
+    out = std::strtoull(value.c_str(), &end, 10);
+    return !value.empty() && *end == '\0' && value[0] != '-';
+}
+
+// "INFO=70,WARN=20,ERROR=10"
+bool ParseMix(const std::string &value, std::vector<std::pair<std::string, double>> &out) {
+    std::vector<std::pair<std::string, double>> mix;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t eq = item.find('=');
+        double weight = 0;
+        if (eq == 0 || eq == std::string::npos || !ParseDouble(item.substr(eq + 1), weight)) {
+            return false;
+        }
+        mix.emplace_back(item.substr(0, eq), weight);
+    }
+    if (mix.empty()) return false;
+    out = std::move(mix);
+    return true;
+}
+
+} // namespace
+
+bool LogGeneratorOptions::Set(const std::string &name, const std::string &value,
+                              std::string &error) {
+    uint64_t n = 0;
+    bool ok = true;
+
+    if (name == "seed") {
+        ok = ParseUint(value, seed);
+    } else if (name == "start") {
+        ok = ParseUint(value, start_timestamp);
+    } else if (name == "ticks_per_second") {
+        ok = ParseUint(value, n) && n > 0 && n <= UINT32_MAX;
+        ticks_per_second = static_cast<uint32_t>(n);
+    } else if (name == "rate") {
+        ok = ParseDouble(value, rate) && rate > 0;
+    } else if (name == "late_fraction") {
+        ok = ParseDouble(value, late_fraction) && late_fraction <= 1.0;
+    } else if (name == "max_skew") {
+        ok = ParseUint(value, max_skew_ticks);
+    } else if (name == "zipf") {
+        ok = ParseDouble(value, zipf_exponent);
+    } else if (name == "severity_mix") {
+        ok = ParseMix(value, severity_mix);
+    } else {
+        error = "unknown option '" + name + "'";
+        return false;
+    }
+
+    if (!ok) {
+        error = "bad value '" + value + "' for " + name;
+    }
+    return ok;
+}
+
+LogGenerator::LogGenerator(const LogGeneratorOptions &options)
+    : options_(options), rng_(options.seed),
+      gaps_(options.rate / options.ticks_per_second),
+      fine_clock_(static_cast<double>(options.start_timestamp)),
+      clock_(options.start_timestamp) {
+    std::vector<double> template_weights;
+    for (size_t k = 1; k <= PREFIXES.size(); k++) {
+        template_weights.push_back(1.0 / std::pow(static_cast<double>(k), options_.zipf_exponent));
+    }
+    templates_ = std::discrete_distribution<size_t>(template_weights.begin(), template_weights.end());
+
+    std::vector<double> severity_weights;
+    for (const auto &[name, weight] : options_.severity_mix) {
+        severity_weights.push_back(weight);
+    }
+    severities_ = std::discrete_distribution<size_t>(severity_weights.begin(), severity_weights.end());
+}
+
+std::string LogGenerator::NextLine() {
+    // Poisson arrivals: exponential gaps, in ticks
+    fine_clock_ += gaps_(rng_);
+    clock_ = static_cast<KeyType>(fine_clock_);
+
+    KeyType timestamp = clock_;
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    if (options_.max_skew_ticks > 0 && unit(rng_) < options_.late_fraction) {
+        uint64_t skew = 1 + rng_() % options_.max_skew_ticks;
+        timestamp = skew < timestamp ? timestamp - skew : 0;
+    }
+
+    lines_++;
+    const std::string &severity = options_.severity_mix[severities_(rng_)].first;
+    return std::to_string(timestamp) + " " + severity + " " + MakeMessage(rng_, templates_(rng_));
+}
+
+const std::vector<std::string> &LogGenerator::TemplatePrefixes() {
+    return PREFIXES;
+}
+
+size_t LogGenerator::TemplateCount() {
+    return PREFIXES.size();
+}
+
+std::string LogGenerator::MakeMessage(std::mt19937_64 &rng, size_t template_id) {
+    auto pick = [&](const std::vector<std::string> &v) { return v[rng() % v.size()]; };
+    auto num = [&](uint64_t mod) { return rng() % mod; };
+    auto ip = [&] {
+        std::string a = std::to_string(num(4));
+        return "10.0." + a + "." + std::to_string(num(64));
+    };
+
+    // operands of << are evaluated left to right (C++17), so the draws
+    // happen in the same order with every compiler
+    std::ostringstream out;
+    template_id %= PREFIXES.size();
+    out << PREFIXES[template_id];
+    switch (template_id) {
+        case 0: out << pick(USERS) << "(uid=" << num(2000) << ")"; break;
+        case 1: out << pick(USERS); break;
+        case 2: out << pick(PATHS) << (num(20) == 0 ? " 404 " : " 200 ") << num(50000) << "us"; break;
+        case 3: out << pick(SERVICES) << ".service"; break;
+        case 4: out << pick(USERS) << " from " << ip() << " port " << num(65536); break;
+        case 5: out << pick(SERVICES) << " latency_ms=" << num(500); break;
+        case 6: out << ip() << " port " << num(65536) << " [preauth]"; break;
+        case 7: out << pick(SERVICES) << " path=" << pick(PATHS) << " ms=" << num(10000); break;
+        case 8: out << pick(USERS) << " from " << ip() << " port " << num(65536) << " ssh2"; break;
+        case 9: out << pick(SERVICES) << ":" << num(10000); break;
+        case 10: out << pick(SERVICES) << ".service"; break;
+        case 11: out << pick(DEVICES) << " sector=" << num(1000000); break;
+        case 12: out << pick(DEVICES) << "): ext4_end_bio: I/O error " << num(16); break;
+        default: out << num(65536) << " (" << pick(SERVICES) << ")"; break;
+    }
+    return out.str();
+}
+
+} // namespace cmse
@@ -0,0 +1,306 @@
+#include "../../include/ingest/log_ingestor.h"
+#include "../../include/index/btree/bplus_tree.h"
+#include "../../include/index/lsm/lsm_write_buffer.h"
+#include "../../include/index/trie/trie.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+
+namespace cmse {
+
+namespace {
+
+// Fields of a LogRecord an index can be bound to
+const char *const INGEST_FIELDS[] = {"timestamp", "severity", "message"};
+
+const std::string &StringField(const LogRecord &record, const std::string &field) {
+    return field == "severity" ? record.severity : record.message;
+}
+
+} // namespace
+
+std::string IngestStats::Describe() const {
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(1);
+
+    double rate = elapsed_sec > 0.0 ? static_cast<double>(lines_indexed) / elapsed_sec : 0.0;
+
+    out << "ingest: " << lines_indexed << "/" << lines_read << " lines indexed"
+        << " (" << rate << " lines/s, " << parse_errors << " unparsable)"
+        << " queues parse=" << parse_queue_depth << "/" << queue_capacity
+        << " index=" << index_queue_depth << "/" << queue_capacity
+        << " blocked reader=" << reader_blocked_us / 1000 << "ms"
+        << " parser=" << parser_blocked_us / 1000 << "ms";
+    return out.str();
+}
+
+LogIngestor::LogIngestor(const std::string &log_path, BufferPoolManager *bpm,
+                         IndexCatalog *catalog, const IngestOptions &options)
+    : log_path_(log_path), bpm_(bpm), catalog_(catalog), options_(options),
+      parse_queue_(options.queue_batches), index_queue_(options.queue_batches) {}
+
+LogIngestor::~LogIngestor() {
+    Stop();
+
+    if (inotify_fd_ >= 0) close(inotify_fd_);
+    if (fd_ >= 0) close(fd_);
+}
+
+bool LogIngestor::Start() {
+    fd_ = open(log_path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        std::cerr << "ingest: cannot open " << log_path_ << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    if (options_.follow) {
+        // without inotify WaitForData degrades to polling
+        inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd_ >= 0 && inotify_add_watch(inotify_fd_, log_path_.c_str(), IN_MODIFY) < 0) {
+            close(inotify_fd_);
+            inotify_fd_ = -1;
+        }
+    }
+
+    indexed_bytes_ = catalog_->GetIngestedBytes();
+    started_ = std::chrono::steady_clock::now();
+
+    reader_ = std::thread([this] { ReadLoop(); });
+    parser_ = std::thread([this] { ParseLoop(); });
+    indexer_ = std::thread([this] { IndexLoop(); });
+    return true;
+}
+
+void LogIngestor::Wait() {
+    if (reader_.joinable()) reader_.join();
+    if (parser_.joinable()) parser_.join();
+    if (indexer_.joinable()) indexer_.join();
+}
+
+void LogIngestor::Stop() {
+    stopping_ = true;
+    Wait();
+}
+
+IngestStats LogIngestor::GetStats() const {
+    IngestStats stats;
+    stats.bytes_read = bytes_read_.load();
+    stats.lines_read = lines_read_.load();
+    stats.lines_indexed = lines_indexed_.load();
+    stats.parse_errors = parse_errors_.load();
+    stats.batches_indexed = batches_indexed_.load();
+    stats.indexed_bytes = indexed_bytes_.load();
+
+    stats.parse_queue_depth = parse_queue_.Size();
+    stats.index_queue_depth = index_queue_.Size();
+    stats.queue_capacity = options_.queue_batches;
+    stats.reader_blocked_us = parse_queue_.BlockedMicros();
+    stats.parser_blocked_us = index_queue_.BlockedMicros();
+
+    stats.elapsed_sec = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - started_).count();
+    return stats;
+}
+
+bool LogIngestor::WaitForData() {
+    if (stopping_) {
+        return false;
+    }
+
+    if (inotify_fd_ >= 0) {
+        pollfd pfd{inotify_fd_, POLLIN, 0};
+        if (poll(&pfd, 1, options_.poll_interval_ms) > 0) {
+            char events[4096];
+            while (read(inotify_fd_, events, sizeof(events)) > 0) {
+            }
+        }
+    } else {
+        poll(nullptr, 0, options_.poll_interval_ms);
+    }
+
+    return !stopping_;
+}
+
+void LogIngestor::ReadLoop() {
+    std::vector<char> buffer(INGEST_READ_CHUNK);
+
+    uint64_t read_pos = indexed_bytes_.load();
+    uint64_t line_start = read_pos;
+    std::string partial;            // bytes of the line at line_start read so far
+    bool truncated_warned = false;
+
+    RawBatch batch;
+    auto flush = [&]() {
+        if (batch.lines.empty()) {
+            return true;
+        }
+        batch.end_offset = line_start;
+        lines_read_ += batch.lines.size();
+        bool ok = parse_queue_.Push(std::move(batch));
+        batch = RawBatch{};
+        return ok;
+    };
+
+    while (!stopping_) {
+        ssize_t n = pread(fd_, buffer.data(), buffer.size(), static_cast<off_t>(read_pos));
+
+        if (n > 0) {
+            const char *data = buffer.data();
+            const char *end = data + n;
+
+            while (data < end) {
+                const char *newline =
+                    static_cast<const char *>(std::memchr(data, '\n', end - data));
+                if (newline == nullptr) {
+                    partial.append(data, end);
+                    break;
+                }
+
+                partial.append(data, newline);
+                batch.lines.push_back(RawLine{line_start, std::move(partial)});
+                partial.clear();
+
+                line_start += batch.lines.back().text.size() + 1;
+                data = newline + 1;
+
+                if (batch.lines.size() >= options_.batch_lines && !flush()) {
+                    return;
+                }
+            }
+
+            read_pos += static_cast<uint64_t>(n);
+            bytes_read_ += static_cast<uint64_t>(n);
+            continue;
+        }
+
+        // end of file: hand over what we have before waiting
+        if (!flush()) {
+            return;
+        }
+
+        if (!options_.follow) {
+            if (!partial.empty()) {
+                // last line without a newline (same as RefReader::Scan)
+                batch.lines.push_back(RawLine{line_start, std::move(partial)});
+                line_start = read_pos;
+                flush();
+            }
+            break;
+        }
+
+        struct stat st;
+        if (!truncated_warned && fstat(fd_, &st) == 0 &&
+            static_cast<uint64_t>(st.st_size) < read_pos) {
+            std::cerr << "ingest: " << log_path_ << " shrank below the indexed offset "
+                      << read_pos << "; waiting for it to grow again\n";
+            truncated_warned = true;
+        }
+
+        if (!WaitForData()) {
+            break;
+        }
+    }
+
+    flush();
+    parse_queue_.Close();
+}
+
+void LogIngestor::ParseLoop() {
+    RawBatch raw;
+    while (parse_queue_.Pop(raw)) {
+        ParsedBatch parsed;
+        parsed.end_offset = raw.end_offset;
+        parsed.records.reserve(raw.lines.size());
+
+        for (const auto &line : raw.lines) {
+            ParsedRecord rec;
+            if (!ParseLogRecord(line.text, rec.record)) {
+                parse_errors_++;
+                continue;
+            }
+            rec.ref = RecordRef{line.offset};
+            parsed.records.push_back(std::move(rec));
+        }
+
+        if (!index_queue_.Push(std::move(parsed))) {
+            break;
+        }
+    }
+
+    index_queue_.Close();
+}
+
+void LogIngestor::IndexLoop() {
+    ParsedBatch batch;
+    while (index_queue_.Pop(batch)) {
+        IndexBatch(batch);
+
+        lines_indexed_ += batch.records.size();
+        batches_indexed_++;
+        indexed_bytes_ = batch.end_offset;
+    }
+}
+
+void LogIngestor::IndexBatch(const ParsedBatch &batch) {
+    // one write epoch per batch: queries see all of it or none of it
+    IndexWriteScope write(catalog_);
+
+    for (const char *name : INGEST_FIELDS) {
+        std::string field = name;
+
+        IndexMetaEntryPage meta;
+        if (!catalog_->GetEntryByField(field, meta)) {
+            continue;
+        }
+        IndexID index_id = meta.index_id;
+        IndexType index_type = meta.index_type;
+        PageID root = meta.root_page_id;
+        PageID stats_pid = meta.stats_page_id;
+
+        if (root == INVALID_PAGE_ID) {
+            continue;
+        }
+
+        if (index_type == IndexType::BTREE && field == "timestamp") {
+            std::vector<std::pair<KeyType, RecordRef>> entries;
+            entries.reserve(batch.records.size());
+            for (const auto &rec : batch.records) {
+                entries.emplace_back(rec.record.timestamp, rec.ref);
+            }
+
+            if (LsmWriteBuffer *buffer = catalog_->GetWriteBuffer(index_id)) {
+                std::unique_lock<std::shared_mutex> guard(catalog_->IndexLatch());
+                buffer->InsertBatch(entries);
+                continue;
+            }
+
+            // log timestamps arrive nearly sorted
+            BPlusTree tree(root, index_id, catalog_, bpm_);
+            tree.SetAppendMode(true);
+            tree.InsertBatch(entries);
+        } else if (index_type == IndexType::TRIE && field != "timestamp") {
+            std::vector<std::pair<std::string, RecordRef>> entries;
+            entries.reserve(batch.records.size());
+            for (const auto &rec : batch.records) {
+                entries.emplace_back(StringField(rec.record, field), rec.ref);
+            }
+
+            TrieIndex trie(root, bpm_, stats_pid, catalog_->GetBloomFilter(index_id), index_id);
+            trie.InsertBatch(entries);
+        }
+    }
+
+    catalog_->SetIngestedBytes(batch.end_offset);
+}
+
+} // namespace cmse
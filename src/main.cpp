@@ -1,11 +1,27 @@
 #include <iostream>
 #include <string>
 #include <cstdlib>
+#include <csignal>
+#include <filesystem>
+#include <memory>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
-#ifdef _WIN32
-#else
-#include <unistd.h>
-#endif
+#include "../include/common/config.h"
+#include "../include/common/metrics.h"
+#include "../include/common/thread_pool.h"
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/btree/bplus_tree.h"
+#include "../include/index/lsm/lsm_write_buffer.h"
+#include "../include/index/trie/trie.h"
+#include "../include/ingest/log_ingestor.h"
+#include "../include/query/query_executor.h"
+#include "../include/query/query_parser.h"
+#include "../include/server/query_server.h"
+
+using namespace cmse;
 
 // Function to clear screen (cross-platform)
 void clearScreen() {
@@ -16,26 +32,6 @@ void clearScreen() {
 #endif
 }
 
-// Function to print CMSE ASCII art
-void printCMSEHeader() {
-    std::cout << R"(
-╔════════════════════════════════════════════════════════════════════════════════╗
-║                                                                                ║
-║  ██████╗███╗   ███╗███████╗███████╗                                           ║
-║ ██╔════╝████╗ ████║██╔════╝██╔════╝                                           ║
-║ ██║     ██╔████╔██║█████╗  ███████╗                                           ║
-║ ██║     ██║╚██╔╝██║██╔══╝  ╚════██║                                           ║
-║ ╚██████╗██║ ╚═╝ ██║███████╗███████║                                           ║
-║  ╚═════╝╚═╝     ╚═╝╚══════╝╚══════╝                                           ║
-║                                                                                ║
-║           ╔══════════════════════════════════════════════════════════╗         ║
-║           ║      Columnar Multi-model Storage Engine v1.0.0          ║         ║
-║           ╚══════════════════════════════════════════════════════════╝         ║
-║                                                                                ║
-╚════════════════════════════════════════════════════════════════════════════════╝
-)" << std::endl;
-}
-
 // Function to print a colorful version (if terminal supports ANSI codes)
 void printColorfulCMSE() {
     std::cout << "\033[1;36m";  // Cyan bold
@@ -60,158 +56,413 @@ void printColorfulCMSE() {
 )" << "\033[0m" << std::endl;
 }
 
-// Alternative minimalist ASCII art
-void printMinimalCMSE() {
-    std::cout << R"(
-┌────────────────────────────────────────────────────────────────────────┐
-│                                                                        │
-│    ██████╗ ███╗   ███╗███████╗███████╗                                │
-│   ██╔════╝ ████╗ ████║██╔════╝██╔════╝                                │
-│   ██║  ███╗██╔████╔██║█████╗  ███████╗                                │
-│   ██║   ██║██║╚██╔╝██║██╔══╝  ╚════██║                                │
-│   ╚██████╔╝██║ ╚═╝ ██║███████╗███████║                                │
-│    ╚═════╝ ╚═╝     ╚═╝╚══════╝╚══════╝                                │
-│                                                                        │
-│              ┌────────────────────────────────────────┐                │
-│              │   CMSE Database Management System      │                │
-│              └────────────────────────────────────────┘                │
-│                                                                        │
-└────────────────────────────────────────────────────────────────────────┘
-)" << std::endl;
+// ================================
+// Command line
+// ================================
+
+struct Options {
+    bool serve = false;
+    std::string log_path;
+    size_t workers = 4;        // concurrent queries (serve)
+    size_t scan_threads = 0;   // intra-query parallelism, 0 = serial scans
+    bool reindex = false;
+    bool follow = false;       // serve: keep indexing lines appended to the log
+    bool lsm = false;          // serve --follow: buffer timestamps LSM-style
+    bool show_options = false;
+    std::string metrics_file;  // Prometheus text dump, empty = none
+    std::string slow_query_dir;     // Chrome traces of slow queries, empty = none
+    uint64_t slow_query_ms = 100;
+    StorageOptions storage;
+    ServerOptions server;
+};
+
+void printUsage() {
+    std::cout <<
+        "usage: cmse [serve] --log FILE [options]\n"
+        "\n"
+        "  (no command)        interactive query prompt\n"
+        "  serve               answer newline-delimited queries on a socket\n"
+        "\n"
+        "  --log FILE          log file to index and query (required)\n"
+        "  --scan-threads N    threads for parallel range/prefix scans (default 0)\n"
+        "  --reindex           rebuild the indexes from the log\n"
+        "  --follow            serve: keep indexing lines appended to the log\n"
+        "  --lsm               serve --follow: buffer new timestamps in a memtable and\n"
+        "                      sorted runs, merged into the B+Tree in the background\n"
+        "  --workers N         serve: queries run concurrently (default 4)\n"
+        "  --port N            serve: TCP port on 127.0.0.1 (default 7411)\n"
+        "  --bind ADDR         serve: TCP bind address\n"
+        "  --socket PATH       serve: Unix-domain socket instead of TCP\n"
+        "  --metrics-file PATH write metrics in Prometheus text format to PATH on exit\n"
+        "                      (serve: also every 10 seconds)\n"
+        "  --slow-query-dir DIR write a Chrome trace (chrome://tracing) of every query\n"
+        "                      slower than --slow-query-ms to DIR\n"
+        "  --slow-query-ms N   slow query threshold (default 100)\n"
+        "\n"
+        "storage options (later ones win):\n"
+        "  --config FILE       read 'key = value' storage options from FILE\n"
+        "  --option KEY=VALUE  set one storage option (see --show-options)\n"
+        "  --pool-pages N      buffer pool frames (default " << DEFAULT_BUFFER_POOL_SIZE << ")\n"
+        "  --disk-file PATH    index file (default " << DISK_FILE_PATH << ")\n"
+        "  --page-size N       4K, 8K, 16K or 64K; must match the build (CMSE_PAGE_SIZE)\n"
+        "  --direct-io         read/write index pages with O_DIRECT, bypassing the\n"
+        "                      page cache (size --pool-pages up to match)\n"
+        "  --show-options      print the storage options in effect and exit\n";
 }
 
-// Function to display menu
-void displayMenu() {
-    std::cout << "\n\033[1;32m" << "┌───────────────────────── Main Menu ─────────────────────────┐" << "\033[0m" << std::endl;
-    std::cout << "\033[1;32m" << "│" << "\033[0m" << "                                                              " << "\033[1;32m" << "│" << "\033[0m" << std::endl;
-    std::cout << "\033[1;32m" << "│" << "\033[0m" << "  1. Create Index                                    " << "\033[1;32m" << "│" << "\033[0m" << std::endl;
-    std::cout << "\033[1;32m" << "│" << "\033[0m" << "  2. Insert Data                                      " << "\033[1;32m" << "│" << "\033[0m" << std::endl;
-    std::cout << "\033[1;32m" << "│" << "\033[0m" << "  3. Search Data                                      " << "\033[1;32m" << "│" << "\033[0m" << std::endl;
-    std::cout << "\033[1;32m" << "│" << "\033[0m" << "  4. Execute Query                                    " << "\033[1;32m" << "│" << "\033[0m" << std::endl;
-    std::cout << "\033[1;32m" << "│" << "\033[0m" << "  5. View Statistics                                  " << "\033[1;32m" << "│" << "\033[0m" << std::endl;
-    std::cout << "\033[1;32m" << "│" << "\033[0m" << "  6. Benchmark                                        " << "\033[1;32m" << "│" << "\033[0m" << std::endl;
-    std::cout << "\033[1;32m" << "│" << "\033[0m" << "  7. System Status                                    " << "\033[1;32m" << "│" << "\033[0m" << std::endl;
-    std::cout << "\033[1;32m" << "│" << "\033[0m" << "  8. Exit                                             " << "\033[1;32m" << "│" << "\033[0m" << std::endl;
-    std::cout << "\033[1;32m" << "│" << "\033[0m" << "                                                              " << "\033[1;32m" << "│" << "\033[0m" << std::endl;
-    std::cout << "\033[1;32m" << "└──────────────────────────────────────────────────────────────┘" << "\033[0m" << std::endl;
-    std::cout << "\n\033[1;36m" << "CMSE> " << "\033[0m";
+bool parseOptions(int argc, char **argv, Options &opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&](std::string &out) {
+            if (i + 1 >= argc) return false;
+            out = argv[++i];
+            return true;
+        };
+        std::string v;
+        std::string error;
+        auto fail = [&] {
+            if (!error.empty()) std::cerr << error << std::endl;
+            return false;
+        };
+
+        if (arg == "serve" && i == 1) {
+            opts.serve = true;
+        } else if (arg == "--log") {
+            if (!value(opts.log_path)) return false;
+        } else if (arg == "--config") {
+            if (!value(v) || !opts.storage.LoadFile(v, error)) return fail();
+        } else if (arg == "--option") {
+            if (!value(v)) return false;
+            size_t eq = v.find('=');
+            if (eq == std::string::npos) return false;
+            if (!opts.storage.Set(v.substr(0, eq), v.substr(eq + 1), error)) return fail();
+        } else if (arg == "--pool-pages") {
+            if (!value(v) || !opts.storage.Set("pool_pages", v, error)) return fail();
+        } else if (arg == "--disk-file") {
+            if (!value(v) || !opts.storage.Set("disk_file", v, error)) return fail();
+        } else if (arg == "--page-size") {
+            if (!value(v) || !opts.storage.Set("page_size", v, error)) return fail();
+        } else if (arg == "--show-options") {
+            opts.show_options = true;
+        } else if (arg == "--scan-threads") {
+            if (!value(v)) return false;
+            opts.scan_threads = std::strtoull(v.c_str(), nullptr, 10);
+        } else if (arg == "--workers") {
+            if (!value(v)) return false;
+            opts.workers = std::strtoull(v.c_str(), nullptr, 10);
+        } else if (arg == "--port") {
+            if (!value(v)) return false;
+            opts.server.port = static_cast<uint16_t>(std::strtoul(v.c_str(), nullptr, 10));
+        } else if (arg == "--bind") {
+            if (!value(opts.server.bind_address)) return false;
+        } else if (arg == "--socket") {
+            if (!value(opts.server.unix_path)) return false;
+        } else if (arg == "--direct-io") {
+            opts.storage.io_mode = DiskIoMode::DIRECT;
+        } else if (arg == "--metrics-file") {
+            if (!value(opts.metrics_file)) return false;
+        } else if (arg == "--slow-query-dir") {
+            if (!value(opts.slow_query_dir)) return false;
+        } else if (arg == "--slow-query-ms") {
+            if (!value(v)) return false;
+            opts.slow_query_ms = std::strtoull(v.c_str(), nullptr, 10);
+        } else if (arg == "--reindex") {
+            opts.reindex = true;
+        } else if (arg == "--follow") {
+            opts.follow = true;
+        } else if (arg == "--lsm") {
+            opts.lsm = true;
+        } else {
+            return false;
+        }
+    }
+    std::string error;
+    if (!opts.storage.Validate(error)) {
+        std::cerr << error << std::endl;
+        return false;
+    }
+    return (opts.show_options || !opts.log_path.empty()) && opts.workers > 0;
 }
 
-// Function to simulate loading animation
-void showLoading() {
-    std::cout << "\033[1;33m" << "\nInitializing CMSE Database Engine" << "\033[0m" << std::endl;
-    
-    for (int i = 0; i < 3; i++) {
-        std::cout << "\033[1;33m" << "." << "\033[0m" << std::flush;
-#ifdef _WIN32
-        Sleep(500);
-#else
-        usleep(500000);
-#endif
+// ================================
+// Index bootstrap
+// ================================
+
+constexpr IndexID TIMESTAMP_INDEX_ID = 1;
+constexpr IndexID SEVERITY_INDEX_ID = 2;
+
+PageID newLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+PageID newTrieRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *root = reinterpret_cast<TrieNodePage *>(page->GetData());
+    for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
+        root->children[i] = INVALID_PAGE_ID;
     }
-    
-    std::cout << "\033[1;32m" << " READY!" << "\033[0m" << std::endl;
-#ifdef _WIN32
-    Sleep(300);
-#else
-    usleep(300000);
-#endif
+    root->is_terminal = false;
+    root->record_count = 0;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
 }
 
-// Main interactive loop
-void runInteractive() {
+// timestamp -> B+Tree, severity -> trie; kept on disk across runs. A
+// catalog that already indexed some log keeps what DROP INDEX left.
+void createIndexes(BufferPoolManager &bpm, IndexCatalog &catalog) {
+    if (catalog.GetIndexCount() == 0 && catalog.GetIngestedBytes() == 0) {
+        catalog.RegisterIndex(TIMESTAMP_INDEX_ID, "timestamp", FieldType::NUMERIC,
+                              IndexType::BTREE, newLeafRoot(bpm));
+        catalog.RegisterIndex(SEVERITY_INDEX_ID, "severity", FieldType::STRING,
+                              IndexType::TRIE, newTrieRoot(bpm));
+    }
+
+    // EQUALS on a missing key then reads no index pages
+    for (const IndexMetaEntryPage &meta : catalog.ListIndexes()) {
+        if (catalog.GetBloomFilter(meta.index_id) == nullptr) {
+            catalog.EnableBloomFilter(meta.index_id);
+        }
+    }
+}
+
+// Index whatever the log gained since the last run
+bool catchUp(BufferPoolManager &bpm, IndexCatalog &catalog, const std::string &log_path) {
+    LogIngestor ingestor(log_path, &bpm, &catalog);
+    if (!ingestor.Start()) {
+        return false;
+    }
+    ingestor.Wait();
+
+    IngestStats stats = ingestor.GetStats();
+    catalog.SaveBloomFilters();
+    bpm.FlushAllPages();
+    std::cout << "Indexed " << stats.lines_indexed << " new records ("
+              << stats.indexed_bytes << " bytes of log covered)\n";
+    return true;
+}
+
+// ================================
+// Modes
+// ================================
+
+void runInteractive(QueryExecutor &executor) {
     std::string input;
-    
+
     while (true) {
-        displayMenu();
-        std::getline(std::cin, input);
-        
+        std::cout << "\033[1;36m" << "CMSE> " << "\033[0m" << std::flush;
+        if (!std::getline(std::cin, input)) {
+            break;
+        }
+
         if (input.empty()) {
             continue;
         }
-        
-        // Convert to lowercase for easier comparison
-        std::string cmd = input;
-        for (char &c : cmd) c = std::tolower(c);
-        
-        if (cmd == "1" || cmd == "create" || cmd == "create index") {
-            std::cout << "\033[1;34m" << "[CREATE INDEX] Enter index type (btree/trie): " << "\033[0m";
-            std::getline(std::cin, input);
-            std::cout << "\033[1;32m" << "Creating " << input << " index..." << "\033[0m" << std::endl;
+
+        if (input == "exit" || input == "quit" || input == "q") {
+            break;
         }
-        else if (cmd == "2" || cmd == "insert" || cmd == "insert data") {
-            std::cout << "\033[1;34m" << "[INSERT] Enter data to insert: " << "\033[0m";
-            std::getline(std::cin, input);
-            std::cout << "\033[1;32m" << "Inserted: '" << input << "'" << "\033[0m" << std::endl;
+        if (input == "clear" || input == "cls") {
+            clearScreen();
+            printColorfulCMSE();
+            continue;
         }
-        else if (cmd == "3" || cmd == "search" || cmd == "search data") {
-            std::cout << "\033[1;34m" << "[SEARCH] Enter search term: " << "\033[0m";
-            std::getline(std::cin, input);
-            std::cout << "\033[1;32m" << "Searching for: '" << input << "'" << "\033[0m" << std::endl;
+        if (input == "help") {
+            std::cout << "  [EXPLAIN [ANALYZE]] [COUNT|MIN|MAX] WHERE <field> <op> <value> [AND ...] [GROUP BY n]\n"
+                      << "  ops: EQUALS n | EQUALS \"s\" | BETWEEN a,b | STARTSWITH \"s\"\n"
+                      << "  CREATE INDEX ON <field> [USING BTREE|TRIE], DROP INDEX ON <field>, SHOW INDEXES\n"
+                      << "  stats, clear, help, exit\n";
+            continue;
         }
-        else if (cmd == "4" || cmd == "query" || cmd == "execute query") {
-            std::cout << "\033[1;34m" << "[QUERY] Enter SQL query: " << "\033[0m";
-            std::getline(std::cin, input);
-            std::cout << "\033[1;32m" << "Executing query..." << "\033[0m" << std::endl;
+        if (input == "stats") {
+            std::cout << MetricsRegistry::Global().Collect().Describe();
+            continue;
         }
-        else if (cmd == "5" || cmd == "stats" || cmd == "statistics") {
-            std::cout << "\033[1;34m" << "[STATISTICS] Generating report..." << "\033[0m" << std::endl;
-            std::cout << "\033[1;33m" << "Indexes: 2" << std::endl;
-            std::cout << "Records: 15,432" << std::endl;
-            std::cout << "Memory: 128 MB" << "\033[0m" << std::endl;
+
+        Query query;
+        if (!QueryParser::Parse(input, query)) {
+            std::cout << "\033[1;31m" << "Invalid query (type 'help')" << "\033[0m" << std::endl;
+            continue;
         }
-        else if (cmd == "6" || cmd == "benchmark") {
-            std::cout << "\033[1;34m" << "[BENCHMARK] Running performance tests..." << "\033[0m" << std::endl;
-            std::cout << "\033[1;33m" << "Insert speed: 12,500 ops/sec" << std::endl;
-            std::cout << "Query speed: 8,200 ops/sec" << "\033[0m" << std::endl;
+        executor.Execute(query);
+    }
+}
+
+QueryServer *g_server = nullptr;
+
+void writeMetrics(const std::string &path) {
+    if (!path.empty() && !MetricsRegistry::Global().WritePrometheusFile(path)) {
+        std::cerr << "cannot write metrics to " << path << std::endl;
+    }
+}
+
+void handleStopSignal(int) {
+    if (g_server != nullptr) {
+        g_server->Stop();
+    }
+}
+
+int runServer(QueryExecutor &executor, BufferPoolManager &bpm, IndexCatalog &catalog,
+              const Options &opts) {
+    ThreadPool workers(opts.workers);
+    QueryServer server(&executor, &workers, opts.server);
+
+    if (!server.Start()) {
+        return 1;
+    }
+
+    // --follow: tail the log while serving, reporting ingest progress and
+    // back-pressure every few seconds; --metrics-file: refresh the dump
+    // on the same schedule
+    std::unique_ptr<LogIngestor> ingestor;
+    std::unique_ptr<LsmWriteBuffer> write_buffer;
+    std::thread reporter;
+    std::mutex report_mutex;
+    std::condition_variable report_cv;
+    bool report_stop = false;
+
+    if (opts.follow) {
+        IngestOptions ingest_opts;
+        ingest_opts.follow = true;
+
+        if (opts.lsm) {
+            write_buffer = std::make_unique<LsmWriteBuffer>(TIMESTAMP_INDEX_ID, &bpm, &catalog);
+            catalog.AttachWriteBuffer(TIMESTAMP_INDEX_ID, write_buffer.get());
+            write_buffer->Start();
         }
-        else if (cmd == "7" || cmd == "status" || cmd == "system status") {
-            std::cout << "\033[1;34m" << "[SYSTEM STATUS]" << "\033[0m" << std::endl;
-            std::cout << "\033[1;33m" << "Buffer Pool: 50 pages" << std::endl;
-            std::cout << "Disk Usage: 45 MB" << std::endl;
-            std::cout << "Uptime: 00:15:32" << "\033[0m" << std::endl;
+
+        ingestor = std::make_unique<LogIngestor>(opts.log_path, &bpm, &catalog, ingest_opts);
+        if (!ingestor->Start()) {
+            return 1;
         }
-        else if (cmd == "8" || cmd == "exit" || cmd == "quit" || cmd == "q") {
-            std::cout << "\033[1;31m" << "\nAre you sure you want to exit? (y/n): " << "\033[0m";
-            std::getline(std::cin, input);
-            if (input == "y" || input == "Y" || input == "yes") {
-                std::cout << "\033[1;32m" << "\nShutting down CMSE Database Engine..." << "\033[0m" << std::endl;
-                std::cout << "\033[1;33m" << "Goodbye!" << "\033[0m" << std::endl;
-                break;
+
+    }
+
+    if (ingestor || !opts.metrics_file.empty()) {
+        reporter = std::thread([&] {
+            std::unique_lock<std::mutex> lock(report_mutex);
+            uint64_t last_read = 0;
+            while (!report_cv.wait_for(lock, std::chrono::seconds(10), [&] { return report_stop; })) {
+                writeMetrics(opts.metrics_file);
+                if (!ingestor) {
+                    continue;
+                }
+                IngestStats stats = ingestor->GetStats();
+                if (stats.lines_read != last_read) {
+                    std::cout << stats.Describe() << std::endl;
+                    if (write_buffer) {
+                        std::cout << write_buffer->GetStats().Describe() << std::endl;
+                    }
+                    last_read = stats.lines_read;
+                }
             }
+        });
+    }
+
+    g_server = &server;
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    if (opts.server.unix_path.empty()) {
+        std::cout << "Listening on " << opts.server.bind_address << ":" << opts.server.port;
+    } else {
+        std::cout << "Listening on " << opts.server.unix_path;
+    }
+    std::cout << " with " << opts.workers << " workers" << std::endl;
+
+    server.Run();
+    g_server = nullptr;
+
+    if (reporter.joinable()) {
+        {
+            std::lock_guard<std::mutex> guard(report_mutex);
+            report_stop = true;
         }
-        else if (cmd == "clear" || cmd == "cls") {
-            clearScreen();
-            printColorfulCMSE();
-        }
-        else if (cmd == "help") {
-            std::cout << "\033[1;34m" << "[HELP] Available commands:" << "\033[0m" << std::endl;
-            std::cout << "  Menu options 1-8" << std::endl;
-            std::cout << "  clear/cls - Clear screen" << std::endl;
-            std::cout << "  help - Show this help" << std::endl;
-            std::cout << "  exit/quit - Exit program" << std::endl;
-        }
-        else {
-            std::cout << "\033[1;31m" << "Unknown command: " << cmd << "\033[0m" << std::endl;
-            std::cout << "Type 'help' for available commands" << std::endl;
+        report_cv.notify_one();
+        reporter.join();
+    }
+
+    if (ingestor) {
+        ingestor->Stop();
+        std::cout << ingestor->GetStats().Describe() << std::endl;
+
+        if (write_buffer) {
+            // merge what is still buffered into the tree before exit
+            write_buffer->Stop();
+            catalog.AttachWriteBuffer(TIMESTAMP_INDEX_ID, nullptr);
+            std::cout << write_buffer->GetStats().Describe() << std::endl;
         }
-        
-        std::cout << std::endl;
     }
+
+    std::cout << "Served " << server.QueriesServed() << " queries" << std::endl;
+    writeMetrics(opts.metrics_file);
+    return 0;
 }
 
-int main() {
-    // Clear screen
-    clearScreen();
-    
-    // Print CMSE ASCII art
-    printColorfulCMSE();
-    
-    // Show loading animation
-    showLoading();
-    
-    // Run interactive mode
-    runInteractive();
-    
+int main(int argc, char **argv) {
+    Options opts;
+    if (!parseOptions(argc, argv, opts)) {
+        printUsage();
+        return 2;
+    }
+
+    if (opts.show_options) {
+        std::cout << opts.storage.Describe();
+        return 0;
+    }
+
+    const std::string &disk_file = opts.storage.disk_file;
+    std::filesystem::path disk_dir = std::filesystem::path(disk_file).parent_path();
+    if (!disk_dir.empty()) {
+        std::filesystem::create_directories(disk_dir);
+    }
+    if (opts.reindex) {
+        std::filesystem::remove(disk_file);
+    }
+
+    RefReader reader(opts.log_path);
+    BufferPoolManager bpm(opts.storage);
+    if (!bpm.GetDiskError().empty()) {
+        std::cerr << bpm.GetDiskError() << std::endl;
+        return 1;
+    }
+    if (opts.storage.io_mode == DiskIoMode::DIRECT && bpm.GetIoMode() != DiskIoMode::DIRECT) {
+        std::cerr << "O_DIRECT not supported for " << disk_file
+                  << ", using buffered I/O" << std::endl;
+    }
+    IndexCatalog catalog(&bpm);
+
+    if (!opts.serve) {
+        clearScreen();
+        printColorfulCMSE();
+    }
+
+    createIndexes(bpm, catalog);
+    if (!catchUp(bpm, catalog, opts.log_path)) {
+        return 1;
+    }
+
+    std::unique_ptr<ThreadPool> scan_pool;
+    if (opts.scan_threads > 0) {
+        scan_pool = std::make_unique<ThreadPool>(opts.scan_threads);
+    }
+    QueryExecutor executor(&bpm, &catalog, &reader, scan_pool.get());
+    executor.SetSlowQueryLog(opts.slow_query_dir, opts.slow_query_ms * 1'000'000);
+
+    if (opts.serve) {
+        return runServer(executor, bpm, catalog, opts);
+    }
+
+    runInteractive(executor);
+    writeMetrics(opts.metrics_file);
     return 0;
 }
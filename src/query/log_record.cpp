@@ -0,0 +1,72 @@
+#include "../../include/query/log_record.h"
+
+namespace cmse {
+
+namespace {
+
+bool MatchesString(const std::string &value, const Predicate &pred) {
+    if (pred.op == QueryOp::EQUALS) {
+        return value == pred.str_value;
+    }
+    if (pred.op == QueryOp::STARTSWITH) {
+        return value.compare(0, pred.str_value.size(), pred.str_value) == 0;
+    }
+    return false;
+}
+
+} // namespace
+
+bool ParseLogRecord(const std::string &line, LogRecord &out) {
+    size_t pos = 0;
+    size_t n = line.size();
+
+    // timestamp
+    if (pos >= n || line[pos] < '0' || line[pos] > '9') {
+        return false;
+    }
+
+    uint64_t ts = 0;
+    while (pos < n && line[pos] >= '0' && line[pos] <= '9') {
+        ts = ts * 10 + static_cast<uint64_t>(line[pos] - '0');
+        pos++;
+    }
+    out.timestamp = ts;
+
+    // severity
+    while (pos < n && line[pos] == ' ') pos++;
+    size_t sev_start = pos;
+    while (pos < n && line[pos] != ' ') pos++;
+    out.severity.assign(line, sev_start, pos - sev_start);
+
+    // message (rest of line, without trailing newline)
+    while (pos < n && line[pos] == ' ') pos++;
+    size_t end = n;
+    while (end > pos && (line[end - 1] == '\n' || line[end - 1] == '\r')) end--;
+    out.message.assign(line, pos, end - pos);
+
+    return true;
+}
+
+bool MatchesPredicate(const LogRecord &record, const Predicate &pred) {
+    if (pred.field_name == "timestamp") {
+        if (pred.op == QueryOp::EQUALS) {
+            return record.timestamp == pred.num_value;
+        }
+        if (pred.op == QueryOp::BETWEEN) {
+            return record.timestamp >= pred.low && record.timestamp <= pred.high;
+        }
+        return false;
+    }
+
+    if (pred.field_name == "severity") {
+        return MatchesString(record.severity, pred);
+    }
+
+    if (pred.field_name == "message") {
+        return MatchesString(record.message, pred);
+    }
+
+    return false;
+}
+
+} // namespace cmse
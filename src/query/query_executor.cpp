@@ -1,57 +1,526 @@
 #include "../../include/query/query_executor.h"
+#include "../../include/common/metrics.h"
+#include "../../include/query/log_record.h"
 #include "../../include/index/btree/bplus_tree.h"
+#include "../../include/index/lsm/lsm_write_buffer.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <shared_mutex>
 
 namespace cmse {
 
-QueryExecutor::QueryExecutor(BufferPoolManager *bpm, IndexCatalog *catalog, RefReader *reader)
-    : bpm_(bpm), catalog_(catalog), reader_(reader) {}
+QueryExecutor::QueryExecutor(BufferPoolManager *bpm, IndexCatalog *catalog, RefReader *reader,
+                             ThreadPool *pool)
+    : bpm_(bpm), catalog_(catalog), reader_(reader), pool_(pool) {}
 
-void QueryExecutor::Execute(const Query &query) {
-    PageID meta_pid =
-        catalog_->GetIndexMetaPageByField(query.field_name);
+void QueryExecutor::SetSlowQueryLog(const std::string &dir, uint64_t threshold_nanos) {
+    slow_query_dir_ = dir;
+    slow_query_nanos_ = threshold_nanos;
+}
 
-    if (meta_pid == INVALID_PAGE_ID) {
-        std::cout << "Index not found\n";
-        return;
+void QueryExecutor::RunAccessPath(const AccessPath &path, const Predicate &pred,
+                                  std::vector<RecordRef> &result, bool parallel) {
+    // QueryOp and the PROBE_* histograms are in the same order
+    LatencyTimer timer(static_cast<Histogram>(static_cast<uint32_t>(Histogram::PROBE_EQUALS) +
+                                              static_cast<uint32_t>(pred.op)));
+    uint32_t temp = 0;
+
+    if (path.index_type == IndexType::BTREE) {
+        BPlusTree tree(path.root_page_id, path.index_id, catalog_, bpm_);
+
+        if (pred.op == QueryOp::EQUALS) {
+            tree.Search(pred.num_value, result, temp);
+        } else if (pred.op == QueryOp::BETWEEN) {
+            if (parallel && pool_ != nullptr) {
+                tree.ParallelRangeSearch(pred.low, pred.high, result, temp, pool_);
+            } else {
+                tree.RangeSearch(pred.low, pred.high, result, temp);
+            }
+        }
+
+        // entries still in the write buffer (LSM front end)
+        if (LsmWriteBuffer *buffer = catalog_->GetWriteBuffer(path.index_id)) {
+            if (pred.op == QueryOp::EQUALS) {
+                buffer->RangeSearch(pred.num_value, pred.num_value, result);
+            } else if (pred.op == QueryOp::BETWEEN) {
+                buffer->RangeSearch(pred.low, pred.high, result);
+            }
+        }
+    }
+
+    else if (path.index_type == IndexType::TRIE) {
+        TrieIndex trie(path.root_page_id, bpm_, INVALID_PAGE_ID,
+                       catalog_->GetBloomFilter(path.index_id), path.index_id);
+        trie.SetHotLevels(catalog_->GetHotLevels(path.index_id));
+
+        if (pred.op == QueryOp::EQUALS) {
+            trie.ExactSearch(pred.str_value, result);
+        } else if (pred.op == QueryOp::STARTSWITH) {
+            if (parallel && pool_ != nullptr) {
+                trie.ParallelPrefixSearch(pred.str_value, result, pool_);
+            } else {
+                trie.PrefixSearch(pred.str_value, result);
+            }
+        }
+    }
+}
+
+namespace {
+
+// Range used for GROUP BY buckets: the first BETWEEN, preferring timestamp
+const Predicate *GroupRange(const Query &query) {
+    const Predicate *range = nullptr;
+    for (const auto &pred : query.predicates) {
+        if (pred.op != QueryOp::BETWEEN) continue;
+        if (range == nullptr || pred.field_name == "timestamp") {
+            range = &pred;
+        }
+    }
+    return range;
+}
+
+// "BTREE #1 timestamp BETWEEN 5,9" (profile stage detail)
+std::string DescribePath(const AccessPath &path, const Predicate &pred) {
+    return std::string(path.index_type == IndexType::BTREE ? "BTREE" : "TRIE") + " #" +
+           std::to_string(path.index_id) + " " + PredicateToString(pred);
+}
+
+std::string DescribeResidual(const Query &query, const QueryPlan &plan) {
+    std::string detail;
+    for (size_t idx : plan.residual) {
+        detail += (detail.empty() ? "filter " : " AND ") + PredicateToString(query.predicates[idx]);
+    }
+    return detail;
+}
+
+PageID NewLeafRoot(BufferPoolManager *bpm) {
+    PageID root_id;
+    Page *page = bpm->NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm->UnpinPage(root_id, true);
+    return root_id;
+}
+
+PageID NewTrieRoot(BufferPoolManager *bpm) {
+    PageID root_id;
+    Page *page = bpm->NewPage(&root_id);
+    auto *root = reinterpret_cast<TrieNodePage *>(page->GetData());
+    for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
+        root->children[i] = INVALID_PAGE_ID;
+    }
+    root->is_terminal = false;
+    root->record_count = 0;
+    bpm->UnpinPage(root_id, true);
+    return root_id;
+}
+
+// Fields of a LogRecord an index can cover, and the index that fits each
+bool IndexableField(const std::string &field, FieldType &field_type, IndexType &index_type) {
+    if (field == "timestamp") {
+        field_type = FieldType::NUMERIC;
+        index_type = IndexType::BTREE;
+        return true;
     }
+    if (field == "severity" || field == "message") {
+        field_type = FieldType::STRING;
+        index_type = IndexType::TRIE;
+        return true;
+    }
+    return false;
+}
+
+const char *IndexTypeName(IndexType type) {
+    return type == IndexType::BTREE ? "BTREE" : "TRIE";
+}
 
-    Page *meta_page = bpm_->FetchPage(meta_pid);
-    auto *meta =
-        reinterpret_cast<IndexMetaEntryPage *>(meta_page->GetData());
+void PrintGroups(std::ostream &out, KeyType low, uint64_t width,
+                 const std::vector<uint64_t> &counts) {
+    KeyType start = low;
+    for (uint64_t count : counts) {
+        out << start << " " << count << "\n";
+        start += width;
+    }
+}
 
-    std::vector<RecordRef> results;
+void PrintMinMax(std::ostream &out, AggregateOp op, bool found, KeyType value) {
+    out << (op == AggregateOp::MIN ? "MIN: " : "MAX: ");
+    if (found) {
+        out << value << "\n";
+    } else {
+        out << "(none)\n";
+    }
+}
+
+} // namespace
+
+void QueryExecutor::ExecuteIndexAggregate(const Query &query, const QueryPlan &plan,
+                                          std::ostream &out) {
+    const AccessPath &path = plan.paths[0];
+    const Predicate &pred = query.predicates[path.predicate_idx];
+
+    KeyType low = pred.op == QueryOp::BETWEEN ? pred.low : pred.num_value;
+    KeyType high = pred.op == QueryOp::BETWEEN ? pred.high : pred.num_value;
+
+    BPlusTree tree(path.root_page_id, path.index_id, catalog_, bpm_);
+    LsmWriteBuffer *buffer = catalog_->GetWriteBuffer(path.index_id);
     uint32_t temp = 0;
 
-    if (meta->index_type == IndexType::BTREE) {
-        BPlusTree tree(meta->root_page_id, meta->index_id, catalog_, bpm_);
+    if (query.aggregate == AggregateOp::COUNT) {
+        uint64_t count = 0;
+
+        if (query.group_by_width > 0) {
+            std::vector<uint64_t> counts;
+            tree.CountByBucket(low, high, query.group_by_width, counts, temp);
+            if (buffer != nullptr) {
+                buffer->CountByBucket(low, high, query.group_by_width, counts);
+            }
+            PrintGroups(out, low, query.group_by_width, counts);
+            for (uint64_t c : counts) count += c;
+        } else {
+            count = tree.CountRange(low, high, temp);
+            if (buffer != nullptr) {
+                count += buffer->CountRange(low, high);
+            }
+        }
+
+        out << "COUNT: " << count << "\n";
+        return;
+    }
+
+    KeyType value = 0;
+    bool found = (query.aggregate == AggregateOp::MIN)
+        ? tree.MinInRange(low, high, value, temp)
+        : tree.MaxInRange(low, high, value, temp);
+
+    KeyType buffered = 0;
+    bool in_buffer = buffer != nullptr &&
+        ((query.aggregate == AggregateOp::MIN)
+             ? buffer->MinInRange(low, high, buffered)
+             : buffer->MaxInRange(low, high, buffered));
+    if (in_buffer) {
+        bool better = (query.aggregate == AggregateOp::MIN) ? buffered < value : buffered > value;
+        if (!found || better) value = buffered;
+        found = true;
+    }
+    PrintMinMax(out, query.aggregate, found, value);
+}
 
-        if (query.op == QueryOp::EQUALS) {
-            tree.Search(query.num_value, results, temp);
-        } else if (query.op == QueryOp::BETWEEN) {
-            tree.RangeSearch(query.low, query.high, results, temp);
+void QueryExecutor::ExecuteIndexStatement(const Query &query, std::ostream &out) {
+    // a write epoch like an ingest batch; running queries keep their snapshots
+    IndexWriteScope write(catalog_);
+    std::unique_lock<std::shared_mutex> guard(catalog_->IndexLatch());
+
+    if (query.statement == StatementType::SHOW_INDEXES) {
+        std::vector<IndexMetaEntryPage> indexes = catalog_->ListIndexes();
+        for (const IndexMetaEntryPage &meta : indexes) {
+            out << "#" << meta.index_id << " " << meta.field_name << " "
+                << IndexTypeName(meta.index_type) << " root=" << meta.root_page_id << "\n";
         }
+        out << "Indexes: " << indexes.size() << "\n";
+        return;
+    }
+
+    IndexMetaEntryPage existing;
+    bool exists = catalog_->GetEntryByField(query.index_field, existing);
+
+    if (query.statement == StatementType::DROP_INDEX) {
+        if (!exists) {
+            out << "Error: no index on " << query.index_field << "\n";
+        } else if (!catalog_->DropIndex(existing.index_id)) {
+            out << "Error: index #" << existing.index_id << " has a write buffer attached\n";
+        } else {
+            out << "Dropped index #" << existing.index_id << " on " << query.index_field << "\n";
+        }
+        return;
+    }
+
+    FieldType field_type;
+    IndexType index_type;
+    if (exists) {
+        out << "Error: " << query.index_field << " already has index #" << existing.index_id << "\n";
+        return;
+    }
+    if (!IndexableField(query.index_field, field_type, index_type)) {
+        out << "Error: cannot index " << query.index_field
+            << " (fields: timestamp, severity, message)\n";
+        return;
+    }
+    if (!query.index_using.empty() && query.index_using != IndexTypeName(index_type)) {
+        out << "Error: " << query.index_field << " takes a " << IndexTypeName(index_type)
+            << " index\n";
+        return;
+    }
+
+    IndexID index_id = catalog_->NextIndexId();
+    PageID root = index_type == IndexType::BTREE ? NewLeafRoot(bpm_) : NewTrieRoot(bpm_);
+    IndexMetaEntryPage meta;
+    if (!catalog_->RegisterIndex(index_id, query.index_field, field_type, index_type, root) ||
+        !catalog_->GetEntry(index_id, meta)) {
+        out << "Error: the catalog is full (" << MAX_INDEXES << " indexes)\n";
+        return;
     }
 
-    else if (meta->index_type == IndexType::TRIE) {
-        TrieIndex trie(meta->root_page_id, bpm_);
+    // the log the other indexes cover; ingest carries on from there
+    uint64_t records = BackfillIndex(meta, catalog_->GetIngestedBytes());
+    catalog_->EnableBloomFilter(index_id);
 
-        if (query.op == QueryOp::EQUALS) {
-            trie.ExactSearch(query.str_value, results);
-        } else if (query.op == QueryOp::STARTSWITH) {
-            trie.PrefixSearch(query.str_value, results);
+    out << "Created index #" << index_id << " on " << query.index_field << " ("
+        << IndexTypeName(index_type) << "), " << records << " records indexed\n";
+}
+
+uint64_t QueryExecutor::BackfillIndex(const IndexMetaEntryPage &meta, uint64_t covered) {
+    constexpr size_t BATCH = 4096;
+    const std::string field = meta.field_name;
+
+    BPlusTree tree(meta.root_page_id, meta.index_id, catalog_, bpm_);
+    TrieIndex trie(meta.root_page_id, bpm_, meta.stats_page_id, nullptr, meta.index_id);
+    std::vector<std::pair<KeyType, RecordRef>> keys;
+    std::vector<std::pair<std::string, RecordRef>> strings;
+
+    auto flush = [&] {
+        if (!keys.empty()) tree.InsertBatch(keys);
+        if (!strings.empty()) trie.InsertBatch(strings);
+        keys.clear();
+        strings.clear();
+    };
+
+    uint64_t records = 0;
+    reader_->Scan([&](RecordRef ref, const std::string &line) {
+        LogRecord record;
+        if (ref.offset >= covered || !ParseLogRecord(line, record)) {
+            return;
+        }
+        if (meta.index_type == IndexType::BTREE) {
+            keys.emplace_back(record.timestamp, ref);
+        } else {
+            strings.emplace_back(field == "severity" ? record.severity : record.message, ref);
+        }
+        records++;
+        if (keys.size() + strings.size() >= BATCH) {
+            flush();
         }
+    });
+    flush();
+    return records;
+}
+
+void QueryExecutor::Execute(const Query &query, std::ostream &out) {
+    if (query.statement != StatementType::SELECT) {
+        ExecuteIndexStatement(query, out);
+        return;
+    }
+
+    // the query reads a snapshot, so ingest does not wait for it nor it
+    // for ingest; write buffers are not in snapshots, so with one attached
+    // the latch is held to the end
+    std::shared_lock<std::shared_mutex> guard(catalog_->IndexLatch());
+    PageSnapshot snapshot = catalog_->OpenSnapshot();
+    SnapshotScope scope(&snapshot);
+    if (!catalog_->HasWriteBuffers()) {
+        guard.unlock();
     }
 
-    bpm_->UnpinPage(meta_pid, false);
+    if (query.explain && !query.analyze) {
+        // planners keep per-query state: one per call keeps Execute reentrant
+        QueryPlanner planner(bpm_, catalog_, reader_);
+        out << planner.Plan(query).Explain(query);
+        return;
+    }
 
-    // Output records
-    for (auto &ref : results) {
-        std::cout << reader_->Read(ref) << "\n";
+    QueryPlan plan;
+    if (!query.analyze && slow_query_dir_.empty()) {
+        Run(query, out, nullptr, plan);
+        return;
     }
 
-    std::cout << "Total results: " << results.size() << "\n";
+    QueryProfile profile;
+    if (query.analyze) {
+        // results are counted, not printed
+        std::ostream discard(nullptr);
+        Run(query, discard, &profile, plan);
+        out << plan.Explain(query) << "Execution:\n" << profile.Describe();
+    } else {
+        Run(query, out, &profile, plan);
+    }
+
+    if (!slow_query_dir_.empty() && profile.TotalNanos() >= slow_query_nanos_) {
+        WriteSlowQueryTrace(query, profile);
+    }
 }
 
-} // namespace cmse
+void QueryExecutor::WriteSlowQueryTrace(const Query &query, const QueryProfile &profile) {
+    uint64_t seq = slow_query_seq_.fetch_add(1, std::memory_order_relaxed);
+    std::error_code ec;
+    std::filesystem::create_directories(slow_query_dir_, ec);
+
+    // wall-clock prefix: traces from earlier runs are not overwritten
+    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string path = slow_query_dir_ + "/slow-query-" + std::to_string(now_ms) + "-" +
+                       std::to_string(seq) + ".json";
+    std::ofstream file(path, std::ios::trunc);
+    file << profile.ChromeTrace(QueryToString(query));
+    if (!file) {
+        std::cerr << "cannot write slow query trace " << path << std::endl;
+    }
+}
 
+void QueryExecutor::Run(const Query &query, std::ostream &out, QueryProfile *profile,
+                        QueryPlan &plan) {
+    ProfileScope execute(profile, "execute");
+
+    {
+        ProfileScope stage(profile, "plan");
+        // planners keep per-query state: one per call keeps Execute reentrant
+        QueryPlanner planner(bpm_, catalog_, reader_);
+        plan = planner.Plan(query);
+    }
+
+    // EXPLAIN ANALYZE keeps scans on this thread so that every page is
+    // counted in its stage
+    const bool parallel = pool_ != nullptr && !query.analyze;
+
+    // AggregateOp and the QUERY_* histograms are in the same order
+    CountMetric(Counter::QUERIES);
+    LatencyTimer timer(static_cast<Histogram>(static_cast<uint32_t>(Histogram::QUERY_SELECT) +
+                                              static_cast<uint32_t>(query.aggregate)));
+
+    if (plan.type == PlanType::INDEX_AGGREGATE) {
+        const AccessPath &path = plan.paths[0];
+        ProfileScope stage(profile, "index aggregate",
+                           profile != nullptr
+                               ? DescribePath(path, query.predicates[path.predicate_idx])
+                               : std::string());
+        ExecuteIndexAggregate(query, plan, out);
+        return;
+    }
+
+    size_t total = 0;
+
+    // aggregates over matching records (timestamp field)
+    const Predicate *group_range = GroupRange(query);
+    std::vector<uint64_t> groups;
+    KeyType min_ts = 0;
+    KeyType max_ts = 0;
+
+    auto emit_if_match = [&](const std::string &line) {
+        LogRecord record;
+        if (!plan.residual.empty() || query.aggregate != AggregateOp::NONE) {
+            if (!ParseLogRecord(line, record)) {
+                return;
+            }
+            for (size_t idx : plan.residual) {
+                if (!MatchesPredicate(record, query.predicates[idx])) {
+                    return;
+                }
+            }
+        }
+
+        if (query.aggregate == AggregateOp::NONE) {
+            out << line << "\n";
+        } else {
+            if (total == 0 || record.timestamp < min_ts) min_ts = record.timestamp;
+            if (total == 0 || record.timestamp > max_ts) max_ts = record.timestamp;
+
+            if (query.group_by_width > 0 && group_range != nullptr &&
+                record.timestamp >= group_range->low && record.timestamp <= group_range->high) {
+                size_t bucket = (record.timestamp - group_range->low) / query.group_by_width;
+                if (bucket >= groups.size()) groups.resize(bucket + 1, 0);
+                groups[bucket]++;
+            }
+        }
+        total++;
+    };
+
+    if (plan.type == PlanType::FULL_SCAN) {
+        ProfileScope stage(profile, "full scan",
+                           profile != nullptr ? DescribeResidual(query, plan) : std::string());
+        reader_->Scan([&](RecordRef, const std::string &line) {
+            emit_if_match(line);
+        });
+        stage.SetRows(total);
+    } else {
+        auto by_offset = [](const RecordRef &a, const RecordRef &b) {
+            return a.offset < b.offset;
+        };
+
+        auto probe = [&](const AccessPath &path, std::vector<RecordRef> &refs) {
+            const Predicate &pred = query.predicates[path.predicate_idx];
+            ProfileScope stage(profile, "probe",
+                               profile != nullptr ? DescribePath(path, pred) : std::string());
+            RunAccessPath(path, pred, refs, parallel);
+            stage.SetRows(refs.size());
+            if (parallel && pred.op != QueryOp::EQUALS) {
+                stage.SetParallel();
+            }
+        };
+
+        std::vector<RecordRef> results;
+        probe(plan.paths[0], results);
+
+        // intersect RecordRef sets on offset
+        if (plan.paths.size() > 1) {
+            {
+                ProfileScope stage(profile, "sort");
+                std::sort(results.begin(), results.end(), by_offset);
+            }
+
+            for (size_t i = 1; i < plan.paths.size() && !results.empty(); i++) {
+                std::vector<RecordRef> other;
+                probe(plan.paths[i], other);
+
+                ProfileScope stage(profile, "intersect");
+                std::sort(other.begin(), other.end(), by_offset);
+
+                std::vector<RecordRef> merged;
+                std::set_intersection(results.begin(), results.end(),
+                                      other.begin(), other.end(),
+                                      std::back_inserter(merged), by_offset);
+                results.swap(merged);
+                stage.SetRows(results.size());
+            }
+        }
+
+        // Output records
+        ProfileScope stage(profile, "fetch records",
+                           profile != nullptr ? DescribeResidual(query, plan) : std::string());
+        for (auto &ref : results) {
+            emit_if_match(reader_->Read(ref));
+        }
+        stage.SetRows(total);
+    }
+    execute.SetRows(total);
+
+    switch (query.aggregate) {
+        case AggregateOp::NONE:
+            out << "Total results: " << total << "\n";
+            break;
+        case AggregateOp::COUNT:
+            if (query.group_by_width > 0 && group_range != nullptr) {
+                // include empty trailing buckets up to high
+                size_t buckets = (group_range->high - group_range->low) / query.group_by_width + 1;
+                if (group_range->high >= group_range->low && groups.size() < buckets) {
+                    groups.resize(buckets, 0);
+                }
+                PrintGroups(out, group_range->low, query.group_by_width, groups);
+            }
+            out << "COUNT: " << total << "\n";
+            break;
+        case AggregateOp::MIN:
+            PrintMinMax(out, query.aggregate, total > 0, min_ts);
+            break;
+        case AggregateOp::MAX:
+            PrintMinMax(out, query.aggregate, total > 0, max_ts);
+            break;
+    }
+}
+
+} // namespace cmse
@@ -3,50 +3,147 @@
 
 namespace cmse {
 
-bool QueryParser::Parse(const std::string &q, Query &out) {
-    std::istringstream ss(q);
-    std::string where, field, op;
+namespace {
+
+// Read a "quoted value" (may contain spaces). Leaves the stream after
+// the closing quote.
+bool ReadQuoted(std::istringstream &ss, std::string &out) {
+    ss >> std::ws;
+    if (ss.peek() != '"') return false;
+    ss.get();
 
-    ss >> where >> field >> op;
+    out.clear();
+    char c;
+    while (ss.get(c)) {
+        if (c == '"') return true;
+        out.push_back(c);
+    }
+    return false; // unterminated
+}
 
-    if (where != "WHERE") return false;
+bool ParsePredicate(std::istringstream &ss, Predicate &out) {
+    std::string field, op;
+    ss >> field >> op;
 
+    if (field.empty()) return false;
     out.field_name = field;
 
     if (op == "EQUALS") {
-        std::string value;
-        ss >> value;
+        ss >> std::ws;
+        out.op = QueryOp::EQUALS;
 
-        if (value.front() == '"') {
+        if (ss.peek() == '"') {
             // string equals
-            out.op = QueryOp::EQUALS;
-            out.str_value = value.substr(1, value.size() - 2);
-        } else {
-            // numeric equals
-            out.op = QueryOp::EQUALS;
-            out.num_value = std::stoull(value);
+            out.is_string = true;
+            return ReadQuoted(ss, out.str_value);
         }
+
+        // numeric equals
+        if (!(ss >> out.num_value)) return false;
         return true;
     }
 
     if (op == "BETWEEN") {
-        ss >> out.low;
-        ss.ignore(1); // comma
-        ss >> out.high;
+        if (!(ss >> out.low)) return false;
+        ss >> std::ws;
+        if (ss.peek() == ',') ss.ignore(1); // comma
+        if (!(ss >> out.high)) return false;
         out.op = QueryOp::BETWEEN;
         return true;
     }
 
     if (op == "STARTSWITH") {
-        std::string value;
-        ss >> value;
         out.op = QueryOp::STARTSWITH;
-        out.str_value = value.substr(1, value.size() - 2);
-        return true;
+        out.is_string = true;
+        return ReadQuoted(ss, out.str_value);
     }
 
     return false;
 }
 
-} // namespace cmse
+// CREATE INDEX ON <field> [USING <type>] | DROP INDEX ON <field> | SHOW INDEXES
+bool ParseIndexStatement(std::istringstream &ss, const std::string &verb, Query &out) {
+    std::string word;
+    if (verb == "SHOW") {
+        out.statement = StatementType::SHOW_INDEXES;
+        return (ss >> word) && word == "INDEXES" && !(ss >> word);
+    }
+
+    out.statement = verb == "CREATE" ? StatementType::CREATE_INDEX : StatementType::DROP_INDEX;
+    if (!(ss >> word) || word != "INDEX") return false;
+    if (!(ss >> word) || word != "ON") return false;
+    if (!(ss >> out.index_field)) return false;
 
+    if (!(ss >> word)) return true;
+    if (word != "USING" || out.statement != StatementType::CREATE_INDEX) return false;
+    if (!(ss >> out.index_using)) return false;
+    if (out.index_using != "BTREE" && out.index_using != "TRIE") return false;
+    return !(ss >> word); // trailing input
+}
+
+} // namespace
+
+bool QueryParser::Parse(const std::string &q, Query &out) {
+    std::istringstream ss(q);
+    std::string word;
+
+    out = Query{};
+
+    ss >> word;
+
+    if (word == "CREATE" || word == "DROP" || word == "SHOW") {
+        return ParseIndexStatement(ss, word, out);
+    }
+
+    if (word == "EXPLAIN") {
+        out.explain = true;
+        ss >> word;
+        if (word == "ANALYZE") {
+            out.analyze = true;
+            ss >> word;
+        }
+    }
+
+    if (word == "COUNT") {
+        out.aggregate = AggregateOp::COUNT;
+        ss >> word;
+    } else if (word == "MIN") {
+        out.aggregate = AggregateOp::MIN;
+        ss >> word;
+    } else if (word == "MAX") {
+        out.aggregate = AggregateOp::MAX;
+        ss >> word;
+    }
+
+    if (word != "WHERE") return false;
+
+    // <pred> [AND <pred>]*
+    while (true) {
+        Predicate pred;
+        if (!ParsePredicate(ss, pred)) return false;
+        out.predicates.push_back(pred);
+
+        if (!(ss >> word)) break;
+        if (word == "GROUP") break;
+        if (word != "AND") return false;
+    }
+
+    // GROUP BY <width>: buckets over the BETWEEN range, COUNT only
+    if (word == "GROUP") {
+        ss >> word;
+        if (word != "BY" || out.aggregate != AggregateOp::COUNT) return false;
+        if (!(ss >> out.group_by_width) || out.group_by_width == 0) return false;
+
+        bool has_range = false;
+        for (const auto &pred : out.predicates) {
+            has_range = has_range || pred.op == QueryOp::BETWEEN;
+        }
+        if (!has_range) return false;
+
+        if (ss >> word) return false; // trailing input
+    }
+
+    return !out.predicates.empty();
+}
+
+} // namespace cmse
@@ -0,0 +1,341 @@
+#include "../../include/query/query_planner.h"
+#include "../../include/index/btree/bplus_tree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace cmse {
+
+namespace {
+
+bool IndexSupports(IndexType type, const Predicate &pred) {
+    if (type == IndexType::BTREE) {
+        return (pred.op == QueryOp::EQUALS && !pred.is_string) ||
+               pred.op == QueryOp::BETWEEN;
+    }
+    if (type == IndexType::TRIE) {
+        return (pred.op == QueryOp::EQUALS && pred.is_string) ||
+               pred.op == QueryOp::STARTSWITH;
+    }
+    return false;
+}
+
+const char *PlanTypeName(PlanType type) {
+    switch (type) {
+        case PlanType::FULL_SCAN: return "FULL SCAN";
+        case PlanType::INDEX_SCAN: return "INDEX SCAN";
+        case PlanType::INDEX_INTERSECTION: return "INDEX INTERSECTION";
+        case PlanType::INDEX_AGGREGATE: return "INDEX-ONLY AGGREGATE";
+    }
+    return "?";
+}
+
+const char *AggregateName(AggregateOp op) {
+    switch (op) {
+        case AggregateOp::NONE: return "";
+        case AggregateOp::COUNT: return "COUNT";
+        case AggregateOp::MIN: return "MIN";
+        case AggregateOp::MAX: return "MAX";
+    }
+    return "?";
+}
+
+} // namespace
+
+std::string PredicateToString(const Predicate &pred) {
+    std::ostringstream out;
+    out << pred.field_name;
+
+    switch (pred.op) {
+        case QueryOp::EQUALS:
+            out << " EQUALS ";
+            if (pred.is_string) {
+                out << '"' << pred.str_value << '"';
+            } else {
+                out << pred.num_value;
+            }
+            break;
+        case QueryOp::BETWEEN:
+            out << " BETWEEN " << pred.low << "," << pred.high;
+            break;
+        case QueryOp::STARTSWITH:
+            out << " STARTSWITH \"" << pred.str_value << '"';
+            break;
+    }
+    return out.str();
+}
+
+std::string QueryToString(const Query &query) {
+    std::ostringstream out;
+    if (query.aggregate != AggregateOp::NONE) {
+        out << AggregateName(query.aggregate) << " ";
+    }
+    out << "WHERE ";
+    for (size_t i = 0; i < query.predicates.size(); i++) {
+        out << (i > 0 ? " AND " : "") << PredicateToString(query.predicates[i]);
+    }
+    if (query.group_by_width > 0) {
+        out << " GROUP BY " << query.group_by_width;
+    }
+    return out.str();
+}
+
+std::string QueryPlan::Explain(const Query &query) const {
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(2);
+
+    if (query.aggregate != AggregateOp::NONE) {
+        out << "-> AGGREGATE " << AggregateName(query.aggregate);
+        if (query.group_by_width > 0) {
+            out << " GROUP BY " << query.group_by_width;
+        }
+        out << "\n";
+    }
+
+    out << "-> " << PlanTypeName(type)
+        << " (cost=" << cost
+        << " rows=" << est_rows
+        << " of " << table_rows << ")\n";
+
+    for (const auto &path : paths) {
+        out << "   -> INDEX "
+            << (path.index_type == IndexType::BTREE ? "BTREE" : "TRIE")
+            << " #" << path.index_id
+            << " " << PredicateToString(query.predicates[path.predicate_idx])
+            << " (sel=" << path.selectivity
+            << " rows=" << path.est_rows
+            << " cost=" << path.cost << ")\n";
+    }
+
+    for (size_t idx : residual) {
+        out << "   -> FILTER " << PredicateToString(query.predicates[idx]) << "\n";
+    }
+
+    return out.str();
+}
+
+QueryPlanner::QueryPlanner(BufferPoolManager *bpm, IndexCatalog *catalog, RefReader *reader)
+    : bpm_(bpm), catalog_(catalog), reader_(reader) {}
+
+bool QueryPlanner::BuildAccessPath(const Predicate &pred, size_t predicate_idx, AccessPath &path) {
+    IndexMetaEntryPage meta;
+    if (!catalog_->GetEntryByField(pred.field_name, meta)) {
+        return false;
+    }
+
+    path.predicate_idx = predicate_idx;
+    path.index_id = meta.index_id;
+    path.index_type = meta.index_type;
+    path.root_page_id = meta.root_page_id;
+
+    return path.root_page_id != INVALID_PAGE_ID &&
+           IndexSupports(path.index_type, pred);
+}
+
+void QueryPlanner::EstimateBTree(const Predicate &pred, AccessPath &path) {
+    BPlusTree tree(path.root_page_id, path.index_id, catalog_, bpm_);
+
+    BPlusTreeStats stats;
+    tree.GetStats(stats);
+
+    double total = static_cast<double>(stats.total_keys);
+    double rows = 0.0;
+
+    IndexStatsPage index_stats;
+    bool has_histogram =
+        catalog_->GetIndexStats(path.index_id, index_stats) &&
+        index_stats.bucket_count > 0;
+
+    if (has_histogram) {
+        // equi-depth histogram: robust to skew (bursts of timestamps)
+        if (pred.op == QueryOp::EQUALS) {
+            rows = EstimateEqualCount(&index_stats, pred.num_value);
+        } else if (pred.op == QueryOp::BETWEEN) {
+            rows = EstimateRangeCount(&index_stats, pred.low, pred.high);
+        }
+        total = std::max(total, static_cast<double>(index_stats.total_count));
+    } else if (stats.total_keys > 0) {
+        // uniform distribution over [min_key, max_key]
+        double span = static_cast<double>(stats.max_key - stats.min_key) + 1.0;
+
+        if (pred.op == QueryOp::EQUALS) {
+            if (pred.num_value >= stats.min_key && pred.num_value <= stats.max_key) {
+                double distinct = std::min(total, span);
+                rows = total / distinct;
+            }
+        } else if (pred.op == QueryOp::BETWEEN) {
+            KeyType low = std::max<KeyType>(pred.low, stats.min_key);
+            KeyType high = std::min<KeyType>(pred.high, stats.max_key);
+            if (low <= high) {
+                double covered = static_cast<double>(high - low) + 1.0;
+                rows = std::max(1.0, total * covered / span);
+            }
+        }
+    }
+
+    table_rows_ = std::max(table_rows_, total);
+
+    double keys_per_leaf =
+        static_cast<double>(bpm_->GetOptions().btree_leaf_max_keys) * PLANNER_BTREE_LEAF_FILL;
+    double leaf_pages = std::ceil(rows / keys_per_leaf);
+
+    path.est_rows = rows;
+    path.descent_cost = stats.height * PLANNER_RANDOM_PAGE_COST;
+    path.cost = path.descent_cost + leaf_pages * PLANNER_RANDOM_PAGE_COST;
+}
+
+void QueryPlanner::EstimateTrie(const Predicate &pred, AccessPath &path) {
+    double depth = static_cast<double>(pred.str_value.size()) + 1.0;
+
+    // distinct-count sketch: an equality matches 1/ndv of the entries
+    IndexStatsPage index_stats;
+    double distinct = 0.0;
+    if (catalog_->GetIndexStats(path.index_id, index_stats) &&
+        index_stats.total_count > 0) {
+        distinct = std::max(1.0, EstimateDistinctKeys(&index_stats));
+        table_rows_ = std::max(table_rows_, static_cast<double>(index_stats.total_count));
+    }
+
+    if (pred.op == QueryOp::EQUALS) {
+        path.selectivity = distinct > 0.0 ? 1.0 / distinct : PLANNER_DEFAULT_EQ_SELECTIVITY;
+        path.descent_cost = depth * PLANNER_RANDOM_PAGE_COST;
+        path.cost = path.descent_cost;
+    } else {
+        // shorter prefixes match (much) more
+        path.selectivity = std::max(PLANNER_DEFAULT_EQ_SELECTIVITY,
+                                    PLANNER_DEFAULT_PREFIX_SELECTIVITY /
+                                        static_cast<double>(std::max<size_t>(1, pred.str_value.size())));
+        path.descent_cost = depth * PLANNER_RANDOM_PAGE_COST;
+        path.cost = path.descent_cost;
+    }
+}
+
+QueryPlan QueryPlanner::Plan(const Query &query) {
+    QueryPlan best;
+
+    double log_bytes = reader_ ? static_cast<double>(reader_->Size()) : 0.0;
+    table_rows_ = log_bytes / PLANNER_AVG_RECORD_BYTES;
+
+    // 1. access paths for every indexed predicate
+    std::vector<AccessPath> paths;
+
+    for (size_t i = 0; i < query.predicates.size(); i++) {
+        AccessPath path{};
+        if (!BuildAccessPath(query.predicates[i], i, path)) {
+            continue;
+        }
+
+        if (path.index_type == IndexType::BTREE) {
+            EstimateBTree(query.predicates[i], path);
+        } else {
+            EstimateTrie(query.predicates[i], path);
+        }
+
+        paths.push_back(path);
+    }
+
+    table_rows_ = std::max(table_rows_, 1.0);
+
+    // 2. convert between rows and selectivity now that the table size is known
+    for (auto &path : paths) {
+        if (path.index_type == IndexType::BTREE) {
+            path.selectivity = std::min(1.0, path.est_rows / table_rows_);
+        } else {
+            path.est_rows = path.selectivity * table_rows_;
+            if (query.predicates[path.predicate_idx].op == QueryOp::STARTSWITH) {
+                path.cost += path.est_rows * PLANNER_TRIE_PAGES_PER_MATCH *
+                             PLANNER_RANDOM_PAGE_COST;
+            }
+        }
+    }
+
+    double residual_count = static_cast<double>(query.predicates.size());
+
+    // 3. full scan: always possible
+    best.type = PlanType::FULL_SCAN;
+    best.table_rows = table_rows_;
+    best.est_rows = table_rows_;
+    for (const auto &path : paths) {
+        best.est_rows *= path.selectivity;
+    }
+    best.cost = std::ceil(log_bytes / PAGE_SIZE) * PLANNER_SEQ_PAGE_COST +
+                table_rows_ * residual_count * PLANNER_CPU_RECORD_COST;
+    for (size_t i = 0; i < query.predicates.size(); i++) {
+        best.residual.push_back(i);
+    }
+
+    if (paths.empty()) {
+        return best;
+    }
+
+    // 4a. a single B+Tree predicate under an aggregate never needs the
+    //     log: counts come from child_counts, MIN/MAX from boundary leaves
+    if (query.aggregate != AggregateOp::NONE && query.predicates.size() == 1 &&
+        paths[0].index_type == IndexType::BTREE) {
+        const Predicate &pred = query.predicates[0];
+
+        double groups = 1.0;
+        if (query.group_by_width > 0 && pred.op == QueryOp::BETWEEN && pred.high >= pred.low) {
+            groups = std::ceil((static_cast<double>(pred.high - pred.low) + 1.0) /
+                               static_cast<double>(query.group_by_width));
+        }
+
+        best.type = PlanType::INDEX_AGGREGATE;
+        best.paths = paths;
+        best.residual.clear();
+        best.est_rows = paths[0].est_rows;
+        // two boundary descents per group
+        best.cost = groups * 2.0 * paths[0].descent_cost;
+        return best;
+    }
+
+    // 4b. greedily intersect the most selective paths first
+    std::sort(paths.begin(), paths.end(),
+              [](const AccessPath &a, const AccessPath &b) {
+                  return a.est_rows < b.est_rows;
+              });
+
+    double index_cost = 0.0;
+    double merged_refs = 0.0;
+    double selectivity = 1.0;
+
+    for (size_t n = 1; n <= paths.size(); n++) {
+        const AccessPath &path = paths[n - 1];
+
+        index_cost += path.cost;
+        merged_refs += path.est_rows;
+        selectivity *= path.selectivity;
+
+        double rows = table_rows_ * selectivity;
+        double residuals = residual_count - static_cast<double>(n);
+
+        double cost = index_cost +
+                      rows * PLANNER_RECORD_FETCH_COST +
+                      rows * residuals * PLANNER_CPU_RECORD_COST;
+        if (n > 1) {
+            cost += merged_refs * PLANNER_CPU_RECORD_COST;   // sort + merge
+        }
+
+        if (cost < best.cost) {
+            best.type = (n == 1) ? PlanType::INDEX_SCAN : PlanType::INDEX_INTERSECTION;
+            best.paths.assign(paths.begin(), paths.begin() + n);
+            best.est_rows = rows;
+            best.cost = cost;
+
+            best.residual.clear();
+            for (size_t i = 0; i < query.predicates.size(); i++) {
+                bool used = false;
+                for (const auto &p : best.paths) {
+                    used = used || (p.predicate_idx == i);
+                }
+                if (!used) best.residual.push_back(i);
+            }
+        }
+    }
+
+    return best;
+}
+
+} // namespace cmse
@@ -0,0 +1,164 @@
+#include "../../include/query/query_profile.h"
+#include "../../include/common/metrics.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace cmse {
+
+namespace {
+
+uint64_t Load(const std::atomic<uint64_t> &cell) {
+    return cell.load(std::memory_order_relaxed);
+}
+
+std::string FormatBytes(uint64_t bytes) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    if (bytes < 1024) {
+        out << bytes << " B";
+    } else if (bytes < 1024 * 1024) {
+        out << static_cast<double>(bytes) / 1024 << " KiB";
+    } else {
+        out << static_cast<double>(bytes) / (1024 * 1024) << " MiB";
+    }
+    return out.str();
+}
+
+std::string JsonEscape(const std::string &s) {
+    std::ostringstream out;
+    for (char c : s) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                        << static_cast<int>(c) << std::dec << std::setfill(' ');
+                } else {
+                    out << c;
+                }
+        }
+    }
+    return out.str();
+}
+
+} // namespace
+
+QueryProfile::QueryProfile() : origin_(std::chrono::steady_clock::now()) {}
+
+QueryProfile::Counts QueryProfile::Sample() {
+    const MetricsRegistry::Shard &shard = MetricsRegistry::Local();
+    Counts counts{};
+    counts.hits = Load(shard.counters[static_cast<size_t>(Counter::BUFFER_POOL_HITS)]);
+    counts.misses = Load(shard.counters[static_cast<size_t>(Counter::BUFFER_POOL_MISSES)]);
+    counts.disk_bytes = Load(shard.counters[static_cast<size_t>(Counter::DISK_READ_BYTES)]);
+    counts.log_bytes = Load(shard.counters[static_cast<size_t>(Counter::LOG_READ_BYTES)]);
+    for (IndexID id = 0; id <= METRICS_MAX_INDEX_ID; id++) {
+        counts.node_visits +=
+            Load(shard.index_counters[id][static_cast<size_t>(IndexCounter::NODE_VISITS)]);
+    }
+    return counts;
+}
+
+size_t QueryProfile::Begin(const std::string &name, const std::string &detail) {
+    ProfileStage stage;
+    stage.name = name;
+    stage.detail = detail;
+    stage.depth = open_.size();
+    stage.start_nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - origin_).count());
+
+    stages_.push_back(std::move(stage));
+    open_.push_back(stages_.size() - 1);
+    open_counts_.push_back(Sample());
+    return stages_.size() - 1;
+}
+
+void QueryProfile::End(size_t stage) {
+    // stages close innermost first (ProfileScope)
+    if (open_.empty() || open_.back() != stage) {
+        return;
+    }
+    Counts now = Sample();
+    const Counts &then = open_counts_.back();
+
+    ProfileStage &s = stages_[stage];
+    uint64_t end_nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - origin_).count());
+    s.elapsed_nanos = end_nanos - s.start_nanos;
+    s.pool_hits = now.hits - then.hits;
+    s.pool_misses = now.misses - then.misses;
+    s.disk_read_bytes = now.disk_bytes - then.disk_bytes;
+    s.node_visits = now.node_visits - then.node_visits;
+    s.log_read_bytes = now.log_bytes - then.log_bytes;
+
+    open_.pop_back();
+    open_counts_.pop_back();
+}
+
+uint64_t QueryProfile::TotalNanos() const {
+    return stages_.empty() ? 0 : stages_[0].elapsed_nanos;
+}
+
+std::string QueryProfile::Describe() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+
+    for (const ProfileStage &s : stages_) {
+        out << std::string(3 * s.depth, ' ') << "-> " << s.name;
+        if (!s.detail.empty()) {
+            out << " " << s.detail;
+        }
+        out << " (time=" << static_cast<double>(s.elapsed_nanos) / 1e6 << " ms"
+            << " rows=" << s.rows
+            << " pages=" << s.pool_hits + s.pool_misses
+            << " hit=" << s.pool_hits
+            << " read=" << s.pool_misses;
+        if (s.disk_read_bytes > 0) {
+            out << " disk=" << FormatBytes(s.disk_read_bytes);
+        }
+        out << " nodes=" << s.node_visits;
+        if (s.log_read_bytes > 0) {
+            out << " log=" << FormatBytes(s.log_read_bytes);
+        }
+        out << ")";
+        if (s.parallel) {
+            out << " [parallel: pages counted on this thread only]";
+        }
+        out << "\n";
+    }
+    return out.str();
+}
+
+std::string QueryProfile::ChromeTrace(const std::string &title) const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+
+    // "X" (complete) events; ts and dur in microseconds
+    out << "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < stages_.size(); i++) {
+        const ProfileStage &s = stages_[i];
+        out << "{\"name\":\"" << JsonEscape(s.name) << "\",\"cat\":\"query\",\"ph\":\"X\""
+            << ",\"ts\":" << static_cast<double>(s.start_nanos) / 1e3
+            << ",\"dur\":" << static_cast<double>(s.elapsed_nanos) / 1e3
+            << ",\"pid\":1,\"tid\":1,\"args\":{"
+            << "\"detail\":\"" << JsonEscape(s.detail) << "\""
+            << ",\"rows\":" << s.rows
+            << ",\"pool_hits\":" << s.pool_hits
+            << ",\"pool_misses\":" << s.pool_misses
+            << ",\"disk_read_bytes\":" << s.disk_read_bytes
+            << ",\"node_visits\":" << s.node_visits
+            << ",\"log_read_bytes\":" << s.log_read_bytes
+            << ",\"parallel\":" << (s.parallel ? "true" : "false") << "}}"
+            << (i + 1 < stages_.size() ? ",\n" : "\n");
+    }
+    out << "],\n\"displayTimeUnit\":\"ns\",\n"
+        << "\"otherData\":{\"query\":\"" << JsonEscape(title) << "\""
+        << ",\"total_ns\":" << TotalNanos() << "}}\n";
+    return out.str();
+}
+
+} // namespace cmse
@@ -1,6 +1,8 @@
 #include "../../include/query/ref_reader.h"
+#include "../../include/common/metrics.h"
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/stat.h>
 
 namespace cmse {
 
@@ -8,12 +10,70 @@ RefReader::RefReader(const std::string &file) {
     fd_ = open(file.c_str(), O_RDONLY);
 }
 
+RefReader::~RefReader() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
 std::string RefReader::Read(const RecordRef &ref) {
     char buffer[1024];
-    lseek(fd_, ref.offset, SEEK_SET);
-    ssize_t n = read(fd_, buffer, sizeof(buffer));
-    return std::string(buffer, n);
+    ssize_t n = pread(fd_, buffer, sizeof(buffer), static_cast<off_t>(ref.offset));
+    if (n <= 0) {
+        return std::string();
+    }
+    CountMetric(Counter::LOG_READ_BYTES, static_cast<uint64_t>(n));
+
+    // Cut at end of line
+    ssize_t len = 0;
+    while (len < n && buffer[len] != '\n') {
+        len++;
+    }
+    return std::string(buffer, len);
 }
 
-} // namespace cmse
+uint64_t RefReader::Size() const {
+    struct stat st;
+    if (fd_ < 0 || fstat(fd_, &st) != 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(st.st_size);
+}
+
+void RefReader::Scan(const std::function<void(RecordRef, const std::string &)> &fn) {
+    if (fd_ < 0) {
+        return;
+    }
+
+    char buffer[64 * 1024];
+    std::string line;
+    uint64_t file_offset = 0;    // offset of buffer[0]
+    uint64_t line_start = 0;     // offset of the line being assembled
 
+    while (true) {
+        ssize_t n = pread(fd_, buffer, sizeof(buffer), static_cast<off_t>(file_offset));
+        if (n <= 0) {
+            break;
+        }
+        CountMetric(Counter::LOG_READ_BYTES, static_cast<uint64_t>(n));
+
+        for (ssize_t i = 0; i < n; i++) {
+            if (buffer[i] == '\n') {
+                fn(RecordRef{line_start}, line);
+                line.clear();
+                line_start = file_offset + i + 1;
+            } else {
+                line.push_back(buffer[i]);
+            }
+        }
+
+        file_offset += static_cast<uint64_t>(n);
+    }
+
+    // last line without newline
+    if (!line.empty()) {
+        fn(RecordRef{line_start}, line);
+    }
+}
+
+} // namespace cmse
@@ -0,0 +1,356 @@
+#include "../../include/server/query_server.h"
+#include "../../include/common/metrics.h"
+#include "../../include/query/query_parser.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <streambuf>
+
+namespace cmse {
+
+namespace {
+
+constexpr size_t MAX_REQUEST_BYTES = 64 * 1024;
+constexpr size_t RESPONSE_CHUNK_BYTES = 16 * 1024;
+constexpr int SEND_TIMEOUT_MS = 30000;
+
+// Blocking write on a non-blocking socket; false once the peer is gone
+bool SendAll(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n > 0) {
+            data += n;
+            len -= static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd pfd{fd, POLLOUT, 0};
+            if (poll(&pfd, 1, SEND_TIMEOUT_MS) > 0) {
+                continue;
+            }
+        }
+        return false;
+    }
+    return true;
+}
+
+// ostream buffer that sends every RESPONSE_CHUNK_BYTES, so large results
+// reach the client while the query is still running
+class SocketStreamBuf : public std::streambuf {
+public:
+    SocketStreamBuf(int fd, std::atomic<bool> *broken) : fd_(fd), broken_(broken) {
+        setp(buffer_, buffer_ + sizeof(buffer_));
+    }
+
+    ~SocketStreamBuf() override { sync(); }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!Flush()) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override { return Flush() ? 0 : -1; }
+
+private:
+    bool Flush() {
+        size_t len = static_cast<size_t>(pptr() - pbase());
+        setp(buffer_, buffer_ + sizeof(buffer_));
+
+        if (broken_->load()) {
+            return false;
+        }
+        if (len > 0 && !SendAll(fd_, buffer_, len)) {
+            broken_->store(true);
+            return false;
+        }
+        return true;
+    }
+
+    int fd_;
+    std::atomic<bool> *broken_;
+    char buffer_[RESPONSE_CHUNK_BYTES];
+};
+
+} // namespace
+
+struct QueryServer::Connection {
+    explicit Connection(int socket_fd) : fd(socket_fd) {}
+    ~Connection() { close(fd); }
+
+    int fd;
+    std::string inbuf;               // event loop thread only
+
+    std::mutex mutex;
+    std::deque<std::string> pending; // request lines not yet answered
+    bool busy = false;               // a worker is draining pending
+
+    std::atomic<bool> broken{false}; // peer stopped reading
+};
+
+QueryServer::QueryServer(QueryExecutor *executor, ThreadPool *workers,
+                         const ServerOptions &options)
+    : executor_(executor), options_(options), inflight_(workers) {}
+
+QueryServer::~QueryServer() {
+    inflight_.Wait();
+    connections_.clear();
+
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        if (!options_.unix_path.empty()) {
+            unlink(options_.unix_path.c_str());
+        }
+    }
+    if (epoll_fd_ >= 0) close(epoll_fd_);
+    if (wake_fd_ >= 0) close(wake_fd_);
+}
+
+bool QueryServer::Start() {
+    if (options_.unix_path.empty()) {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) {
+            std::cerr << "socket: " << std::strerror(errno) << "\n";
+            return false;
+        }
+
+        int one = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(options_.port);
+        if (inet_pton(AF_INET, options_.bind_address.c_str(), &addr.sin_addr) != 1) {
+            std::cerr << "invalid bind address " << options_.bind_address << "\n";
+            return false;
+        }
+
+        if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+            std::cerr << "bind " << options_.bind_address << ":" << options_.port
+                      << ": " << std::strerror(errno) << "\n";
+            return false;
+        }
+    } else {
+        listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) {
+            std::cerr << "socket: " << std::strerror(errno) << "\n";
+            return false;
+        }
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (options_.unix_path.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "socket path too long: " << options_.unix_path << "\n";
+            return false;
+        }
+        std::strcpy(addr.sun_path, options_.unix_path.c_str());
+        unlink(options_.unix_path.c_str());
+
+        if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+            std::cerr << "bind " << options_.unix_path << ": " << std::strerror(errno) << "\n";
+            return false;
+        }
+    }
+
+    if (listen(listen_fd_, options_.backlog) != 0) {
+        std::cerr << "listen: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        std::cerr << "epoll: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+    ev.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+
+    return true;
+}
+
+void QueryServer::Stop() {
+    uint64_t one = 1;
+    if (wake_fd_ >= 0) {
+        ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+void QueryServer::Run() {
+    epoll_event events[64];
+
+    while (true) {
+        int n = epoll_wait(epoll_fd_, events, 64, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "epoll_wait: " << std::strerror(errno) << "\n";
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+
+            if (fd == wake_fd_) {
+                // drop idle connections; busy ones finish their requests
+                connections_.clear();
+                return;
+            }
+
+            if (fd == listen_fd_) {
+                Accept();
+                continue;
+            }
+
+            auto it = connections_.find(fd);
+            if (it != connections_.end()) {
+                std::shared_ptr<Connection> conn = it->second; // Close() erases it
+                ReadFrom(conn);
+            }
+        }
+    }
+}
+
+void QueryServer::Accept() {
+    while (true) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return; // EAGAIN: backlog drained
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close(fd);
+            continue;
+        }
+
+        connections_[fd] = std::make_shared<Connection>(fd);
+    }
+}
+
+void QueryServer::ReadFrom(const std::shared_ptr<Connection> &conn) {
+    char buffer[16 * 1024];
+    bool eof = false;
+
+    while (true) {
+        ssize_t n = read(conn->fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            conn->inbuf.append(buffer, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        eof = true;
+        break;
+    }
+
+    // complete lines become requests
+    std::deque<std::string> lines;
+    size_t start = 0;
+    size_t newline;
+    while ((newline = conn->inbuf.find('\n', start)) != std::string::npos) {
+        std::string line = conn->inbuf.substr(start, newline - start);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) lines.push_back(std::move(line));
+        start = newline + 1;
+    }
+    conn->inbuf.erase(0, start);
+
+    if (conn->inbuf.size() > MAX_REQUEST_BYTES) {
+        eof = true; // no newline in sight: drop the client
+    }
+
+    if (!lines.empty()) {
+        bool schedule = false;
+        {
+            std::lock_guard<std::mutex> guard(conn->mutex);
+            for (auto &line : lines) {
+                conn->pending.push_back(std::move(line));
+            }
+            if (!conn->busy) {
+                conn->busy = true;
+                schedule = true;
+            }
+        }
+
+        if (schedule) {
+            std::shared_ptr<Connection> ref = conn;
+            inflight_.Run([this, ref] { Serve(ref); });
+        }
+    }
+
+    // queued requests are still answered after a half-close
+    if (eof) {
+        Close(conn);
+    }
+}
+
+void QueryServer::Close(const std::shared_ptr<Connection> &conn) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn->fd, nullptr);
+    connections_.erase(conn->fd);
+}
+
+void QueryServer::Serve(const std::shared_ptr<Connection> &conn) {
+    while (true) {
+        std::string line;
+        {
+            std::lock_guard<std::mutex> guard(conn->mutex);
+            if (conn->pending.empty()) {
+                conn->busy = false;
+                return;
+            }
+            line = std::move(conn->pending.front());
+            conn->pending.pop_front();
+        }
+
+        if (conn->broken.load()) {
+            continue; // nobody is listening
+        }
+
+        SocketStreamBuf buf(conn->fd, &conn->broken);
+        std::ostream out(&buf);
+
+        Query query;
+        if (line == "STATS") {
+            out << MetricsRegistry::Global().Collect().Prometheus();
+        } else if (QueryParser::Parse(line, query)) {
+            executor_->Execute(query, out);
+        } else {
+            out << "ERROR invalid query\n";
+        }
+        out << "END\n";
+        out.flush();
+
+        queries_served_++;
+    }
+}
+
+} // namespace cmse
@@ -1,44 +1,182 @@
 #include "../../include/storage/buffer_pool_manager.h"
 
+#include <algorithm>
 #include <cstring>
 
+#include "../../include/common/metrics.h"
+
 namespace cmse {
 
-BufferPoolManager::BufferPoolManager(size_t pool_size)
-    : pool_size_(pool_size), disk_manager_(), replacer_() {
+namespace {
+
+StorageOptions DefaultOptions(size_t pool_size, DiskIoMode io_mode) {
+    StorageOptions options;
+    options.pool_pages = pool_size;
+    options.io_mode = io_mode;
+    return options;
+}
+
+// what the calling thread reads through (SnapshotScope) and writes in (BeginWrite)
+thread_local const PageSnapshot *tls_snapshot = nullptr;
+thread_local const BufferPoolManager *tls_writer = nullptr;
+
+// The calling thread's snapshot of bpm; writers always read the latest pages
+const PageSnapshot *SnapshotOf(const BufferPoolManager *bpm) {
+    if (tls_writer == bpm || tls_snapshot == nullptr || tls_snapshot->Pool() != bpm) {
+        return nullptr;
+    }
+    return tls_snapshot;
+}
+
+// fetch_counts_ stripe of the calling thread
+size_t ThreadFetchStripe() {
+    static std::atomic<size_t> next{0};
+    thread_local size_t stripe = next.fetch_add(1, std::memory_order_relaxed);
+    return stripe;
+}
+
+} // namespace
+
+PageSnapshot::~PageSnapshot() {
+    Release();
+}
+
+PageSnapshot::PageSnapshot(PageSnapshot &&other) noexcept
+    : bpm_(std::exchange(other.bpm_, nullptr)), slot_(other.slot_), epoch_(other.epoch_) {}
+
+PageSnapshot &PageSnapshot::operator=(PageSnapshot &&other) noexcept {
+    if (this != &other) {
+        Release();
+        bpm_ = std::exchange(other.bpm_, nullptr);
+        slot_ = other.slot_;
+        epoch_ = other.epoch_;
+    }
+    return *this;
+}
+
+void PageSnapshot::Release() {
+    if (bpm_ != nullptr) {
+        bpm_->CloseSnapshot(slot_);
+        bpm_ = nullptr;
+    }
+}
+
+const PageSnapshot *PageSnapshot::Current() {
+    return tls_snapshot;
+}
+
+SnapshotScope::SnapshotScope(const PageSnapshot *snapshot) : previous_(tls_snapshot) {
+    tls_snapshot = snapshot != nullptr && snapshot->Valid() ? snapshot : nullptr;
+}
+
+SnapshotScope::~SnapshotScope() {
+    tls_snapshot = previous_;
+}
+
+PageGuard::PageGuard(PageGuard &&other) noexcept
+    : bpm_(std::exchange(other.bpm_, nullptr)), page_(std::exchange(other.page_, nullptr)),
+      page_id_(other.page_id_), dirty_(other.dirty_) {}
+
+PageGuard &PageGuard::operator=(PageGuard &&other) noexcept {
+    if (this != &other) {
+        Drop();
+        bpm_ = std::exchange(other.bpm_, nullptr);
+        page_ = std::exchange(other.page_, nullptr);
+        page_id_ = other.page_id_;
+        dirty_ = other.dirty_;
+    }
+    return *this;
+}
+
+void PageGuard::Drop() {
+    if (page_ != nullptr) {
+        bpm_->UnpinPage(page_id_, dirty_);
+        bpm_ = nullptr;
+        page_ = nullptr;
+    }
+}
+
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskIoMode io_mode)
+    : BufferPoolManager(DefaultOptions(pool_size, io_mode)) {}
+
+BufferPoolManager::BufferPoolManager(const StorageOptions &options)
+    : options_(options),
+      pool_size_(options.pool_pages),
+      arena_(options.pool_pages, options.huge_pages, options.numa_partitions),
+      page_table_(options.pool_pages),
+      replacer_(),
+      disk_manager_(options),
+      hot_capacity_(std::min({options.hot_pages, options.pool_pages / 4, SWIZZLED_SLOTS})),
+      hot_frames_(new std::atomic<FrameID>[hot_capacity_]),
+      swip_arrays_(new std::atomic<SwipArray*>[options.pool_pages]),
+      swip_owners_(options.pool_pages) {
+    // The arena's memory is zero and untouched: each frame is first
+    // written (and so faulted in) by the thread that loads a page into it
     pages_ = new Page[pool_size_];
-    free_frames_.reserve(pool_size_);
     for (size_t i = 0; i < pool_size_; ++i) {
-        free_frames_.push_back(static_cast<FrameID>(i));
+        pages_[i].SetData(arena_.Frame(static_cast<FrameID>(i)));
+    }
+
+    // Page 0 is reserved for the index catalog directory; continue after
+    // whatever is already on disk.
+    next_page_id_ = std::max<PageID>(1, disk_manager_.GetNumPages());
+    free_frames_.resize(arena_.PartitionCount());
+    for (size_t i = 0; i < hot_capacity_; ++i) {
+        hot_frames_[i].store(INVALID_FRAME_ID, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < pool_size_; ++i) {
+        swip_arrays_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    for (size_t i = pool_size_; i-- > 0;) {
+        FrameID frame_id = static_cast<FrameID>(i);
+        free_frames_[arena_.PartitionOf(frame_id)].push_back(frame_id);
     }
 }
 
 BufferPoolManager::~BufferPoolManager() {
     FlushAllPages();
+    for (size_t i = 0; i < pool_size_; ++i) {
+        delete swip_arrays_[i].load(std::memory_order_relaxed);
+    }
     delete[] pages_;
 }
 
 FrameID BufferPoolManager::AllocateFrame() {
     FrameID frame_id = INVALID_FRAME_ID;
 
-    // 1. Try to get a free frame
-    if (!free_frames_.empty()) {
-        frame_id = free_frames_.back();
-        free_frames_.pop_back();
-        return frame_id;
+    // 1. Try to get a free frame, from the caller's NUMA node first
+    size_t home = arena_.CurrentPartition();
+    for (size_t n = 0; n < free_frames_.size(); ++n) {
+        auto& free_list = free_frames_[(home + n) % free_frames_.size()];
+        if (!free_list.empty()) {
+            frame_id = free_list.back();
+            free_list.pop_back();
+            return frame_id;
+        }
     }
 
-    // 2. No free frame -> evict using LRU
-    if (replacer_.Victim(&frame_id)) {
-        PageID old_page_id = pages_[frame_id].GetPageID();
+    // 2. No free frame -> evict using LRU. Resident frames stay in the
+    // replacer while pinned: skip those, and give frames hit since the
+    // last pass a second chance (so at most two passes)
+    for (size_t n = 2 * replacer_.Size(); n > 0 && replacer_.Victim(&frame_id); --n) {
+        Page &page = pages_[frame_id];
+        if (page.TakeReferenced() || !page.TryEvict()) {
+            replacer_.Unpin(frame_id);      // back in as most recently used
+            continue;
+        }
+
+        PageID old_page_id = page.GetPageID();
+        CountMetric(Counter::BUFFER_POOL_EVICTIONS);
 
         // Write back if dirty
-        if (pages_[frame_id].IsDirty()) {
-            disk_manager_.WritePage(old_page_id, pages_[frame_id].GetData());
+        if (page.IsDirty()) {
+            CountMetric(Counter::BUFFER_POOL_DIRTY_WRITEBACKS);
+            disk_manager_.WritePage(old_page_id, page.GetData());
         }
 
         // Remove old mapping
-        page_table_.erase(old_page_id);
+        page_table_.Erase(old_page_id);
+        UnswizzleFrame(frame_id);
 
         return frame_id;
     }
@@ -47,32 +185,196 @@ FrameID BufferPoolManager::AllocateFrame() {
     return INVALID_FRAME_ID;
 }
 
-Page* BufferPoolManager::FetchPage(PageID page_id) {
-    // Case 1: Page already in buffer pool
-    auto it = page_table_.find(page_id);
-    if (it != page_table_.end()) {
-        FrameID frame_id = it->second;
-        replacer_.Pin(frame_id);        // Remove from replacer if present
-        pages_[frame_id].Pin();
-        return &pages_[frame_id];
+bool BufferPoolManager::ReadsLatest(const Page& page, PageID page_id,
+                                    const PageSnapshot* snapshot) const {
+    if (page.GetPageID() != page_id) {
+        return false;                   // evicted and reused since the lookup
+    }
+    uint64_t version_epoch = page.GetVersionEpoch();
+    if (snapshot == nullptr) {
+        return version_epoch != Page::OLD_VERSION;
     }
+    return version_epoch <= snapshot->Epoch();
+}
 
-    // Case 2: Page not in pool -> allocate frame and load from disk
-    FrameID frame_id = AllocateFrame();
+FrameID BufferPoolManager::ResidentFrame(PageID page_id) const {
+    if (!IsSwizzled(page_id)) {
+        return page_table_.Find(page_id);
+    }
+    size_t slot = static_cast<size_t>((page_id & ~(SWIZZLED | SWIZZLED_FRAME)) >> SWIZZLED_SLOT_SHIFT);
+    if (page_id & SWIZZLED_FRAME) {
+        return slot < pool_size_ ? static_cast<FrameID>(slot) : INVALID_FRAME_ID;
+    }
+    if (slot >= hot_capacity_) {
+        return INVALID_FRAME_ID;
+    }
+    return hot_frames_[slot].load(std::memory_order_acquire);
+}
+
+void BufferPoolManager::CountFetch() {
+    fetch_counts_[ThreadFetchStripe() % FETCH_COUNT_STRIPES].count.fetch_add(1, std::memory_order_relaxed);
+}
+
+Page* BufferPoolManager::TryFetchResident(PageID page_id, FrameID frame_id,
+                                          const PageSnapshot* snapshot) {
     if (frame_id == INVALID_FRAME_ID) {
         return nullptr;
     }
 
+    Page &page = pages_[frame_id];
+    if (!page.TryPin()) {
+        return nullptr;
+    }
+    if (!ReadsLatest(page, page_id, snapshot)) {
+        if (page.Unpin() == 0 && page.GetVersionEpoch() == Page::OLD_VERSION) {
+            ReleaseUnpinnedVersion(page.GetPageID(), frame_id);
+        }
+        return nullptr;
+    }
+    page.SetReferenced();
+    return &page;
+}
+
+bool BufferPoolManager::TryUnpinResident(PageID page_id, FrameID frame_id,
+                                         const PageSnapshot* snapshot) {
+    if (frame_id == INVALID_FRAME_ID) {
+        return false;
+    }
+
+    // the frame the caller pinned, held in place by that pin; a frame a
+    // write epoch has moved the page away from is resolved under the latch
+    Page &page = pages_[frame_id];
+    if (!ReadsLatest(page, page_id, snapshot) || page.GetPinCount() == 0) {
+        return false;
+    }
+    if (page.Unpin() == 0 && page.GetVersionEpoch() == Page::OLD_VERSION) {
+        ReleaseUnpinnedVersion(page_id, frame_id);
+    }
+    return true;
+}
+
+void BufferPoolManager::ReleaseUnpinnedVersion(PageID page_id, FrameID frame_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    auto chain = versions_.find(page_id);
+    if (chain == versions_.end()) {
+        return;
+    }
+    for (PageVersion &version : chain->second.versions) {
+        if (version.frame == frame_id && pages_[frame_id].GetPinCount() == 0) {
+            ReleaseVersionFrame(version);
+            return;
+        }
+    }
+}
+
+Page* BufferPoolManager::FetchPage(PageID page_id) {
+    const bool writer = tls_writer == this;
+    const PageSnapshot *snapshot = SnapshotOf(this);
+    CountFetch();
+
+    // Hit without the latch (a swizzled id names the frame itself); write
+    // epochs may have to save a version first
+    if (!writer) {
+        if (Page *page = TryFetchResident(Unswizzle(page_id), ResidentFrame(page_id), snapshot)) {
+            CountMetric(Counter::BUFFER_POOL_HITS);
+            if (IsSwizzled(page_id)) {
+                CountMetric(page_id & SWIZZLED_FRAME ? Counter::SWIZZLED_HITS : Counter::HOT_PAGE_HITS);
+            }
+            return page;
+        }
+    }
+    page_id = Unswizzle(page_id);
+
+    std::lock_guard<std::mutex> guard(latch_);
+
+    // Snapshot reader: the page as of its epoch if a write epoch changed it since
+    if (snapshot != nullptr) {
+        if (PageVersion *version = FindVersion(page_id, snapshot->Epoch())) {
+            if (version->frame == INVALID_FRAME_ID) {
+                FrameID frame_id = AllocateFrame();
+                if (frame_id == INVALID_FRAME_ID) {
+                    return nullptr;
+                }
+                pages_[frame_id].Reset();
+                std::memcpy(pages_[frame_id].GetData(), version->data.get(), PAGE_SIZE);
+                pages_[frame_id].SetPageID(page_id);
+                pages_[frame_id].SetVersionEpoch(Page::OLD_VERSION);
+                pages_[frame_id].MarkLoaded();
+                version->frame = frame_id;
+            }
+            pages_[version->frame].Pin();
+            CountMetric(Counter::BUFFER_POOL_HITS);
+            CountMetric(Counter::PAGE_VERSION_READS);
+            return &pages_[version->frame];
+        }
+    }
+
+    FrameID frame_id = page_table_.Find(page_id);
+    if (frame_id != INVALID_FRAME_ID) {
+        // Case 1: Page already in buffer pool
+        pages_[frame_id].SetReferenced();
+        CountMetric(Counter::BUFFER_POOL_HITS);
+    } else {
+        // Case 2: Page not in pool -> allocate frame and load from disk
+        CountMetric(Counter::BUFFER_POOL_MISSES);
+        frame_id = LoadPage(page_id);
+        if (frame_id == INVALID_FRAME_ID) {
+            return nullptr;
+        }
+    }
+
+    // Writer: keep the committed image for snapshots first
+    if (writer && page_id != 0) {
+        frame_id = SaveVersion(page_id, frame_id);
+        if (frame_id == INVALID_FRAME_ID) {
+            return nullptr;
+        }
+    }
+
+    pages_[frame_id].Pin();             // Caller now holds a pin
+    return &pages_[frame_id];
+}
+
+FrameID BufferPoolManager::LoadPage(PageID page_id) {
+    FrameID frame_id = page_table_.Find(page_id);
+    if (frame_id != INVALID_FRAME_ID) {
+        return frame_id;
+    }
+
+    frame_id = AllocateFrame();
+    if (frame_id == INVALID_FRAME_ID) {
+        return INVALID_FRAME_ID;
+    }
+
     pages_[frame_id].Reset();
     disk_manager_.ReadPage(page_id, pages_[frame_id].GetData());
     pages_[frame_id].SetPageID(page_id);
-    page_table_[page_id] = frame_id;
-    pages_[frame_id].Pin();             // Caller now holds a pin
+    auto chain = versions_.find(page_id);
+    pages_[frame_id].SetVersionEpoch(chain != versions_.end() ? chain->second.written : 0);
+    page_table_.Insert(page_id, frame_id);
+    replacer_.Unpin(frame_id);      // a victim candidate from now on
+    pages_[frame_id].MarkLoaded();
+    return frame_id;
+}
 
-    return &pages_[frame_id];
+ReadPageGuard BufferPoolManager::FetchPageRead(PageID page_id) {
+    Page *page = FetchPage(page_id);
+    return page != nullptr ? ReadPageGuard(this, page, page_id) : ReadPageGuard();
+}
+
+WritePageGuard BufferPoolManager::FetchPageWrite(PageID page_id) {
+    Page *page = FetchPage(page_id);
+    return page != nullptr ? WritePageGuard(this, page, page_id) : WritePageGuard();
+}
+
+WritePageGuard BufferPoolManager::NewPageGuarded(PageID* page_id) {
+    Page *page = NewPage(page_id);
+    return page != nullptr ? WritePageGuard(this, page, *page_id) : WritePageGuard();
 }
 
 Page* BufferPoolManager::NewPage(PageID* page_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+
     FrameID frame_id = AllocateFrame();
     if (frame_id == INVALID_FRAME_ID) {
         return nullptr;
@@ -84,58 +386,482 @@ Page* BufferPoolManager::NewPage(PageID* page_id) {
     *page_id = new_page_id;
 
     pages_[frame_id].SetPageID(new_page_id);
-    page_table_[new_page_id] = frame_id;
-    pages_[frame_id].Pin();
     pages_[frame_id].SetDirty(true);    // New pages are considered dirty (zeroed page should persist)
 
+    // no snapshot can reach a page that did not exist: nothing to save
+    if (tls_writer == this) {
+        uint64_t epoch = write_epoch_.load(std::memory_order_relaxed);
+        versions_[new_page_id].written = epoch;
+        epoch_pages_.push_back(new_page_id);
+        pages_[frame_id].SetVersionEpoch(epoch);
+    }
+
+    page_table_.Insert(new_page_id, frame_id);
+    replacer_.Unpin(frame_id);
+    pages_[frame_id].MarkLoaded();
+    pages_[frame_id].Pin();
     return &pages_[frame_id];
 }
 
 bool BufferPoolManager::UnpinPage(PageID page_id, bool is_dirty) {
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
+    const PageSnapshot *snapshot = SnapshotOf(this);
+    if (!is_dirty && TryUnpinResident(Unswizzle(page_id), ResidentFrame(page_id), snapshot)) {
+        return true;
+    }
+    page_id = Unswizzle(page_id);
+
+    std::lock_guard<std::mutex> guard(latch_);
+
+    // the same version FetchPage resolved to: images only come and go
+    // for epochs the snapshot cannot see
+    if (snapshot != nullptr) {
+        if (PageVersion *version = FindVersion(page_id, snapshot->Epoch())) {
+            if (version->frame == INVALID_FRAME_ID || pages_[version->frame].GetPinCount() == 0) {
+                return false;
+            }
+            if (pages_[version->frame].Unpin() == 0) {
+                ReleaseVersionFrame(*version);
+            }
+            return true;
+        }
+    }
+
+    FrameID frame_id = page_table_.Find(page_id);
+    if (frame_id == INVALID_FRAME_ID) {
         return false;
     }
 
-    FrameID frame_id = it->second;
     if (pages_[frame_id].GetPinCount() == 0) {
         return false;   // Invalid unpin
     }
 
     if (is_dirty) {
         pages_[frame_id].SetDirty(true);
+        if (pages_[frame_id].GetHotSlot() != Page::NO_HOT_SLOT) {
+            hot_writes_.fetch_add(1, std::memory_order_release);
+        }
     }
 
+    // still a victim candidate: the replacer skips pinned frames
     pages_[frame_id].Unpin();
-
-    if (pages_[frame_id].GetPinCount() == 0) {
-        replacer_.Unpin(frame_id);
-    }
-
     return true;
 }
 
 bool BufferPoolManager::FlushPage(PageID page_id) {
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
+    std::lock_guard<std::mutex> guard(latch_);
+
+    FrameID frame_id = page_table_.Find(page_id);
+    if (frame_id == INVALID_FRAME_ID) {
         return false;
     }
 
-    FrameID frame_id = it->second;
+    CountMetric(Counter::BUFFER_POOL_FLUSHES);
     disk_manager_.WritePage(page_id, pages_[frame_id].GetData());
     pages_[frame_id].SetDirty(false);
     return true;
 }
 
 void BufferPoolManager::FlushAllPages() {
-    for (const auto& pair : page_table_) {
-        PageID page_id = pair.first;
-        FrameID frame_id = pair.second;
+    std::lock_guard<std::mutex> guard(latch_);
+
+    page_table_.ForEach([this](PageID page_id, FrameID frame_id) {
         if (pages_[frame_id].IsDirty()) {
+            CountMetric(Counter::BUFFER_POOL_FLUSHES);
             disk_manager_.WritePage(page_id, pages_[frame_id].GetData());
             pages_[frame_id].SetDirty(false);
         }
+    });
+}
+
+FrameID BufferPoolManager::SaveVersion(PageID page_id, FrameID frame_id) {
+    const uint64_t epoch = write_epoch_.load(std::memory_order_relaxed);
+    VersionChain &chain = versions_[page_id];
+    if (chain.written == epoch) {
+        return frame_id;                // saved (or created) earlier in this epoch
+    }
+
+    PageVersion version;
+    version.until = epoch;
+
+    // the epoch goes on the frame before the pins are looked at: a
+    // lock-free reader pinning it later sees it and leaves snapshots
+    // older than the epoch to the latch
+    Page &page = pages_[frame_id];
+    page.SetVersionEpoch(epoch);
+
+    if (page.GetPinCount() == 0) {
+        version.data.reset(new char[PAGE_SIZE]);
+        std::memcpy(version.data.get(), page.GetData(), PAGE_SIZE);
+    } else {
+        // readers are on this frame: it becomes the image, the writer
+        // continues on a copy (the pin keeps it from being the victim)
+        page.Pin();
+        FrameID copy = AllocateFrame();
+        if (copy == INVALID_FRAME_ID) {
+            page.Unpin();
+            if (chain.versions.empty() && chain.written == 0) {
+                versions_.erase(page_id);
+            }
+            return INVALID_FRAME_ID;
+        }
+        pages_[copy].Reset();
+        std::memcpy(pages_[copy].GetData(), page.GetData(), PAGE_SIZE);
+        pages_[copy].SetPageID(page_id);
+        pages_[copy].SetDirty(page.IsDirty());
+        pages_[copy].SetVersionEpoch(epoch);
+        page.SetDirty(false);
+        page.SetVersionEpoch(Page::OLD_VERSION);
+        page_table_.Insert(page_id, copy);
+        replacer_.Pin(frame_id);        // an image is never a victim
+        if (uint32_t slot = page.GetHotSlot(); slot != Page::NO_HOT_SLOT) {
+            // the hot tier keeps the latest page
+            page.SetHotSlot(Page::NO_HOT_SLOT);
+            pages_[copy].SetHotSlot(slot);
+            hot_frames_[slot].store(copy, std::memory_order_release);
+        } else {
+            replacer_.Unpin(copy);
+        }
+        if (SwipOwner owner = swip_owners_[frame_id]; owner.parent != INVALID_FRAME_ID) {
+            // so does the parent's link; the image keeps its own links
+            swip_arrays_[owner.parent].load(std::memory_order_relaxed)
+                ->frames[owner.slot].store(copy, std::memory_order_release);
+            swip_owners_[copy] = owner;
+            swip_owners_[frame_id] = SwipOwner{};
+        }
+        pages_[copy].MarkLoaded();
+
+        version.frame = frame_id;
+        frame_id = copy;
+    }
+
+    chain.versions.push_back(std::move(version));
+    if (chain.versions.back().frame != INVALID_FRAME_ID &&
+        pages_[chain.versions.back().frame].Unpin() == 0) {
+        ReleaseVersionFrame(chain.versions.back());   // its readers left meanwhile
+    }
+    chain.written = epoch;
+    version_queue_.emplace_back(epoch, page_id);
+    epoch_pages_.push_back(page_id);
+    CountMetric(Counter::PAGE_VERSIONS_SAVED);
+    return frame_id;
+}
+
+BufferPoolManager::PageVersion* BufferPoolManager::FindVersion(PageID page_id, uint64_t epoch) {
+    auto chain = versions_.find(page_id);
+    if (chain == versions_.end()) {
+        return nullptr;
+    }
+    for (PageVersion &version : chain->second.versions) {
+        if (version.until > epoch) {
+            return &version;
+        }
+    }
+    return nullptr;
+}
+
+void BufferPoolManager::FreeFrame(FrameID frame_id) {
+    UnswizzleFrame(frame_id);
+    pages_[frame_id].MarkFree();
+    pages_[frame_id].SetPageID(INVALID_PAGE_ID);
+    pages_[frame_id].SetDirty(false);
+    free_frames_[arena_.PartitionOf(frame_id)].push_back(frame_id);
+}
+
+void BufferPoolManager::ReleaseVersionFrame(PageVersion& version) {
+    if (!version.data) {
+        version.data.reset(new char[PAGE_SIZE]);
+        std::memcpy(version.data.get(), pages_[version.frame].GetData(), PAGE_SIZE);
+    }
+    FreeFrame(version.frame);
+    version.frame = INVALID_FRAME_ID;
+}
+
+void BufferPoolManager::ReclaimVersions() {
+    // an image saved by write epoch e serves snapshots older than e
+    const uint64_t safe = epochs_.SafeEpoch();
+    const uint64_t open_epoch = write_epoch_.load(std::memory_order_relaxed);
+
+    while (!version_queue_.empty() && version_queue_.front().first <= safe) {
+        auto [until, page_id] = version_queue_.front();
+        version_queue_.pop_front();
+
+        auto chain = versions_.find(page_id);
+        if (chain == versions_.end()) {
+            continue;
+        }
+        auto &versions = chain->second.versions;
+        auto version = std::find_if(versions.begin(), versions.end(),
+                                    [until = until](const PageVersion &v) { return v.until == until; });
+        if (version != versions.end()) {
+            // a frame still pinned here has lost its unpin (leaked pin): left as it is
+            if (version->frame != INVALID_FRAME_ID && pages_[version->frame].GetPinCount() == 0) {
+                FreeFrame(version->frame);
+            }
+            versions.erase(version);
+        }
+        if (versions.empty() && chain->second.written != open_epoch) {
+            versions_.erase(chain);
+        }
+    }
+}
+
+const PageSnapshot* BufferPoolManager::CurrentSnapshot() const {
+    return SnapshotOf(this);
+}
+
+PageSnapshot BufferPoolManager::OpenSnapshot() {
+    uint64_t epoch;
+    size_t slot = epochs_.Enter(&epoch);
+    return PageSnapshot(this, slot, epoch);
+}
+
+void BufferPoolManager::CloseSnapshot(size_t slot) {
+    epochs_.Exit(slot);
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        ReclaimVersions();
+    }
+    epochs_.Reclaim();
+}
+
+void BufferPoolManager::BeginWrite() {
+    write_mutex_.lock();
+
+    std::lock_guard<std::mutex> guard(latch_);
+    write_epoch_.store(epochs_.Current() + 1, std::memory_order_release);
+    tls_writer = this;
+}
+
+void BufferPoolManager::CommitWrite() {
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        const uint64_t epoch = write_epoch_.load(std::memory_order_relaxed);
+
+        // pages the epoch only read (on the way down) keep no image
+        for (PageID page_id : epoch_pages_) {
+            auto chain = versions_.find(page_id);
+            if (chain == versions_.end()) {
+                continue;
+            }
+            auto &versions = chain->second.versions;
+            if (!versions.empty() && versions.back().until == epoch &&
+                versions.back().frame == INVALID_FRAME_ID) {
+                FrameID latest = page_table_.Find(page_id);
+                if (latest != INVALID_FRAME_ID &&
+                    std::memcmp(pages_[latest].GetData(), versions.back().data.get(),
+                                PAGE_SIZE) == 0) {
+                    versions.pop_back();
+                }
+            }
+            if (versions.empty()) {
+                versions_.erase(chain);
+            }
+        }
+        epoch_pages_.clear();
+
+        // snapshots opened from now on see the epoch
+        epochs_.Advance();
+        write_epoch_.store(0, std::memory_order_release);
+        ReclaimVersions();
+    }
+
+    tls_writer = nullptr;
+    write_mutex_.unlock();
+    epochs_.Reclaim();
+}
+
+uint64_t BufferPoolManager::GetFetchCount() const {
+    uint64_t count = 0;
+    for (const FetchCountStripe &stripe : fetch_counts_) {
+        count += stripe.count.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+PageID BufferPoolManager::PinHotPage(PageID page_id) {
+    page_id = Unswizzle(page_id);
+    if (page_id == INVALID_PAGE_ID || page_id > SWIZZLED_PAGE_MASK) {
+        return INVALID_PAGE_ID;
+    }
+
+    std::lock_guard<std::mutex> guard(latch_);
+
+    FrameID frame_id = page_table_.Find(page_id);
+    if (frame_id != INVALID_FRAME_ID && pages_[frame_id].GetHotSlot() != Page::NO_HOT_SLOT) {
+        return Swizzle(page_id, pages_[frame_id].GetHotSlot(), 0);
+    }
+    if (hot_count_ == hot_capacity_) {
+        return INVALID_PAGE_ID;
+    }
+
+    frame_id = LoadPage(page_id);
+    if (frame_id == INVALID_FRAME_ID) {
+        return INVALID_PAGE_ID;
+    }
+
+    uint32_t slot = 0;
+    while (hot_frames_[slot].load(std::memory_order_relaxed) != INVALID_FRAME_ID) {
+        slot++;
+    }
+    replacer_.Pin(frame_id);            // never a victim while hot
+    pages_[frame_id].SetHotSlot(slot);
+    hot_frames_[slot].store(frame_id, std::memory_order_release);
+    hot_count_++;
+    CountMetric(Counter::HOT_PAGE_PINS);
+    return Swizzle(page_id, slot, 0);
+}
+
+bool BufferPoolManager::UnpinHotPage(PageID page_id) {
+    page_id = Unswizzle(page_id);
+
+    std::lock_guard<std::mutex> guard(latch_);
+
+    FrameID frame_id = page_table_.Find(page_id);
+    if (frame_id == INVALID_FRAME_ID || pages_[frame_id].GetHotSlot() == Page::NO_HOT_SLOT) {
+        return false;
+    }
+
+    // readers still holding the swizzled id find the slot empty (or
+    // another page in it) and fall back to the page table
+    uint32_t slot = pages_[frame_id].GetHotSlot();
+    hot_frames_[slot].store(INVALID_FRAME_ID, std::memory_order_release);
+    pages_[frame_id].SetHotSlot(Page::NO_HOT_SLOT);
+    replacer_.Unpin(frame_id);
+    hot_count_--;
+    CountMetric(Counter::HOT_PAGE_UNPINS);
+    return true;
+}
+
+size_t BufferPoolManager::GetHotPageCount() {
+    std::lock_guard<std::mutex> guard(latch_);
+    return hot_count_;
+}
+
+Page* BufferPoolManager::FetchChild(const Page* parent, uint32_t slot, PageID* child_id) {
+    const PageID page_id = *child_id;
+    if (IsSwizzled(page_id) || !options_.pointer_swizzling || tls_writer == this ||
+        slot >= SWIP_SLOTS) {
+        return FetchPage(page_id);
+    }
+
+    // the linked frame, if the child is still there
+    const FrameID parent_frame = static_cast<FrameID>(parent - pages_);
+    if (const SwipArray *swips = swip_arrays_[parent_frame].load(std::memory_order_acquire)) {
+        FrameID frame_id = swips->frames[slot].load(std::memory_order_acquire);
+        if (Page *page = TryFetchResident(page_id, frame_id, SnapshotOf(this))) {
+            CountFetch();
+            CountMetric(Counter::BUFFER_POOL_HITS);
+            CountMetric(Counter::SWIZZLED_HITS);
+            *child_id = Swizzle(page_id, frame_id, SWIZZLED_FRAME);
+            return page;
+        }
+    }
+
+    // old images (snapshot reads) are reached through the latch anyway
+    Page *page = FetchPage(page_id);
+    if (page != nullptr && parent->GetVersionEpoch() != Page::OLD_VERSION &&
+        page->GetVersionEpoch() != Page::OLD_VERSION) {
+        FrameID frame_id = static_cast<FrameID>(page - pages_);
+        if (SwizzleChild(parent_frame, slot, page_id, frame_id)) {
+            *child_id = Swizzle(page_id, frame_id, SWIZZLED_FRAME);
+        }
+    }
+    return page;
+}
+
+ReadPageGuard BufferPoolManager::FetchChildRead(const PageGuard& parent, uint32_t slot,
+                                                PageID child_id) {
+    Page *page = FetchChild(parent.GetPage(), slot, &child_id);
+    return page != nullptr ? ReadPageGuard(this, page, child_id) : ReadPageGuard();
+}
+
+bool BufferPoolManager::SwizzleChild(FrameID parent, uint32_t slot, PageID child_page_id,
+                                     FrameID child) {
+    if (parent >= SWIZZLED_SLOTS || child >= SWIZZLED_SLOTS) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(latch_);
+
+    if (page_table_.Find(pages_[parent].GetPageID()) != parent ||
+        page_table_.Find(child_page_id) != child) {
+        return false;
+    }
+
+    SwipArray *swips = swip_arrays_[parent].load(std::memory_order_relaxed);
+    if (swips == nullptr) {
+        swips = new SwipArray;
+        for (auto &frame : swips->frames) {
+            frame.store(INVALID_FRAME_ID, std::memory_order_relaxed);
+        }
+        swip_arrays_[parent].store(swips, std::memory_order_release);
+    }
+    FrameID linked = swips->frames[slot].load(std::memory_order_relaxed);
+    if (linked == child) {
+        return true;
+    }
+
+    // one link per slot and per frame: replace the slot's (a child that
+    // moved to another slot, or was split off) and the frame's old ones
+    if (linked != INVALID_FRAME_ID) {
+        swips->frames[slot].store(INVALID_FRAME_ID, std::memory_order_release);
+        swips->linked--;
+        swip_owners_[linked] = SwipOwner{};
+        swizzled_count_--;
+    }
+    if (SwipOwner owner = swip_owners_[child]; owner.parent != INVALID_FRAME_ID) {
+        SwipArray *old = swip_arrays_[owner.parent].load(std::memory_order_relaxed);
+        old->frames[owner.slot].store(INVALID_FRAME_ID, std::memory_order_release);
+        old->linked--;
+        swizzled_count_--;
+    }
+
+    swips->frames[slot].store(child, std::memory_order_release);
+    swips->linked++;
+    swip_owners_[child] = SwipOwner{parent, slot};
+    swizzled_count_++;
+    CountMetric(Counter::PAGE_SWIZZLES);
+    return true;
+}
+
+void BufferPoolManager::UnswizzleFrame(FrameID frame_id) {
+    if (SwipOwner owner = swip_owners_[frame_id]; owner.parent != INVALID_FRAME_ID) {
+        SwipArray *swips = swip_arrays_[owner.parent].load(std::memory_order_relaxed);
+        swips->frames[owner.slot].store(INVALID_FRAME_ID, std::memory_order_release);
+        swips->linked--;
+        swip_owners_[frame_id] = SwipOwner{};
+        swizzled_count_--;
+        CountMetric(Counter::PAGE_UNSWIZZLES);
+    }
+
+    SwipArray *swips = swip_arrays_[frame_id].load(std::memory_order_relaxed);
+    if (swips == nullptr || swips->linked == 0) {
+        return;
+    }
+    for (auto &frame : swips->frames) {
+        FrameID child = frame.load(std::memory_order_relaxed);
+        if (child != INVALID_FRAME_ID) {
+            frame.store(INVALID_FRAME_ID, std::memory_order_release);
+            swip_owners_[child] = SwipOwner{};
+            swizzled_count_--;
+            CountMetric(Counter::PAGE_UNSWIZZLES);
+        }
+    }
+    swips->linked = 0;
+}
+
+size_t BufferPoolManager::GetSwizzledCount() {
+    std::lock_guard<std::mutex> guard(latch_);
+    return swizzled_count_;
+}
+
+size_t BufferPoolManager::GetVersionCount() {
+    std::lock_guard<std::mutex> guard(latch_);
+    size_t count = 0;
+    for (const auto &[page_id, chain] : versions_) {
+        count += chain.versions.size();
     }
+    return count;
 }
 
 } // namespace cmse
@@ -1,54 +1,177 @@
 #include "../../include/storage/disk_manager.h"
 
-#include <cstring>   // for memset
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>   // for memset, memcpy
+#include <string>
+
+#include "../../include/common/metrics.h"
 
 namespace cmse {
 
-DiskManager::DiskManager() {
-    // Open file for read & write, binary mode
-    file_.open(DISK_FILE_PATH,
-               std::ios::in | std::ios::out | std::ios::binary);
+namespace {
+
+// Format of files written before the header existed
+constexpr DiskFileHeader LEGACY_HEADER = {DISK_FILE_MAGIC, 4096, 253, 200};
+
+bool IsAligned(const void* ptr) {
+    return reinterpret_cast<uintptr_t>(ptr) % PAGE_SIZE == 0;
+}
+
+} // namespace
+
+DiskManager::DiskManager(const StorageOptions &options)
+    : mode_(options.io_mode), path_(options.disk_file) {
+    header_ = DiskFileHeader{DISK_FILE_MAGIC, static_cast<uint32_t>(options.page_size),
+                             options.btree_leaf_max_keys, options.btree_internal_max_keys};
+
+    // Open file for read & write, create it if it does not exist
+    int flags = O_RDWR | O_CREAT;
+    if (mode_ == DiskIoMode::DIRECT) {
+        fd_ = open(path_.c_str(), flags | O_DIRECT, 0644);
+
+        // e.g. tmpfs: no O_DIRECT, use the page cache after all
+        if (fd_ < 0 && errno == EINVAL) {
+            mode_ = DiskIoMode::BUFFERED;
+        }
+    }
+    if (fd_ < 0) {
+        fd_ = open(path_.c_str(), flags, 0644);
+    }
+
+    if (fd_ < 0) {
+        error_ = "cannot open " + path_ + ": " + std::strerror(errno);
+        return;
+    }
+    CheckHeader();
+}
 
-    // If file does not exist, create it
-    if (!file_.is_open()) {
-        file_.open(DISK_FILE_PATH,
-                   std::ios::out | std::ios::binary);
-        file_.close();
+void DiskManager::CheckHeader() {
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || st.st_size < 4096) {
+        return;     // new file: the header goes out with page 0
+    }
+
+    // the first 4 KiB hold it whatever the file's page size
+    char* buffer = BounceBuffer();
+    if (pread(fd_, buffer, 4096, 0) != 4096) {
+        error_ = "cannot read the header of " + path_;
+    } else {
+        DiskFileHeader found;
+        std::memcpy(&found, buffer + DISK_FILE_HEADER_OFFSET, sizeof(found));
+        bool legacy = found.magic == 0;
+        if (legacy) {
+            found = LEGACY_HEADER;
+        }
+
+        if (found.magic != DISK_FILE_MAGIC) {
+            error_ = path_ + " is not a CMSE disk file";
+        } else if (std::memcmp(&found, &header_, sizeof(found)) != 0) {
+            error_ = path_ + " was created with page_size = " + std::to_string(found.page_size) +
+                     ", btree_leaf_max_keys = " + std::to_string(found.btree_leaf_max_keys) +
+                     ", btree_internal_max_keys = " +
+                     std::to_string(found.btree_internal_max_keys) +
+                     "; use the same options or rebuild it (--reindex)";
+        } else if (legacy) {
+            // record the format now rather than at the next catalog change
+            std::memcpy(buffer + DISK_FILE_HEADER_OFFSET, &header_, sizeof(header_));
+            if (pwrite(fd_, buffer, 4096, 0) != 4096) {
+                error_ = "cannot write the header of " + path_;
+            }
+        }
+    }
 
-        // Reopen in read/write mode
-        file_.open(DISK_FILE_PATH,
-                   std::ios::in | std::ios::out | std::ios::binary);
+    if (!error_.empty()) {
+        close(fd_);
+        fd_ = -1;
     }
 }
 
 DiskManager::~DiskManager() {
-    file_.close();
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+    std::free(bounce_);
+}
+
+char* DiskManager::BounceBuffer() {
+    if (bounce_ == nullptr) {
+        bounce_ = static_cast<char*>(std::aligned_alloc(PAGE_SIZE, PAGE_SIZE));
+    }
+    return bounce_;
 }
 
 void DiskManager::ReadPage(PageID page_id, char* data) {
+    LatencyTimer timer(Histogram::DISK_READ_LATENCY);
+
     // Calculate where this page starts in the file
-    long offset = page_id * PAGE_SIZE;
+    off_t offset = static_cast<off_t>(page_id * PAGE_SIZE);
 
-    // Move file cursor to that position
-    file_.seekg(offset);
+    char* target = data;
+    if (mode_ == DiskIoMode::DIRECT && !IsAligned(data)) {
+        target = BounceBuffer();
+    }
 
     // Try to read one full page
-    file_.read(data, PAGE_SIZE);
+    size_t done = 0;
+    while (done < PAGE_SIZE) {
+        ssize_t n = pread(fd_, target + done, PAGE_SIZE - done, offset + static_cast<off_t>(done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += static_cast<size_t>(n);
+    }
+    CountMetric(Counter::DISK_READS);
+    CountMetric(Counter::DISK_READ_BYTES, done);
 
     // If read failed (page does not exist yet)
-    if (file_.gcount() < PAGE_SIZE) {
+    if (done < PAGE_SIZE) {
         std::memset(data, 0, PAGE_SIZE);
-        file_.clear(); // clear error flags
+        return;
+    }
+
+    if (target != data) {
+        std::memcpy(data, target, PAGE_SIZE);
     }
 }
 
 void DiskManager::WritePage(PageID page_id, const char* data) {
-    long offset = page_id * PAGE_SIZE;
+    LatencyTimer timer(Histogram::DISK_WRITE_LATENCY);
 
-    file_.seekp(offset);
-    file_.write(data, PAGE_SIZE);
-    file_.flush();
+    off_t offset = static_cast<off_t>(page_id * PAGE_SIZE);
+
+    // page 0 carries the file header
+    const char* source = data;
+    if (page_id == 0 || (mode_ == DiskIoMode::DIRECT && !IsAligned(data))) {
+        char* bounce = BounceBuffer();
+        std::memcpy(bounce, data, PAGE_SIZE);
+        if (page_id == 0) {
+            std::memcpy(bounce + DISK_FILE_HEADER_OFFSET, &header_, sizeof(header_));
+        }
+        source = bounce;
+    }
+
+    size_t done = 0;
+    while (done < PAGE_SIZE) {
+        ssize_t n = pwrite(fd_, source + done, PAGE_SIZE - done, offset + static_cast<off_t>(done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += static_cast<size_t>(n);
+    }
+    CountMetric(Counter::DISK_WRITES);
+    CountMetric(Counter::DISK_WRITE_BYTES, done);
 }
 
-} // namespace cmse
+PageID DiskManager::GetNumPages() {
+    struct stat st;
+    if (fd_ < 0 || fstat(fd_, &st) != 0 || st.st_size < 0) {
+        return 0;
+    }
+    return static_cast<PageID>(st.st_size) / PAGE_SIZE;
+}
 
+} // namespace cmse
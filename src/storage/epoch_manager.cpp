@@ -0,0 +1,93 @@
+#include "../../include/storage/epoch_manager.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace cmse {
+
+EpochManager::~EpochManager() {
+    for (auto &[epoch, free_fn] : retired_) {
+        free_fn();
+    }
+}
+
+size_t EpochManager::Enter(uint64_t *epoch) {
+    // threads start looking at different slots
+    size_t start = std::hash<std::thread::id>{}(std::this_thread::get_id()) % EPOCH_MAX_READERS;
+
+    while (true) {
+        for (size_t n = 0; n < EPOCH_MAX_READERS; n++) {
+            size_t slot = (start + n) % EPOCH_MAX_READERS;
+            uint64_t idle = IDLE;
+            uint64_t e = Current();
+            if (!slots_[slot].epoch.compare_exchange_strong(idle, e, std::memory_order_seq_cst)) {
+                continue;
+            }
+
+            // a reclaimer that scanned the slots before the store saw the
+            // epoch already past e: move along with it
+            uint64_t now = Current();
+            while (now != e) {
+                e = now;
+                slots_[slot].epoch.store(e, std::memory_order_seq_cst);
+                now = Current();
+            }
+            *epoch = e;
+            return slot;
+        }
+        std::this_thread::yield();
+    }
+}
+
+void EpochManager::Exit(size_t slot) {
+    slots_[slot].epoch.store(IDLE, std::memory_order_release);
+}
+
+uint64_t EpochManager::MinActive() const {
+    uint64_t min_epoch = IDLE;
+    for (const Slot &slot : slots_) {
+        min_epoch = std::min(min_epoch, slot.epoch.load(std::memory_order_seq_cst));
+    }
+    return min_epoch;
+}
+
+uint64_t EpochManager::SafeEpoch() const {
+    // epoch first: a reader entering after the scan announces at least it
+    uint64_t current = Current();
+    return std::min(current, MinActive());
+}
+
+void EpochManager::Retire(std::function<void()> free_fn) {
+    std::lock_guard<std::mutex> guard(retired_mutex_);
+    retired_.emplace_back(Current(), std::move(free_fn));
+}
+
+size_t EpochManager::Reclaim() {
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> guard(retired_mutex_);
+        if (retired_.empty()) {
+            return 0;
+        }
+        // retired at e: readers at e may hold it, later ones cannot
+        uint64_t safe = SafeEpoch();
+        while (!retired_.empty() && retired_.front().first < safe) {
+            ready.push_back(std::move(retired_.front().second));
+            retired_.pop_front();
+        }
+    }
+
+    // outside the mutex: callbacks may retire more
+    for (auto &free_fn : ready) {
+        free_fn();
+    }
+    return ready.size();
+}
+
+size_t EpochManager::RetiredCount() const {
+    std::lock_guard<std::mutex> guard(retired_mutex_);
+    return retired_.size();
+}
+
+} // namespace cmse
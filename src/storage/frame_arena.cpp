@@ -0,0 +1,185 @@
+#include "../../include/storage/frame_arena.h"
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+
+namespace cmse {
+
+namespace {
+
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+constexpr size_t FRAMES_PER_HUGE_PAGE = HUGE_PAGE_SIZE / PAGE_SIZE;
+
+size_t RoundUp(size_t n, size_t to) {
+    return (n + to - 1) / to * to;
+}
+
+// Nodes listed in /sys/devices/system/node/online ("0", "0-3", "0,2-3")
+std::vector<int> OnlineNumaNodes() {
+    std::vector<int> nodes;
+    std::ifstream in("/sys/devices/system/node/online");
+    std::string list;
+    if (!std::getline(in, list)) {
+        return nodes;
+    }
+
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int node = first; node <= last && node < 64; node++) {
+            nodes.push_back(node);      // mbind below takes a one-word mask
+        }
+    }
+    return nodes;
+}
+
+void *MapAnonymous(size_t bytes, int extra_flags) {
+    void *addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+    return addr == MAP_FAILED ? nullptr : addr;
+}
+
+} // namespace
+
+const char *FrameBackingName(FrameBacking backing) {
+    switch (backing) {
+        case FrameBacking::HUGETLB: return "hugetlb";
+        case FrameBacking::TRANSPARENT_HUGE: return "transparent huge pages";
+        case FrameBacking::NORMAL: return "4 KiB pages";
+    }
+    return "unknown";
+}
+
+FrameArena::FrameArena(size_t frame_count, bool huge_pages, bool numa_partitions)
+    : frame_count_(frame_count) {
+    size_t bytes = std::max<size_t>(frame_count, 1) * PAGE_SIZE;
+
+    // 1. explicit huge pages: fails unless the system has enough reserved
+    if (huge_pages && bytes >= HUGE_PAGE_SIZE) {
+        size_t huge_bytes = RoundUp(bytes, HUGE_PAGE_SIZE);
+        if (void *addr = MapAnonymous(huge_bytes, MAP_HUGETLB)) {
+            base_ = static_cast<char *>(addr);
+            mapped_bytes_ = huge_bytes;
+            backing_ = FrameBacking::HUGETLB;
+        }
+    }
+
+    // 2. transparent huge pages: only whole aligned 2 MiB ranges qualify,
+    //    so map with slack, align the start and trim the rest
+    if (base_ == nullptr && huge_pages && bytes >= HUGE_PAGE_SIZE) {
+        size_t huge_bytes = RoundUp(bytes, HUGE_PAGE_SIZE);
+        if (void *addr = MapAnonymous(huge_bytes + HUGE_PAGE_SIZE, 0)) {
+            auto raw = reinterpret_cast<uintptr_t>(addr);
+            uintptr_t aligned = RoundUp(raw, HUGE_PAGE_SIZE);
+            if (aligned > raw) {
+                munmap(addr, aligned - raw);
+            }
+            size_t tail = raw + huge_bytes + HUGE_PAGE_SIZE - (aligned + huge_bytes);
+            if (tail > 0) {
+                munmap(reinterpret_cast<void *>(aligned + huge_bytes), tail);
+            }
+
+            base_ = reinterpret_cast<char *>(aligned);
+            mapped_bytes_ = huge_bytes;
+            backing_ = madvise(base_, mapped_bytes_, MADV_HUGEPAGE) == 0
+                           ? FrameBacking::TRANSPARENT_HUGE
+                           : FrameBacking::NORMAL;
+        }
+    }
+
+    // 3. plain pages (mmap is page-aligned either way)
+    if (base_ == nullptr) {
+        size_t page_bytes = RoundUp(bytes, PAGE_SIZE);
+        void *addr = MapAnonymous(page_bytes, 0);
+        if (addr == nullptr) {
+            throw std::bad_alloc();
+        }
+        base_ = static_cast<char *>(addr);
+        mapped_bytes_ = page_bytes;
+        backing_ = FrameBacking::NORMAL;
+    }
+
+    partition_begin_ = {0};
+    partition_node_ = {0};
+    if (numa_partitions) {
+        std::vector<int> nodes = OnlineNumaNodes();
+        if (nodes.size() > 1) {
+            BindPartitions(nodes);
+        }
+    }
+}
+
+FrameArena::~FrameArena() {
+    if (base_ != nullptr) {
+        munmap(base_, mapped_bytes_);
+    }
+}
+
+void FrameArena::BindPartitions(const std::vector<int> &nodes) {
+    // Partition boundaries on huge page boundaries where the pool is big
+    // enough, so no huge page straddles two nodes (hugetlb requires it)
+    size_t granule = 1;
+    if (backing_ != FrameBacking::NORMAL) {
+        granule = FRAMES_PER_HUGE_PAGE;
+    }
+
+    size_t usable = nodes.size();
+    size_t per_partition = frame_count_ / usable / granule * granule;
+    if (per_partition == 0) {
+        return;     // too small to split: one partition, default placement
+    }
+
+    partition_begin_.clear();
+    partition_node_.clear();
+    for (size_t i = 0; i < usable; i++) {
+        // the last partition takes the remainder, mapping slack included
+        FrameID begin = static_cast<FrameID>(i * per_partition);
+        size_t end_byte = i + 1 == usable ? mapped_bytes_ : (i + 1) * per_partition * PAGE_SIZE;
+        size_t bytes = end_byte - static_cast<size_t>(begin) * PAGE_SIZE;
+
+        // preferred rather than bound: a full node spills over instead of
+        // failing the fault
+        unsigned long mask = 1UL << nodes[i];
+        syscall(SYS_mbind, Frame(begin), bytes, MPOL_PREFERRED, &mask,
+                sizeof(mask) * 8 + 1, 0);
+
+        partition_begin_.push_back(begin);
+        partition_node_.push_back(nodes[i]);
+    }
+}
+
+size_t FrameArena::PartitionOf(FrameID frame_id) const {
+    auto it = std::upper_bound(partition_begin_.begin(), partition_begin_.end(), frame_id);
+    return static_cast<size_t>(it - partition_begin_.begin()) - 1;
+}
+
+size_t FrameArena::CurrentPartition() const {
+    if (partition_node_.size() <= 1) {
+        return 0;
+    }
+
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+        return 0;
+    }
+    for (size_t i = 0; i < partition_node_.size(); i++) {
+        if (partition_node_[i] == static_cast<int>(node)) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+} // namespace cmse
@@ -0,0 +1,89 @@
+#include "../../include/storage/page_table.h"
+
+namespace cmse {
+
+PageTable::PageTable(size_t max_entries) {
+    size_t capacity = 16;
+    unsigned bits = 4;
+    while (capacity < max_entries * 2) {
+        capacity *= 2;
+        bits++;
+    }
+    slots_.reset(new Slot[capacity]);
+    mask_ = capacity - 1;
+    shift_ = 64 - bits;
+}
+
+FrameID PageTable::Find(PageID page_id) const {
+    size_t i = Home(page_id);
+    for (size_t n = 0; n <= mask_; n++, i = (i + 1) & mask_) {
+        PageID key = slots_[i].page_id.load(std::memory_order_acquire);
+        if (key == page_id) {
+            return slots_[i].frame_id.load(std::memory_order_acquire);
+        }
+        if (key == INVALID_PAGE_ID) {
+            break;
+        }
+    }
+    return INVALID_FRAME_ID;
+}
+
+void PageTable::Insert(PageID page_id, FrameID frame_id) {
+    size_t i = Home(page_id);
+    while (true) {
+        PageID key = slots_[i].page_id.load(std::memory_order_relaxed);
+        if (key == page_id) {
+            slots_[i].frame_id.store(frame_id, std::memory_order_release);
+            return;
+        }
+        if (key == INVALID_PAGE_ID) {
+            // frame before key: a reader that sees the key sees its frame
+            slots_[i].frame_id.store(frame_id, std::memory_order_relaxed);
+            slots_[i].page_id.store(page_id, std::memory_order_release);
+            size_++;
+            return;
+        }
+        i = (i + 1) & mask_;
+    }
+}
+
+bool PageTable::Erase(PageID page_id) {
+    size_t i = Home(page_id);
+    while (true) {
+        PageID key = slots_[i].page_id.load(std::memory_order_relaxed);
+        if (key == INVALID_PAGE_ID) {
+            return false;
+        }
+        if (key == page_id) {
+            break;
+        }
+        i = (i + 1) & mask_;
+    }
+
+    // backward shift: pull later entries of the probe run into the hole
+    // unless that would put them before their home slot
+    size_t hole = i;
+    size_t j = i;
+    while (true) {
+        j = (j + 1) & mask_;
+        PageID key = slots_[j].page_id.load(std::memory_order_relaxed);
+        if (key == INVALID_PAGE_ID) {
+            break;
+        }
+        size_t home = Home(key);
+        bool stays = hole <= j ? (hole < home && home <= j) : (hole < home || home <= j);
+        if (stays) {
+            continue;
+        }
+        slots_[hole].frame_id.store(slots_[j].frame_id.load(std::memory_order_relaxed),
+                                    std::memory_order_relaxed);
+        slots_[hole].page_id.store(key, std::memory_order_release);
+        hole = j;
+    }
+    slots_[hole].page_id.store(INVALID_PAGE_ID, std::memory_order_release);
+    slots_[hole].frame_id.store(INVALID_FRAME_ID, std::memory_order_relaxed);
+    size_--;
+    return true;
+}
+
+} // namespace cmse
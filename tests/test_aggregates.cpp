@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/btree/bplus_tree.h"
+#include "../include/query/query_parser.h"
+
+using namespace cmse;
+
+int main() {
+
+    BufferPoolManager bpm(64); // small pool to force eviction
+    IndexCatalog catalog(&bpm);
+
+    // Create root leaf
+    PageID root_page_id;
+    Page *root_page = bpm.NewPage(&root_page_id);
+
+    auto *root_leaf =
+        reinterpret_cast<BPlusTreeLeafPage *>(root_page->GetData());
+
+    root_leaf->header.is_leaf = true;
+    root_leaf->header.key_count = 0;
+    root_leaf->header.parent_page_id = INVALID_PAGE_ID;
+    root_leaf->next_leaf_page_id = INVALID_PAGE_ID;
+
+    const IndexID TEST_INDEX_ID = 1;
+    catalog.SetRoot(TEST_INDEX_ID, root_page_id);
+    bpm.UnpinPage(root_page_id, true);
+
+    BPlusTree tree(root_page_id, TEST_INDEX_ID, &catalog, &bpm);
+
+    std::cout << "Inserting keys...\n";
+
+    // one day of timestamps with duplicates, plus an error burst
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<KeyType> day(0, 86'399);
+    std::uniform_int_distribution<KeyType> burst(40'000, 40'059);
+
+    std::vector<KeyType> keys;
+    for (int i = 0; i < 150000; i++) {
+        keys.push_back(i % 4 == 0 ? burst(rng) : day(rng));
+    }
+    for (size_t i = 0; i < keys.size(); i++) {
+        tree.Insert(keys[i], RecordRef{i});
+    }
+    std::sort(keys.begin(), keys.end());
+
+    auto brute_count = [&](KeyType low, KeyType high) {
+        return static_cast<uint64_t>(
+            std::upper_bound(keys.begin(), keys.end(), high) -
+            std::lower_bound(keys.begin(), keys.end(), low));
+    };
+
+    int failures = 0;
+
+    std::cout << "Checking COUNT...\n";
+
+    std::uniform_int_distribution<KeyType> any(0, 90'000);
+    uint32_t max_fetches = 0;
+    for (int i = 0; i < 500; i++) {
+        KeyType a = any(rng);
+        KeyType b = any(rng);
+        KeyType low = std::min(a, b);
+        KeyType high = std::max(a, b);
+
+        uint32_t fetch_count = 0;
+        uint64_t count = tree.CountRange(low, high, fetch_count);
+        max_fetches = std::max(max_fetches, fetch_count);
+
+        if (count != brute_count(low, high)) {
+            std::cout << "COUNT [" << low << ", " << high << "] = " << count
+                      << " expected " << brute_count(low, high) << "\n";
+            failures++;
+        }
+    }
+
+    uint32_t full_fetches = 0;
+    std::vector<RecordRef> refs;
+    tree.RangeSearch(0, 90'000, refs, full_fetches);
+
+    std::cout << "COUNT worst case: " << max_fetches << " page fetches"
+              << " (RangeSearch over everything: " << full_fetches << ")\n";
+
+    std::cout << "Checking MIN/MAX...\n";
+
+    for (int i = 0; i < 200; i++) {
+        KeyType a = any(rng);
+        KeyType b = a + any(rng) % 50;
+
+        uint32_t fetch_count = 0;
+        KeyType min_key = 0, max_key = 0;
+        bool has_min = tree.MinInRange(a, b, min_key, fetch_count);
+        bool has_max = tree.MaxInRange(a, b, max_key, fetch_count);
+
+        auto lo = std::lower_bound(keys.begin(), keys.end(), a);
+        auto hi = std::upper_bound(keys.begin(), keys.end(), b);
+        bool expected = lo != hi;
+
+        if (has_min != expected || has_max != expected ||
+            (expected && (min_key != *lo || max_key != *(hi - 1)))) {
+            std::cout << "MIN/MAX [" << a << ", " << b << "] mismatch\n";
+            failures++;
+        }
+    }
+
+    std::cout << "Checking GROUP BY...\n";
+
+    std::vector<uint64_t> counts;
+    uint32_t fetch_count = 0;
+    tree.CountByBucket(39'000, 41'000, 60, counts, fetch_count);
+    for (size_t k = 0; k < counts.size(); k++) {
+        KeyType start = 39'000 + k * 60;
+        KeyType end = std::min<KeyType>(41'000, start + 59);
+        if (counts[k] != brute_count(start, end)) {
+            std::cout << "bucket " << start << " mismatch\n";
+            failures++;
+        }
+    }
+    std::cout << counts.size() << " buckets | " << fetch_count << " page fetches\n";
+
+    Query query;
+    if (!QueryParser::Parse("COUNT WHERE timestamp BETWEEN 0,3599 GROUP BY 60", query) ||
+        query.aggregate != AggregateOp::COUNT || query.group_by_width != 60) {
+        std::cout << "GROUP BY parse failed\n";
+        failures++;
+    }
+    if (QueryParser::Parse("MIN WHERE timestamp BETWEEN 0,10 GROUP BY 5", query)) {
+        std::cout << "GROUP BY accepted for MIN\n";
+        failures++;
+    }
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/btree/bplus_tree.h"
+
+using namespace cmse;
+
+static PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+// leaves visited left to right: keys sorted, count and fill
+static bool CheckLeafChain(BufferPoolManager &bpm, PageID root, uint64_t &keys, uint64_t &leaves) {
+    PageID page_id = root;
+    while (true) {
+        Page *page = bpm.FetchPage(page_id);
+        auto *header = reinterpret_cast<BPlusTreePageHeader *>(page->GetData());
+        if (header->is_leaf) {
+            bpm.UnpinPage(page_id, false);
+            break;
+        }
+        PageID next = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData())->children[0];
+        bpm.UnpinPage(page_id, false);
+        page_id = next;
+    }
+
+    KeyType last = 0;
+    keys = 0;
+    leaves = 0;
+    while (page_id != INVALID_PAGE_ID) {
+        Page *page = bpm.FetchPage(page_id);
+        auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+        for (uint32_t i = 0; i < leaf->header.key_count; i++) {
+            if (leaf->keys[i] < last) {
+                bpm.UnpinPage(page_id, false);
+                return false;
+            }
+            last = leaf->keys[i];
+        }
+        keys += leaf->header.key_count;
+        leaves++;
+
+        PageID next = leaf->next_leaf_page_id;
+        bpm.UnpinPage(page_id, false);
+        page_id = next;
+    }
+    return true;
+}
+
+int main() {
+    BufferPoolManager bpm(128);
+    IndexCatalog catalog(&bpm);
+
+    catalog.RegisterIndex(1, "plain", FieldType::NUMERIC, IndexType::BTREE, NewLeafRoot(bpm));
+    catalog.RegisterIndex(2, "append", FieldType::NUMERIC, IndexType::BTREE, NewLeafRoot(bpm));
+
+    BPlusTree plain(catalog.GetRoot(1), 1, &catalog, &bpm);
+    BPlusTree append(catalog.GetRoot(2), 2, &catalog, &bpm);
+    append.SetAppendMode(true);
+
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        if (!ok) {
+            std::cout << "FAIL " << what << "\n";
+            failures++;
+        }
+    };
+
+    // a log clock with jitter, duplicates and late records; reads are
+    // interleaved so deferred statistics are exercised mid-stream
+    std::mt19937_64 rng(3);
+    KeyType clock = 5'000'000;
+    uint32_t temp = 0;
+
+    for (uint64_t i = 0; i < 400000; i++) {
+        if (rng() % 3 == 0) clock++;
+        KeyType key = clock + rng() % 4;
+        if (rng() % 100 == 0) key -= rng() % 5000;
+
+        plain.Insert(key, RecordRef{i});
+        append.Insert(key, RecordRef{i});
+
+        if (i % 50000 == 49999) {
+            KeyType low = 5'000'000 + rng() % (clock - 5'000'000);
+            expect(plain.CountRange(low, clock + 10, temp) == append.CountRange(low, clock + 10, temp),
+                   "interleaved CountRange at " + std::to_string(i));
+        }
+    }
+
+    BPlusTreeStats a, b;
+    plain.GetStats(a);
+    append.GetStats(b);
+    expect(a.total_keys == b.total_keys && a.min_key == b.min_key && a.max_key == b.max_key,
+           "root statistics");
+
+    for (int i = 0; i < 500; i++) {
+        KeyType low = 4'990'000 + rng() % (clock - 4'990'000);
+        KeyType high = low + rng() % 5000;
+
+        expect(plain.CountRange(low, high, temp) == append.CountRange(low, high, temp),
+               "CountRange [" + std::to_string(low) + ", " + std::to_string(high) + "]");
+
+        std::vector<RecordRef> ra, rb;
+        plain.RangeSearch(low, high, ra, temp);
+        append.RangeSearch(low, high, rb, temp);
+        expect(ra.size() == rb.size(), "RangeSearch size");
+
+        KeyType point = low + rng() % 100;
+        plain.Search(point, ra, temp);
+        append.Search(point, rb, temp);
+        expect(ra.size() == rb.size(), "Search " + std::to_string(point));
+
+        KeyType ma = 0, mb = 0;
+        bool fa = plain.MaxInRange(low, high, ma, temp);
+        bool fb = append.MaxInRange(low, high, mb, temp);
+        expect(fa == fb && ma == mb, "MaxInRange");
+    }
+
+    uint64_t plain_keys, plain_leaves, append_keys, append_leaves;
+    expect(CheckLeafChain(bpm, plain.root_page_id_, plain_keys, plain_leaves), "plain leaf order");
+    expect(CheckLeafChain(bpm, append.root_page_id_, append_keys, append_leaves), "append leaf order");
+    expect(plain_keys == append_keys, "leaf key totals");
+
+    std::cout << "leaves: " << plain_leaves << " default, " << append_leaves << " append mode\n";
+    expect(append_leaves * 10 < plain_leaves * 7, "append mode packs leaves");
+
+    // the catalog keeps the new root, and the histogram saw every key
+    expect(catalog.GetRoot(2) == append.root_page_id_, "catalog root");
+    IndexStatsPage sa, sb;
+    catalog.GetIndexStats(1, sa);
+    catalog.GetIndexStats(2, sb);
+    expect(sa.total_count == sb.total_count, "histogram totals");
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/common/hash_util.h"
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/index/bloom_filter.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/btree/bplus_tree.h"
+#include "../include/index/trie/trie.h"
+
+using namespace cmse;
+
+static PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+static PageID NewTrieRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *root = reinterpret_cast<TrieNodePage *>(page->GetData());
+    for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
+        root->children[i] = INVALID_PAGE_ID;
+    }
+    root->is_terminal = false;
+    root->record_count = 0;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+int main() {
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) failures++;
+    };
+
+    // 1. the filter alone: grown by layers and bulk built
+    {
+        std::mt19937_64 rng(1);
+        BloomFilter grown;
+        std::vector<uint64_t> keys;
+        for (int i = 0; i < 300000; i++) {
+            keys.push_back(HashKey(rng()));
+            grown.Add(keys.back());
+        }
+        BloomFilter built = BloomFilter::Build(keys);
+
+        bool no_false_negatives = true;
+        for (uint64_t h : keys) {
+            no_false_negatives &= grown.MayContain(h) && built.MayContain(h);
+        }
+        expect(no_false_negatives, "no false negatives");
+
+        uint64_t fp_grown = 0, fp_built = 0;
+        const int PROBES = 1000000;
+        for (int i = 0; i < PROBES; i++) {
+            uint64_t h = HashKey(rng());
+            fp_grown += grown.MayContain(h);
+            fp_built += built.MayContain(h);
+        }
+        double rate_grown = static_cast<double>(fp_grown) / PROBES;
+        double rate_built = static_cast<double>(fp_built) / PROBES;
+        std::cout << "     false positives: " << rate_grown << " grown (" << grown.LayerCount()
+                  << " layers, " << grown.MemoryBytes() / 1024 << " KiB), " << rate_built
+                  << " bulk (" << built.MemoryBytes() / 1024 << " KiB), target "
+                  << BLOOM_FILTER_FPR << "\n";
+        expect(rate_grown <= BLOOM_FILTER_FPR && rate_built <= BLOOM_FILTER_FPR,
+               "false-positive rate within target");
+    }
+
+    BufferPoolManager bpm(128);
+    const uint64_t KEYS = 100000;
+    uint64_t saved_keys = 0;
+
+    {
+        IndexCatalog catalog(&bpm);
+        catalog.RegisterIndex(1, "timestamp", FieldType::NUMERIC, IndexType::BTREE, NewLeafRoot(bpm));
+        catalog.RegisterIndex(2, "severity", FieldType::STRING, IndexType::TRIE, NewTrieRoot(bpm));
+        catalog.RegisterIndex(3, "late", FieldType::NUMERIC, IndexType::BTREE, NewLeafRoot(bpm));
+
+        expect(catalog.GetBloomFilter(1) == nullptr, "no filter until enabled");
+        expect(catalog.EnableBloomFilter(1) && catalog.EnableBloomFilter(2), "enable");
+
+        // 2. B+Tree: even keys through both insert paths, odd keys absent
+        {
+            BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+            std::vector<std::pair<KeyType, RecordRef>> batch;
+            for (uint64_t i = 0; i < KEYS / 2; i++) {
+                batch.emplace_back(2 * i, RecordRef{i});
+            }
+            tree.InsertBatch(batch);
+            for (uint64_t i = KEYS / 2; i < KEYS; i++) {
+                tree.Insert(2 * i, RecordRef{i});
+            }
+        }
+
+        BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+        uint32_t temp = 0;
+        std::vector<RecordRef> result;
+
+        bool all_found = true;
+        for (uint64_t i = 0; i < KEYS; i += 97) {
+            tree.Search(2 * i, result, temp);
+            all_found &= result.size() == 1 && result[0].offset == i;
+        }
+        expect(all_found, "present keys found");
+        saved_keys = catalog.GetBloomFilter(1)->KeyCount();
+
+        uint64_t reads_before = bpm.GetFetchCount();
+        uint64_t descents = 0;
+        for (uint64_t i = 0; i < KEYS; i++) {
+            uint64_t before = bpm.GetFetchCount();
+            tree.Search(2 * i + 1, result, temp);
+            descents += bpm.GetFetchCount() != before;
+            if (!result.empty()) all_found = false;
+        }
+        double descent_rate = static_cast<double>(descents) / KEYS;
+        std::cout << "     absent B+Tree lookups: " << bpm.GetFetchCount() - reads_before
+                  << " page reads, " << descents << " of " << KEYS << " descended\n";
+        expect(all_found && descent_rate <= BLOOM_FILTER_FPR, "absent keys skip the tree");
+
+        // 3. trie, filter passed by the writer and the reader
+        {
+            TrieIndex trie(catalog.GetRoot(2), &bpm, catalog.GetStatsPage(2), catalog.GetBloomFilter(2));
+            std::vector<std::pair<std::string, RecordRef>> words = {
+                {"INFO", {1}}, {"WARN", {2}}, {"ERROR", {3}}};
+            trie.InsertBatch(words);
+            trie.Insert("DEBUG", RecordRef{4});
+        }
+
+        TrieIndex trie(catalog.GetRoot(2), &bpm, INVALID_PAGE_ID, catalog.GetBloomFilter(2));
+        trie.ExactSearch("DEBUG", result);
+        expect(result.size() == 1, "trie key found");
+        trie.ExactSearch("WARN", result);
+        expect(result.size() == 1, "trie batch key found");
+
+        reads_before = bpm.GetFetchCount();
+        for (const char *word : {"FATAL", "TRACE", "NOTICE", "ERR", "INFOS"}) {
+            trie.ExactSearch(word, result);
+        }
+        expect(bpm.GetFetchCount() == reads_before, "absent trie keys read no pages");
+
+        // 4. bulk build over an index that already has keys
+        {
+            BPlusTree late(catalog.GetRoot(3), 3, &catalog, &bpm);
+            for (uint64_t i = 0; i < 5000; i++) {
+                late.Insert(i * 7, RecordRef{i});
+            }
+        }
+        expect(catalog.EnableBloomFilter(3), "enable on a populated index");
+        BPlusTree late(catalog.GetRoot(3), 3, &catalog, &bpm);
+        all_found = true;
+        for (uint64_t i = 0; i < 5000; i++) {
+            late.Search(i * 7, result, temp);
+            all_found &= result.size() == 1;
+        }
+        expect(all_found, "bulk-built filter covers existing keys");
+    }
+
+    // 5. saved with the catalog and loaded again
+    {
+        IndexCatalog catalog(&bpm);
+        BloomFilter *filter = catalog.GetBloomFilter(1);
+        expect(filter != nullptr && filter->KeyCount() == saved_keys, "filter reloaded from pages");
+
+        // a change marks the saved copy stale until the next save
+        BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+        tree.Insert(1, RecordRef{999});
+
+        IndexCatalog crashed(&bpm);         // sees the stale copy: rebuilds
+        BPlusTree reread(catalog.GetRoot(1), 1, &crashed, &bpm);
+        std::vector<RecordRef> result;
+        uint32_t temp = 0;
+        reread.Search(1, result, temp);
+        expect(result.size() == 1, "stale filter rebuilt from the index");
+    }
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
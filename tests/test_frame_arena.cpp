@@ -0,0 +1,83 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/storage/frame_arena.h"
+
+using namespace cmse;
+
+int main() {
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) failures++;
+    };
+
+    // 1. the arena alone, small (plain pages) and huge-page sized
+    for (size_t frames : {size_t{128}, size_t{4096}}) {
+        FrameArena arena(frames, true, true);
+        std::cout << "     " << frames << " frames: " << FrameBackingName(arena.Backing())
+                  << ", " << arena.PartitionCount() << " partition(s)\n";
+
+        bool aligned = true, partitions_ok = true;
+        size_t last_partition = 0;
+        for (size_t i = 0; i < frames; i++) {
+            char *frame = arena.Frame(static_cast<FrameID>(i));
+            aligned &= reinterpret_cast<uintptr_t>(frame) % PAGE_SIZE == 0;
+            std::memset(frame, static_cast<int>(i & 0xff), PAGE_SIZE);
+
+            size_t partition = arena.PartitionOf(static_cast<FrameID>(i));
+            partitions_ok &= partition >= last_partition && partition < arena.PartitionCount();
+            last_partition = partition;
+        }
+        expect(aligned, "frames are PAGE_SIZE aligned");
+        expect(partitions_ok && arena.CurrentPartition() < arena.PartitionCount(),
+               "partitions cover the frames in order");
+
+        bool intact = true;
+        for (size_t i = 0; i < frames; i++) {
+            const char *frame = arena.Frame(static_cast<FrameID>(i));
+            intact &= frame[0] == static_cast<char>(i & 0xff) &&
+                      frame[PAGE_SIZE - 1] == static_cast<char>(i & 0xff);
+        }
+        expect(intact, "frames do not overlap");
+        if (frames < 512) {
+            expect(arena.Backing() == FrameBacking::NORMAL, "small pools stay on 4 KiB pages");
+        }
+    }
+
+    // 2. the pool over the arena: pages survive eviction and reload
+    BufferPoolManager bpm(16);
+    const int PAGES = 64;
+    PageID ids[PAGES];
+    for (int i = 0; i < PAGES; i++) {
+        Page *page = bpm.NewPage(&ids[i]);
+        bool fresh = true;
+        for (size_t b = 0; b < PAGE_SIZE; b++) fresh &= page->GetData()[b] == 0;
+        if (!fresh) {
+            expect(false, "new page is zeroed");
+        }
+        std::memset(page->GetData(), 'a' + i % 26, PAGE_SIZE);
+        bpm.UnpinPage(ids[i], true);
+    }
+
+    bool reloaded = true;
+    for (int i = 0; i < PAGES; i++) {
+        Page *page = bpm.FetchPage(ids[i]);
+        reloaded &= page != nullptr && page->GetData()[0] == 'a' + i % 26 &&
+                    page->GetData()[PAGE_SIZE - 1] == 'a' + i % 26 &&
+                    reinterpret_cast<uintptr_t>(page->GetData()) % PAGE_SIZE == 0;
+        bpm.UnpinPage(ids[i], false);
+    }
+    expect(reloaded, "pages written back and reloaded through arena frames");
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
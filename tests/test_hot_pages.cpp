@@ -0,0 +1,306 @@
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../include/common/metrics.h"
+#include "../include/common/storage_options.h"
+#include "../include/index/btree/bplus_tree.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/trie/trie.h"
+#include "../include/storage/buffer_pool_manager.h"
+
+using namespace cmse;
+
+static uint64_t HotHits() {
+    return MetricsRegistry::Global().Collect().Get(Counter::HOT_PAGE_HITS);
+}
+
+static uint64_t ReadValue(BufferPoolManager &bpm, PageID page_id) {
+    Page *page = bpm.FetchPage(page_id);
+    uint64_t value;
+    std::memcpy(&value, page->GetData(), sizeof(value));
+    bpm.UnpinPage(page_id, false);
+    return value;
+}
+
+static void WriteValue(BufferPoolManager &bpm, PageID page_id, uint64_t value) {
+    Page *page = bpm.FetchPage(page_id);
+    std::memcpy(page->GetData(), &value, sizeof(value));
+    bpm.UnpinPage(page_id, true);
+}
+
+static PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+static PageID NewTrieRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *root = reinterpret_cast<TrieNodePage *>(page->GetData());
+    for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
+        root->children[i] = INVALID_PAGE_ID;
+    }
+    root->is_terminal = false;
+    root->record_count = 0;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+int main() {
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) failures++;
+    };
+
+    const std::string dir = "data/test_hot_pages";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    StorageOptions options;
+    options.pool_pages = 32;
+    options.disk_file = dir + "/pages.disk";
+
+    // 1. the tier in the buffer pool
+    {
+        BufferPoolManager bpm(options);
+        expect(bpm.GetHotCapacity() == 8, "tier capped at a quarter of the pool");
+
+        std::vector<PageID> ids;
+        for (uint64_t i = 0; i < 64; i++) {
+            PageID page_id;
+            bpm.NewPage(&page_id);
+            bpm.UnpinPage(page_id, true);
+            WriteValue(bpm, page_id, i);
+            ids.push_back(page_id);
+        }
+
+        PageID hot = bpm.PinHotPage(ids[0]);
+        expect(BufferPoolManager::IsSwizzled(hot) && BufferPoolManager::Unswizzle(hot) == ids[0],
+               "swizzled id names the page");
+        expect(bpm.PinHotPage(ids[0]) == hot && bpm.GetHotPageCount() == 1, "pinning twice is a no-op");
+
+        // cycle the whole file through the pool: the hot page stays put
+        for (PageID page_id : ids) {
+            ReadValue(bpm, page_id);
+        }
+        uint64_t hits = HotHits();
+        Page *page = bpm.FetchPage(hot);
+        bool same_frame = page == bpm.FetchPage(ids[0]);
+        bpm.UnpinPage(ids[0], false);
+        bpm.UnpinPage(hot, false);
+        expect(same_frame && HotHits() == hits + 1, "hot page never evicted, hit by swizzled id");
+        expect(ReadValue(bpm, hot) == 0, "swizzled fetch reads the page");
+
+        for (size_t i = 1; i < ids.size(); i++) {
+            bpm.PinHotPage(ids[i]);
+        }
+        expect(bpm.GetHotPageCount() == 8 && bpm.PinHotPage(ids[40]) == INVALID_PAGE_ID,
+               "full tier refuses more pages");
+        expect(bpm.FetchPage(ids[40]) != nullptr && bpm.UnpinPage(ids[40], false),
+               "the rest of the pool still serves pages");
+
+        // a stale swizzled id falls back to the page table
+        expect(bpm.UnpinHotPage(hot) && !bpm.UnpinHotPage(hot), "released once");
+        PageID other = bpm.PinHotPage(ids[40]);
+        expect(BufferPoolManager::Unswizzle(other) == ids[40], "slot reused");
+        for (PageID page_id : ids) {
+            ReadValue(bpm, page_id);
+        }
+        expect(ReadValue(bpm, hot) == 0 && ReadValue(bpm, other) == 40, "stale and reused ids still right");
+
+        // a write epoch moves a hot page a snapshot reader holds: the tier
+        // follows the latest page
+        PageSnapshot before = bpm.OpenSnapshot();
+        {
+            SnapshotScope scope(&before);
+            Page *held = bpm.FetchPage(other);
+            bpm.BeginWrite();
+            WriteValue(bpm, other, 41);
+            bpm.CommitWrite();
+            uint64_t value;
+            std::memcpy(&value, held->GetData(), sizeof(value));
+            expect(value == 40 && bpm.UnpinPage(other, false), "reader keeps and unpins the old frame");
+        }
+        expect(ReadValue(bpm, other) == 41 && ReadValue(bpm, ids[40]) == 41, "latest page through the tier");
+        std::thread reader([&] {
+            SnapshotScope scope(&before);
+            expect(ReadValue(bpm, other) == 40, "older snapshot reads the old image");
+        });
+        reader.join();
+        expect(bpm.GetHotPageCount() == 8, "still hot after the move");
+        before = PageSnapshot();
+        expect(bpm.GetVersionCount() == 0, "old frame reclaimed");
+    }
+
+    // 2. the catalog keeps the upper index levels hot
+    {
+        options.pool_pages = 1024;
+        options.btree_leaf_max_keys = 8;
+        options.btree_internal_max_keys = 8;
+        options.disk_file = dir + "/tree.disk";
+        BufferPoolManager bpm(options);
+        IndexCatalog catalog(&bpm);
+
+        catalog.RegisterIndex(1, "timestamp", FieldType::NUMERIC, IndexType::BTREE, NewLeafRoot(bpm));
+        catalog.RegisterIndex(2, "message", FieldType::STRING, IndexType::TRIE, NewTrieRoot(bpm));
+
+        const uint64_t KEYS = 2000;
+        {
+            IndexWriteScope write(&catalog);
+            std::vector<std::pair<KeyType, RecordRef>> entries;
+            for (uint64_t k = 0; k < KEYS; k++) {
+                entries.emplace_back(k * 2, RecordRef{k});
+            }
+            BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+            tree.InsertBatch(entries);
+
+            TrieIndex trie(catalog.GetRoot(2), &bpm);
+            for (uint64_t k = 0; k < 200; k++) {
+                trie.Insert("key" + std::to_string(k), RecordRef{k});
+            }
+        }
+
+        auto levels = catalog.GetHotLevels(1);
+        expect(levels != nullptr && !levels->nodes.empty() &&
+                   BufferPoolManager::Unswizzle(levels->nodes[0].page_id) == catalog.GetRoot(1),
+               "tree root hot after the write epoch");
+        expect(levels != nullptr && levels->nodes.size() > 1 &&
+                   levels->nodes.size() == levels->nodes[0].children.size() + 1,
+               "and the level below it");
+        expect(catalog.GetHotLevels(2) != nullptr, "trie root hot as well");
+
+        BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+        BPlusTreeStats stats;
+        tree.GetStats(stats);
+        expect(stats.height >= 3, "tree deeper than the hot levels");
+
+        bool found = true;
+        uint64_t hits = HotHits();
+        for (uint64_t k = 0; k < KEYS; k++) {
+            std::vector<RecordRef> result;
+            uint32_t fetches = 0;
+            tree.Search(k * 2, result, fetches);
+            found = found && result.size() == 1 && result[0].offset == k;
+            tree.Search(k * 2 + 1, result, fetches);
+            found = found && result.empty();
+        }
+        expect(found, "point lookups through the hot levels");
+        // every lookup but the one past the last key (pruned at the root)
+        expect(HotHits() - hits >= 2 * (2 * KEYS - 1), "root and the next level hit by swizzled id");
+
+        std::vector<RecordRef> range;
+        uint32_t fetches = 0;
+        tree.RangeSearch(100, 299, range, fetches);
+        expect(range.size() == 100 && tree.CountRange(0, 2 * KEYS, fetches) == KEYS,
+               "range scans and counts");
+
+        TrieIndex trie(catalog.GetRoot(2), &bpm);
+        trie.SetHotLevels(catalog.GetHotLevels(2));
+        std::vector<RecordRef> refs;
+        trie.ExactSearch("key42", refs);
+        bool trie_ok = refs.size() == 1 && refs[0].offset == 42;
+        trie.PrefixSearch("key1", refs);
+        expect(trie_ok && refs.size() == 111, "trie searches through the hot levels");
+
+        // keys past the end split the root: the levels follow it, and a
+        // descent still holding the old ones stays right
+        {
+            IndexWriteScope write(&catalog);
+            std::vector<std::pair<KeyType, RecordRef>> entries;
+            for (uint64_t k = KEYS; k < 4 * KEYS; k++) {
+                entries.emplace_back(k * 2, RecordRef{k});
+            }
+            BPlusTree writer(catalog.GetRoot(1), 1, &catalog, &bpm);
+            writer.InsertBatch(entries);
+        }
+        auto after = catalog.GetHotLevels(1);
+        expect(after != nullptr && after != levels &&
+                   BufferPoolManager::Unswizzle(after->nodes[0].page_id) == catalog.GetRoot(1),
+               "hot levels rebuilt after the tree changed");
+
+        found = true;
+        BPlusTree fresh(catalog.GetRoot(1), 1, &catalog, &bpm);
+        for (uint64_t k = 0; k < 4 * KEYS; k += 7) {
+            std::vector<RecordRef> result;
+            fresh.Search(k * 2, result, fetches);
+            found = found && result.size() == 1 && result[0].offset == k;
+        }
+        expect(found, "lookups after the rebuild");
+        fresh.RangeSearch(0, 8 * KEYS, range, fetches);
+        expect(range.size() == 4 * KEYS, "whole range after the rebuild");
+
+        // readers under snapshots while a writer keeps changing the levels
+        std::atomic<bool> done{false};
+        std::atomic<bool> wrong{false};
+        std::thread writer([&] {
+            for (uint64_t b = 0; b < 20; b++) {
+                IndexWriteScope write(&catalog);
+                std::vector<std::pair<KeyType, RecordRef>> entries;
+                for (uint64_t i = 0; i < 200; i++) {
+                    entries.emplace_back((4 * KEYS + b * 200 + i) * 2, RecordRef{4 * KEYS + b * 200 + i});
+                }
+                BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+                tree.InsertBatch(entries);
+            }
+            done = true;
+        });
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 3; t++) {
+            readers.emplace_back([&, t] {
+                uint64_t k = t;
+                while (!done.load()) {
+                    PageSnapshot snapshot = catalog.OpenSnapshot();
+                    SnapshotScope scope(&snapshot);
+                    BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+                    std::vector<RecordRef> result;
+                    uint32_t reads = 0;
+                    k = (k + 97) % (4 * KEYS);
+                    tree.Search(k * 2, result, reads);
+                    if (result.size() != 1 || result[0].offset != k) wrong = true;
+                }
+            });
+        }
+        writer.join();
+        for (auto &reader : readers) reader.join();
+        expect(!wrong.load(), "snapshot lookups right while the levels change");
+        expect(bpm.GetHotPageCount() <= bpm.GetHotCapacity(), "tier within its capacity");
+    }
+
+    // 3. hot_index_levels = 0 turns the catalog's use off
+    {
+        options.hot_index_levels = 0;
+        BufferPoolManager bpm(options);
+        IndexCatalog catalog(&bpm);
+        expect(catalog.GetHotLevels(1) == nullptr && bpm.GetHotPageCount() == 0, "no hot levels");
+
+        BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+        std::vector<RecordRef> result;
+        uint32_t fetches = 0;
+        tree.Search(42, result, fetches);
+        expect(result.size() == 1 && result[0].offset == 21, "index reopened from disk");
+    }
+
+    std::filesystem::remove_all(dir);
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
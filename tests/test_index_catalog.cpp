@@ -0,0 +1,210 @@
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/common/storage_options.h"
+#include "../include/index/index_catalog.h"
+#include "../include/storage/buffer_pool_manager.h"
+
+using namespace cmse;
+
+int main() {
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) failures++;
+    };
+
+    const std::string dir = "data/test_index_catalog";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    StorageOptions options;
+    options.pool_pages = 32;
+    options.disk_file = dir + "/catalog.disk";
+
+    // 1. lookups are served from memory
+    {
+        BufferPoolManager bpm(options);
+        IndexCatalog catalog(&bpm);
+
+        catalog.RegisterIndex(1, "timestamp", FieldType::NUMERIC, IndexType::BTREE, 100);
+        catalog.RegisterIndex(2, "severity", FieldType::STRING, IndexType::TRIE, 200);
+
+        uint64_t fetches = bpm.GetFetchCount();
+        IndexMetaEntryPage meta;
+        bool by_field = catalog.GetEntryByField("severity", meta);
+        expect(by_field && meta.index_id == 2 && meta.root_page_id == 200 &&
+               meta.index_type == IndexType::TRIE, "entry by field name");
+        expect(catalog.GetEntryByField("timestamp", meta) && meta.index_id == 1,
+               "second entry by field name");
+        expect(!catalog.GetEntryByField("message", meta), "unknown field");
+        expect(catalog.HasIndex(1) && !catalog.HasIndex(3), "HasIndex");
+        expect(catalog.GetRoot(1) == 100 && catalog.GetStatsPage(1) != INVALID_PAGE_ID,
+               "root and stats page");
+        expect(bpm.GetFetchCount() == fetches, "lookups fetch no pages");
+
+        uint64_t version = catalog.GetVersion();
+        catalog.SetRoot(1, 150);
+        expect(catalog.GetRoot(1) == 150 && catalog.GetVersion() > version,
+               "SetRoot updates the cache and the version");
+
+        // renaming an index moves its field lookup
+        catalog.RegisterIndex(2, "level", FieldType::STRING, IndexType::TRIE, 200);
+        expect(!catalog.GetEntryByField("severity", meta) &&
+               catalog.GetEntryByField("level", meta) && meta.index_id == 2,
+               "re-registered field name");
+    }
+
+    // 2. changes were written through to the catalog pages
+    {
+        BufferPoolManager bpm(options);
+        IndexCatalog catalog(&bpm);
+
+        IndexMetaEntryPage meta;
+        expect(catalog.GetIndexCount() == 2, "two entries on disk");
+        expect(catalog.GetEntryByField("timestamp", meta) && meta.root_page_id == 150,
+               "root survives a restart");
+        expect(catalog.GetCatalogPageCount() == 1, "both entries share one page");
+        expect(catalog.GetEntryByField("level", meta) && meta.root_page_id == 200,
+               "field name survives a restart");
+
+        Page *directory = bpm.FetchPage(0);
+        auto *index_meta = reinterpret_cast<IndexMetaPage *>(directory->GetData());
+        PageID head = index_meta->catalog_head_page_id;
+        bool pages_format = index_meta->catalog_format == INDEX_CATALOG_FORMAT_PAGES;
+        bpm.UnpinPage(0, false);
+
+        Page *page = bpm.FetchPage(head);
+        auto *catalog_page = reinterpret_cast<IndexCatalogPage *>(page->GetData());
+        bool found = false;
+        for (uint32_t slot = 0; slot < INDEX_CATALOG_PAGE_ENTRIES; slot++) {
+            found = found || (catalog_page->used[slot] && catalog_page->entries[slot].index_id == 1 &&
+                              catalog_page->entries[slot].root_page_id == 150);
+        }
+        bpm.UnpinPage(head, false);
+        expect(pages_format && found, "catalog page holds the root");
+    }
+
+    // 3. readers see whole entries while roots change
+    {
+        BufferPoolManager bpm(options);
+        IndexCatalog catalog(&bpm);
+
+        std::atomic<bool> stop{false};
+        std::atomic<bool> torn{false};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 3; t++) {
+            readers.emplace_back([&] {
+                IndexMetaEntryPage meta;
+                while (!stop.load()) {
+                    // every root read must be one the writer set
+                    if (catalog.GetEntry(1, meta) && meta.root_page_id != 150 &&
+                        meta.root_page_id % 1000 != 7) {
+                        torn = true;
+                    }
+                }
+            });
+        }
+        for (PageID root = 1007; root < 50007; root += 1000) {
+            catalog.SetRoot(1, root);
+        }
+        stop = true;
+        for (auto &reader : readers) reader.join();
+
+        expect(!torn.load(), "readers only see roots that were set");
+        expect(catalog.GetRoot(1) == 49007, "last root wins");
+    }
+
+    // 4. hundreds of indexes, dropping, and slot reuse
+    {
+        std::filesystem::remove(options.disk_file);
+        const IndexID count = 300;
+        {
+            BufferPoolManager bpm(options);
+            IndexCatalog catalog(&bpm);
+            bool all = true;
+            for (IndexID id = 1; id <= count; id++) {
+                all = catalog.RegisterIndex(id, "field" + std::to_string(id), FieldType::NUMERIC,
+                                            IndexType::BTREE, 1000 + id) && all;
+            }
+            expect(all && catalog.GetIndexCount() == count, "300 indexes registered");
+            size_t pages = (count + INDEX_CATALOG_PAGE_ENTRIES - 1) / INDEX_CATALOG_PAGE_ENTRIES;
+            expect(catalog.GetCatalogPageCount() == pages, "entries packed into few pages");
+            expect(catalog.NextIndexId() == count + 1, "next id follows the highest");
+
+            expect(catalog.DropIndex(7) && !catalog.HasIndex(7), "drop an index");
+            expect(!catalog.DropIndex(7) && !catalog.DropIndex(count + 5), "drop unknown index fails");
+            IndexMetaEntryPage meta;
+            expect(!catalog.GetEntryByField("field7", meta), "dropped field is gone");
+            expect(catalog.RegisterIndex(count + 1, "reused", FieldType::STRING, IndexType::TRIE, 9) &&
+                   catalog.GetCatalogPageCount() == pages, "freed slot is reused");
+        }
+        {
+            BufferPoolManager bpm(options);
+            IndexCatalog catalog(&bpm);
+            IndexMetaEntryPage meta;
+            expect(catalog.GetIndexCount() == count, "index count survives a restart");
+            expect(catalog.GetEntryByField("field250", meta) && meta.root_page_id == 1250,
+                   "entry on a later page survives a restart");
+            expect(!catalog.HasIndex(7) && catalog.GetEntryByField("reused", meta) &&
+                   meta.index_id == count + 1, "drop and reuse survive a restart");
+            expect(catalog.ListIndexes().size() == count, "ListIndexes");
+        }
+    }
+
+    // 5. a directory written by older versions is converted on open
+    {
+        std::filesystem::remove(options.disk_file);
+        {
+            BufferPoolManager bpm(options);
+            Page *directory = bpm.FetchPage(0);
+            auto *index_meta = reinterpret_cast<IndexMetaPage *>(directory->GetData());
+            index_meta->catalog_format = INDEX_CATALOG_FORMAT_LEGACY;
+            index_meta->index_count = 2;
+            index_meta->ingested_bytes = 4321;
+            for (IndexID i = 0; i < 2; i++) {
+                PageID meta_id;
+                Page *page = bpm.NewPage(&meta_id);
+                auto *meta = reinterpret_cast<IndexMetaEntryPage *>(page->GetData());
+                meta->index_id = i + 1;
+                std::snprintf(meta->field_name, sizeof(meta->field_name), "%s",
+                              i == 0 ? "timestamp" : "severity");
+                meta->field_type = i == 0 ? FieldType::NUMERIC : FieldType::STRING;
+                meta->index_type = i == 0 ? IndexType::BTREE : IndexType::TRIE;
+                meta->root_page_id = 500 + i;
+                meta->stats_page_id = INVALID_PAGE_ID;
+                bpm.UnpinPage(meta_id, true);
+                index_meta->index_meta_pages[i] = meta_id;
+            }
+            bpm.UnpinPage(0, true);
+            bpm.FlushAllPages();
+        }
+        for (int open = 0; open < 2; open++) {
+            BufferPoolManager bpm(options);
+            IndexCatalog catalog(&bpm);
+            IndexMetaEntryPage meta;
+            std::string when = open == 0 ? " (converted)" : " (reopened)";
+            expect(catalog.GetIndexCount() == 2 && catalog.GetIngestedBytes() == 4321,
+                   "legacy count and ingested bytes" + when);
+            expect(catalog.GetEntryByField("severity", meta) && meta.index_id == 2 &&
+                   meta.root_page_id == 501 && meta.index_type == IndexType::TRIE,
+                   "legacy entry" + when);
+            expect(catalog.GetCatalogPageCount() == 1, "legacy entries on one page" + when);
+        }
+    }
+
+    std::filesystem::remove_all(dir);
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "../include/common/storage_options.h"
+#include "../include/index/btree/bplus_tree.h"
+#include "../include/index/index_catalog.h"
+#include "../include/ingest/log_ingestor.h"
+#include "../include/query/query_executor.h"
+#include "../include/query/query_parser.h"
+#include "../include/storage/buffer_pool_manager.h"
+
+using namespace cmse;
+
+static PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+static void AppendLines(const std::string &path, uint64_t from, uint64_t count) {
+    const char *severities[] = {"INFO", "INFO", "WARN", "ERROR"};
+    std::ofstream log(path, std::ios::app);
+    for (uint64_t i = from; i < from + count; i++) {
+        log << (1000000 + i) << " " << severities[i % 4] << " request id=" << i << " done\n";
+    }
+}
+
+static void Ingest(const std::string &log_path, BufferPoolManager &bpm, IndexCatalog &catalog) {
+    LogIngestor ingestor(log_path, &bpm, &catalog);
+    ingestor.Start();
+    ingestor.Wait();
+}
+
+static std::string Run(QueryExecutor &executor, const std::string &text) {
+    Query query;
+    if (!QueryParser::Parse(text, query)) {
+        return "parse error";
+    }
+    std::ostringstream out;
+    executor.Execute(query, out);
+    return out.str();
+}
+
+static bool Contains(const std::string &text, const std::string &what) {
+    return text.find(what) != std::string::npos;
+}
+
+int main() {
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) failures++;
+    };
+
+    const std::string dir = "data/test_index_ddl";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const std::string log_path = dir + "/app.log";
+    AppendLines(log_path, 0, 5000);
+
+    StorageOptions options;
+    options.pool_pages = 256;
+    options.disk_file = dir + "/index.disk";
+
+    // 1. parsing
+    {
+        Query query;
+        expect(QueryParser::Parse("CREATE INDEX ON message USING TRIE", query) &&
+               query.statement == StatementType::CREATE_INDEX &&
+               query.index_field == "message" && query.index_using == "TRIE", "CREATE INDEX");
+        expect(QueryParser::Parse("CREATE INDEX ON severity", query) &&
+               query.index_using.empty(), "CREATE INDEX without USING");
+        expect(QueryParser::Parse("DROP INDEX ON message", query) &&
+               query.statement == StatementType::DROP_INDEX, "DROP INDEX");
+        expect(QueryParser::Parse("SHOW INDEXES", query) &&
+               query.statement == StatementType::SHOW_INDEXES, "SHOW INDEXES");
+        expect(QueryParser::Parse("COUNT WHERE timestamp EQUALS 1", query) &&
+               query.statement == StatementType::SELECT, "queries are SELECT");
+        expect(!QueryParser::Parse("CREATE INDEX ON message USING HASH", query) &&
+               !QueryParser::Parse("DROP INDEX message", query) &&
+               !QueryParser::Parse("CREATE INDEX ON a b", query), "malformed statements");
+    }
+
+    // 2. create, backfill, keep ingesting, drop
+    {
+        BufferPoolManager bpm(options);
+        IndexCatalog catalog(&bpm);
+        catalog.RegisterIndex(1, "timestamp", FieldType::NUMERIC, IndexType::BTREE, NewLeafRoot(bpm));
+        Ingest(log_path, bpm, catalog);
+
+        RefReader reader(log_path);
+        QueryExecutor executor(&bpm, &catalog, &reader);
+
+        expect(Contains(Run(executor, "CREATE INDEX ON message USING BTREE"), "Error:"),
+               "message takes a trie");
+        expect(Contains(Run(executor, "CREATE INDEX ON host"), "Error:"), "unknown field");
+        expect(Contains(Run(executor, "CREATE INDEX ON timestamp"), "already has index #1"),
+               "field already indexed");
+
+        std::string created = Run(executor, "CREATE INDEX ON message");
+        expect(Contains(created, "Created index #2 on message (TRIE), 5000 records indexed"),
+               "CREATE INDEX backfills the ingested log");
+        expect(catalog.GetBloomFilter(2) != nullptr, "new index gets a Bloom filter");
+
+        std::string plan = Run(executor, "EXPLAIN WHERE message EQUALS \"request id=42 done\"");
+        expect(Contains(plan, "TRIE #2"), "planner uses the new index");
+        expect(Run(executor, "COUNT WHERE message EQUALS \"request id=42 done\"") == "COUNT: 1\n",
+               "backfilled record is found");
+
+        AppendLines(log_path, 5000, 100);
+        Ingest(log_path, bpm, catalog);
+        expect(Run(executor, "COUNT WHERE message EQUALS \"request id=5050 done\"") == "COUNT: 1\n",
+               "ingest feeds the new index");
+
+        std::string shown = Run(executor, "SHOW INDEXES");
+        expect(Contains(shown, "#1 timestamp BTREE") && Contains(shown, "#2 message TRIE") &&
+               Contains(shown, "Indexes: 2"), "SHOW INDEXES");
+
+        expect(Contains(Run(executor, "DROP INDEX ON message"), "Dropped index #2 on message"),
+               "DROP INDEX");
+        expect(!catalog.HasIndex(2) && catalog.GetBloomFilter(2) == nullptr, "index is gone");
+        expect(Contains(Run(executor, "DROP INDEX ON message"), "Error:"), "drop twice fails");
+        expect(Run(executor, "COUNT WHERE message EQUALS \"request id=42 done\"") == "COUNT: 1\n",
+               "queries fall back to a scan");
+
+        expect(Contains(Run(executor, "CREATE INDEX ON severity"),
+                        "Created index #2 on severity (TRIE), 5100 records indexed"),
+               "CREATE INDEX after a drop reuses the id");
+    }
+
+    // 3. the index set survives a restart
+    {
+        BufferPoolManager bpm(options);
+        IndexCatalog catalog(&bpm);
+        RefReader reader(log_path);
+        QueryExecutor executor(&bpm, &catalog, &reader);
+
+        std::string shown = Run(executor, "SHOW INDEXES");
+        expect(Contains(shown, "#2 severity TRIE") && !Contains(shown, "message") &&
+               Contains(shown, "Indexes: 2"), "indexes after a restart");
+        expect(Run(executor, "COUNT WHERE severity EQUALS \"ERROR\"") == "COUNT: 1275\n",
+               "restarted index answers");
+    }
+
+    std::filesystem::remove_all(dir);
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../include/index/index_stats.h"
+
+using namespace cmse;
+
+int main() {
+    static IndexStatsPage stats;
+    InitIndexStats(&stats);
+
+    // Timestamps at a steady 10/s, plus an incident burst of 50k entries
+    // packed into 60 seconds.
+    std::vector<KeyType> keys;
+    std::mt19937_64 rng(42);
+
+    for (KeyType t = 0; t < 100000; t++) {
+        keys.push_back(1'700'000'000 + t * 10 / 100);
+    }
+    std::uniform_int_distribution<KeyType> burst(1'700'000'500, 1'700'000'559);
+    for (int i = 0; i < 50000; i++) {
+        keys.push_back(burst(rng));
+    }
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    for (KeyType k : keys) {
+        IndexStatsAddKey(&stats, k);
+    }
+
+    int failures = 0;
+    auto check = [&](const char *name, double estimate, double actual, double tolerance) {
+        double error = std::fabs(estimate - actual) / std::max(1.0, actual);
+        std::cout << name << ": estimate=" << estimate
+                  << " actual=" << actual
+                  << " error=" << error * 100.0 << "%\n";
+        if (error > tolerance) {
+            std::cout << "  TOO FAR OFF\n";
+            failures++;
+        }
+    };
+
+    auto actual_range = [&](KeyType low, KeyType high) {
+        double n = 0;
+        for (KeyType k : keys) n += (k >= low && k <= high);
+        return n;
+    };
+
+    std::cout << "Buckets used: " << stats.bucket_count << "\n";
+
+    check("burst window", EstimateRangeCount(&stats, 1'700'000'500, 1'700'000'559),
+          actual_range(1'700'000'500, 1'700'000'559), 0.15);
+    check("quiet window", EstimateRangeCount(&stats, 1'700'002'000, 1'700'005'000),
+          actual_range(1'700'002'000, 1'700'005'000), 0.15);
+    check("everything", EstimateRangeCount(&stats, 0, ~0ULL),
+          static_cast<double>(keys.size()), 0.001);
+
+    // distinct keys
+    std::vector<KeyType> sorted = keys;
+    std::sort(sorted.begin(), sorted.end());
+    double distinct = static_cast<double>(
+        std::unique(sorted.begin(), sorted.end()) - sorted.begin());
+    check("distinct keys", EstimateDistinctKeys(&stats), distinct, 0.05);
+
+    // string sketch
+    static IndexStatsPage strings;
+    InitIndexStats(&strings);
+    for (int i = 0; i < 200000; i++) {
+        IndexStatsAddString(&strings, "session opened for user u" + std::to_string(i % 30000));
+    }
+    check("distinct strings", EstimateDistinctKeys(&strings), 30000, 0.05);
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
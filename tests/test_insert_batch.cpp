@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/btree/bplus_tree.h"
+#include "../include/index/trie/trie.h"
+
+using namespace cmse;
+
+static PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+static PageID NewTrieRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *root = reinterpret_cast<TrieNodePage *>(page->GetData());
+    for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
+        root->children[i] = INVALID_PAGE_ID;
+    }
+    root->is_terminal = false;
+    root->record_count = 0;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+static double Millis(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    BufferPoolManager bpm(256);
+    IndexCatalog catalog(&bpm);
+
+    catalog.RegisterIndex(1, "single", FieldType::NUMERIC, IndexType::BTREE, NewLeafRoot(bpm));
+    catalog.RegisterIndex(2, "batch", FieldType::NUMERIC, IndexType::BTREE, NewLeafRoot(bpm));
+
+    BPlusTree single(catalog.GetRoot(1), 1, &catalog, &bpm);
+    BPlusTree batched(catalog.GetRoot(2), 2, &catalog, &bpm);
+
+    // near-sorted timestamps (jitter of a few seconds, duplicates) with an
+    // occasional late record far in the past
+    std::mt19937_64 rng(11);
+    std::vector<std::pair<KeyType, RecordRef>> entries;
+    KeyType now = 1'000'000;
+    for (uint64_t i = 0; i < 300000; i++) {
+        if (i % 3 == 0) now++;
+        KeyType key = now + rng() % 5;
+        if (rng() % 1000 == 0) key = 1'000'000 + rng() % (now - 1'000'000 + 1);
+        entries.emplace_back(key, RecordRef{i * 100});
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &[key, ref] : entries) {
+        single.Insert(key, ref);
+    }
+    double single_ms = Millis(start);
+
+    start = std::chrono::steady_clock::now();
+    const size_t BATCH = 1024;
+    for (size_t i = 0; i < entries.size(); i += BATCH) {
+        size_t n = std::min(BATCH, entries.size() - i);
+        batched.InsertBatch(std::span(entries).subspan(i, n));
+    }
+    double batch_ms = Millis(start);
+
+    std::cout << "Insert:      " << single_ms << " ms\n"
+              << "InsertBatch: " << batch_ms << " ms\n";
+
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        if (!ok) {
+            std::cout << "FAIL " << what << "\n";
+            failures++;
+        }
+    };
+
+    // same contents, same statistics
+    BPlusTreeStats a, b;
+    single.GetStats(a);
+    batched.GetStats(b);
+    expect(a.total_keys == b.total_keys && a.min_key == b.min_key && a.max_key == b.max_key,
+           "root statistics");
+    expect(b.total_keys == entries.size(), "total keys");
+
+    uint32_t temp = 0;
+    for (int i = 0; i < 300; i++) {
+        KeyType low = 1'000'000 + rng() % (now - 1'000'000);
+        KeyType high = low + rng() % 2000;
+        expect(single.CountRange(low, high, temp) == batched.CountRange(low, high, temp),
+               "CountRange [" + std::to_string(low) + ", " + std::to_string(high) + "]");
+
+        std::vector<RecordRef> ra, rb;
+        single.RangeSearch(low, high, ra, temp);
+        batched.RangeSearch(low, high, rb, temp);
+        auto by_offset = [](const RecordRef &x, const RecordRef &y) { return x.offset < y.offset; };
+        std::sort(ra.begin(), ra.end(), by_offset);
+        std::sort(rb.begin(), rb.end(), by_offset);
+        expect(ra.size() == rb.size() &&
+                   std::equal(ra.begin(), ra.end(), rb.begin(),
+                              [](const RecordRef &x, const RecordRef &y) { return x.offset == y.offset; }),
+               "RangeSearch results");
+    }
+
+    IndexStatsPage sa, sb;
+    catalog.GetIndexStats(1, sa);
+    catalog.GetIndexStats(2, sb);
+    expect(sa.total_count == sb.total_count && sa.min_key == sb.min_key && sa.max_key == sb.max_key,
+           "histogram totals");
+
+    // trie: batch vs one by one
+    catalog.RegisterIndex(3, "sev_single", FieldType::STRING, IndexType::TRIE, NewTrieRoot(bpm));
+    catalog.RegisterIndex(4, "sev_batch", FieldType::STRING, IndexType::TRIE, NewTrieRoot(bpm));
+    TrieIndex trie_single(catalog.GetRoot(3), &bpm, catalog.GetStatsPage(3));
+    TrieIndex trie_batch(catalog.GetRoot(4), &bpm, catalog.GetStatsPage(4));
+
+    const char *words[] = {"INFO", "INFO", "INFO", "WARN", "WARNING", "ERROR", "ERR", "DEBUG"};
+    std::vector<std::pair<std::string, RecordRef>> strings;
+    for (uint64_t i = 0; i < 200; i++) {
+        strings.emplace_back(words[rng() % 8], RecordRef{i});
+    }
+
+    for (const auto &[word, ref] : strings) {
+        trie_single.Insert(word, ref);
+    }
+    trie_batch.InsertBatch(strings);
+
+    for (const char *word : {"INFO", "WARN", "WARNING", "ERROR", "ERR", "DEBUG", "ER"}) {
+        std::vector<RecordRef> ra, rb;
+        trie_single.ExactSearch(word, ra);
+        trie_batch.ExactSearch(word, rb);
+        expect(ra.size() == rb.size(), std::string("trie exact ") + word);
+
+        ra.clear();
+        rb.clear();
+        trie_single.PrefixSearch(word, ra);
+        trie_batch.PrefixSearch(word, rb);
+        expect(ra.size() == rb.size(), std::string("trie prefix ") + word);
+    }
+
+    catalog.GetIndexStats(3, sa);
+    catalog.GetIndexStats(4, sb);
+    expect(sa.total_count == sb.total_count, "trie stats count");
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../include/ingest/log_generator.h"
+
+using namespace cmse;
+
+static std::vector<std::string> Generate(const LogGeneratorOptions &options, size_t lines) {
+    LogGenerator generator(options);
+    std::vector<std::string> out;
+    for (size_t i = 0; i < lines; i++) out.push_back(generator.NextLine());
+    return out;
+}
+
+int main() {
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) failures++;
+    };
+
+    // 1. same seed, same lines; another seed, other lines
+    {
+        LogGeneratorOptions options;
+        options.seed = 11;
+        auto a = Generate(options, 2000);
+        auto b = Generate(options, 2000);
+        options.seed = 12;
+        auto c = Generate(options, 2000);
+        expect(a == b, "same seed reproduces the stream");
+        expect(a != c, "different seed gives a different stream");
+    }
+
+    // 2. line shape, rate, late lines and the severity mix
+    {
+        LogGeneratorOptions options;
+        options.seed = 5;
+        options.rate = 500;                 // 2 ms apart on average
+        options.late_fraction = 0.05;
+        options.max_skew_ticks = 1000;
+        options.severity_mix = {{"INFO", 80}, {"ERROR", 20}};
+
+        const size_t lines = 20000;
+        LogGenerator generator(options);
+        std::map<std::string, size_t> severities;
+        size_t late = 0, well_formed = 0, within_skew = 0;
+        KeyType newest = 0;
+        for (size_t i = 0; i < lines; i++) {
+            std::istringstream line(generator.NextLine());
+            KeyType ts = 0;
+            std::string severity, message;
+            if (line >> ts >> severity && std::getline(line >> std::ws, message) && !message.empty()) {
+                well_formed++;
+            }
+            severities[severity]++;
+            if (ts < newest) {
+                late++;
+                if (newest - ts <= options.max_skew_ticks) within_skew++;
+            }
+            newest = std::max(newest, ts);
+        }
+
+        expect(well_formed == lines, "every line is '<ts> <SEVERITY> <message>'");
+        expect(severities.size() == 2, "only the configured severities appear");
+        double error_share = static_cast<double>(severities["ERROR"]) / lines;
+        expect(error_share > 0.18 && error_share < 0.22, "severity mix is respected");
+
+        // 20000 lines at 500/s: ~40 s of log time, i.e. ~40000 ticks
+        KeyType span = generator.Clock() - options.start_timestamp;
+        expect(span > 36000 && span < 44000, "timestamps advance at the configured rate");
+        expect(late > 0 && late < lines / 10, "a few lines arrive late");
+        expect(within_skew == late, "late lines stay within max_skew_ticks");
+    }
+
+    // 3. option parsing
+    {
+        LogGeneratorOptions options;
+        std::string error;
+        expect(options.Set("rate", "250", error) && options.rate == 250, "Set rate");
+        expect(options.Set("severity_mix", "WARN=1,ERROR=3", error) &&
+               options.severity_mix.size() == 2 && options.severity_mix[1].second == 3,
+               "Set severity_mix");
+        expect(!options.Set("rate", "0", error), "rate must be positive");
+        expect(!options.Set("severity_mix", "WARN", error), "malformed mix is rejected");
+        expect(!options.Set("nope", "1", error) && !error.empty(), "unknown option is rejected");
+    }
+
+    // 4. templates start with their advertised prefix
+    {
+        std::mt19937_64 rng(3);
+        const auto &prefixes = LogGenerator::TemplatePrefixes();
+        bool all = true;
+        for (size_t t = 0; t < LogGenerator::TemplateCount(); t++) {
+            all = all && LogGenerator::MakeMessage(rng, t).rfind(prefixes[t], 0) == 0;
+        }
+        expect(all, "messages start with their template prefix");
+    }
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/btree/bplus_tree.h"
+#include "../include/index/trie/trie.h"
+#include "../include/ingest/log_ingestor.h"
+#include "../include/query/ref_reader.h"
+
+using namespace cmse;
+
+static PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+static PageID NewTrieRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *root = reinterpret_cast<TrieNodePage *>(page->GetData());
+    for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
+        root->children[i] = INVALID_PAGE_ID;
+    }
+    root->is_terminal = false;
+    root->record_count = 0;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+static void AppendLines(const std::string &path, uint64_t from, uint64_t count) {
+    const char *severities[] = {"INFO", "INFO", "WARN", "ERROR"};
+    std::ofstream log(path, std::ios::app);
+    for (uint64_t i = from; i < from + count; i++) {
+        log << (1000000 + i) << " " << severities[i % 4] << " request id=" << i << " done\n";
+    }
+}
+
+int main(int argc, char **argv) {
+    const std::string log_path = "test_log_ingestor.log";
+    uint64_t bulk_lines = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+
+    std::remove(log_path.c_str());
+    AppendLines(log_path, 0, bulk_lines);
+    {
+        std::ofstream log(log_path, std::ios::app);
+        log << "not a log line\n";
+    }
+
+    BufferPoolManager bpm(1024);
+    IndexCatalog catalog(&bpm);
+
+    PageID ts_root = NewLeafRoot(bpm);
+    PageID sev_root = NewTrieRoot(bpm);
+    catalog.RegisterIndex(1, "timestamp", FieldType::NUMERIC, IndexType::BTREE, ts_root);
+    catalog.RegisterIndex(2, "severity", FieldType::STRING, IndexType::TRIE, sev_root);
+
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) failures++;
+    };
+
+    // 1. bulk ingest of the existing file
+    {
+        LogIngestor ingestor(log_path, &bpm, &catalog);
+        expect(ingestor.Start(), "start");
+        ingestor.Wait();
+
+        IngestStats stats = ingestor.GetStats();
+        std::cout << stats.Describe() << "\n";
+        expect(stats.lines_indexed == bulk_lines, "all lines indexed");
+        expect(stats.parse_errors == 1, "one unparsable line");
+        expect(catalog.GetIngestedBytes() == stats.bytes_read, "resume point at end of log");
+    }
+
+    BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+    uint32_t temp = 0;
+    expect(tree.CountRange(0, UINT64_MAX, temp) == bulk_lines, "timestamp index count");
+
+    // offsets must point at the lines themselves
+    RefReader reader(log_path);
+    std::vector<RecordRef> refs;
+    tree.Search(1000000 + bulk_lines / 2, refs, temp);
+    expect(refs.size() == 1 &&
+               reader.Read(refs[0]).rfind(std::to_string(1000000 + bulk_lines / 2) + " ", 0) == 0,
+           "record ref offset");
+
+    TrieIndex trie(catalog.GetRoot(2), &bpm);
+    refs.clear();
+    trie.ExactSearch("ERROR", refs);
+    expect(!refs.empty() && reader.Read(refs[0]).find(" ERROR ") != std::string::npos,
+           "severity index");
+
+    // 2. follow mode picks up appended lines from the resume point
+    {
+        IngestOptions opts;
+        opts.follow = true;
+        opts.poll_interval_ms = 20;
+
+        LogIngestor ingestor(log_path, &bpm, &catalog, opts);
+        expect(ingestor.Start(), "start follow");
+
+        AppendLines(log_path, bulk_lines, 500);
+
+        for (int i = 0; i < 200 && ingestor.GetStats().lines_indexed < 500; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ingestor.Stop();
+
+        expect(ingestor.GetStats().lines_indexed == 500, "appended lines indexed");
+    }
+
+    BPlusTree tree_after(catalog.GetRoot(1), 1, &catalog, &bpm);
+    expect(tree_after.CountRange(0, UINT64_MAX, temp) == bulk_lines + 500,
+           "timestamp index count after follow");
+
+    std::remove(log_path.c_str());
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
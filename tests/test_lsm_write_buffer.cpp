@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/btree/bplus_tree.h"
+#include "../include/index/lsm/lsm_write_buffer.h"
+
+using namespace cmse;
+
+static PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+static std::vector<uint64_t> SortedOffsets(const std::vector<RecordRef> &refs) {
+    std::vector<uint64_t> offsets;
+    for (const auto &ref : refs) offsets.push_back(ref.offset);
+    std::sort(offsets.begin(), offsets.end());
+    return offsets;
+}
+
+int main() {
+    // the default pool: the buffer must work within 128 frames
+    BufferPoolManager bpm(128);
+    IndexCatalog catalog(&bpm);
+
+    catalog.RegisterIndex(1, "buffered", FieldType::NUMERIC, IndexType::BTREE, NewLeafRoot(bpm));
+    catalog.RegisterIndex(2, "reference", FieldType::NUMERIC, IndexType::BTREE, NewLeafRoot(bpm));
+
+    LsmWriteBuffer buffer(1, &bpm, &catalog);
+    catalog.AttachWriteBuffer(1, &buffer);
+    buffer.Start();
+
+    std::atomic<int> failures{0};
+    std::mutex print_mutex;
+    auto expect = [&](bool ok, const std::string &what) {
+        if (!ok) {
+            std::lock_guard<std::mutex> guard(print_mutex);
+            std::cout << "FAIL " << what << "\n";
+            failures++;
+        }
+    };
+
+    const uint64_t TOTAL = 600000;
+    const KeyType BASE = 1'000'000;
+    std::atomic<KeyType> clock{BASE};
+    std::atomic<bool> writing{true};
+
+    // writer: near-sorted timestamps with duplicates and late records, into
+    // the buffered index and, under the same latch hold, a plain tree
+    std::thread writer([&] {
+        std::mt19937_64 rng(7);
+        std::vector<std::pair<KeyType, RecordRef>> batch;
+        KeyType now = BASE;
+
+        for (uint64_t i = 0; i < TOTAL; i++) {
+            if (rng() % 3 == 0) now++;
+            KeyType key = now + rng() % 5;
+            if (rng() % 500 == 0) key = BASE + rng() % (now - BASE + 1);
+            batch.emplace_back(key, RecordRef{i});
+
+            if (batch.size() == 1024 || i + 1 == TOTAL) {
+                std::unique_lock<std::shared_mutex> latch(catalog.IndexLatch());
+                buffer.InsertBatch(batch);
+                BPlusTree reference(catalog.GetRoot(2), 2, &catalog, &bpm);
+                reference.InsertBatch(batch);
+                batch.clear();
+                clock = now;
+            }
+        }
+        writing = false;
+    });
+
+    // reader: tree + buffer must match the reference while runs are
+    // written and compacted underneath it
+    uint64_t reads = 0;
+    std::thread reader([&] {
+        std::mt19937_64 rng(9);
+        uint32_t temp = 0;
+
+        while (writing) {
+            std::shared_lock<std::shared_mutex> latch(catalog.IndexLatch());
+
+            KeyType now = clock;
+            KeyType low = BASE + rng() % (now - BASE + 1);
+            KeyType high = low + rng() % 20000;
+
+            BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+            BPlusTree reference(catalog.GetRoot(2), 2, &catalog, &bpm);
+
+            uint64_t expected = reference.CountRange(low, high, temp);
+            uint64_t got = tree.CountRange(low, high, temp) + buffer.CountRange(low, high);
+            expect(got == expected, "CountRange [" + std::to_string(low) + ", " +
+                                        std::to_string(high) + "] " + std::to_string(got) +
+                                        " != " + std::to_string(expected));
+
+            if (reads % 8 == 0) {
+                std::vector<RecordRef> a, b;
+                reference.RangeSearch(low, high, a, temp);
+                tree.RangeSearch(low, high, b, temp);
+                buffer.RangeSearch(low, high, b);
+                expect(SortedOffsets(a) == SortedOffsets(b), "RangeSearch results");
+
+                KeyType ref_max = 0, max = 0, buf_max = 0;
+                bool ref_found = reference.MaxInRange(low, high, ref_max, temp);
+                bool found = tree.MaxInRange(low, high, max, temp);
+                if (buffer.MaxInRange(low, high, buf_max)) {
+                    max = found ? std::max(max, buf_max) : buf_max;
+                    found = true;
+                }
+                expect(found == ref_found && (!found || max == ref_max), "MaxInRange");
+
+                KeyType ref_min = 0, min = 0, buf_min = 0;
+                reference.MinInRange(low, high, ref_min, temp);
+                found = tree.MinInRange(low, high, min, temp);
+                if (buffer.MinInRange(low, high, buf_min)) {
+                    min = found ? std::min(min, buf_min) : buf_min;
+                }
+                expect(!ref_found || min == ref_min, "MinInRange");
+            }
+            reads++;
+        }
+    });
+
+    writer.join();
+    reader.join();
+
+    LsmStats during = buffer.GetStats();
+    std::cout << "reads during ingest: " << reads << "\n" << during.Describe() << "\n";
+    expect(during.compactions > 0, "background compaction ran");
+
+    buffer.Stop();
+    catalog.AttachWriteBuffer(1, nullptr);
+
+    LsmStats after = buffer.GetStats();
+    std::cout << after.Describe() << "\n";
+    expect(after.memtable_entries == 0 && after.runs == 0 && after.frozen_memtables == 0,
+           "buffer drained on Stop");
+    expect(after.entries_compacted == TOTAL, "every entry compacted once");
+
+    // everything is in the tree now, and was counted once in the statistics
+    uint32_t temp = 0;
+    BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+    BPlusTree reference(catalog.GetRoot(2), 2, &catalog, &bpm);
+    expect(tree.CountRange(0, UINT64_MAX, temp) == TOTAL, "tree holds every key");
+
+    BPlusTreeStats a, b;
+    tree.GetStats(a);
+    reference.GetStats(b);
+    expect(a.total_keys == b.total_keys && a.min_key == b.min_key && a.max_key == b.max_key,
+           "root statistics");
+
+    IndexStatsPage sa, sb;
+    catalog.GetIndexStats(1, sa);
+    catalog.GetIndexStats(2, sb);
+    expect(sa.total_count == TOTAL && sa.total_count == sb.total_count, "histogram totals");
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
@@ -0,0 +1,245 @@
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/common/metrics.h"
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/btree/bplus_tree.h"
+
+using namespace cmse;
+
+static PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+static MetricsSnapshot Collect() {
+    return MetricsRegistry::Global().Collect();
+}
+
+int main() {
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) failures++;
+    };
+
+    const std::string dir = "data/test_metrics";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    // 1. bucket math: every value lands in a bucket at most 12.5% wide
+    {
+        bool exact = true;
+        for (uint64_t v = 0; v < METRICS_SUB_BUCKETS; v++) {
+            exact = exact && LatencyBucket(v) == v;
+        }
+        expect(exact, "small values have their own bucket");
+
+        bool bounded = true;
+        for (uint64_t v = 8; v < (uint64_t{1} << 41); v = v * 3 / 2 + 1) {
+            size_t b = LatencyBucket(v);
+            uint64_t low = LatencyBucketLow(b);
+            uint64_t high = LatencyBucketLow(b + 1);
+            bounded = bounded && low <= v && v < high && (high - low) * 8 <= low;
+        }
+        expect(bounded, "bucket bounds contain the value, width <= 1/8");
+        expect(LatencyBucket(uint64_t{1} << 50) == METRICS_HISTOGRAM_BUCKETS - 1,
+               "huge values go to the overflow bucket");
+    }
+
+    // 2. counts from many threads, including ones that have exited
+    {
+        MetricsSnapshot before = Collect();
+
+        const int THREADS = 4;
+        const uint64_t PER_THREAD = 100000;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; t++) {
+            threads.emplace_back([&] {
+                for (uint64_t i = 0; i < PER_THREAD; i++) {
+                    CountMetric(Counter::QUERIES);
+                }
+            });
+        }
+        for (auto &t : threads) t.join();
+
+        MetricsSnapshot after = Collect();
+        expect(after.Get(Counter::QUERIES) - before.Get(Counter::QUERIES) == THREADS * PER_THREAD,
+               "exited threads' counts kept");
+
+        // a live thread's counts are visible without it exiting
+        std::mutex m;
+        std::condition_variable cv;
+        bool counted = false, done = false;
+        std::thread live([&] {
+            CountMetric(Counter::QUERIES, 7);
+            std::unique_lock<std::mutex> lock(m);
+            counted = true;
+            cv.notify_all();
+            cv.wait(lock, [&] { return done; });
+        });
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&] { return counted; });
+        }
+        MetricsSnapshot live_snap = Collect();
+        expect(live_snap.Get(Counter::QUERIES) - after.Get(Counter::QUERIES) == 7,
+               "live thread's counts visible");
+        {
+            std::lock_guard<std::mutex> lock(m);
+            done = true;
+        }
+        cv.notify_all();
+        live.join();
+        expect(Collect().Get(Counter::QUERIES) == live_snap.Get(Counter::QUERIES),
+               "counts unchanged by thread exit");
+    }
+
+    // 3. percentiles: 1..1000 us, uniform
+    {
+        std::thread([] {
+            for (uint64_t us = 1; us <= 1000; us++) {
+                RecordLatency(Histogram::QUERY_MIN, us * 1000);
+            }
+        }).join();
+
+        const HistogramSnapshot &h = Collect().histograms[static_cast<size_t>(Histogram::QUERY_MIN)];
+        uint64_t p50 = h.Percentile(0.5);
+        uint64_t p99 = h.Percentile(0.99);
+        std::cout << "     p50 " << p50 << " ns, p99 " << p99 << " ns\n";
+        expect(h.count == 1000 && h.max_nanos == 1000000, "count and max");
+        expect(p50 >= 500000 && p50 <= 500000 * 9 / 8, "p50 within one bucket");
+        expect(p99 >= 990000 && p99 <= 1000000, "p99 within one bucket, capped at max");
+        expect(h.Percentile(1.0) == 1000000, "p100 is the max");
+    }
+
+    // 4. buffer pool and disk counters
+    {
+        StorageOptions options;
+        options.pool_pages = 16;
+        options.disk_file = dir + "/pool.disk";
+        BufferPoolManager bpm(options);
+
+        MetricsSnapshot before = Collect();
+        std::vector<PageID> ids;
+        for (int i = 0; i < 40; i++) {
+            PageID id;
+            Page *page = bpm.NewPage(&id);
+            page->GetData()[0] = static_cast<char>(i);
+            bpm.UnpinPage(id, true);
+            ids.push_back(id);
+        }
+        Page *resident = bpm.FetchPage(ids.back());   // hit
+        bpm.UnpinPage(ids.back(), false);
+        Page *evicted = bpm.FetchPage(ids.front());   // miss
+        bool intact = evicted->GetData()[0] == 0 && resident->GetData()[0] == 39;
+        bpm.UnpinPage(ids.front(), false);
+        MetricsSnapshot after = Collect();
+
+        auto delta = [&](Counter c) { return after.Get(c) - before.Get(c); };
+        expect(intact, "pages read back");
+        expect(delta(Counter::BUFFER_POOL_HITS) == 1, "one hit");
+        expect(delta(Counter::BUFFER_POOL_MISSES) == 1, "one miss");
+        expect(delta(Counter::BUFFER_POOL_EVICTIONS) == 40 - 16 + 1, "evictions");
+        expect(delta(Counter::BUFFER_POOL_DIRTY_WRITEBACKS) == 40 - 16 + 1, "dirty writebacks");
+        expect(delta(Counter::DISK_READS) == 1 && delta(Counter::DISK_READ_BYTES) == PAGE_SIZE,
+               "disk read bytes");
+        expect(delta(Counter::DISK_WRITE_BYTES) == delta(Counter::DISK_WRITES) * PAGE_SIZE,
+               "disk write bytes");
+        const auto hist = static_cast<size_t>(Histogram::DISK_WRITE_LATENCY);
+        expect(after.histograms[hist].count - before.histograms[hist].count ==
+                   delta(Counter::DISK_WRITES),
+               "one write latency sample per write");
+    }
+
+    // 5. per-index counters
+    {
+        StorageOptions options;
+        options.disk_file = dir + "/index.disk";
+        options.btree_leaf_max_keys = 8;
+        options.btree_internal_max_keys = 6;
+        BufferPoolManager bpm(options);
+        IndexCatalog catalog(&bpm);
+        catalog.RegisterIndex(3, "timestamp", FieldType::NUMERIC, IndexType::BTREE,
+                              NewLeafRoot(bpm));
+
+        MetricsSnapshot before = Collect();
+        BPlusTree tree(catalog.GetRoot(3), 3, &catalog, &bpm);
+        for (uint64_t i = 0; i < 1000; i++) {
+            tree.Insert(i * 7919 % 1000, RecordRef{i});
+        }
+        MetricsSnapshot after = Collect();
+
+        auto delta = [&](IndexCounter c) { return after.Get(3, c) - before.Get(3, c); };
+        std::cout << "     " << delta(IndexCounter::NODE_VISITS) << " node visits, "
+                  << delta(IndexCounter::LEAF_SPLITS) << " leaf splits, "
+                  << delta(IndexCounter::INTERNAL_SPLITS) << " internal splits\n";
+        expect(delta(IndexCounter::NODE_VISITS) >= 1000, "node visits counted");
+        expect(delta(IndexCounter::LEAF_SPLITS) >= 1000 / 8, "leaf splits counted");
+        expect(delta(IndexCounter::INTERNAL_SPLITS) > 0, "internal splits counted");
+        expect(after.Get(1, IndexCounter::LEAF_SPLITS) == before.Get(1, IndexCounter::LEAF_SPLITS),
+               "other indexes untouched");
+    }
+
+    // 6. Prometheus text
+    {
+        std::string path = dir + "/metrics.prom";
+        expect(MetricsRegistry::Global().WritePrometheusFile(path), "dump written");
+        std::ifstream in(path);
+        std::stringstream text;
+        text << in.rdbuf();
+        std::string prom = text.str();
+
+        expect(prom.find("# TYPE cmse_buffer_pool_hits_total counter\n") != std::string::npos,
+               "counter family");
+        expect(prom.find("cmse_index_leaf_splits_total{index=\"3\"} ") != std::string::npos,
+               "per-index label");
+        expect(prom.find("# TYPE cmse_query_seconds histogram\n") != std::string::npos,
+               "histogram family");
+        expect(prom.find("cmse_query_seconds_bucket{kind=\"min\",le=\"+Inf\"} 1000\n") !=
+                   std::string::npos,
+               "+Inf bucket equals count");
+        expect(prom.find("cmse_query_seconds_count{kind=\"min\"} 1000\n") != std::string::npos,
+               "histogram count");
+
+        // cumulative buckets never decrease
+        std::istringstream lines(prom);
+        std::string line;
+        uint64_t last = 0;
+        bool monotonic = true;
+        while (std::getline(lines, line)) {
+            if (line.rfind("cmse_disk_write_seconds_bucket", 0) != 0) continue;
+            uint64_t value = std::stoull(line.substr(line.rfind(' ') + 1));
+            monotonic = monotonic && value >= last;
+            last = value;
+        }
+        expect(monotonic && last > 0, "cumulative buckets");
+
+        std::cout << Collect().Describe();
+    }
+
+    std::filesystem::remove_all(dir);
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
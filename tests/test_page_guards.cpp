@@ -0,0 +1,205 @@
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/common/metrics.h"
+#include "../include/common/storage_options.h"
+#include "../include/index/btree/bplus_tree.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/trie/trie.h"
+#include "../include/storage/buffer_pool_manager.h"
+
+using namespace cmse;
+
+static PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    WritePageGuard page = bpm.NewPageGuarded(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page.GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    return root_id;
+}
+
+static PageID NewTrieRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    WritePageGuard page = bpm.NewPageGuarded(&root_id);
+    auto *node = reinterpret_cast<TrieNodePage *>(page.GetData());
+    for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
+        node->children[i] = INVALID_PAGE_ID;
+    }
+    node->is_terminal = false;
+    node->record_count = 0;
+    return root_id;
+}
+
+// Whether every frame of the pool can be pinned at once (nothing leaked a
+// pin); ids must name at least pool_pages pages
+static bool AllFramesFree(BufferPoolManager &bpm, const std::vector<PageID> &ids, size_t pool_pages) {
+    std::vector<ReadPageGuard> held;
+    for (size_t i = 0; i < pool_pages; i++) {
+        held.push_back(bpm.FetchPageRead(ids[i]));
+        if (!held.back()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) failures++;
+    };
+
+    const std::string dir = "data/test_page_guards";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    StorageOptions options;
+    options.pool_pages = 32;
+    options.btree_leaf_max_keys = 32;
+    options.btree_internal_max_keys = 8;
+    options.disk_file = dir + "/pages.disk";
+
+    // 1. pins follow the guards
+    {
+        BufferPoolManager bpm(options);
+        std::vector<PageID> ids;
+        for (uint64_t i = 0; i < 64; i++) {
+            PageID page_id;
+            WritePageGuard page = bpm.NewPageGuarded(&page_id);
+            std::memcpy(page.GetData(), &i, sizeof(i));
+            ids.push_back(page_id);
+        }
+
+        ReadPageGuard a = bpm.FetchPageRead(ids[0]);
+        expect(a && a.PageId() == ids[0], "read guard holds the page");
+
+        ReadPageGuard b = std::move(a);
+        expect(!a && b && b.PageId() == ids[0], "move hands the pin over");
+        b = bpm.FetchPageRead(ids[1]);
+        expect(!bpm.UnpinPage(ids[0], false), "assigning over a guard unpins its page");
+        b.Drop();
+        expect(!b && !bpm.UnpinPage(ids[1], false), "Drop unpins once");
+        b.Drop();
+
+        {
+            WritePageGuard page = bpm.FetchPageWrite(ids[3]);
+            uint64_t value = 1000;
+            std::memcpy(page.GetData(), &value, sizeof(value));
+        }
+        // every other page through the pool: ids[3] is evicted and reread
+        for (size_t i = 4; i < ids.size(); i++) {
+            bpm.FetchPageRead(ids[i]);
+        }
+        uint64_t value = 0;
+        std::memcpy(&value, bpm.FetchPageRead(ids[3]).GetData(), sizeof(value));
+        expect(value == 1000, "write guard unpins dirty");
+
+        std::vector<ReadPageGuard> held;
+        for (size_t i = 0; i < options.pool_pages; i++) {
+            held.push_back(bpm.FetchPageRead(ids[i]));
+        }
+        expect(!bpm.FetchPageRead(ids.back()), "guard empty when no frame is free");
+        held.clear();
+        expect(AllFramesFree(bpm, ids, options.pool_pages), "all frames free after the guards go");
+    }
+
+    // 2. B+Tree and trie operations leave no pins behind, and an insert
+    // fetches each node on its path once
+    {
+        BufferPoolManager bpm(options);
+        IndexCatalog catalog(&bpm);
+        catalog.RegisterIndex(1, "key", FieldType::NUMERIC, IndexType::BTREE, NewLeafRoot(bpm));
+        catalog.RegisterIndex(2, "seq", FieldType::NUMERIC, IndexType::BTREE, NewLeafRoot(bpm));
+        catalog.RegisterIndex(3, "message", FieldType::STRING, IndexType::TRIE, NewTrieRoot(bpm));
+
+        BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+        std::mt19937_64 rng(5);
+        std::vector<KeyType> keys;
+        for (uint32_t i = 0; i < 20000; i++) {
+            keys.push_back(rng() % 100000);
+            tree.Insert(keys.back(), RecordRef{i});
+        }
+        std::vector<std::pair<KeyType, RecordRef>> batch;
+        for (uint32_t i = 0; i < 5000; i++) {
+            batch.emplace_back(rng() % 100000, RecordRef{i});
+            keys.push_back(batch.back().first);
+        }
+        tree.InsertBatch(batch);
+
+        BPlusTree appended(catalog.GetRoot(2), 2, &catalog, &bpm);
+        appended.SetAppendMode(true);
+        for (uint32_t i = 0; i < 20000; i++) {
+            appended.Insert(i, RecordRef{i});
+        }
+        appended.FlushAppends();
+
+        TrieIndex trie(catalog.GetRoot(3), &bpm, catalog.GetStatsPage(3));
+        for (uint32_t i = 0; i < 2000; i++) {
+            trie.Insert("message " + std::to_string(rng() % 500), RecordRef{i});
+        }
+
+        BPlusTreeStats stats;
+        tree.GetStats(stats);
+        expect(stats.height >= 3 && stats.total_keys == keys.size(), "tree split into several levels");
+
+        bool found = true;
+        for (size_t i = 0; i < keys.size(); i += 97) {
+            std::vector<RecordRef> result;
+            uint32_t fetches = 0;
+            tree.Search(keys[i], result, fetches);
+            found = found && !result.empty();
+        }
+        expect(found, "inserted keys found");
+
+        std::vector<RecordRef> result;
+        uint32_t fetches = 0;
+        appended.RangeSearch(100, 10099, result, fetches);
+        expect(result.size() == 10000, "appended range complete");
+        KeyType min_key = 0, max_key = 0;
+        expect(appended.MinInRange(5000, 6000, min_key, fetches) && min_key == 5000 &&
+               appended.MaxInRange(5000, 6000, max_key, fetches) && max_key == 6000,
+               "min / max in range");
+        expect(appended.CountRange(0, 19999, fetches) == 20000, "counted range complete");
+        trie.PrefixSearch("message 1", result);
+        expect(!result.empty(), "trie prefix found");
+
+        // an insert that does not split: its path and the stats page
+        uint64_t fetched = 0;
+        for (int attempt = 0; attempt < 100 && fetched == 0; attempt++) {
+            tree.GetStats(stats);
+            uint64_t splits = MetricsRegistry::Global().Collect().Get(1, IndexCounter::LEAF_SPLITS);
+            uint64_t before = bpm.GetFetchCount();
+            tree.Insert(rng() % 100000, RecordRef{0});
+            if (MetricsRegistry::Global().Collect().Get(1, IndexCounter::LEAF_SPLITS) == splits) {
+                fetched = bpm.GetFetchCount() - before;
+            }
+        }
+        expect(fetched == stats.height + 1, "insert fetches each page once");
+
+        std::vector<PageID> ids;
+        for (PageID page_id = 1; ids.size() < options.pool_pages; page_id++) {
+            ids.push_back(page_id);
+        }
+        expect(AllFramesFree(bpm, ids, options.pool_pages),
+               "all frames free after inserts, splits and searches (catalog holds no pin)");
+    }
+
+    std::filesystem::remove_all(dir);
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
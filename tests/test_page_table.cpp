@@ -0,0 +1,148 @@
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/common/storage_options.h"
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/storage/page_table.h"
+
+using namespace cmse;
+
+int main() {
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) failures++;
+    };
+
+    const std::string dir = "data/test_page_table";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    // 1. open addressing against a reference map
+    {
+        PageTable table(1000);
+        expect(table.Capacity() >= 2000 && (table.Capacity() & (table.Capacity() - 1)) == 0,
+               "power-of-two capacity at load factor 1/2");
+
+        std::unordered_map<PageID, FrameID> reference;
+        std::mt19937_64 rng(3);
+        bool same = true;
+        for (int op = 0; op < 200000; op++) {
+            PageID page_id = rng() % 1500;
+            switch (rng() % 3) {
+            case 0:
+                if (reference.size() < 1000 || reference.count(page_id)) {
+                    FrameID frame_id = static_cast<FrameID>(rng() % 1000);
+                    table.Insert(page_id, frame_id);
+                    reference[page_id] = frame_id;
+                }
+                break;
+            case 1:
+                same = same && table.Erase(page_id) == (reference.erase(page_id) == 1);
+                break;
+            default: {
+                auto it = reference.find(page_id);
+                same = same && table.Find(page_id) == (it == reference.end() ? INVALID_FRAME_ID : it->second);
+            }
+            }
+        }
+        same = same && table.Size() == reference.size();
+        size_t visited = 0;
+        table.ForEach([&](PageID page_id, FrameID frame_id) {
+            visited++;
+            same = same && reference.count(page_id) && reference[page_id] == frame_id;
+        });
+        expect(same && visited == reference.size(), "inserts, moves and erases match a map");
+    }
+
+    StorageOptions options;
+    options.pool_pages = 64;
+    options.disk_file = dir + "/pages.disk";
+
+    // 2. lock-free hits while other threads evict
+    {
+        BufferPoolManager bpm(options);
+        std::vector<PageID> ids;
+        for (int i = 0; i < 512; i++) {
+            PageID page_id;
+            Page *page = bpm.NewPage(&page_id);
+            std::memcpy(page->GetData(), &page_id, sizeof(page_id));
+            bpm.UnpinPage(page_id, true);
+            ids.push_back(page_id);
+        }
+
+        std::atomic<bool> wrong{false};
+        std::atomic<bool> failed{false};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; t++) {
+            threads.emplace_back([&, t] {
+                std::mt19937_64 rng(t);
+                for (int i = 0; i < 20000; i++) {
+                    // a few hot pages, and a cold one now and then to force evictions
+                    PageID page_id = rng() % 8 == 0 ? ids[rng() % ids.size()] : ids[rng() % 4];
+                    Page *page = bpm.FetchPage(page_id);
+                    if (page == nullptr) {
+                        failed = true;
+                        continue;
+                    }
+                    PageID stored;
+                    std::memcpy(&stored, page->GetData(), sizeof(stored));
+                    if (stored != page_id || page->GetPageID() != page_id) {
+                        wrong = true;
+                    }
+                    if (!bpm.UnpinPage(page_id, false)) {
+                        failed = true;
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) thread.join();
+
+        expect(!wrong.load(), "every fetch returned the page asked for");
+        expect(!failed.load(), "no fetch or unpin failed");
+
+        // no pin leaked: the whole pool can be pinned at once
+        std::vector<PageID> held;
+        bool all = true;
+        for (size_t i = 0; i < options.pool_pages; i++) {
+            PageID page_id = ids[ids.size() - 1 - i];
+            all = all && bpm.FetchPage(page_id) != nullptr;
+            held.push_back(page_id);
+        }
+        expect(all, "all frames evictable afterwards");
+        expect(bpm.FetchPage(ids[0]) == nullptr, "pool full while every frame is pinned");
+        for (PageID page_id : held) {
+            bpm.UnpinPage(page_id, false);
+        }
+        expect(!bpm.UnpinPage(held[0], false), "unpin below zero is refused");
+        expect(bpm.GetFetchCount() >= 8 * 20000, "fetches counted across threads");
+    }
+
+    // 3. a page hit lock-free survives a restart like any other
+    {
+        BufferPoolManager bpm(options);
+        PageID page_id = 5;
+        Page *page = bpm.FetchPage(page_id);
+        PageID stored;
+        std::memcpy(&stored, page->GetData(), sizeof(stored));
+        bpm.UnpinPage(page_id, false);
+        expect(stored == page_id, "pages written back on eviction and exit");
+    }
+
+    std::filesystem::remove_all(dir);
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
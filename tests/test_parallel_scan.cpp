@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../include/common/thread_pool.h"
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/btree/bplus_tree.h"
+
+using namespace cmse;
+
+int main() {
+
+    // large enough to keep the whole tree resident
+    BufferPoolManager bpm(16384);
+    IndexCatalog catalog(&bpm);
+
+    // Create root leaf
+    PageID root_page_id;
+    Page *root_page = bpm.NewPage(&root_page_id);
+
+    auto *root_leaf =
+        reinterpret_cast<BPlusTreeLeafPage *>(root_page->GetData());
+
+    root_leaf->header.is_leaf = true;
+    root_leaf->header.key_count = 0;
+    root_leaf->header.parent_page_id = INVALID_PAGE_ID;
+    root_leaf->next_leaf_page_id = INVALID_PAGE_ID;
+
+    const IndexID TEST_INDEX_ID = 1;
+    catalog.SetRoot(TEST_INDEX_ID, root_page_id);
+    bpm.UnpinPage(root_page_id, true);
+
+    BPlusTree tree(root_page_id, TEST_INDEX_ID, &catalog, &bpm);
+
+    std::cout << "Inserting keys...\n";
+
+    const int N = 1'000'000;
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<KeyType> dist(0, 500'000);  // duplicates allowed
+
+    for (int i = 0; i < N; i++) {
+        tree.Insert(dist(rng), RecordRef{static_cast<uint64_t>(i)});
+    }
+
+    std::cout << "Insertion done.\n";
+
+    int failures = 0;
+
+    std::vector<RecordRef> serial;
+    uint32_t serial_fetches = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    tree.RangeSearch(10'000, 490'000, serial, serial_fetches);
+    double serial_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "serial: " << serial.size() << " records | "
+              << serial_fetches << " page fetches | " << serial_ms << " ms\n";
+
+    auto same = [](std::vector<RecordRef> a, std::vector<RecordRef> b, bool sort) {
+        auto by_offset = [](const RecordRef &x, const RecordRef &y) { return x.offset < y.offset; };
+        if (sort) {
+            std::sort(a.begin(), a.end(), by_offset);
+            std::sort(b.begin(), b.end(), by_offset);
+        }
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].offset != b[i].offset) return false;
+        }
+        return true;
+    };
+
+    for (size_t threads : {1, 2, 4, 8}) {
+        ThreadPool pool(threads);
+
+        for (bool ordered : {true, false}) {
+            std::vector<RecordRef> parallel;
+            uint32_t fetches = 0;
+
+            start = std::chrono::steady_clock::now();
+            tree.ParallelRangeSearch(10'000, 490'000, parallel, fetches, &pool, ordered);
+            double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+
+            bool ok = same(serial, parallel, !ordered);
+            std::cout << threads << " threads " << (ordered ? "ordered  " : "unordered")
+                      << ": " << parallel.size() << " records | "
+                      << fetches << " page fetches | " << ms << " ms"
+                      << (ok ? "" : " MISMATCH") << "\n";
+            if (!ok) failures++;
+        }
+    }
+
+    // narrow ranges and duplicates on partition boundaries
+    ThreadPool pool(4);
+    for (int i = 0; i < 200; i++) {
+        KeyType a = dist(rng);
+        KeyType b = a + dist(rng) % 20'000;
+
+        std::vector<RecordRef> expected, actual;
+        uint32_t fetches = 0;
+        tree.RangeSearch(a, b, expected, fetches);
+        tree.ParallelRangeSearch(a, b, actual, fetches, &pool);
+
+        if (!same(expected, actual, false)) {
+            std::cout << "range [" << a << ", " << b << "] mismatch\n";
+            failures++;
+        }
+    }
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
@@ -0,0 +1,313 @@
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../include/common/metrics.h"
+#include "../include/common/storage_options.h"
+#include "../include/index/btree/bplus_tree.h"
+#include "../include/index/index_catalog.h"
+#include "../include/storage/buffer_pool_manager.h"
+
+using namespace cmse;
+
+static uint64_t SwizzledHits() {
+    return MetricsRegistry::Global().Collect().Get(Counter::SWIZZLED_HITS);
+}
+
+static uint64_t ReadValue(BufferPoolManager &bpm, PageID page_id) {
+    Page *page = bpm.FetchPage(page_id);
+    uint64_t value;
+    std::memcpy(&value, page->GetData(), sizeof(value));
+    bpm.UnpinPage(page_id, false);
+    return value;
+}
+
+static void WriteValue(BufferPoolManager &bpm, PageID page_id, uint64_t value) {
+    Page *page = bpm.FetchPage(page_id);
+    std::memcpy(page->GetData(), &value, sizeof(value));
+    bpm.UnpinPage(page_id, true);
+}
+
+// Fetch child_id through slot of the pinned parent; value read, page unpinned
+static uint64_t ReadChild(BufferPoolManager &bpm, Page *parent, uint32_t slot, PageID child_id) {
+    Page *page = bpm.FetchChild(parent, slot, &child_id);
+    uint64_t value;
+    std::memcpy(&value, page->GetData(), sizeof(value));
+    bpm.UnpinPage(child_id, false);
+    return value;
+}
+
+static PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+int main() {
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) failures++;
+    };
+
+    const std::string dir = "data/test_pointer_swizzling";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    StorageOptions options;
+    options.pool_pages = 16;
+    options.disk_file = dir + "/pages.disk";
+
+    // 1. links between frames in the buffer pool
+    {
+        BufferPoolManager bpm(options);
+        std::vector<PageID> ids;
+        for (uint64_t i = 0; i < 64; i++) {
+            PageID page_id;
+            bpm.NewPage(&page_id);
+            bpm.UnpinPage(page_id, true);
+            WriteValue(bpm, page_id, i);
+            ids.push_back(page_id);
+        }
+
+        Page *parent = bpm.FetchPage(ids[0]);
+        PageID child_id = ids[1];
+        Page *child = bpm.FetchChild(parent, 3, &child_id);
+        expect(BufferPoolManager::IsSwizzled(child_id) && BufferPoolManager::Unswizzle(child_id) == ids[1],
+               "first fetch links the child and returns a swizzled id");
+        expect(bpm.UnpinPage(child_id, false) && bpm.GetSwizzledCount() == 1, "unpinned by swizzled id");
+
+        uint64_t hits = SwizzledHits();
+        child_id = ids[1];
+        expect(bpm.FetchChild(parent, 3, &child_id) == child && SwizzledHits() == hits + 1,
+               "second fetch goes through the link");
+        bpm.UnpinPage(child_id, false);
+
+        // the slot now names another child (a split moved it): relinked
+        expect(ReadChild(bpm, parent, 3, ids[2]) == 2 && ReadChild(bpm, parent, 3, ids[2]) == 2 &&
+                   bpm.GetSwizzledCount() == 1,
+               "stale link falls back and is replaced");
+        expect(ReadChild(bpm, parent, 4, ids[2]) == 2 && bpm.GetSwizzledCount() == 1,
+               "a frame is linked from one slot only");
+
+        // cycle the file through the pool: the evicted child unswizzles
+        for (PageID page_id : ids) {
+            ReadValue(bpm, page_id);
+        }
+        expect(bpm.GetSwizzledCount() == 0, "link dropped when the child is evicted");
+        expect(ReadChild(bpm, parent, 4, ids[2]) == 2, "child read back by id");
+        bpm.UnpinPage(ids[0], false);
+
+        // evicting the parent drops its links
+        for (PageID page_id : ids) {
+            ReadValue(bpm, page_id);
+        }
+        expect(bpm.GetSwizzledCount() == 0, "links dropped when the parent is evicted");
+
+        // a write epoch moves a linked child a snapshot reader holds: the
+        // link follows the latest page
+        parent = bpm.FetchPage(ids[10]);
+        expect(ReadChild(bpm, parent, 0, ids[11]) == 11 && bpm.GetSwizzledCount() == 1, "linked again");
+        PageSnapshot before = bpm.OpenSnapshot();
+        {
+            SnapshotScope scope(&before);
+            Page *held = bpm.FetchPage(ids[11]);
+            bpm.BeginWrite();
+            WriteValue(bpm, ids[11], 111);
+            bpm.CommitWrite();
+            uint64_t value;
+            std::memcpy(&value, held->GetData(), sizeof(value));
+            expect(value == 11 && bpm.UnpinPage(ids[11], false), "reader keeps the old frame");
+            expect(ReadChild(bpm, parent, 0, ids[11]) == 11, "snapshot reads the old image through the slot");
+        }
+        hits = SwizzledHits();
+        expect(ReadChild(bpm, parent, 0, ids[11]) == 111 && SwizzledHits() == hits + 1,
+               "link moved to the latest page");
+        before = PageSnapshot();
+        expect(bpm.GetVersionCount() == 0 && bpm.GetSwizzledCount() == 1, "old frame reclaimed, link kept");
+
+        // writers fetch by id
+        bpm.BeginWrite();
+        child_id = ids[11];
+        bpm.FetchChild(parent, 0, &child_id);
+        expect(child_id == ids[11], "write epochs do not use links");
+        bpm.UnpinPage(child_id, false);
+        bpm.CommitWrite();
+        bpm.UnpinPage(ids[10], false);
+    }
+
+    // 2. B+Tree descents through the links
+    {
+        options.pool_pages = 2048;
+        options.btree_leaf_max_keys = 8;
+        options.btree_internal_max_keys = 8;
+        options.hot_index_levels = 0;
+        options.disk_file = dir + "/tree.disk";
+        BufferPoolManager bpm(options);
+        IndexCatalog catalog(&bpm);
+        catalog.RegisterIndex(1, "timestamp", FieldType::NUMERIC, IndexType::BTREE, NewLeafRoot(bpm));
+
+        const uint64_t KEYS = 4000;
+        {
+            IndexWriteScope write(&catalog);
+            std::vector<std::pair<KeyType, RecordRef>> entries;
+            for (uint64_t k = 0; k < KEYS; k++) {
+                entries.emplace_back(k * 2, RecordRef{k});
+            }
+            BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+            tree.InsertBatch(entries);
+        }
+
+        BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+        BPlusTreeStats stats;
+        tree.GetStats(stats);
+        expect(stats.height >= 4, "tree several levels deep");
+
+        auto lookups = [&](BPlusTree &t) {
+            bool found = true;
+            for (uint64_t k = 0; k < KEYS; k++) {
+                std::vector<RecordRef> result;
+                uint32_t fetches = 0;
+                t.Search(k * 2, result, fetches);
+                found = found && result.size() == 1 && result[0].offset == k;
+                t.Search(k * 2 + 1, result, fetches);
+                found = found && result.empty();
+            }
+            return found;
+        };
+        expect(lookups(tree), "point lookups");
+        uint64_t hits = SwizzledHits();
+        expect(lookups(tree), "point lookups again");
+        // every level below the root, for all but the lookups pruned at the root
+        expect(SwizzledHits() - hits >= (stats.height - 1) * (2 * KEYS - 1),
+               "second round follows links all the way down");
+
+        std::vector<RecordRef> range;
+        uint32_t fetches = 0;
+        tree.RangeSearch(100, 299, range, fetches);
+        expect(range.size() == 100, "range scan");
+
+        // splits move children between slots and parents; descents stay right
+        {
+            IndexWriteScope write(&catalog);
+            BPlusTree writer(catalog.GetRoot(1), 1, &catalog, &bpm);
+            for (uint64_t k = 0; k < KEYS; k++) {
+                writer.Insert(k * 2 + 1, RecordRef{KEYS + k});
+            }
+        }
+        BPlusTree grown(catalog.GetRoot(1), 1, &catalog, &bpm);
+        bool found = true;
+        for (uint64_t k = 0; k < 2 * KEYS; k++) {
+            std::vector<RecordRef> result;
+            grown.Search(k, result, fetches);
+            found = found && result.size() == 1 && result[0].offset == (k % 2 ? KEYS + k / 2 : k / 2);
+        }
+        expect(found, "lookups after splits");
+
+        // readers while a writer splits pages
+        std::atomic<bool> done{false};
+        std::atomic<bool> wrong{false};
+        std::thread writer([&] {
+            for (uint64_t b = 0; b < 20; b++) {
+                IndexWriteScope write(&catalog);
+                BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+                for (uint64_t i = 0; i < 100; i++) {
+                    tree.Insert(4 * KEYS + b * 100 + i, RecordRef{4 * KEYS + b * 100 + i});
+                }
+            }
+            done = true;
+        });
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 3; t++) {
+            readers.emplace_back([&, t] {
+                uint64_t k = t;
+                while (!done.load()) {
+                    PageSnapshot snapshot = catalog.OpenSnapshot();
+                    SnapshotScope scope(&snapshot);
+                    BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+                    std::vector<RecordRef> result;
+                    uint32_t reads = 0;
+                    k = (k + 97) % (2 * KEYS);
+                    tree.Search(k, result, reads);
+                    if (result.size() != 1) wrong = true;
+                }
+            });
+        }
+        writer.join();
+        for (auto &reader : readers) reader.join();
+        expect(!wrong.load(), "snapshot lookups right while pages split");
+    }
+
+    // 3. a pool smaller than the tree: links come and go with evictions
+    {
+        options.pool_pages = 64;
+        BufferPoolManager bpm(options);
+        IndexCatalog catalog(&bpm);
+        std::atomic<bool> wrong{false};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; t++) {
+            readers.emplace_back([&, t] {
+                std::mt19937_64 rng(t);
+                BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+                for (int i = 0; i < 5000; i++) {
+                    // a few hot keys, and a cold one now and then to force evictions
+                    uint64_t k = rng() % 8 == 0 ? rng() % 4000 : rng() % 16;
+                    std::vector<RecordRef> result;
+                    uint32_t reads = 0;
+                    tree.Search(k * 2, result, reads);
+                    if (result.empty() || result[0].offset != k) wrong = true;
+                }
+            });
+        }
+        for (auto &reader : readers) reader.join();
+        expect(!wrong.load(), "lookups right while links are dropped");
+
+        // no pin leaked: the whole pool but the catalog page can be pinned at once
+        std::vector<PageID> held;
+        bool all = true;
+        for (PageID page_id = 1; page_id < options.pool_pages; page_id++) {
+            all = all && bpm.FetchPage(page_id) != nullptr;
+            held.push_back(page_id);
+        }
+        expect(all, "all frames evictable afterwards");
+        for (PageID page_id : held) {
+            bpm.UnpinPage(page_id, false);
+        }
+        expect(bpm.GetSwizzledCount() < options.pool_pages, "links only between resident frames");
+    }
+
+    // 4. pointer_swizzling = false: descents fetch by id
+    {
+        options.pointer_swizzling = false;
+        BufferPoolManager bpm(options);
+        IndexCatalog catalog(&bpm);
+        BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+        std::vector<RecordRef> result;
+        uint32_t fetches = 0;
+        tree.Search(42, result, fetches);
+        tree.Search(42, result, fetches);
+        expect(result.size() == 1 && result[0].offset == 21 && bpm.GetSwizzledCount() == 0, "no links");
+    }
+
+    std::filesystem::remove_all(dir);
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
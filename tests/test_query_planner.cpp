@@ -0,0 +1,133 @@
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/btree/bplus_tree.h"
+#include "../include/index/trie/trie.h"
+#include "../include/query/log_record.h"
+#include "../include/query/query_executor.h"
+#include "../include/query/query_parser.h"
+
+using namespace cmse;
+
+static PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+static PageID NewTrieRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *root = reinterpret_cast<TrieNodePage *>(page->GetData());
+    for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
+        root->children[i] = INVALID_PAGE_ID;
+    }
+    root->is_terminal = false;
+    root->record_count = 0;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+int main() {
+    const std::string log_path = "test_query_planner.log";
+    const char *severities[] = {"INFO", "INFO", "INFO", "WARN", "ERROR"};
+
+    // 1. write a small log file
+    std::ofstream log(log_path, std::ios::trunc);
+    std::vector<std::string> lines;
+    for (int i = 0; i < 2000; i++) {
+        std::string line = std::to_string(1000 + i) + " " + severities[i % 5] +
+                           " worker-" + std::to_string(i % 7) + " done";
+        lines.push_back(line);
+        log << line << "\n";
+    }
+    log.close();
+
+    BufferPoolManager bpm(128);
+    IndexCatalog catalog(&bpm);
+
+    PageID ts_root = NewLeafRoot(bpm);
+    PageID sev_root = NewTrieRoot(bpm);
+    catalog.RegisterIndex(1, "timestamp", FieldType::NUMERIC, IndexType::BTREE, ts_root);
+    catalog.RegisterIndex(2, "severity", FieldType::STRING, IndexType::TRIE, sev_root);
+
+    BPlusTree ts_index(ts_root, 1, &catalog, &bpm);
+    TrieIndex sev_index(sev_root, &bpm, catalog.GetStatsPage(2));
+
+    // 2. index every line by byte offset
+    uint64_t offset = 0;
+    for (const auto &line : lines) {
+        LogRecord record;
+        ParseLogRecord(line, record);
+        ts_index.Insert(record.timestamp, RecordRef{offset});
+        sev_index.Insert(record.severity, RecordRef{offset});
+        offset += line.size() + 1;
+    }
+
+    RefReader reader(log_path);
+    QueryPlanner planner(&bpm, &catalog, &reader);
+
+    int failures = 0;
+    auto check = [&](const std::string &q, PlanType expected) {
+        Query query;
+        if (!QueryParser::Parse(q, query)) {
+            std::cout << "PARSE FAILED: " << q << "\n";
+            failures++;
+            return;
+        }
+        QueryPlan plan = planner.Plan(query);
+        std::cout << q << "\n" << plan.Explain(query);
+        if (plan.type != expected) {
+            std::cout << "UNEXPECTED PLAN\n";
+            failures++;
+        }
+    };
+
+    std::cout << "Planning queries...\n";
+
+    check("WHERE timestamp BETWEEN 1100,1110", PlanType::INDEX_SCAN);
+    check("WHERE timestamp EQUALS 1500", PlanType::INDEX_SCAN);
+    check("WHERE timestamp BETWEEN 0,100000 AND message STARTSWITH \"worker-3\"",
+          PlanType::FULL_SCAN);
+    check("WHERE message EQUALS \"worker-1 done\"", PlanType::FULL_SCAN);
+    check("WHERE timestamp BETWEEN 1100,1105 AND severity EQUALS \"ERROR\"",
+          PlanType::INDEX_SCAN);
+    check("COUNT WHERE timestamp BETWEEN 1000,1999 GROUP BY 500", PlanType::INDEX_AGGREGATE);
+
+    std::cout << "\nExecuting query...\n";
+
+    Query query;
+    QueryParser::Parse("WHERE timestamp BETWEEN 1100,1119 AND severity EQUALS \"ERROR\"", query);
+    QueryExecutor executor(&bpm, &catalog, &reader);
+    executor.Execute(query);
+
+    QueryParser::Parse("EXPLAIN WHERE severity EQUALS \"WARN\" AND timestamp BETWEEN 1000,2999", query);
+    executor.Execute(query);
+
+    QueryParser::Parse("COUNT WHERE timestamp BETWEEN 1000,1999 GROUP BY 500", query);
+    executor.Execute(query);
+
+    QueryParser::Parse("COUNT WHERE severity EQUALS \"ERROR\" AND timestamp BETWEEN 1000,1999 GROUP BY 500", query);
+    executor.Execute(query);
+
+    std::remove(log_path.c_str());
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../include/common/storage_options.h"
+#include "../include/index/btree/bplus_tree.h"
+#include "../include/index/index_catalog.h"
+#include "../include/query/log_record.h"
+#include "../include/query/query_executor.h"
+#include "../include/query/query_parser.h"
+#include "../include/query/query_profile.h"
+#include "../include/storage/buffer_pool_manager.h"
+
+using namespace cmse;
+
+static PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+static bool Contains(const std::string &text, const std::string &what) {
+    return text.find(what) != std::string::npos;
+}
+
+int main() {
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) failures++;
+    };
+
+    const std::string dir = "data/test_query_profile";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    // 1. parsing
+    {
+        Query query;
+        expect(QueryParser::Parse("EXPLAIN ANALYZE COUNT WHERE timestamp BETWEEN 1,2", query) &&
+               query.explain && query.analyze && query.aggregate == AggregateOp::COUNT,
+               "EXPLAIN ANALYZE parses");
+        expect(QueryParser::Parse("EXPLAIN WHERE timestamp EQUALS 1", query) &&
+               query.explain && !query.analyze, "plain EXPLAIN does not analyze");
+        expect(QueryToString(query) == "WHERE timestamp EQUALS 1", "QueryToString");
+    }
+
+    // 2. stages nest and count this thread's page accesses
+    {
+        StorageOptions options;
+        options.pool_pages = 16;
+        options.disk_file = dir + "/pages.disk";
+        BufferPoolManager bpm(options);
+
+        PageID page_id;
+        bpm.NewPage(&page_id);
+        bpm.UnpinPage(page_id, true);
+
+        QueryProfile profile;
+        {
+            ProfileScope outer(&profile, "outer");
+            {
+                ProfileScope inner(&profile, "inner", "detail");
+                bpm.FetchPage(page_id);
+                bpm.UnpinPage(page_id, false);
+                inner.SetRows(3);
+            }
+            bpm.FetchPage(page_id);
+            bpm.UnpinPage(page_id, false);
+        }
+
+        const auto &stages = profile.Stages();
+        expect(stages.size() == 2, "two stages");
+        expect(stages[0].depth == 0 && stages[1].depth == 1, "inner stage nests");
+        expect(stages[1].pool_hits == 1 && stages[0].pool_hits == 2, "hits counted per stage");
+        expect(stages[1].rows == 3 && stages[1].detail == "detail", "rows and detail kept");
+        expect(stages[0].elapsed_nanos >= stages[1].elapsed_nanos &&
+               profile.TotalNanos() == stages[0].elapsed_nanos, "outer stage covers inner");
+
+        std::string trace = profile.ChromeTrace("q \"1\"");
+        expect(Contains(trace, "\"traceEvents\"") && Contains(trace, "\"ph\":\"X\"") &&
+               Contains(trace, "\"name\":\"inner\""), "Chrome trace has complete events");
+        expect(Contains(trace, "q \\\"1\\\""), "trace metadata is escaped");
+
+        ProfileScope none(nullptr, "ignored");
+        none.SetRows(1);
+    }
+
+    // 3. EXPLAIN ANALYZE through the executor, and the slow query log
+    {
+        const std::string log_path = dir + "/app.log";
+        std::vector<std::string> lines;
+        {
+            std::ofstream log(log_path, std::ios::trunc);
+            for (int i = 0; i < 20000; i++) {
+                lines.push_back(std::to_string(5000 + i) + " INFO request " + std::to_string(i));
+                log << lines.back() << "\n";
+            }
+        }
+
+        StorageOptions options;
+        options.pool_pages = 256;
+        options.disk_file = dir + "/index.disk";
+        BufferPoolManager bpm(options);
+        IndexCatalog catalog(&bpm);
+
+        PageID root = NewLeafRoot(bpm);
+        catalog.RegisterIndex(1, "timestamp", FieldType::NUMERIC, IndexType::BTREE, root);
+        BPlusTree tree(root, 1, &catalog, &bpm);
+        uint64_t offset = 0;
+        for (const auto &line : lines) {
+            LogRecord record;
+            ParseLogRecord(line, record);
+            tree.Insert(record.timestamp, RecordRef{offset});
+            offset += line.size() + 1;
+        }
+
+        RefReader reader(log_path);
+        QueryExecutor executor(&bpm, &catalog, &reader);
+
+        Query query;
+        QueryParser::Parse("EXPLAIN ANALYZE WHERE timestamp BETWEEN 5100,5109", query);
+        std::ostringstream out;
+        executor.Execute(query, out);
+        std::string text = out.str();
+
+        expect(Contains(text, "INDEX SCAN") && Contains(text, "Execution:"), "plan and execution");
+        expect(Contains(text, "-> execute (") && Contains(text, "rows=10 "), "rows counted");
+        expect(Contains(text, "   -> probe BTREE #1 timestamp BETWEEN 5100,5109"), "probe stage");
+        expect(Contains(text, "   -> fetch records") && Contains(text, "log="), "fetch stage reads the log");
+        expect(!Contains(text, "INFO request"), "results are not printed");
+
+        const std::string slow_dir = dir + "/slow";
+        executor.SetSlowQueryLog(slow_dir, 0);
+        QueryParser::Parse("COUNT WHERE timestamp BETWEEN 5000,5999", query);
+        std::ostringstream count_out;
+        executor.Execute(query, count_out);
+        expect(count_out.str() == "COUNT: 1000\n", "profiled query still answers");
+
+        size_t traces = 0;
+        for (const auto &entry : std::filesystem::directory_iterator(slow_dir)) {
+            std::ifstream in(entry.path());
+            std::stringstream content;
+            content << in.rdbuf();
+            traces += Contains(content.str(), "COUNT WHERE timestamp BETWEEN 5000,5999");
+        }
+        expect(traces == 1, "slow query trace written");
+    }
+
+    std::filesystem::remove_all(dir);
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
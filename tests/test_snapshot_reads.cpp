@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../include/common/storage_options.h"
+#include "../include/common/thread_pool.h"
+#include "../include/index/btree/bplus_tree.h"
+#include "../include/index/index_catalog.h"
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/storage/epoch_manager.h"
+
+using namespace cmse;
+
+static uint64_t ReadValue(BufferPoolManager &bpm, PageID page_id) {
+    Page *page = bpm.FetchPage(page_id);
+    uint64_t value;
+    std::memcpy(&value, page->GetData(), sizeof(value));
+    bpm.UnpinPage(page_id, false);
+    return value;
+}
+
+static void WriteValue(BufferPoolManager &bpm, PageID page_id, uint64_t value) {
+    Page *page = bpm.FetchPage(page_id);
+    std::memcpy(page->GetData(), &value, sizeof(value));
+    bpm.UnpinPage(page_id, true);
+}
+
+// value read on another thread through snapshot
+static uint64_t ReadIn(BufferPoolManager &bpm, const PageSnapshot &snapshot, PageID page_id) {
+    uint64_t value = 0;
+    std::thread reader([&] {
+        SnapshotScope scope(&snapshot);
+        value = ReadValue(bpm, page_id);
+    });
+    reader.join();
+    return value;
+}
+
+int main() {
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) failures++;
+    };
+
+    const std::string dir = "data/test_snapshot_reads";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    // 1. epoch-based reclamation
+    {
+        EpochManager epochs;
+        bool freed = false;
+
+        uint64_t epoch;
+        size_t slot = epochs.Enter(&epoch);
+        expect(epoch == epochs.Current() && epochs.MinActive() == epoch, "reader announced");
+
+        epochs.Retire([&] { freed = true; });
+        expect(epochs.Reclaim() == 0 && !freed, "not freed in the same epoch");
+        epochs.Advance();
+        expect(epochs.Reclaim() == 0 && !freed, "not freed while an older reader runs");
+        epochs.Exit(slot);
+        expect(epochs.MinActive() == EpochManager::IDLE, "reader gone");
+        expect(epochs.Reclaim() == 1 && freed && epochs.RetiredCount() == 0, "freed afterwards");
+    }
+
+    StorageOptions options;
+    options.pool_pages = 16;
+    options.disk_file = dir + "/pages.disk";
+
+    // 2. page versions
+    {
+        BufferPoolManager bpm(options);
+        PageID page_id;
+        bpm.NewPage(&page_id);
+        bpm.UnpinPage(page_id, true);
+        WriteValue(bpm, page_id, 1);
+
+        PageSnapshot before = bpm.OpenSnapshot();
+
+        bpm.BeginWrite();
+        WriteValue(bpm, page_id, 2);
+        PageSnapshot during = bpm.OpenSnapshot();
+        expect(ReadIn(bpm, before, page_id) == 1, "snapshot does not see an open epoch");
+        expect(ReadIn(bpm, during, page_id) == 1, "snapshot opened during the epoch neither");
+        expect(ReadValue(bpm, page_id) == 2, "writer reads its own change");
+        bpm.CommitWrite();
+
+        PageSnapshot after = bpm.OpenSnapshot();
+        expect(ReadIn(bpm, before, page_id) == 1 && ReadIn(bpm, after, page_id) == 2,
+               "committed epoch visible to later snapshots only");
+        expect(ReadValue(bpm, page_id) == 2, "latest page without a snapshot");
+        expect(bpm.GetVersionCount() == 1, "image kept for older snapshots");
+
+        before = PageSnapshot();
+        during = PageSnapshot();
+        expect(bpm.GetVersionCount() == 0, "image dropped with the last older snapshot");
+
+        // a reader keeps its pinned page while the writer moves on
+        std::atomic<int> step{0};
+        uint64_t pinned_value = 0;
+        bool unpinned = false;
+        std::thread reader([&] {
+            SnapshotScope scope(&after);
+            Page *page = bpm.FetchPage(page_id);
+            step = 1;
+            while (step.load() != 2) std::this_thread::yield();
+            std::memcpy(&pinned_value, page->GetData(), sizeof(pinned_value));
+            unpinned = bpm.UnpinPage(page_id, false);
+        });
+        while (step.load() != 1) std::this_thread::yield();
+        bpm.BeginWrite();
+        WriteValue(bpm, page_id, 3);
+        step = 2;
+        reader.join();
+        bpm.CommitWrite();
+        expect(pinned_value == 2 && unpinned, "pinned page left to its reader");
+        expect(ReadIn(bpm, after, page_id) == 2 && ReadValue(bpm, page_id) == 3,
+               "both versions readable");
+        after = PageSnapshot();
+        expect(bpm.GetVersionCount() == 0, "moved frame reclaimed");
+
+        // pages an epoch only read keep no image
+        PageSnapshot open = bpm.OpenSnapshot();
+        bpm.BeginWrite();
+        ReadValue(bpm, page_id);
+        bpm.CommitWrite();
+        expect(bpm.GetVersionCount() == 0, "unchanged page keeps no image");
+    }
+
+    // 3. scans during inserts see whole write epochs
+    {
+        options.pool_pages = 1024;
+        options.disk_file = dir + "/tree.disk";
+        BufferPoolManager bpm(options);
+        IndexCatalog catalog(&bpm);
+
+        PageID root_id;
+        Page *root = bpm.NewPage(&root_id);
+        auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(root->GetData());
+        leaf->header.is_leaf = true;
+        leaf->header.key_count = 0;
+        leaf->header.parent_page_id = INVALID_PAGE_ID;
+        leaf->next_leaf_page_id = INVALID_PAGE_ID;
+        bpm.UnpinPage(root_id, true);
+        catalog.RegisterIndex(1, "timestamp", FieldType::NUMERIC, IndexType::BTREE, root_id);
+
+        const uint64_t BATCHES = 150;
+        const uint64_t BATCH = 400;
+        std::atomic<bool> done{false};
+        std::atomic<uint64_t> scans{0};
+        std::atomic<bool> torn{false};
+        std::atomic<bool> went_back{false};
+
+        // keys spread over the whole range: every batch splits leaves everywhere
+        std::thread writer([&] {
+            for (uint64_t b = 0; b < BATCHES; b++) {
+                std::vector<std::pair<KeyType, RecordRef>> entries;
+                for (uint64_t i = 0; i < BATCH; i++) {
+                    entries.emplace_back(i * BATCHES + b, RecordRef{b * BATCH + i});
+                }
+                IndexWriteScope write(&catalog);
+                BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+                tree.InsertBatch(entries);
+            }
+            done = true;
+        });
+
+        ThreadPool pool(4);
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 3; t++) {
+            readers.emplace_back([&, t] {
+                uint64_t last = 0;
+                while (!done.load()) {
+                    PageSnapshot snapshot = catalog.OpenSnapshot();
+                    SnapshotScope scope(&snapshot);
+
+                    BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+                    std::vector<RecordRef> refs;
+                    uint32_t fetches = 0;
+                    if (t == 0) {
+                        tree.ParallelRangeSearch(0, BATCH * BATCHES, refs, fetches, &pool);
+                    } else {
+                        tree.RangeSearch(0, BATCH * BATCHES, refs, fetches);
+                    }
+                    uint64_t counted = tree.CountRange(0, BATCH * BATCHES, fetches);
+
+                    std::sort(refs.begin(), refs.end(), [](const RecordRef &a, const RecordRef &b) {
+                        return a.offset < b.offset;
+                    });
+                    bool whole = refs.size() % BATCH == 0 && counted == refs.size();
+                    for (size_t i = 0; whole && i < refs.size(); i++) {
+                        whole = refs[i].offset == i;     // batches 0..k exactly once
+                    }
+                    if (!whole) torn = true;
+                    if (refs.size() < last) went_back = true;
+                    last = refs.size();
+                    scans++;
+                }
+            });
+        }
+        writer.join();
+        for (auto &reader : readers) reader.join();
+
+        expect(!torn.load(), "every scan saw whole batches, each key once");
+        expect(!went_back.load(), "scans never went back in time");
+        expect(scans.load() > 0, "scans ran during the inserts");
+
+        PageSnapshot snapshot = catalog.OpenSnapshot();
+        SnapshotScope scope(&snapshot);
+        BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+        uint32_t fetches = 0;
+        expect(tree.CountRange(0, BATCH * BATCHES, fetches) == BATCH * BATCHES, "all keys at the end");
+    }
+
+    std::filesystem::remove_all(dir);
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
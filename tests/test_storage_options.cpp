@@ -0,0 +1,155 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/common/storage_options.h"
+#include "../include/storage/buffer_pool_manager.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/btree/bplus_tree.h"
+
+using namespace cmse;
+
+static PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+int main() {
+    int failures = 0;
+    auto expect = [&](bool ok, const std::string &what) {
+        std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+        if (!ok) failures++;
+    };
+
+    const std::string dir = "data/test_storage_options";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    // 1. parsing and validation
+    {
+        std::ofstream(dir + "/cmse.conf") << "# sizing experiment\n"
+                                             "pool_pages = 2K\n"
+                                             "direct_io = on   # bypass the page cache\n"
+                                             "btree_leaf_max_keys = 64\n";
+        StorageOptions options;
+        std::string error;
+        expect(options.LoadFile(dir + "/cmse.conf", error) && options.pool_pages == 2048 &&
+                   options.io_mode == DiskIoMode::DIRECT && options.btree_leaf_max_keys == 64,
+               "config file");
+        expect(options.Validate(error), "valid options");
+
+        bool rejected = !options.Set("pool_size", "10", error);
+        expect(rejected, "unknown option rejected: " + error);
+        rejected = !options.Set("direct_io", "maybe", error);
+        expect(rejected, "bad value rejected: " + error);
+
+        StorageOptions bad = options;
+        bad.btree_leaf_max_keys = BPLUS_TREE_LEAF_MAX_KEYS + 1;
+        rejected = !bad.Validate(error);
+        expect(rejected, "fan-out above page capacity: " + error);
+        bad = options;
+        bad.page_size = 12345;
+        rejected = !bad.Validate(error);
+        expect(rejected, "odd page size: " + error);
+        bad.page_size = PAGE_SIZE == 4096 ? 16384 : 4096;
+        rejected = !bad.Validate(error);
+        expect(rejected, "page size of another build: " + error);
+
+        std::ofstream(dir + "/broken.conf") << "pool_pages 12\n";
+        rejected = !options.LoadFile(dir + "/broken.conf", error);
+        expect(rejected && error.find(":1:") != std::string::npos,
+               "syntax error names the line: " + error);
+    }
+
+    // 2. small nodes from the options: the tree splits at the lower limit
+    StorageOptions options;
+    options.disk_file = dir + "/small_nodes.disk";
+    options.btree_leaf_max_keys = 8;
+    options.btree_internal_max_keys = 6;
+    const uint64_t KEYS = 5000;
+    {
+        BufferPoolManager bpm(options);
+        expect(bpm.GetDiskError().empty(), "new file opens");
+        IndexCatalog catalog(&bpm);
+        catalog.RegisterIndex(1, "timestamp", FieldType::NUMERIC, IndexType::BTREE,
+                              NewLeafRoot(bpm));
+
+        BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+        std::vector<std::pair<KeyType, RecordRef>> batch;
+        for (uint64_t i = 0; i < KEYS; i++) {
+            if (i % 2 == 0) {
+                tree.Insert(i, RecordRef{i});
+            } else {
+                batch.emplace_back(i, RecordRef{i});
+            }
+        }
+        tree.InsertBatch(batch);
+
+        BPlusTreeStats stats;
+        tree.GetStats(stats);
+        uint32_t temp = 0;
+        expect(tree.CountRange(0, KEYS, temp) == KEYS, "every key indexed");
+        std::cout << "     height " << stats.height << " with 8-key leaves\n";
+        expect(stats.height >= 5, "tree built from small nodes");
+    }
+
+    // 3. the file remembers its format
+    {
+        StorageOptions other = options;
+        other.btree_leaf_max_keys = 16;
+        BufferPoolManager bpm(other);
+        expect(!bpm.GetDiskError().empty(), "other fan-out refused: " + bpm.GetDiskError());
+    }
+    {
+        BufferPoolManager bpm(options);
+        expect(bpm.GetDiskError().empty(), "same options reopen");
+        IndexCatalog catalog(&bpm);
+        BPlusTree tree(catalog.GetRoot(1), 1, &catalog, &bpm);
+        uint32_t temp = 0;
+        expect(tree.CountRange(0, KEYS, temp) == KEYS, "keys read back");
+    }
+
+    // 4. files from before the header: 4 KiB pages, default fan-out
+    if (PAGE_SIZE == 4096) {
+        std::string legacy = dir + "/legacy.disk";
+        {
+            std::vector<char> page(PAGE_SIZE, 0);
+            std::ofstream out(legacy, std::ios::binary);
+            out.write(page.data(), PAGE_SIZE);
+        }
+        StorageOptions defaults;
+        defaults.disk_file = legacy;
+        {
+            BufferPoolManager bpm(defaults);
+            expect(bpm.GetDiskError().empty(), "legacy file opens with defaults");
+        }
+
+        DiskFileHeader header;
+        std::ifstream in(legacy, std::ios::binary);
+        in.seekg(DISK_FILE_HEADER_OFFSET);
+        in.read(reinterpret_cast<char *>(&header), sizeof(header));
+        expect(header.magic == DISK_FILE_MAGIC && header.page_size == PAGE_SIZE,
+               "header written to legacy file");
+    }
+
+    std::filesystem::remove_all(dir);
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "\nTest finished successfully.\n";
+    return 0;
+}
@@ -0,0 +1,203 @@
+// Load generator for `cmse serve`.
+//
+// Opens N client connections, each sending one query at a time and
+// waiting for the "END" line, and reports throughput and latency
+// percentiles over the whole run.
+//
+// usage: cmse_loadgen [--port N | --socket PATH] [--clients N]
+//                     [--duration SEC] [--queries FILE]
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string host = "127.0.0.1";
+    uint16_t port = 7411;
+    std::string unix_path;
+    size_t clients = 8;
+    double duration_sec = 10.0;
+    std::string queries_file;
+};
+
+// Default mix: point lookups, short ranges, aggregates and a selective
+// intersection, roughly what a log dashboard sends
+const std::vector<std::string> DEFAULT_QUERIES = {
+    "WHERE severity EQUALS \"ERROR\" AND timestamp BETWEEN 1000,1100",
+    "WHERE timestamp BETWEEN 1500,1520",
+    "COUNT WHERE timestamp BETWEEN 0,100000000000",
+    "COUNT WHERE timestamp BETWEEN 1000,5000 GROUP BY 500",
+    "MAX WHERE timestamp BETWEEN 0,100000000000",
+    "EXPLAIN WHERE severity STARTSWITH \"WA\"",
+};
+
+int Connect(const Options &opts) {
+    if (!opts.unix_path.empty()) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, opts.unix_path.c_str(), sizeof(addr.sun_path) - 1);
+        if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(opts.port);
+    inet_pton(AF_INET, opts.host.c_str(), &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Send one request and read until the "END" line; false on I/O error
+bool RoundTrip(int fd, const std::string &query, std::string &pending) {
+    std::string request = query + "\n";
+    size_t sent = 0;
+    while (sent < request.size()) {
+        ssize_t n = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+
+    char buffer[16 * 1024];
+    while (true) {
+        // look for "END\n" at the start of a line
+        size_t pos = 0;
+        while (pos < pending.size()) {
+            size_t newline = pending.find('\n', pos);
+            if (newline == std::string::npos) break;
+            if (pending.compare(pos, newline - pos, "END") == 0) {
+                pending.erase(0, newline + 1);
+                return true;
+            }
+            pos = newline + 1;
+        }
+        pending.erase(0, pos);
+
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) return false;
+        pending.append(buffer, static_cast<size_t>(n));
+    }
+}
+
+double Percentile(std::vector<double> &sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+    return sorted[idx];
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options opts;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        std::string value = argv[i + 1];
+        if (arg == "--port") opts.port = static_cast<uint16_t>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--host") opts.host = value;
+        else if (arg == "--socket") opts.unix_path = value;
+        else if (arg == "--clients") opts.clients = std::strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--duration") opts.duration_sec = std::strtod(value.c_str(), nullptr);
+        else if (arg == "--queries") opts.queries_file = value;
+        else {
+            std::cerr << "unknown option " << arg << "\n";
+            return 2;
+        }
+    }
+
+    std::vector<std::string> queries = DEFAULT_QUERIES;
+    if (!opts.queries_file.empty()) {
+        std::ifstream in(opts.queries_file);
+        queries.clear();
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty()) queries.push_back(line);
+        }
+        if (queries.empty()) {
+            std::cerr << "no queries in " << opts.queries_file << "\n";
+            return 2;
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                             std::chrono::duration<double>(opts.duration_sec));
+
+    std::mutex mutex;
+    std::vector<double> latencies_us;
+    std::atomic<uint64_t> errors{0};
+
+    auto client = [&](size_t id) {
+        int fd = Connect(opts);
+        if (fd < 0) {
+            errors++;
+            return;
+        }
+
+        std::vector<double> local;
+        std::string pending;
+        size_t next = id;   // clients start at different queries
+
+        while (Clock::now() < deadline) {
+            const std::string &query = queries[next++ % queries.size()];
+
+            auto start = Clock::now();
+            if (!RoundTrip(fd, query, pending)) {
+                errors++;
+                break;
+            }
+            local.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        }
+        close(fd);
+
+        std::lock_guard<std::mutex> guard(mutex);
+        latencies_us.insert(latencies_us.end(), local.begin(), local.end());
+    };
+
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < opts.clients; i++) {
+        threads.emplace_back(client, i);
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::sort(latencies_us.begin(), latencies_us.end());
+
+    std::cout << "clients:     " << opts.clients << "\n"
+              << "queries:     " << latencies_us.size() << "\n"
+              << "errors:      " << errors.load() << "\n"
+              << "throughput:  " << static_cast<double>(latencies_us.size()) / elapsed << " q/s\n"
+              << "latency p50: " << Percentile(latencies_us, 0.50) / 1000.0 << " ms\n"
+              << "latency p99: " << Percentile(latencies_us, 0.99) / 1000.0 << " ms\n"
+              << "latency max: " << Percentile(latencies_us, 1.0) / 1000.0 << " ms\n";
+
+    return errors.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+// Synthetic log generator (see LogGenerator).
+//
+// Writes "<timestamp> <SEVERITY> <message>" lines. The same options and
+// seed always produce the same file. With --realtime the lines are
+// written at --rate lines per wall-clock second instead of all at once,
+// to feed `cmse serve --follow`.
+//
+// usage: cmse_loggen [--lines N] [--out FILE] [--append] [--realtime]
+//                    [--seed N] [--start TS] [--ticks-per-second N]
+//                    [--rate LINES_PER_SEC] [--late-fraction F]
+//                    [--max-skew TICKS] [--zipf S]
+//                    [--severity-mix INFO=70,DEBUG=15,WARN=10,ERROR=5]
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "../include/ingest/log_generator.h"
+
+using namespace cmse;
+
+namespace {
+
+void PrintUsage() {
+    std::cerr <<
+        "usage: cmse_loggen [options]\n"
+        "\n"
+        "  --lines N              lines to write (default 100000; 0 with --realtime: forever)\n"
+        "  --out FILE             output file (default stdout)\n"
+        "  --append               append to FILE instead of replacing it\n"
+        "  --realtime             write at --rate lines per wall-clock second\n"
+        "\n"
+        "  --seed N               random seed (default 1)\n"
+        "  --start TS             first timestamp (default 1718000000000)\n"
+        "  --ticks-per-second N   timestamp resolution (default 1000: milliseconds)\n"
+        "  --rate N               mean lines per second of log time (default 1000)\n"
+        "  --late-fraction F      share of lines stamped in the past (default 0.01)\n"
+        "  --max-skew TICKS       how far in the past at most (default 2000)\n"
+        "  --zipf S               message template skew, P(k) ~ 1/k^S (default 1.1)\n"
+        "  --severity-mix MIX     relative weights (default INFO=70,DEBUG=15,WARN=10,ERROR=5)\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    LogGeneratorOptions options;
+    uint64_t lines = 100000;
+    std::string out_path;
+    bool append = false;
+    bool realtime = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--append") {
+            append = true;
+            continue;
+        }
+        if (arg == "--realtime") {
+            realtime = true;
+            continue;
+        }
+        if (arg.rfind("--", 0) != 0 || i + 1 >= argc) {
+            PrintUsage();
+            return 2;
+        }
+
+        std::string value = argv[++i];
+        std::string error;
+        if (arg == "--lines") {
+            lines = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--out") {
+            out_path = value;
+        } else {
+            // --max-skew -> max_skew, ...
+            std::string name = arg.substr(2);
+            for (char &c : name) {
+                if (c == '-') c = '_';
+            }
+            if (!options.Set(name, value, error)) {
+                std::cerr << error << "\n";
+                PrintUsage();
+                return 2;
+            }
+        }
+    }
+
+    std::ofstream file;
+    if (!out_path.empty()) {
+        file.open(out_path, append ? std::ios::app : std::ios::trunc);
+        if (!file) {
+            std::cerr << "cannot open " << out_path << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = out_path.empty() ? std::cout : file;
+
+    LogGenerator generator(options);
+
+    if (!realtime) {
+        for (uint64_t i = 0; i < lines; i++) {
+            out << generator.NextLine() << '\n';
+        }
+        out.flush();
+        return out ? 0 : 1;
+    }
+
+    // paced: catch up to rate * elapsed every 10 ms
+    auto start = std::chrono::steady_clock::now();
+    while (lines == 0 || generator.LinesGenerated() < lines) {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        auto due = static_cast<uint64_t>(elapsed * options.rate);
+        if (lines > 0 && due > lines) due = lines;
+
+        while (generator.LinesGenerated() < due) {
+            out << generator.NextLine() << '\n';
+        }
+        out.flush();
+        if (!out) {
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return 0;
+}
@@ -0,0 +1,504 @@
+// Replay harness: a mixed ingest + query workload against an in-process
+// engine, fully offline.
+//
+// 1. Generates a synthetic log (LogGenerator) in a scratch directory and
+//    indexes it the way `cmse` does (timestamp B+Tree, severity trie,
+//    Bloom filters), reporting bulk ingest throughput.
+// 2. For --duration seconds, appends new lines at --ingest-rate while a
+//    follow-mode LogIngestor indexes them, and --clients threads run the
+//    script's queries at --qps in total.
+// 3. Reports per operation: throughput and latency percentiles, plus how
+//    far ingest fell behind.
+//
+// Queries follow an open-loop schedule: query i is due at start + i/qps,
+// and its latency is measured from when it was due, so time spent queued
+// behind slow queries counts (no coordinated omission). Per-query random
+// choices are seeded from --seed and i, so runs are repeatable.
+//
+// usage: cmse_replay [--script FILE] [--lines N] [--ingest-rate N]
+//                    [--qps N] [--clients N] [--duration SEC]
+//                    [--seed N] [--pool-pages N] [--scan-threads N]
+//                    [--work-dir DIR] [--keep]
+//                    [--gen NAME=VALUE]...   (LogGenerator options)
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/common/metrics.h"
+#include "../include/common/thread_pool.h"
+#include "../include/index/btree/bplus_tree.h"
+#include "../include/index/index_catalog.h"
+#include "../include/index/trie/trie.h"
+#include "../include/ingest/log_generator.h"
+#include "../include/ingest/log_ingestor.h"
+#include "../include/query/query_executor.h"
+#include "../include/query/query_parser.h"
+#include "../include/query/ref_reader.h"
+
+using namespace cmse;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr IndexID TIMESTAMP_INDEX_ID = 1;
+constexpr IndexID SEVERITY_INDEX_ID = 2;
+
+struct Options {
+    std::string script_path;
+    uint64_t lines = 200000;        // generated and indexed before the replay
+    double ingest_rate = 2000;      // lines appended per second during the replay
+    double qps = 200;
+    size_t clients = 4;
+    double duration_sec = 10;
+    uint64_t seed = 1;
+    size_t pool_pages = 4096;
+    size_t scan_threads = 0;
+    std::string work_dir;
+    bool keep = false;
+    LogGeneratorOptions gen;
+};
+
+// <name> <weight> <query template>
+//
+// Placeholders, drawn per query:
+//   {ts}        timestamp uniform over the log written so far
+//   {recent}    timestamp in the newest 10% of the log
+//   {ts+N}      {ts} plus N (same draw), likewise {recent+N}
+//   {severity}  a severity from the generator's mix (by weight)
+//   {prefix}    the fixed start of a message template (by popularity)
+const char *const DEFAULT_SCRIPT =
+    "point      40  WHERE timestamp EQUALS {ts}\n"
+    "range      20  WHERE timestamp BETWEEN {recent},{recent+2000}\n"
+    "count      10  COUNT WHERE timestamp BETWEEN {ts},{ts+60000}\n"
+    "max         5  MAX WHERE timestamp BETWEEN {ts},{ts+600000}\n"
+    "prefix     10  COUNT WHERE severity STARTSWITH \"W\"\n"
+    "multi      15  WHERE timestamp BETWEEN {recent},{recent+5000} AND severity EQUALS "
+    "\"{severity}\" AND message STARTSWITH \"{prefix}\"\n";
+
+struct Operation {
+    std::string name;
+    double weight;
+    std::string query;
+};
+
+bool ParseScript(std::istream &in, std::vector<Operation> &ops, std::string &error) {
+    std::string line;
+    for (int line_no = 1; std::getline(in, line); line_no++) {
+        size_t begin = line.find_first_not_of(" \t");
+        if (begin == std::string::npos || line[begin] == '#') continue;
+
+        std::istringstream ss(line);
+        Operation op;
+        if (!(ss >> op.name >> op.weight) || op.weight <= 0) {
+            error = "line " + std::to_string(line_no) + ": expected <name> <weight> <query>";
+            return false;
+        }
+        std::getline(ss >> std::ws, op.query);
+        if (op.query.empty()) {
+            error = "line " + std::to_string(line_no) + ": missing query";
+            return false;
+        }
+        ops.push_back(std::move(op));
+    }
+    if (ops.empty()) {
+        error = "no operations";
+        return false;
+    }
+    return true;
+}
+
+// What placeholders are drawn from; the clock moves while ingest runs
+struct LogRange {
+    KeyType first = 0;
+    std::atomic<KeyType> last{0};
+};
+
+std::string Expand(const std::string &tmpl, const LogRange &range, const LogGeneratorOptions &gen,
+                   std::mt19937_64 &rng) {
+    KeyType first = range.first;
+    KeyType last = std::max(range.last.load(std::memory_order_relaxed), first + 1);
+    KeyType ts = first + rng() % (last - first);
+    KeyType recent_from = last - (last - first) / 10;
+    KeyType recent = recent_from + rng() % (last - recent_from);
+
+    std::string out;
+    size_t pos = 0;
+    while (pos < tmpl.size()) {
+        size_t open = tmpl.find('{', pos);
+        size_t close = open == std::string::npos ? open : tmpl.find('}', open);
+        if (close == std::string::npos) {
+            out += tmpl.substr(pos);
+            break;
+        }
+        out += tmpl.substr(pos, open - pos);
+
+        std::string token = tmpl.substr(open + 1, close - open - 1);
+        size_t plus = token.find('+');
+        uint64_t offset = plus == std::string::npos ? 0 : std::strtoull(token.c_str() + plus + 1, nullptr, 10);
+        std::string name = token.substr(0, plus);
+
+        if (name == "ts") {
+            out += std::to_string(ts + offset);
+        } else if (name == "recent") {
+            out += std::to_string(recent + offset);
+        } else if (name == "severity") {
+            std::vector<double> weights;
+            for (const auto &s : gen.severity_mix) weights.push_back(s.second);
+            std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+            out += gen.severity_mix[pick(rng)].first;
+        } else if (name == "prefix") {
+            const auto &prefixes = LogGenerator::TemplatePrefixes();
+            std::vector<double> weights;
+            for (size_t k = 1; k <= prefixes.size(); k++) {
+                weights.push_back(1.0 / std::pow(static_cast<double>(k), gen.zipf_exponent));
+            }
+            std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+            out += prefixes[pick(rng)];
+        } else {
+            out += "{" + token + "}";   // left for the parser to reject
+        }
+        pos = close + 1;
+    }
+    return out;
+}
+
+// Counts what the executor writes, keeps none of it
+class DiscardBuf : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+};
+
+void Record(HistogramSnapshot &h, uint64_t nanos) {
+    h.count++;
+    h.sum_nanos += nanos;
+    h.max_nanos = std::max(h.max_nanos, nanos);
+    h.buckets[LatencyBucket(nanos)]++;
+}
+
+void Merge(HistogramSnapshot &into, const HistogramSnapshot &from) {
+    into.count += from.count;
+    into.sum_nanos += from.sum_nanos;
+    into.max_nanos = std::max(into.max_nanos, from.max_nanos);
+    for (size_t b = 0; b < into.buckets.size(); b++) into.buckets[b] += from.buckets[b];
+}
+
+double Ms(uint64_t nanos) {
+    return static_cast<double>(nanos) / 1e6;
+}
+
+PageID NewLeafRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    leaf->header.is_leaf = true;
+    leaf->header.key_count = 0;
+    leaf->header.parent_page_id = INVALID_PAGE_ID;
+    leaf->next_leaf_page_id = INVALID_PAGE_ID;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+PageID NewTrieRoot(BufferPoolManager &bpm) {
+    PageID root_id;
+    Page *page = bpm.NewPage(&root_id);
+    auto *root = reinterpret_cast<TrieNodePage *>(page->GetData());
+    for (uint32_t i = 0; i < TRIE_ALPHABET_SIZE; i++) {
+        root->children[i] = INVALID_PAGE_ID;
+    }
+    root->is_terminal = false;
+    root->record_count = 0;
+    bpm.UnpinPage(root_id, true);
+    return root_id;
+}
+
+void PrintUsage() {
+    std::cerr <<
+        "usage: cmse_replay [options]\n"
+        "\n"
+        "  --script FILE        operations, one '<name> <weight> <query template>' per line\n"
+        "                       (default: a built-in point/range/count/prefix/multi mix)\n"
+        "  --lines N            log lines indexed before the replay (default 200000)\n"
+        "  --ingest-rate N      lines appended per second during the replay (default 2000)\n"
+        "  --qps N              target queries per second, all clients (default 200)\n"
+        "  --clients N          query threads (default 4)\n"
+        "  --duration SEC       replay length (default 10)\n"
+        "  --seed N             seed for the log and the query choices (default 1)\n"
+        "  --pool-pages N       buffer pool frames (default 4096)\n"
+        "  --scan-threads N     threads for parallel range/prefix scans (default 0)\n"
+        "  --work-dir DIR       where the log and index go (default: a temp directory)\n"
+        "  --keep               keep the work directory\n"
+        "  --gen NAME=VALUE     LogGenerator option: rate, late_fraction, max_skew, zipf,\n"
+        "                       severity_mix, start, ticks_per_second\n";
+}
+
+bool ParseOptions(int argc, char **argv, Options &opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--keep") {
+            opts.keep = true;
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+        std::string v = argv[++i];
+
+        if (arg == "--script") opts.script_path = v;
+        else if (arg == "--lines") opts.lines = std::strtoull(v.c_str(), nullptr, 10);
+        else if (arg == "--ingest-rate") opts.ingest_rate = std::strtod(v.c_str(), nullptr);
+        else if (arg == "--qps") opts.qps = std::strtod(v.c_str(), nullptr);
+        else if (arg == "--clients") opts.clients = std::strtoull(v.c_str(), nullptr, 10);
+        else if (arg == "--duration") opts.duration_sec = std::strtod(v.c_str(), nullptr);
+        else if (arg == "--seed") opts.seed = std::strtoull(v.c_str(), nullptr, 10);
+        else if (arg == "--pool-pages") opts.pool_pages = std::strtoull(v.c_str(), nullptr, 10);
+        else if (arg == "--scan-threads") opts.scan_threads = std::strtoull(v.c_str(), nullptr, 10);
+        else if (arg == "--work-dir") opts.work_dir = v;
+        else if (arg == "--gen") {
+            size_t eq = v.find('=');
+            std::string error;
+            if (eq == std::string::npos || !opts.gen.Set(v.substr(0, eq), v.substr(eq + 1), error)) {
+                std::cerr << (error.empty() ? "expected --gen NAME=VALUE" : error) << "\n";
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    opts.gen.seed = opts.seed;
+    return opts.qps > 0 && opts.clients > 0 && opts.duration_sec > 0 && opts.pool_pages >= 8;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options opts;
+    if (!ParseOptions(argc, argv, opts)) {
+        PrintUsage();
+        return 2;
+    }
+
+    std::vector<Operation> ops;
+    std::string error;
+    if (opts.script_path.empty()) {
+        std::istringstream in(DEFAULT_SCRIPT);
+        ParseScript(in, ops, error);
+    } else {
+        std::ifstream in(opts.script_path);
+        if (!in || !ParseScript(in, ops, error)) {
+            std::cerr << opts.script_path << ": " << (in ? error : "cannot read") << "\n";
+            return 2;
+        }
+    }
+
+    bool temp_dir = opts.work_dir.empty();
+    if (temp_dir) {
+        opts.work_dir = (std::filesystem::temp_directory_path() /
+                         ("cmse_replay_" + std::to_string(getpid()))).string();
+    }
+    std::filesystem::create_directories(opts.work_dir);
+    const std::string log_path = opts.work_dir + "/app.log";
+    const std::string disk_path = opts.work_dir + "/cmse.disk";
+    std::filesystem::remove(disk_path);
+
+    // ---- 1. initial log and bulk ingest ----
+    LogGenerator generator(opts.gen);
+    LogRange range;
+    range.first = opts.gen.start_timestamp;
+    {
+        std::ofstream log(log_path, std::ios::trunc);
+        for (uint64_t i = 0; i < opts.lines; i++) {
+            log << generator.NextLine() << '\n';
+        }
+    }
+    range.last = generator.Clock();
+
+    StorageOptions storage;
+    storage.pool_pages = opts.pool_pages;
+    storage.disk_file = disk_path;
+    BufferPoolManager bpm(storage);
+    IndexCatalog catalog(&bpm);
+    catalog.RegisterIndex(TIMESTAMP_INDEX_ID, "timestamp", FieldType::NUMERIC, IndexType::BTREE,
+                          NewLeafRoot(bpm));
+    catalog.RegisterIndex(SEVERITY_INDEX_ID, "severity", FieldType::STRING, IndexType::TRIE,
+                          NewTrieRoot(bpm));
+    catalog.EnableBloomFilter(TIMESTAMP_INDEX_ID);
+    catalog.EnableBloomFilter(SEVERITY_INDEX_ID);
+
+    {
+        LogIngestor ingestor(log_path, &bpm, &catalog);
+        if (!ingestor.Start()) {
+            std::cerr << "cannot read " << log_path << "\n";
+            return 1;
+        }
+        ingestor.Wait();
+        IngestStats stats = ingestor.GetStats();
+        std::cout << "bulk ingest: " << stats.lines_indexed << " lines in " << std::fixed
+                  << std::setprecision(2) << stats.elapsed_sec << " s ("
+                  << std::setprecision(0) << static_cast<double>(stats.lines_indexed) / stats.elapsed_sec
+                  << " lines/s)\n";
+    }
+
+    RefReader reader(log_path);
+    std::unique_ptr<ThreadPool> scan_pool;
+    if (opts.scan_threads > 0) {
+        scan_pool = std::make_unique<ThreadPool>(opts.scan_threads);
+    }
+    QueryExecutor executor(&bpm, &catalog, &reader, scan_pool.get());
+
+    // every template must expand to a valid query
+    for (const Operation &op : ops) {
+        std::mt19937_64 rng(opts.seed);
+        Query query;
+        std::string text = Expand(op.query, range, opts.gen, rng);
+        if (!QueryParser::Parse(text, query)) {
+            std::cerr << "operation '" << op.name << "': invalid query: " << text << "\n";
+            return 2;
+        }
+    }
+
+    // ---- 2. replay ----
+    IngestOptions follow;
+    follow.follow = true;
+    follow.poll_interval_ms = 10;
+    LogIngestor ingestor(log_path, &bpm, &catalog, follow);
+    ingestor.Start();
+
+    const auto start = Clock::now();
+    const auto deadline = start + std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double>(opts.duration_sec));
+    std::atomic<uint64_t> appended{0};
+
+    std::thread writer([&] {
+        if (opts.ingest_rate <= 0) return;
+        std::ofstream log(log_path, std::ios::app);
+        while (Clock::now() < deadline) {
+            double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            auto due = static_cast<uint64_t>(elapsed * opts.ingest_rate);
+            uint64_t n = appended.load();
+            for (; n < due; n++) {
+                log << generator.NextLine() << '\n';
+            }
+            log.flush();
+            appended = n;
+            range.last = generator.Clock();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    });
+
+    std::vector<double> weights;
+    for (const Operation &op : ops) weights.push_back(op.weight);
+    std::discrete_distribution<size_t> pick_op(weights.begin(), weights.end());
+
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / opts.qps));
+    std::atomic<uint64_t> next_query{0};
+    std::atomic<uint64_t> parse_errors{0};
+    std::mutex results_mutex;
+    std::vector<HistogramSnapshot> latency(ops.size());   // from when the query was due
+    std::vector<HistogramSnapshot> service(ops.size());   // from when it started
+
+    auto client = [&] {
+        std::vector<HistogramSnapshot> local_latency(ops.size());
+        std::vector<HistogramSnapshot> local_service(ops.size());
+        DiscardBuf discard;
+        std::ostream out(&discard);
+
+        while (true) {
+            uint64_t i = next_query++;
+            auto due = start + interval * static_cast<int64_t>(i);
+            if (due >= deadline) break;
+            std::this_thread::sleep_until(due);
+
+            std::mt19937_64 rng(opts.seed * 0x9E3779B97F4A7C15ULL + i);
+            size_t op = pick_op(rng);
+            std::string text = Expand(ops[op].query, range, opts.gen, rng);
+
+            auto begin = Clock::now();
+            Query query;
+            if (!QueryParser::Parse(text, query)) {
+                parse_errors++;
+                continue;
+            }
+            executor.Execute(query, out);
+            auto end = Clock::now();
+
+            Record(local_latency[op], static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - due).count()));
+            Record(local_service[op], static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()));
+        }
+
+        std::lock_guard<std::mutex> guard(results_mutex);
+        for (size_t op = 0; op < ops.size(); op++) {
+            Merge(latency[op], local_latency[op]);
+            Merge(service[op], local_service[op]);
+        }
+    };
+
+    std::vector<std::thread> clients;
+    for (size_t c = 0; c < opts.clients; c++) {
+        clients.emplace_back(client);
+    }
+    for (auto &t : clients) t.join();
+    writer.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    IngestStats at_end = ingestor.GetStats();
+    ingestor.Stop();
+    IngestStats stats = ingestor.GetStats();
+
+    // ---- 3. report ----
+    uint64_t total = 0;
+    for (const auto &h : latency) total += h.count;
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "replay: " << elapsed << " s, " << opts.clients << " clients, target "
+              << opts.qps << " q/s, achieved " << static_cast<double>(total) / elapsed << " q/s\n"
+              << "ingest: " << appended.load() << " lines appended ("
+              << static_cast<double>(appended.load()) / elapsed << " lines/s), "
+              << at_end.lines_indexed << " indexed by the end of the replay, "
+              << stats.lines_indexed << " after draining\n";
+    if (parse_errors.load() > 0) {
+        std::cout << "parse errors: " << parse_errors.load() << "\n";
+    }
+
+    std::cout << "\nlatency from due time, ms (service time p50 in the last column)\n"
+              << std::left << std::setw(12) << "op" << std::right << std::setw(8) << "count"
+              << std::setw(9) << "q/s" << std::setw(9) << "mean" << std::setw(9) << "p50"
+              << std::setw(9) << "p90" << std::setw(9) << "p99" << std::setw(9) << "p99.9"
+              << std::setw(9) << "max" << std::setw(11) << "svc p50" << "\n";
+    std::cout << std::setprecision(3);
+    for (size_t op = 0; op < ops.size(); op++) {
+        const HistogramSnapshot &h = latency[op];
+        std::cout << std::left << std::setw(12) << ops[op].name << std::right << std::setw(8)
+                  << h.count << std::setw(9) << std::setprecision(1)
+                  << static_cast<double>(h.count) / elapsed << std::setprecision(3)
+                  << std::setw(9) << (h.count ? Ms(h.sum_nanos / h.count) : 0.0)
+                  << std::setw(9) << Ms(h.Percentile(0.50)) << std::setw(9) << Ms(h.Percentile(0.90))
+                  << std::setw(9) << Ms(h.Percentile(0.99)) << std::setw(9) << Ms(h.Percentile(0.999))
+                  << std::setw(9) << Ms(h.max_nanos) << std::setw(11)
+                  << Ms(service[op].Percentile(0.50)) << "\n";
+    }
+
+    if (temp_dir && !opts.keep) {
+        std::filesystem::remove_all(opts.work_dir);
+    }
+    return 0;
+}